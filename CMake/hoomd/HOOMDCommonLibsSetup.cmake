@@ -39,6 +39,10 @@ endif()
 
 set(HOOMD_COMMON_LIBS ${ADDITIONAL_LIBS})
 
+# std::thread is used for background output
+find_package(Threads REQUIRED)
+list(APPEND HOOMD_COMMON_LIBS ${CMAKE_THREAD_LIBS_INIT})
+
 if (ENABLE_TBB)
     list(APPEND HOOMD_COMMON_LIBS ${TBB_LIBRARY})
 endif()
@@ -67,6 +67,36 @@ class PYBIND11_EXPORT Analyzer
             */
         virtual void analyze(unsigned int timestep){}
 
+        //! Returns true if the analyzer can run off the critical path
+        /*! Derived classes that implement analyzeSnapshot() return true. System then allows the analyzer to be
+            executed by the AnalyzerPipeline, while the simulation continues.
+        */
+        virtual bool isOffPathCapable()
+            {
+            return false;
+            }
+
+        //! Performs the analysis on a snapshot
+        /*! \param timestep Time step of the snapshot
+            \param snapshot Snapshot of the system at \a timestep, gathered on the root rank
+
+            Off-path analyzers implement this method in addition to analyze(). It is called from a worker thread of the
+            AnalyzerPipeline while the simulation continues, in time step order for each analyzer. Implementations
+            must only use the snapshot and state owned by the analyzer, the live particle data, groups and computes
+            may be modified concurrently. The method is called on all ranks, only the root rank has the particles.
+        */
+        virtual void analyzeSnapshot(unsigned int timestep, std::shared_ptr<const SnapshotSystemData<Scalar> > snapshot){}
+
+        //! Checks the analysis of a snapshot before it is submitted
+        /*! \param timestep Time step of the snapshot
+
+            Called on the main thread, on all ranks, before the snapshot of \a timestep is submitted to the
+            AnalyzerPipeline. The Messenger may write to python streams and must not be used from analyzeSnapshot(),
+            so off-path analyzers print their warnings here. analyzeSnapshot() reports errors only by throwing an
+            exception with the complete message, which the pipeline prints on the main thread.
+        */
+        virtual void prepareSnapshot(unsigned int timestep){}
+
         //! Sets the profiler for the analyzer to use
         void setProfiler(std::shared_ptr<Profiler> prof);
 
@@ -92,6 +122,12 @@ class PYBIND11_EXPORT Analyzer
         */
         virtual void resetStats(){}
 
+        //! Complete output that is still in progress
+        /*! Derived classes that write output in the background should wait in flush() until all of it is written.
+            System flushes all analyzers at the end of every run().
+        */
+        virtual void flush(){}
+
         //! Get needed pdata flags
         /*! Not all fields in ParticleData are computed by default. When derived classes need one of these optional
             fields, they must return the requested fields in getRequestedPDataFlags().
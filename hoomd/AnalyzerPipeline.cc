@@ -0,0 +1,209 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file AnalyzerPipeline.cc
+    \brief Defines the AnalyzerPipeline class
+*/
+
+#include "AnalyzerPipeline.h"
+
+#include <algorithm>
+
+using namespace std;
+
+/*! \param exec_conf The execution configuration
+
+    By default, a single worker thread executes the tasks and the analysis may lag behind by 100 time steps. The
+    threads are started when the first task is submitted.
+*/
+AnalyzerPipeline::AnalyzerPipeline(std::shared_ptr<const ExecutionConfiguration> exec_conf)
+    : m_exec_conf(exec_conf), m_max_lag(100), m_num_threads(1), m_stop(false)
+    {
+    m_exec_conf->msg->notice(5) << "Constructing AnalyzerPipeline" << endl;
+    }
+
+AnalyzerPipeline::~AnalyzerPipeline()
+    {
+    m_exec_conf->msg->notice(5) << "Destroying AnalyzerPipeline" << endl;
+    stopThreads();
+    }
+
+/*! \param max_lag Maximum number of time steps between the submission of a task and the time step at which
+                   waitForLag() waits for its completion
+*/
+void AnalyzerPipeline::setMaxLag(unsigned int max_lag)
+    {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_max_lag = max_lag;
+    }
+
+/*! \param num_threads Number of worker threads
+
+    Completes all queued tasks before the number of threads is changed.
+*/
+void AnalyzerPipeline::setNumThreads(unsigned int num_threads)
+    {
+    if (num_threads == 0)
+        {
+        m_exec_conf->msg->error() << "The analyzer pipeline needs at least one thread" << endl;
+        throw runtime_error("Error setting analyzer pipeline parameters");
+        }
+
+    stopThreads();
+    m_num_threads = num_threads;
+    checkError();
+    }
+
+/*! \param analyzer Analyzer to execute
+    \param timestep Time step of the snapshot
+    \param snapshot Snapshot to pass to Analyzer::analyzeSnapshot()
+*/
+void AnalyzerPipeline::submit(std::shared_ptr<Analyzer> analyzer, unsigned int timestep, std::shared_ptr<const Snapshot> snapshot)
+    {
+    checkError();
+
+    if (m_threads.empty())
+        {
+        for (unsigned int i = 0; i < m_num_threads; i++)
+            m_threads.push_back(std::thread(&AnalyzerPipeline::workerThread, this));
+        }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_tasks.push_back(Task(analyzer, timestep, snapshot));
+    m_cv.notify_all();
+    }
+
+/*! \param timestep Current time step of the simulation
+
+    Blocks until all tasks of time steps before \a timestep - getMaxLag() are complete.
+*/
+void AnalyzerPipeline::waitForLag(unsigned int timestep)
+    {
+        {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this, timestep]{ return m_tasks.empty() || m_tasks.front().timestep + m_max_lag >= timestep; });
+        }
+
+    checkError();
+    }
+
+/*! Waits until all queued tasks are complete and raises any error that occurred in the analysis.
+*/
+void AnalyzerPipeline::flush()
+    {
+        {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]{ return m_tasks.empty(); });
+        }
+
+    checkError();
+    }
+
+//! Raise an error that occurred in a worker thread
+/*! The error is printed on the calling thread before it is rethrown.
+*/
+void AnalyzerPipeline::checkError()
+    {
+    std::exception_ptr error;
+        {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        std::swap(error, m_error);
+        }
+
+    if (! error)
+        return;
+
+    try
+        {
+        std::rethrow_exception(error);
+        }
+    catch (const std::exception& e)
+        {
+        m_exec_conf->msg->error() << e.what() << endl;
+        throw;
+        }
+    }
+
+/*! \returns The first task that is not running and has no earlier task of the same analyzer in the queue, or
+             m_tasks.end() if there is none
+
+    \pre m_mutex is locked
+*/
+std::list<AnalyzerPipeline::Task>::iterator AnalyzerPipeline::findRunnableTask()
+    {
+    std::vector<Analyzer *> busy;
+    for (std::list<Task>::iterator task = m_tasks.begin(); task != m_tasks.end(); ++task)
+        {
+        Analyzer *analyzer = task->analyzer.get();
+        if (std::find(busy.begin(), busy.end(), analyzer) != busy.end())
+            continue;
+
+        if (! task->running)
+            return task;
+
+        busy.push_back(analyzer);
+        }
+
+    return m_tasks.end();
+    }
+
+//! Execute queued tasks until the threads are stopped
+/*! The task stays in the queue while it runs, so that waitForLag() and flush() also wait for the tasks in progress.
+    After an error, the remaining tasks are discarded.
+*/
+void AnalyzerPipeline::workerThread()
+    {
+    while (true)
+        {
+        std::list<Task>::iterator task;
+        bool execute = true;
+            {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]{ return findRunnableTask() != m_tasks.end() || (m_stop && m_tasks.empty()); });
+            task = findRunnableTask();
+            if (task == m_tasks.end())
+                break;
+            task->running = true;
+            execute = !m_error;
+            }
+
+        if (execute)
+            {
+            try
+                {
+                task->analyzer->analyzeSnapshot(task->timestep, task->snapshot);
+                }
+            catch (...)
+                {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_error = std::current_exception();
+                }
+            }
+
+            {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_tasks.erase(task);
+            m_cv.notify_all();
+            }
+        }
+    }
+
+//! Complete all queued tasks and join the worker threads
+void AnalyzerPipeline::stopThreads()
+    {
+    if (m_threads.empty())
+        return;
+
+        {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cv.notify_all();
+        }
+
+    for (unsigned int i = 0; i < m_threads.size(); i++)
+        m_threads[i].join();
+
+    m_threads.clear();
+    m_stop = false;
+    }
@@ -0,0 +1,120 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file AnalyzerPipeline.h
+    \brief Declares the AnalyzerPipeline class
+*/
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+#ifndef __ANALYZER_PIPELINE_H__
+#define __ANALYZER_PIPELINE_H__
+
+#include "Analyzer.h"
+#include "SnapshotSystemData.h"
+
+#include <memory>
+#include <list>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+//! Runs analyzers on snapshots in worker threads
+/*! System hands every execution of an off-path analyzer to the pipeline together with an immutable snapshot of the
+    system, instead of calling Analyzer::analyze(). The worker threads call Analyzer::analyzeSnapshot() while the
+    simulation continues. All analyzers executed on the same time step share the same snapshot.
+
+    The tasks of one analyzer are executed in the order they were submitted, one at a time, so that an analyzer sees
+    its snapshots in time step order. Tasks of different analyzers run concurrently on up to getNumThreads() threads.
+
+    The analysis may lag behind the simulation by at most getMaxLag() time steps: waitForLag() blocks until all tasks
+    submitted more than that many steps ago are complete. An error raised by an analyzer is printed and rethrown on the
+    main thread by the next call to submit(), waitForLag() or flush(), the tasks remaining at that time are discarded.
+    The worker threads do not hold the python GIL and never use the Messenger.
+
+    \ingroup analyzers
+*/
+class PYBIND11_EXPORT AnalyzerPipeline
+    {
+    public:
+        //! Snapshot type passed to the analyzers
+        typedef SnapshotSystemData<Scalar> Snapshot;
+
+        //! Constructor
+        AnalyzerPipeline(std::shared_ptr<const ExecutionConfiguration> exec_conf);
+
+        //! Destructor
+        ~AnalyzerPipeline();
+
+        //! Set the maximum number of time steps the analysis may lag behind
+        void setMaxLag(unsigned int max_lag);
+
+        //! Get the maximum number of time steps the analysis may lag behind
+        unsigned int getMaxLag() const
+            {
+            return m_max_lag;
+            }
+
+        //! Set the number of worker threads
+        void setNumThreads(unsigned int num_threads);
+
+        //! Get the number of worker threads
+        unsigned int getNumThreads() const
+            {
+            return m_num_threads;
+            }
+
+        //! Queue the analysis of a snapshot
+        void submit(std::shared_ptr<Analyzer> analyzer, unsigned int timestep, std::shared_ptr<const Snapshot> snapshot);
+
+        //! Wait until the analysis is no more than the maximum lag behind the given time step
+        void waitForLag(unsigned int timestep);
+
+        //! Wait until all queued tasks are complete
+        void flush();
+
+    private:
+        //! A queued execution of an analyzer
+        struct Task
+            {
+            //! Constructor
+            Task(std::shared_ptr<Analyzer> _analyzer, unsigned int _timestep, std::shared_ptr<const Snapshot> _snapshot)
+                : analyzer(_analyzer), timestep(_timestep), snapshot(_snapshot), running(false)
+                {
+                }
+
+            std::shared_ptr<Analyzer> analyzer;       //!< Analyzer to execute
+            unsigned int timestep;                    //!< Time step of the snapshot
+            std::shared_ptr<const Snapshot> snapshot; //!< Snapshot to analyze
+            bool running;                             //!< True while a worker executes the task
+            };
+
+        std::shared_ptr<const ExecutionConfiguration> m_exec_conf; //!< The execution configuration
+        unsigned int m_max_lag;                 //!< Maximum number of time steps the analysis may lag behind
+        unsigned int m_num_threads;             //!< Number of worker threads
+        std::vector<std::thread> m_threads;     //!< The worker threads
+        std::mutex m_mutex;                     //!< Protects the tasks, the stop flag and the error
+        std::condition_variable m_cv;           //!< Signals changes of the tasks
+        std::list<Task> m_tasks;                //!< Tasks in order of submission, including those in progress
+        bool m_stop;                            //!< True if the workers should exit when no tasks are left
+        std::exception_ptr m_error;             //!< Error raised in a worker thread
+
+        //! Main loop of the worker threads
+        void workerThread();
+
+        //! Find the first task that can be started
+        std::list<Task>::iterator findRunnableTask();
+
+        //! Complete all tasks and join the worker threads
+        void stopThreads();
+
+        //! Raise an error that occurred in a worker thread
+        void checkError();
+    };
+
+#endif
@@ -0,0 +1,167 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file BackgroundWriter.cc
+    \brief Defines the BackgroundWriter class
+*/
+
+#include "BackgroundWriter.h"
+
+using namespace std;
+
+namespace
+    {
+    //! True on the threads of all BackgroundWriters
+    thread_local bool in_writer_thread = false;
+    }
+
+/*! \param exec_conf The execution configuration
+    \param max_queued Maximum number of queued tasks, including the task in progress
+*/
+BackgroundWriter::BackgroundWriter(std::shared_ptr<const ExecutionConfiguration> exec_conf, unsigned int max_queued)
+    : m_exec_conf(exec_conf), m_max_queued(max_queued > 0 ? max_queued : 1), m_stop(false)
+    {
+    }
+
+/*! Completes the queued tasks, errors cannot be raised from the destructor.
+*/
+BackgroundWriter::~BackgroundWriter()
+    {
+    stop();
+    }
+
+/*! \param max_queued Maximum number of queued tasks, including the task in progress
+*/
+void BackgroundWriter::setMaxQueued(unsigned int max_queued)
+    {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_max_queued = max_queued > 0 ? max_queued : 1;
+    m_cv.notify_all();
+    }
+
+/*! \param task Task to execute on the writer thread
+
+    Raises the error of a previous task, and blocks while the queue is full.
+*/
+void BackgroundWriter::queue(const std::function<void ()>& task)
+    {
+    checkError();
+
+    if (! m_thread.joinable())
+        m_thread = std::thread(&BackgroundWriter::writerThread, this);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]{ return m_queue.size() < m_max_queued; });
+    m_queue.push_back(task);
+    m_cv.notify_all();
+    }
+
+/*! Waits until all queued tasks are complete and raises any error that occurred in them.
+*/
+void BackgroundWriter::flush()
+    {
+        {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]{ return m_queue.empty(); });
+        }
+
+    checkError();
+    }
+
+/*! The error of a task is printed on the calling thread before it is rethrown.
+*/
+void BackgroundWriter::checkError()
+    {
+    std::exception_ptr error;
+        {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        std::swap(error, m_error);
+        }
+
+    if (! error)
+        return;
+
+    try
+        {
+        std::rethrow_exception(error);
+        }
+    catch (const std::exception& e)
+        {
+        m_exec_conf->msg->error() << e.what() << endl;
+        throw;
+        }
+    }
+
+/*! \param level Notice level
+    \returns The notice stream of the Messenger, or a null stream on the writer thread
+*/
+std::ostream& BackgroundWriter::notice(unsigned int level)
+    {
+    if (in_writer_thread)
+        return m_nullstream;
+    return m_exec_conf->msg->notice(level);
+    }
+
+bool BackgroundWriter::isWriterThread()
+    {
+    return in_writer_thread;
+    }
+
+//! Execute queued tasks until the thread is stopped
+/*! After an error, the remaining tasks are discarded.
+*/
+void BackgroundWriter::writerThread()
+    {
+    in_writer_thread = true;
+
+    while (true)
+        {
+        std::function<void ()> task;
+        bool execute = true;
+            {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]{ return !m_queue.empty() || m_stop; });
+            if (m_queue.empty())
+                break;
+            task = m_queue.front();
+            execute = !m_error;
+            }
+
+        if (execute)
+            {
+            try
+                {
+                task();
+                }
+            catch (...)
+                {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_error = std::current_exception();
+                }
+            }
+
+            {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queue.pop_front();
+            m_cv.notify_all();
+            }
+        }
+    }
+
+/*! The error of a task is kept, the next call to checkError() raises it.
+*/
+void BackgroundWriter::stop()
+    {
+    if (! m_thread.joinable())
+        return;
+
+        {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cv.notify_all();
+        }
+
+    m_thread.join();
+    m_stop = false;
+    }
@@ -0,0 +1,92 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file BackgroundWriter.h
+    \brief Declares the BackgroundWriter class
+*/
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+#ifndef __BACKGROUND_WRITER_H__
+#define __BACKGROUND_WRITER_H__
+
+#include "ExecutionConfiguration.h"
+#include "Messenger.h"
+
+#include <memory>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+//! Executes write tasks in order on a background thread
+/*! Output classes hand the tasks that write to their file to a BackgroundWriter, so that the simulation continues
+    while the data is written. The tasks run one at a time, in the order they were queued, on a thread that is started
+    with the first task. A task stays in the queue while it runs, so that the number of queued tasks includes the task
+    in progress, and queue() blocks while getMaxQueued() tasks are queued.
+
+    The writer thread does not hold the python GIL, so tasks must not touch python objects. This includes the
+    Messenger, which may write to python streams: tasks print notices through notice(), which discards them on the
+    writer thread, and report errors by throwing an exception with the complete message. The first error is stored and
+    the remaining tasks are discarded. The next call to queue(), flush() or checkError() prints the message with
+    Messenger::error() on the caller's thread and rethrows the exception.
+
+    \ingroup analyzers
+*/
+class PYBIND11_EXPORT BackgroundWriter
+    {
+    public:
+        //! Constructor
+        BackgroundWriter(std::shared_ptr<const ExecutionConfiguration> exec_conf, unsigned int max_queued);
+
+        //! Destructor
+        ~BackgroundWriter();
+
+        //! Set the maximum number of queued tasks
+        void setMaxQueued(unsigned int max_queued);
+
+        //! Get the maximum number of queued tasks
+        unsigned int getMaxQueued() const
+            {
+            return m_max_queued;
+            }
+
+        //! Queue a task
+        void queue(const std::function<void ()>& task);
+
+        //! Wait until all queued tasks are complete
+        void flush();
+
+        //! Complete all queued tasks and join the writer thread
+        void stop();
+
+        //! Raise an error that occurred in a task
+        void checkError();
+
+        //! Get a notice stream that may be used in tasks
+        std::ostream& notice(unsigned int level);
+
+        //! Test if the calling thread is the thread of a BackgroundWriter
+        static bool isWriterThread();
+
+    private:
+        std::shared_ptr<const ExecutionConfiguration> m_exec_conf; //!< The execution configuration
+        unsigned int m_max_queued;                  //!< Maximum number of queued tasks
+        std::thread m_thread;                       //!< Thread that executes the tasks
+        std::mutex m_mutex;                         //!< Protects the queue, the stop flag and the error
+        std::condition_variable m_cv;               //!< Signals changes of the queue
+        std::deque< std::function<void ()> > m_queue; //!< Tasks waiting to be executed, the first one is in progress
+        bool m_stop;                                //!< True if the thread should exit when the queue is empty
+        std::exception_ptr m_error;                 //!< Error raised by a task
+        nullstream m_nullstream;                    //!< Discards the notices of the tasks
+
+        //! Main loop of the writer thread
+        void writerThread();
+    };
+
+#endif
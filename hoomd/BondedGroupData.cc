@@ -12,14 +12,21 @@
 #include "BondedGroupData.h"
 #include "ParticleData.h"
 #include "Index1D.h"
+#include "CheckpointIO.h"
 
 #include "hoomd/extern/pybind/include/pybind11/numpy.h"
 
+#ifdef ENABLE_TBB
+#include <tbb/tbb.h>
+#endif
+
 #ifdef ENABLE_CUDA
 #include "BondedGroupData.cuh"
 #include "CachedAllocator.h"
 #endif
 
+#include <algorithm>
+
 using namespace std;
 namespace py = pybind11;
 
@@ -44,14 +51,15 @@ template<unsigned int group_size, typename Group, const char *name, bool has_typ
 BondedGroupData<group_size, Group, name, has_type_mapping>::BondedGroupData(
     std::shared_ptr<ParticleData> pdata,
     unsigned int n_group_types)
-    : m_exec_conf(pdata->getExecConf()), m_pdata(pdata), m_n_groups(0), m_n_ghost(0), m_nglobal(0), m_groups_dirty(true)
+    : m_exec_conf(pdata->getExecConf()), m_pdata(pdata), m_n_groups(0), m_n_ghost(0), m_nglobal(0), m_modification_count(0),
+      m_groups_dirty(true)
     {
     m_exec_conf->msg->notice(5) << "Constructing BondedGroupData (" << name<< "s, n=" << group_size << ") "
         << endl;
 
     // connect to particle sort signal
-    m_pdata->getParticleSortSignal().template connect<BondedGroupData<group_size, Group, name, has_type_mapping>,
-        &BondedGroupData<group_size, Group, name, has_type_mapping>::setDirty>(this);
+    m_pdata->getParticlePermutationSignal().template connect<BondedGroupData<group_size, Group, name, has_type_mapping>,
+        &BondedGroupData<group_size, Group, name, has_type_mapping>::slotParticleSort>(this);
     #ifdef ENABLE_MPI
     if (m_pdata->getDomainDecomposition())
         {
@@ -94,13 +102,14 @@ template<unsigned int group_size, typename Group, const char *name, bool has_typ
 BondedGroupData<group_size, Group, name, has_type_mapping>::BondedGroupData(
     std::shared_ptr<ParticleData> pdata,
     const Snapshot& snapshot)
-    : m_exec_conf(pdata->getExecConf()), m_pdata(pdata), m_n_groups(0), m_n_ghost(0), m_nglobal(0), m_groups_dirty(true)
+    : m_exec_conf(pdata->getExecConf()), m_pdata(pdata), m_n_groups(0), m_n_ghost(0), m_nglobal(0), m_modification_count(0),
+      m_groups_dirty(true)
     {
     m_exec_conf->msg->notice(5) << "Constructing BondedGroupData (" << name << ") " << endl;
 
     // connect to particle sort signal
-    m_pdata->getParticleSortSignal().template connect<BondedGroupData<group_size, Group, name, has_type_mapping>,
-        &BondedGroupData<group_size, Group, name, has_type_mapping>::setDirty>(this);
+    m_pdata->getParticlePermutationSignal().template connect<BondedGroupData<group_size, Group, name, has_type_mapping>,
+        &BondedGroupData<group_size, Group, name, has_type_mapping>::slotParticleSort>(this);
 
     #ifdef ENABLE_CUDA
     if (m_exec_conf->isCUDAEnabled())
@@ -126,8 +135,8 @@ BondedGroupData<group_size, Group, name, has_type_mapping>::BondedGroupData(
 template<unsigned int group_size, typename Group, const char *name, bool has_type_mapping>
 BondedGroupData<group_size, Group, name, has_type_mapping>::~BondedGroupData()
     {
-    m_pdata->getParticleSortSignal().template disconnect<BondedGroupData<group_size, Group, name, has_type_mapping>,
-        &BondedGroupData<group_size, Group, name, has_type_mapping>::setDirty>(this);
+    m_pdata->getParticlePermutationSignal().template disconnect<BondedGroupData<group_size, Group, name, has_type_mapping>,
+        &BondedGroupData<group_size, Group, name, has_type_mapping>::slotParticleSort>(this);
     #ifdef ENABLE_MPI
     m_pdata->getSingleParticleMoveSignal().template disconnect<BondedGroupData<group_size, Group, name, has_type_mapping>,
         &BondedGroupData<group_size, Group, name, has_type_mapping>::moveParticleGroups>(this);
@@ -140,6 +149,9 @@ void BondedGroupData<group_size, Group, name, has_type_mapping>::initialize()
     // reset global number of groups
     m_nglobal = 0;
 
+    // all groups are replaced
+    m_modification_count++;
+
     // reset local number of groups
     m_n_groups = 0;
 
@@ -177,6 +189,15 @@ void BondedGroupData<group_size, Group, name, has_type_mapping>::initialize()
     GPUVector<unsigned int> n_groups(m_exec_conf);
     m_gpu_n_groups.swap(n_groups);
 
+    GPUVector<members_t> gpu_table_alt(m_exec_conf);
+    m_gpu_table_alt.swap(gpu_table_alt);
+
+    GPUVector<unsigned int> gpu_pos_table_alt(m_exec_conf);
+    m_gpu_pos_table_alt.swap(gpu_pos_table_alt);
+
+    GPUVector<unsigned int> n_groups_alt(m_exec_conf);
+    m_gpu_n_groups_alt.swap(n_groups_alt);
+
     #ifdef ENABLE_MPI
     if (m_pdata->getDomainDecomposition())
         {
@@ -422,6 +443,7 @@ unsigned int BondedGroupData<group_size, Group, name, has_type_mapping>::addBond
 
     // increment number of bonded groups
     m_nglobal++;
+    m_modification_count++;
 
     // notify observers
     m_group_num_change_signal.emit();
@@ -643,6 +665,7 @@ void BondedGroupData<group_size, Group, name, has_type_mapping>::removeBondedGro
     // maintain a stack of deleted group tags for future recycling
     m_recycled_tags.push(tag);
     m_nglobal--;
+    m_modification_count++;
 
     // notify observers
     m_group_num_change_signal.emit();
@@ -693,6 +716,7 @@ void BondedGroupData<group_size, Group, name, has_type_mapping>::setTypeName(uns
         }
 
     m_type_mapping[type] = new_name;
+    m_modification_count++;
     }
 
 /*! Rebuild the cached vector of active tags, if necessary
@@ -841,6 +865,95 @@ void BondedGroupData<group_size, Group, name, has_type_mapping>::rebuildGPUTable
         }
     }
 
+/*! \param order Permutation applied to the particles (new index -> old index), NULL if unknown
+    \param inverse Inverse permutation (old index -> new index), NULL if unknown
+
+    If the lookup table is current and only covers local particles, its rows are gathered according to the
+    permutation into the alternate tables, which are then swapped in. Otherwise, the table is marked for a full
+    rebuild.
+
+    The permuted table is only used in serial runs. With a domain decomposition, the rows of local particles refer to
+    ghost particles by index. The ghosts are removed before the sort and exchanged again after it, which marks the
+    table for a rebuild anyway, so it is not permuted.
+ */
+template<unsigned int group_size, typename Group, const char *name, bool has_type_mapping>
+void BondedGroupData<group_size, Group, name, has_type_mapping>::slotParticleSort(const unsigned int *order,
+    const unsigned int *inverse)
+    {
+    bool incremental = order && inverse && !m_groups_dirty && m_pdata->getNGhosts() == 0
+        && m_gpu_table_indexer.getW() == m_pdata->getN();
+    #ifdef ENABLE_MPI
+    incremental = incremental && !m_pdata->getDomainDecomposition();
+    #endif
+    #ifdef ENABLE_CUDA
+    incremental = incremental && !m_exec_conf->isCUDAEnabled();
+    #endif
+
+    if (!incremental)
+        {
+        m_groups_dirty = true;
+        return;
+        }
+
+    if (m_prof) m_prof->push("permute " + std::string(name) + " table");
+
+    const unsigned int N = m_pdata->getN();
+    const unsigned int H = m_gpu_table_indexer.getH();
+
+    // GPUVector keeps its allocation when the size does not grow, the alternate tables are not reallocated per sort
+    m_gpu_table_alt.resize(m_gpu_table.size());
+    m_gpu_pos_table_alt.resize(m_gpu_pos_table.size());
+    m_gpu_n_groups_alt.resize(m_gpu_n_groups.size());
+
+        {
+        ArrayHandle<members_t> h_gpu_table(m_gpu_table, access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_gpu_pos_table(m_gpu_pos_table, access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_n_groups(m_gpu_n_groups, access_location::host, access_mode::read);
+
+        ArrayHandle<members_t> h_gpu_table_new(m_gpu_table_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<unsigned int> h_gpu_pos_table_new(m_gpu_pos_table_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<unsigned int> h_n_groups_new(m_gpu_n_groups_alt, access_location::host, access_mode::overwrite);
+
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, N),
+            [&](const tbb::blocked_range<unsigned int>& r)
+            {
+            for (unsigned int i = r.begin(); i != r.end(); ++i)
+        #else
+        for (unsigned int i = 0; i < N; ++i)
+        #endif
+                {
+                const unsigned int j = order[i];
+                const unsigned int n = h_n_groups.data[j];
+                h_n_groups_new.data[i] = n;
+
+                for (unsigned int k = 0; k < n; ++k)
+                    {
+                    members_t h = h_gpu_table.data[m_gpu_table_indexer(j, k)];
+
+                    // the last element holds the type or group index, the other ones are particle indices
+                    for (unsigned int m = 0; m < group_size - 1; ++m)
+                        h.idx[m] = inverse[h.idx[m]];
+
+                    h_gpu_table_new.data[m_gpu_table_indexer(i, k)] = h;
+                    h_gpu_pos_table_new.data[m_gpu_table_indexer(i, k)] = h_gpu_pos_table.data[m_gpu_table_indexer(j, k)];
+                    }
+                }
+        #ifdef ENABLE_TBB
+            });
+        #endif
+        }
+
+    m_gpu_table.swap(m_gpu_table_alt);
+    m_gpu_pos_table.swap(m_gpu_pos_table_alt);
+    m_gpu_n_groups.swap(m_gpu_n_groups_alt);
+
+    // the table indexer is unchanged
+    assert(m_gpu_table_indexer.getNumElements() == N*H);
+
+    if (m_prof) m_prof->pop();
+    }
+
 #ifdef ENABLE_CUDA
 template<unsigned int group_size, typename Group, const char *name, bool has_type_mapping>
 void BondedGroupData<group_size, Group, name, has_type_mapping>::rebuildGPUTableGPU()
@@ -941,122 +1054,141 @@ void BondedGroupData<group_size, Group, name, has_type_mapping>::rebuildGPUTable
 template<unsigned int group_size, typename Group, const char *name, bool has_type_mapping>
 std::map<unsigned int, unsigned int> BondedGroupData<group_size, Group, name, has_type_mapping>::takeSnapshot(Snapshot& snapshot) const
     {
-    // map to lookup snapshot index by tag
+    std::vector<unsigned int> snap_idx;
+    takeSnapshot(snapshot, snap_idx);
+
+    // map to lookup snapshot index by tag, the tags are inserted in order
     std::map<unsigned int, unsigned int> index;
+    for (unsigned int tag = 0; tag < snap_idx.size(); ++tag)
+        if (snap_idx[tag] != GROUP_NOT_LOCAL)
+            index.insert(index.end(), std::make_pair(tag, snap_idx[tag]));
 
-    std::map<unsigned int, unsigned int> rtag_map;
-    for (unsigned int group_idx = 0; group_idx < getN(); group_idx++)
-        {
-        unsigned int tag = m_group_tag[group_idx];
-        assert(m_group_rtag[tag] == group_idx);
+    return index;
+    }
 
-        rtag_map.insert(std::pair<unsigned int,unsigned int>(tag, group_idx));
-        }
+/*! \param snapshot Snapshot that will contain the group data
+ * \param snap_idx Snapshot index of every group tag, GROUP_NOT_LOCAL for inactive tags (output)
+ *
+ *  Data in the snapshot is in tag order, where non-existent tags are skipped. With domain decomposition, every
+ *  rank sends flat arrays of its group tags, types and members to the root, which scatters them into the snapshot
+ *  in parallel. The snapshot and \a snap_idx are only filled on the root processor.
+ */
+template<unsigned int group_size, typename Group, const char *name, bool has_type_mapping>
+void BondedGroupData<group_size, Group, name, has_type_mapping>::takeSnapshot(Snapshot& snapshot,
+    std::vector<unsigned int>& snap_idx) const
+    {
+    const unsigned int nglobal = getNGlobal();
 
     #ifdef ENABLE_MPI
     if (m_pdata->getDomainDecomposition())
         {
         // gather local data
-        std::vector<typeval_t> typevals; // Group types or constraint values
-        std::vector<members_t> members;  // Group members
+        std::vector<typeval_t> typevals(getN()); // Group types or constraint values
+        std::vector<members_t> members(getN());  // Group members
+        std::vector<unsigned int> tags(getN());  // Group tags
 
         for (unsigned int group_idx  = 0; group_idx < getN(); ++group_idx)
             {
-            typevals.push_back(m_group_typeval[group_idx]);
-            members.push_back(m_groups[group_idx]);
+            typevals[group_idx] = m_group_typeval[group_idx];
+            members[group_idx] = m_groups[group_idx];
+            tags[group_idx] = m_group_tag[group_idx];
+            assert(m_group_rtag[tags[group_idx]] == group_idx);
             }
 
-        std::vector< std::vector<typeval_t> > typevals_proc;     // Group types of every processor
-        std::vector< std::vector<members_t> > members_proc;      // Group members of every processor
-
-        std::vector< std::map<unsigned int, unsigned int> > rtag_map_proc; // List of reverse-lookup maps
-
-        unsigned int size = m_exec_conf->getNRanks();
-
-        // resize arrays to accumulate group data of all ranks
-        typevals_proc.resize(size);
-        members_proc.resize(size);
-        rtag_map_proc.resize(size);
+        std::vector<typeval_t> typevals_all;     // Group types of all processors
+        std::vector<members_t> members_all;      // Group members of all processors
+        std::vector<unsigned int> tags_all;      // Group tags of all processors
 
         // gather all processors' data
-        gather_v(typevals, typevals_proc, 0, m_exec_conf->getMPICommunicator());
-        gather_v(members, members_proc, 0, m_exec_conf->getMPICommunicator());
-        gather_v(rtag_map, rtag_map_proc, 0, m_exec_conf->getMPICommunicator());
+        gather_v_flat(typevals, typevals_all, 0, m_exec_conf->getMPICommunicator());
+        gather_v_flat(members, members_all, 0, m_exec_conf->getMPICommunicator());
+        gather_v_flat(tags, tags_all, 0, m_exec_conf->getMPICommunicator());
 
         if (m_exec_conf->getRank() == 0)
             {
             // allocate memory in snapshot
-            snapshot.resize(getNGlobal());
-
-            assert(rtag_map_proc.size() == size);
-
-            // create single map of all group ranks and indices
-            // groups present on more than one processor will count as one group
-            std::map<unsigned int, std::pair<unsigned int, unsigned int> > rank_rtag_map;
-            std::map<unsigned int, unsigned int>::iterator it;
-            for (unsigned int irank = 0; irank < size; ++irank)
-                for (it = rtag_map_proc[irank].begin(); it != rtag_map_proc[irank].end(); ++it)
-                    rank_rtag_map.insert(std::make_pair(it->first, std::make_pair(irank, it->second)));
-
-            // add groups to snapshot
-            std::map<unsigned int, std::pair<unsigned int, unsigned int> >::iterator rank_rtag_it;
+            snapshot.resize(nglobal);
 
             // index in snapshot
-            unsigned int snap_id = 0;
-
-            // loop through active tags
-            std::set<unsigned int>::iterator active_tag_it;
+            snap_idx.assign(m_tag_set.empty() ? 0 : *m_tag_set.rbegin() + 1, GROUP_NOT_LOCAL);
+            unsigned int n = 0;
+            std::set<unsigned int>::const_iterator active_tag_it;
             for (active_tag_it = m_tag_set.begin(); active_tag_it != m_tag_set.end(); ++active_tag_it)
+                snap_idx[*active_tag_it] = n++;
+
+            // position of every group in the gathered arrays
+            // groups present on more than one processor will count as one group
+            std::vector<unsigned int> gathered_idx(nglobal, GROUP_NOT_LOCAL);
+            for (unsigned int i = 0; i < tags_all.size(); ++i)
                 {
-                unsigned int group_tag = *active_tag_it;
-                rank_rtag_it = rank_rtag_map.find(group_tag);
-                if (rank_rtag_it == rank_rtag_map.end())
+                unsigned int group_tag = tags_all[i];
+                if (group_tag >= snap_idx.size() || snap_idx[group_tag] == GROUP_NOT_LOCAL)
                     {
                     m_exec_conf->msg->error()
-                        << endl << "Could not find " << name << " " << group_tag << " on any processor. "
+                        << endl << "Found inactive " << name << " " << group_tag << " during snapshot. "
                         << endl << endl;
                     throw std::runtime_error("Error gathering "+std::string(name)+"s");
                     }
 
-                // store tag in index
-                index.insert(std::make_pair(group_tag, snap_id));
-
-                // rank contains the processor rank on which the particle was found
-                std::pair<unsigned int, unsigned int> rank_idx = rank_rtag_it->second;
-                unsigned int rank = rank_idx.first;
-                unsigned int idx = rank_idx.second;
+                unsigned int snap_id = snap_idx[group_tag];
+                if (gathered_idx[snap_id] == GROUP_NOT_LOCAL)
+                    gathered_idx[snap_id] = i;
+                }
 
-                if (has_type_mapping)
+            for (unsigned int snap_id = 0; snap_id < nglobal; ++snap_id)
+                {
+                if (gathered_idx[snap_id] == GROUP_NOT_LOCAL)
                     {
-                    snapshot.type_id[snap_id] = typevals_proc[rank][idx].type;
+                    unsigned int group_tag = *std::next(m_tag_set.begin(), snap_id);
+                    m_exec_conf->msg->error()
+                        << endl << "Could not find " << name << " " << group_tag << " on any processor. "
+                        << endl << endl;
+                    throw std::runtime_error("Error gathering "+std::string(name)+"s");
                     }
-                else
+                }
+
+            // add groups to snapshot
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(0, nglobal),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int snap_id = r.begin(); snap_id != r.end(); ++snap_id)
+            #else
+            for (unsigned int snap_id = 0; snap_id < nglobal; ++snap_id)
+            #endif
                     {
-                    snapshot.val[snap_id] = typevals_proc[rank][idx].val;
+                    unsigned int i = gathered_idx[snap_id];
+
+                    if (has_type_mapping)
+                        {
+                        snapshot.type_id[snap_id] = typevals_all[i].type;
+                        }
+                    else
+                        {
+                        snapshot.val[snap_id] = typevals_all[i].val;
+                        }
+                    snapshot.groups[snap_id] = members_all[i];
                     }
-                snapshot.groups[snap_id] = members_proc[rank][idx];
-                snap_id++;
-                }
+            #ifdef ENABLE_TBB
+                });
+            #endif
             }
         }
     else
     #endif
         {
         // allocate memory in snapshot
-        snapshot.resize(getNGlobal());
+        snapshot.resize(nglobal);
 
         assert(getN() == getNGlobal());
-        std::map<unsigned int, unsigned int>::iterator rtag_it;
-        // index in snapshot
-        unsigned int snap_id = 0;
 
         // loop through active tags
-        std::set<unsigned int>::iterator active_tag_it;
-        for (active_tag_it = m_tag_set.begin(); active_tag_it != m_tag_set.end(); ++active_tag_it)
+        std::vector<unsigned int> tags(m_tag_set.begin(), m_tag_set.end());
+        snap_idx.assign(tags.empty() ? 0 : tags.back() + 1, GROUP_NOT_LOCAL);
+        for (unsigned int snap_id = 0; snap_id < nglobal; ++snap_id)
             {
-            unsigned int group_tag = *active_tag_it;
-            rtag_it = rtag_map.find(group_tag);
-            if (rtag_it == rtag_map.end())
+            unsigned int group_tag = tags[snap_id];
+            if (m_group_rtag[group_tag] >= getN())
                 {
                 m_exec_conf->msg->error()
                     << endl << "Could not find " << name << " " << group_tag << ". Possible internal error?"
@@ -1064,26 +1196,162 @@ std::map<unsigned int, unsigned int> BondedGroupData<group_size, Group, name, ha
                 throw std::runtime_error("Error gathering "+std::string(name)+"s");
                 }
 
-            // store tag in index
-            index.insert(std::make_pair(group_tag, snap_id));
+            // store snapshot index of the tag
+            snap_idx[group_tag] = snap_id;
+            }
 
-            unsigned int group_idx = rtag_it->second;
-            snapshot.groups[snap_id] = m_groups[group_idx];
-            if (has_type_mapping)
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, nglobal),
+            [&](const tbb::blocked_range<unsigned int>& r)
+            {
+            for (unsigned int snap_id = r.begin(); snap_id != r.end(); ++snap_id)
+        #else
+        for (unsigned int snap_id = 0; snap_id < nglobal; ++snap_id)
+        #endif
                 {
-                snapshot.type_id[snap_id] = ((typeval_t) m_group_typeval[group_idx]).type;
+                unsigned int group_idx = m_group_rtag[tags[snap_id]];
+                snapshot.groups[snap_id] = m_groups[group_idx];
+                if (has_type_mapping)
+                    {
+                    snapshot.type_id[snap_id] = ((typeval_t) m_group_typeval[group_idx]).type;
+                    }
+                else
+                    {
+                    snapshot.val[snap_id] = ((typeval_t) m_group_typeval[group_idx]).val;
+                    }
                 }
-            else
+        #ifdef ENABLE_TBB
+            });
+        #endif
+        }
+
+    snapshot.type_mapping = m_type_mapping;
+    }
+
+/*! \param out Stream to write to
+
+    Writes the local (non-ghost) groups with their member ranks and the global tag state, in the same form as
+    ParticleData::writeCheckpoint(). The type mapping is not part of the stream.
+*/
+template<unsigned int group_size, typename Group, const char *name, bool has_type_mapping>
+void BondedGroupData<group_size, Group, name, has_type_mapping>::writeCheckpoint(std::ostream& out) const
+    {
+    // the stack of recycled tags, bottom first
+    std::vector<unsigned int> recycled_tags;
+    std::stack<unsigned int> recycled(m_recycled_tags);
+    while (! recycled.empty())
+        {
+        recycled_tags.push_back(recycled.top());
+        recycled.pop();
+        }
+    std::reverse(recycled_tags.begin(), recycled_tags.end());
+
+    unsigned int n = getN();
+    checkpoint_write(out, n);
+    checkpoint_write(out, m_nglobal);
+    checkpoint_write(out, recycled_tags);
+
+    ArrayHandle<members_t> h_groups(m_groups, access_location::host, access_mode::read);
+    ArrayHandle<typeval_t> h_typeval(m_group_typeval, access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag(m_group_tag, access_location::host, access_mode::read);
+
+    checkpoint_write(out, h_groups.data, n);
+    checkpoint_write(out, h_typeval.data, n);
+    checkpoint_write(out, h_tag.data, n);
+
+    #ifdef ENABLE_MPI
+    if (m_pdata->getDomainDecomposition())
+        {
+        ArrayHandle<ranks_t> h_ranks(m_group_ranks, access_location::host, access_mode::read);
+        checkpoint_write(out, h_ranks.data, n);
+        }
+    #endif
+    }
+
+/*! \param in Stream to read from, written by writeCheckpoint()
+    \param rank_map New rank of every rank that wrote the checkpoint, applied to the member ranks
+
+    The particle data must have been restored before. If the stream is truncated, reading stops and the caller is
+    expected to check the stream state.
+*/
+template<unsigned int group_size, typename Group, const char *name, bool has_type_mapping>
+void BondedGroupData<group_size, Group, name, has_type_mapping>::readCheckpoint(std::istream& in,
+    const std::vector<unsigned int>& rank_map)
+    {
+    // re-initialize data structures
+    initialize();
+
+    unsigned int n = 0;
+    unsigned int nglobal = 0;
+    std::vector<unsigned int> recycled_tags;
+    checkpoint_read(in, n);
+    checkpoint_read(in, nglobal);
+    checkpoint_read(in, recycled_tags);
+    if (! in)
+        return;
+
+    // restore the active tags and the reservoir of recycled tags
+    for (unsigned int i = 0; i < recycled_tags.size(); i++)
+        m_recycled_tags.push(recycled_tags[i]);
+
+    unsigned int n_tags = nglobal + recycled_tags.size();
+    std::sort(recycled_tags.begin(), recycled_tags.end());
+    std::vector<unsigned int>::const_iterator next_recycled = recycled_tags.begin();
+    for (unsigned int tag = 0; tag < n_tags; tag++)
+        {
+        if (next_recycled != recycled_tags.end() && *next_recycled == tag)
+            {
+            ++next_recycled;
+            continue;
+            }
+        m_tag_set.insert(m_tag_set.end(), tag);
+        }
+    m_invalid_cached_tags = true;
+
+    reallocate(n);
+    m_n_groups = n;
+    m_group_rtag.resize(n_tags);
+
+        {
+        ArrayHandle<members_t> h_groups(m_groups, access_location::host, access_mode::overwrite);
+        ArrayHandle<typeval_t> h_typeval(m_group_typeval, access_location::host, access_mode::overwrite);
+        ArrayHandle<unsigned int> h_tag(m_group_tag, access_location::host, access_mode::overwrite);
+        ArrayHandle<unsigned int> h_rtag(m_group_rtag, access_location::host, access_mode::overwrite);
+
+        checkpoint_read(in, h_groups.data, n);
+        checkpoint_read(in, h_typeval.data, n);
+        checkpoint_read(in, h_tag.data, n);
+
+        for (unsigned int tag = 0; tag < n_tags; tag++)
+            h_rtag.data[tag] = GROUP_NOT_LOCAL;
+
+        for (unsigned int group_idx = 0; group_idx < n; group_idx++)
+            if (in && h_tag.data[group_idx] < n_tags)
+                h_rtag.data[h_tag.data[group_idx]] = group_idx;
+        }
+
+    #ifdef ENABLE_MPI
+    if (m_pdata->getDomainDecomposition())
+        {
+        ArrayHandle<ranks_t> h_ranks(m_group_ranks, access_location::host, access_mode::overwrite);
+        checkpoint_read(in, h_ranks.data, n);
+
+        // the ranks may be laid out differently on the grid than when the checkpoint was written
+        for (unsigned int group_idx = 0; group_idx < n; group_idx++)
+            for (unsigned int i = 0; i < group_size; ++i)
                 {
-                snapshot.val[snap_id] = ((typeval_t) m_group_typeval[group_idx]).val;
+                unsigned int rank = h_ranks.data[group_idx].idx[i];
+                if (rank < rank_map.size())
+                    h_ranks.data[group_idx].idx[i] = rank_map[rank];
                 }
-            snap_id++;
-            }
         }
+    #endif
 
-    snapshot.type_mapping = m_type_mapping;
+    m_nglobal = nglobal;
 
-    return index;
+    // notify observers
+    m_group_num_change_signal.emit();
+    notifyGroupReorder();
     }
 
 #ifdef ENABLE_MPI
@@ -1227,7 +1495,7 @@ template<class T, typename Group>
         .def(py::init<std::shared_ptr<ParticleData>, unsigned int>())
         .def(py::init<std::shared_ptr<ParticleData>, const typename T::Snapshot& >())
         .def("initializeFromSnapshot", &T::initializeFromSnapshot)
-        .def("takeSnapshot", &T::takeSnapshot)
+        .def("takeSnapshot", (std::map<unsigned int, unsigned int> (T::*)(typename T::Snapshot&) const) &T::takeSnapshot)
         .def("getN", &T::getN)
         .def("getNGlobal", &T::getNGlobal)
         .def("getNTypes", &T::getNTypes)
@@ -43,6 +43,7 @@ const unsigned int GROUP_NOT_LOCAL ((unsigned int) 0xffffffff);
 #include <set>
 #include <vector>
 #include <map>
+#include <iosfwd>
 
 //! Storage data type for group members
 /*! We use a union to emphasize it that can contain either particle
@@ -249,6 +250,15 @@ class BondedGroupData
         //! Take a snapshot
         virtual std::map<unsigned int, unsigned int> takeSnapshot(Snapshot& snapshot) const;
 
+        //! Take a snapshot and return the snapshot index of every group tag in a flat array
+        void takeSnapshot(Snapshot& snapshot, std::vector<unsigned int>& snap_idx) const;
+
+        //! Write the local groups and the global tag state to a checkpoint stream
+        void writeCheckpoint(std::ostream& out) const;
+
+        //! Restore the local groups and the global tag state from a checkpoint stream
+        void readCheckpoint(std::istream& in, const std::vector<unsigned int>& rank_map);
+
         //! Get local number of bonded groups
         unsigned int getN() const
             {
@@ -291,6 +301,16 @@ class BondedGroupData
             return m_nglobal;
             }
 
+        //! Get the number of global changes of the bonded groups
+        /*! The count is incremented whenever groups are added or removed, the data is re-initialized, or a type is
+            renamed. It is identical on all ranks, and it does not change when groups migrate between ranks or are
+            reordered. Output writers compare it to the count of their last snapshot to skip unchanged data.
+        */
+        uint64_t getModificationCount() const
+            {
+            return m_modification_count;
+            }
+
         //! Get the number of group types
         unsigned int getNTypes() const
             {
@@ -598,6 +618,9 @@ class BondedGroupData
             m_groups_dirty = true;
             }
 
+        //! Update the GPU table after the particles have been reordered (serial runs only)
+        void slotParticleSort(const unsigned int *order, const unsigned int *inverse);
+
     protected:
         #ifdef ENABLE_MPI
         //! Helper function to transfer bonded groups connected to a single particle
@@ -619,6 +642,9 @@ class BondedGroupData
         GPUVector<unsigned int> m_gpu_pos_table;     //!< Position of particle idx in group table
         Index2D m_gpu_table_indexer;                 //!< Indexer for GPU table
         GPUVector<unsigned int> m_gpu_n_groups;      //!< Number of entries in lookup table per particle
+        GPUVector<members_t> m_gpu_table_alt;        //!< Permuted GPU table, swapped in by slotParticleSort()
+        GPUVector<unsigned int> m_gpu_pos_table_alt; //!< Permuted position table
+        GPUVector<unsigned int> m_gpu_n_groups_alt;  //!< Permuted number of entries per particle
         std::vector<std::string> m_type_mapping;     //!< Mapping of types of bonded groups
 
         unsigned int m_n_groups;                     //!< Number of local groups
@@ -637,6 +663,7 @@ class BondedGroupData
         #endif
 
         unsigned int m_nglobal;                      //!< Global number of groups
+        uint64_t m_modification_count;               //!< Number of global changes of the groups
         std::stack<unsigned int> m_recycled_tags;    //!< Global tags of removed groups
         std::set<unsigned int> m_tag_set;            //!< Lookup table for tags by active index
         GPUVector<unsigned int> m_cached_tag_set;    //!< Cached constant-time lookup table for tags by active index
@@ -0,0 +1,163 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file CheckpointIO.h
+    \brief Helper functions to write and read binary checkpoint streams
+*/
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+#ifndef __CHECKPOINT_IO_H__
+#define __CHECKPOINT_IO_H__
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+/*! \defgroup checkpoint_io Checkpoint I/O
+    Checkpoint streams hold the raw in-memory representation of the data, they can only be read by a build with the
+    same floating point precision on the same architecture. Variable length data is prefixed with its length.
+
+    The read functions leave the stream in a failed state when the data is truncated, the caller checks the stream
+    state once after reading a section.
+*/
+
+//! Write an array of plain values to a checkpoint stream
+/*! \ingroup checkpoint_io */
+template<class T>
+inline void checkpoint_write(std::ostream& out, const T *data, size_t n)
+    {
+    if (n > 0)
+        out.write((const char *)data, n*sizeof(T));
+    }
+
+//! Write a plain value to a checkpoint stream
+/*! \ingroup checkpoint_io */
+template<class T>
+inline void checkpoint_write(std::ostream& out, const T& v)
+    {
+    checkpoint_write(out, &v, 1);
+    }
+
+//! Write a vector of plain values to a checkpoint stream
+/*! \ingroup checkpoint_io */
+template<class T>
+inline void checkpoint_write(std::ostream& out, const std::vector<T>& v)
+    {
+    uint64_t n = v.size();
+    checkpoint_write(out, n);
+    checkpoint_write(out, v.data(), v.size());
+    }
+
+//! Write a string to a checkpoint stream
+/*! \ingroup checkpoint_io */
+inline void checkpoint_write(std::ostream& out, const std::string& s)
+    {
+    uint64_t n = s.size();
+    checkpoint_write(out, n);
+    checkpoint_write(out, s.data(), s.size());
+    }
+
+//! Write a list of strings to a checkpoint stream
+/*! \ingroup checkpoint_io */
+inline void checkpoint_write(std::ostream& out, const std::vector<std::string>& v)
+    {
+    uint64_t n = v.size();
+    checkpoint_write(out, n);
+    for (unsigned int i = 0; i < v.size(); i++)
+        checkpoint_write(out, v[i]);
+    }
+
+//! Read an array of plain values from a checkpoint stream
+/*! \ingroup checkpoint_io */
+template<class T>
+inline void checkpoint_read(std::istream& in, T *data, size_t n)
+    {
+    if (n > 0)
+        in.read((char *)data, n*sizeof(T));
+    }
+
+//! Read a plain value from a checkpoint stream
+/*! \ingroup checkpoint_io */
+template<class T>
+inline void checkpoint_read(std::istream& in, T& v)
+    {
+    checkpoint_read(in, &v, 1);
+    }
+
+//! Read a vector of plain values from a checkpoint stream
+/*! \ingroup checkpoint_io */
+template<class T>
+inline void checkpoint_read(std::istream& in, std::vector<T>& v)
+    {
+    uint64_t n = 0;
+    checkpoint_read(in, n);
+    if (! in)
+        return;
+    v.resize(n);
+    checkpoint_read(in, v.data(), v.size());
+    }
+
+//! Read a string from a checkpoint stream
+/*! \ingroup checkpoint_io */
+inline void checkpoint_read(std::istream& in, std::string& s)
+    {
+    uint64_t n = 0;
+    checkpoint_read(in, n);
+    if (! in)
+        return;
+    std::vector<char> buf(n);
+    checkpoint_read(in, buf.data(), buf.size());
+    s.assign(buf.begin(), buf.end());
+    }
+
+//! Read a list of strings from a checkpoint stream
+/*! \ingroup checkpoint_io */
+inline void checkpoint_read(std::istream& in, std::vector<std::string>& v)
+    {
+    uint64_t n = 0;
+    checkpoint_read(in, n);
+    if (! in)
+        return;
+    v.resize(n);
+    for (unsigned int i = 0; i < v.size() && in; i++)
+        checkpoint_read(in, v[i]);
+    }
+
+//! Version of the checkpoint format
+/*! \ingroup checkpoint_io */
+const uint32_t CHECKPOINT_VERSION = 1;
+
+//! Magic string at the beginning of the manifest
+/*! \ingroup checkpoint_io */
+const char CHECKPOINT_MANIFEST_MAGIC[8] = {'H','O','O','M','D','C','K','M'};
+
+//! Magic string at the beginning of the file of a rank
+/*! \ingroup checkpoint_io */
+const char CHECKPOINT_RANK_MAGIC[8] = {'H','O','O','M','D','C','K','R'};
+
+//! Name of the checkpoint manifest
+/*! \ingroup checkpoint_io */
+inline std::string checkpoint_manifest_filename(const std::string& prefix)
+    {
+    return prefix + ".manifest";
+    }
+
+//! Name of the checkpoint file written by a rank
+/*! The file name includes the time step of the checkpoint, the manifest selects the set of files by its time step.
+    \ingroup checkpoint_io
+*/
+inline std::string checkpoint_rank_filename(const std::string& prefix, uint64_t timestep, unsigned int rank)
+    {
+    std::ostringstream s;
+    s << prefix << "." << timestep << "." << rank << ".bin";
+    return s.str();
+    }
+
+#endif
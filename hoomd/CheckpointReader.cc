@@ -0,0 +1,322 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file CheckpointReader.cc
+    \brief Defines the CheckpointReader class
+*/
+
+#include "CheckpointReader.h"
+#include "CheckpointIO.h"
+#include "SystemDefinition.h"
+
+#ifdef ENABLE_MPI
+#include "HOOMDMPI.h"
+#endif
+
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+
+namespace py = pybind11;
+
+using namespace std;
+
+/*! \param exec_conf The execution configuration
+    \param prefix Prefix of the checkpoint file names
+
+    The root rank reads the manifest <prefix>.manifest and broadcasts it. The checkpoint must have been written with
+    the same number of ranks.
+*/
+CheckpointReader::CheckpointReader(std::shared_ptr<const ExecutionConfiguration> exec_conf, const std::string &prefix)
+    : m_exec_conf(exec_conf), m_prefix(prefix), m_timestep(0), m_snapshot(new SnapshotSystemData<float>),
+      m_grid(make_uint3(0,0,0)), m_staggered(false)
+    {
+    m_exec_conf->msg->notice(5) << "Constructing CheckpointReader: " << prefix << endl;
+
+    unsigned int nranks = 0;
+    bool ok = true;
+    if (m_exec_conf->isRoot())
+        ok = readManifest(nranks);
+
+    #ifdef ENABLE_MPI
+    const MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+    bcast(ok, 0, mpi_comm);
+    #endif
+
+    if (! ok)
+        throw runtime_error("Error reading checkpoint");
+
+    #ifdef ENABLE_MPI
+    if (m_exec_conf->getNRanks() > 1)
+        {
+        bcast(nranks, 0, mpi_comm);
+        bcast(m_timestep, 0, mpi_comm);
+        bcast(m_snapshot->dimensions, 0, mpi_comm);
+        bcast(m_snapshot->global_box, 0, mpi_comm);
+        bcast(m_snapshot->particle_data.type_mapping, 0, mpi_comm);
+        bcast(m_snapshot->bond_data.type_mapping, 0, mpi_comm);
+        bcast(m_snapshot->angle_data.type_mapping, 0, mpi_comm);
+        bcast(m_snapshot->dihedral_data.type_mapping, 0, mpi_comm);
+        bcast(m_snapshot->improper_data.type_mapping, 0, mpi_comm);
+        bcast(m_snapshot->pair_data.type_mapping, 0, mpi_comm);
+        bcast(m_snapshot->integrator_data, 0, mpi_comm);
+        bcast(m_grid, 0, mpi_comm);
+        bcast(m_staggered, 0, mpi_comm);
+        bcast(m_frac_x, 0, mpi_comm);
+        bcast(m_frac_y, 0, mpi_comm);
+        bcast(m_frac_z, 0, mpi_comm);
+        bcast(m_cart_ranks, 0, mpi_comm);
+        }
+    #endif
+
+    if (nranks != m_exec_conf->getNRanks())
+        {
+        m_exec_conf->msg->error() << "init.read_checkpoint: " << prefix << " was written by " << nranks
+                                  << " ranks, it can only be restored on the same number of ranks" << endl;
+        throw runtime_error("Error reading checkpoint");
+        }
+    }
+
+/*! \param nranks Number of ranks that wrote the checkpoint (output)
+    \returns true if the manifest was read successfully
+*/
+bool CheckpointReader::readManifest(unsigned int& nranks)
+    {
+    string fname = checkpoint_manifest_filename(m_prefix);
+    m_exec_conf->msg->notice(3) << "init.read_checkpoint: reading " << fname << endl;
+
+    ifstream in(fname.c_str(), ios::in | ios::binary);
+    if (! in)
+        {
+        m_exec_conf->msg->error() << "init.read_checkpoint: " << strerror(errno) << " - " << fname << endl;
+        return false;
+        }
+
+    char magic[sizeof(CHECKPOINT_MANIFEST_MAGIC)];
+    uint32_t version = 0;
+    uint32_t scalar_size = 0;
+    in.read(magic, sizeof(magic));
+    checkpoint_read(in, version);
+    checkpoint_read(in, scalar_size);
+    if (! in || memcmp(magic, CHECKPOINT_MANIFEST_MAGIC, sizeof(magic)) != 0)
+        {
+        m_exec_conf->msg->error() << "init.read_checkpoint: " << fname << " is not a checkpoint manifest" << endl;
+        return false;
+        }
+    if (version != CHECKPOINT_VERSION)
+        {
+        m_exec_conf->msg->error() << "init.read_checkpoint: " << fname << " has unsupported version " << version << endl;
+        return false;
+        }
+    if (scalar_size != sizeof(Scalar))
+        {
+        m_exec_conf->msg->error() << "init.read_checkpoint: " << fname << " was written in "
+                                  << (scalar_size == sizeof(float) ? "single" : "double")
+                                  << " precision, it cannot be restored by this build" << endl;
+        return false;
+        }
+
+    uint32_t n = 0;
+    uint32_t dimensions = 3;
+    checkpoint_read(in, m_timestep);
+    checkpoint_read(in, n);
+    checkpoint_read(in, dimensions);
+    nranks = n;
+    m_snapshot->dimensions = dimensions;
+
+    Scalar3 lo, hi;
+    Scalar xy = 0, xz = 0, yz = 0;
+    uchar3 periodic;
+    checkpoint_read(in, lo);
+    checkpoint_read(in, hi);
+    checkpoint_read(in, xy);
+    checkpoint_read(in, xz);
+    checkpoint_read(in, yz);
+    checkpoint_read(in, periodic);
+
+    BoxDim box;
+    box.setLoHi(lo, hi);
+    box.setTiltFactors(xy, xz, yz);
+    box.setPeriodic(periodic);
+    m_snapshot->global_box = box;
+
+    checkpoint_read(in, m_snapshot->particle_data.type_mapping);
+    checkpoint_read(in, m_snapshot->bond_data.type_mapping);
+    checkpoint_read(in, m_snapshot->angle_data.type_mapping);
+    checkpoint_read(in, m_snapshot->dihedral_data.type_mapping);
+    checkpoint_read(in, m_snapshot->improper_data.type_mapping);
+    checkpoint_read(in, m_snapshot->pair_data.type_mapping);
+
+    uint32_t n_integrators = 0;
+    checkpoint_read(in, n_integrators);
+    if (in)
+        {
+        m_snapshot->integrator_data.resize(n_integrators);
+        for (unsigned int i = 0; i < n_integrators && in; i++)
+            {
+            checkpoint_read(in, m_snapshot->integrator_data[i].type);
+            checkpoint_read(in, m_snapshot->integrator_data[i].variable);
+            }
+        }
+
+    uint8_t staggered = 0;
+    checkpoint_read(in, m_grid);
+    checkpoint_read(in, staggered);
+    checkpoint_read(in, m_frac_x);
+    checkpoint_read(in, m_frac_y);
+    checkpoint_read(in, m_frac_z);
+    checkpoint_read(in, m_cart_ranks);
+    m_staggered = staggered;
+
+    if (! in)
+        {
+        m_exec_conf->msg->error() << "init.read_checkpoint: " << fname << " is truncated" << endl;
+        return false;
+        }
+
+    return true;
+    }
+
+#ifdef ENABLE_MPI
+/*! \param decomposition Domain decomposition to restore, before any particles are placed into it
+
+    This is a collective call.
+*/
+void CheckpointReader::setDomainDecomposition(std::shared_ptr<DomainDecomposition> decomposition)
+    {
+    uint3 grid = decomposition->getGridSize();
+    if (grid.x != m_grid.x || grid.y != m_grid.y || grid.z != m_grid.z
+        || decomposition->isStaggered() != m_staggered)
+        {
+        m_exec_conf->msg->error() << "init.read_checkpoint: " << m_prefix << " was written with a "
+                                  << (m_staggered ? "staggered " : "") << m_grid.x << "x" << m_grid.y << "x" << m_grid.z
+                                  << " domain decomposition, the decomposition must be the same" << endl;
+        throw runtime_error("Error reading checkpoint");
+        }
+
+    // restore the cut planes, which may have been moved by load balancing
+    decomposition->setCumulativeFractions(0, m_frac_x, 0);
+    if (m_staggered)
+        {
+        decomposition->setStaggeredFractions(1, m_frac_y, 0);
+        decomposition->setStaggeredFractions(2, m_frac_z, 0);
+        }
+    else
+        {
+        decomposition->setCumulativeFractions(1, m_frac_y, 0);
+        decomposition->setCumulativeFractions(2, m_frac_z, 0);
+        }
+    }
+#endif
+
+/*! \param sysdef System definition constructed from getSnapshot() (and the decomposition)
+
+    Every rank reads the file written by the rank that held the same domain. The ranks may be laid out differently
+    on the grid than when the checkpoint was written, the member ranks of the bonded groups are translated. This is a
+    collective call.
+*/
+void CheckpointReader::initialize(std::shared_ptr<SystemDefinition> sysdef)
+    {
+    std::shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+    unsigned int rank = m_exec_conf->getRank();
+    unsigned int nranks = m_exec_conf->getNRanks();
+
+    // the rank that wrote the data of this domain, and the new rank of every rank that wrote the checkpoint
+    unsigned int file_rank = rank;
+    unsigned int grid_idx = 0;
+    std::vector<unsigned int> rank_map(nranks);
+    for (unsigned int r = 0; r < nranks; r++)
+        rank_map[r] = r;
+
+    bool decomposed = false;
+    #ifdef ENABLE_MPI
+    std::shared_ptr<DomainDecomposition> decomposition = pdata->getDomainDecomposition();
+    if (decomposition)
+        {
+        decomposed = true;
+        if (m_cart_ranks.size() == nranks)
+            {
+            ArrayHandle<unsigned int> h_cart_ranks(decomposition->getCartRanks(), access_location::host, access_mode::read);
+            ArrayHandle<unsigned int> h_cart_ranks_inv(decomposition->getInverseCartRanks(), access_location::host, access_mode::read);
+
+            grid_idx = h_cart_ranks_inv.data[rank];
+            file_rank = m_cart_ranks[grid_idx];
+            for (unsigned int i = 0; i < nranks; i++)
+                rank_map[m_cart_ranks[i]] = h_cart_ranks.data[i];
+            }
+        }
+    #endif
+
+    if (decomposed != (m_cart_ranks.size() > 0))
+        {
+        m_exec_conf->msg->error() << "init.read_checkpoint: " << m_prefix << " was written "
+                                  << (decomposed ? "without" : "with") << " a domain decomposition" << endl;
+        throw runtime_error("Error reading checkpoint");
+        }
+
+    string fname = checkpoint_rank_filename(m_prefix, m_timestep, file_rank);
+    ifstream in(fname.c_str(), ios::in | ios::binary);
+    int ok = bool(in);
+    if (! ok)
+        m_exec_conf->msg->error() << "init.read_checkpoint: " << strerror(errno) << " - " << fname << endl;
+
+    if (ok)
+        {
+        char magic[sizeof(CHECKPOINT_RANK_MAGIC)];
+        uint32_t version = 0, scalar_size = 0, file_nranks = 0, file_rank_read = 0, file_grid_idx = 0;
+        uint64_t timestep = 0;
+        in.read(magic, sizeof(magic));
+        checkpoint_read(in, version);
+        checkpoint_read(in, scalar_size);
+        checkpoint_read(in, timestep);
+        checkpoint_read(in, file_nranks);
+        checkpoint_read(in, file_rank_read);
+        checkpoint_read(in, file_grid_idx);
+
+        ok = in && memcmp(magic, CHECKPOINT_RANK_MAGIC, sizeof(magic)) == 0 && version == CHECKPOINT_VERSION
+             && scalar_size == sizeof(Scalar) && timestep == m_timestep && file_nranks == nranks
+             && file_rank_read == file_rank && file_grid_idx == grid_idx;
+        if (! ok)
+            m_exec_conf->msg->error() << "init.read_checkpoint: " << fname << " does not belong to the checkpoint "
+                                      << "at step " << m_timestep << endl;
+        }
+
+    if (ok)
+        {
+        pdata->readCheckpoint(in);
+        sysdef->getBondData()->readCheckpoint(in, rank_map);
+        sysdef->getAngleData()->readCheckpoint(in, rank_map);
+        sysdef->getDihedralData()->readCheckpoint(in, rank_map);
+        sysdef->getImproperData()->readCheckpoint(in, rank_map);
+        sysdef->getConstraintData()->readCheckpoint(in, rank_map);
+        sysdef->getPairData()->readCheckpoint(in, rank_map);
+
+        ok = bool(in);
+        if (! ok)
+            m_exec_conf->msg->error() << "init.read_checkpoint: " << fname << " is truncated" << endl;
+        }
+
+    #ifdef ENABLE_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_LAND, m_exec_conf->getMPICommunicator());
+    #endif
+
+    if (! ok)
+        throw runtime_error("Error reading checkpoint");
+    }
+
+void export_CheckpointReader(py::module& m)
+    {
+    py::class_< CheckpointReader, std::shared_ptr<CheckpointReader> >(m,"CheckpointReader")
+    .def(py::init< std::shared_ptr<const ExecutionConfiguration>, const std::string& >())
+    .def("getTimeStep", &CheckpointReader::getTimeStep)
+    .def("getSnapshot", &CheckpointReader::getSnapshot)
+    .def("getGridSize", &CheckpointReader::getGridSize)
+    .def("isStaggered", &CheckpointReader::isStaggered)
+    #ifdef ENABLE_MPI
+    .def("setDomainDecomposition", &CheckpointReader::setDomainDecomposition)
+    #endif
+    .def("initialize", &CheckpointReader::initialize)
+    ;
+    }
@@ -0,0 +1,94 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file CheckpointReader.h
+    \brief Declares the CheckpointReader class
+*/
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+#ifndef __CHECKPOINT_READER_H__
+#define __CHECKPOINT_READER_H__
+
+#include "ParticleData.h"
+#include "SnapshotSystemData.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <hoomd/extern/pybind/include/pybind11/pybind11.h>
+
+//! Forward declarations
+class SystemDefinition;
+
+//! Restores a system from the checkpoint files written by CheckpointWriter
+/*! The root rank reads the manifest and broadcasts it. getSnapshot() returns a snapshot that only holds the box,
+    the type names and the integrator variables, to construct the SystemDefinition from. In MPI simulations, the
+    domain decomposition must have the grid of the checkpoint, setDomainDecomposition() restores its cut planes
+    before the SystemDefinition is constructed. initialize() then reads the local particles and bonded groups of
+    every rank from the file written by the rank at the same position in the grid.
+
+    \ingroup data_structs
+*/
+class PYBIND11_EXPORT CheckpointReader
+    {
+    public:
+        //! Reads the manifest
+        CheckpointReader(std::shared_ptr<const ExecutionConfiguration> exec_conf, const std::string &prefix);
+
+        //! Returns the time step of the checkpoint
+        uint64_t getTimeStep() const
+            {
+            return m_timestep;
+            }
+
+        //! Returns the snapshot with the box, the type names and the integrator variables
+        std::shared_ptr< SnapshotSystemData<float> > getSnapshot() const
+            {
+            return m_snapshot;
+            }
+
+        //! Returns the grid of the domain decomposition, zero without domain decomposition
+        uint3 getGridSize() const
+            {
+            return m_grid;
+            }
+
+        //! Returns true if the domain decomposition is staggered
+        bool isStaggered() const
+            {
+            return m_staggered;
+            }
+
+        #ifdef ENABLE_MPI
+        //! Restore the cut planes of a domain decomposition
+        void setDomainDecomposition(std::shared_ptr<DomainDecomposition> decomposition);
+        #endif
+
+        //! Restore the particles and bonded groups of all ranks
+        void initialize(std::shared_ptr<SystemDefinition> sysdef);
+
+    private:
+        std::shared_ptr<const ExecutionConfiguration> m_exec_conf; //!< The execution configuration
+        std::string m_prefix;                                        //!< Prefix of the checkpoint file names
+        uint64_t m_timestep;                                         //!< Time step of the checkpoint
+        std::shared_ptr< SnapshotSystemData<float> > m_snapshot;   //!< Snapshot with the system metadata
+        uint3 m_grid;                                                //!< Grid of the domain decomposition
+        bool m_staggered;                                            //!< True if the decomposition is staggered
+        std::vector<Scalar> m_frac_x;                                //!< Cumulative fractions along x
+        std::vector<Scalar> m_frac_y;                                //!< Cumulative fractions along y
+        std::vector<Scalar> m_frac_z;                                //!< Cumulative fractions along z
+        std::vector<unsigned int> m_cart_ranks;                      //!< Rank at every grid position
+
+        //! Read the manifest (on the root rank)
+        bool readManifest(unsigned int& nranks);
+    };
+
+//! Exports CheckpointReader to python
+void export_CheckpointReader(pybind11::module& m);
+
+#endif
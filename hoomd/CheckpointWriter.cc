@@ -0,0 +1,282 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file CheckpointWriter.cc
+    \brief Defines the CheckpointWriter class
+*/
+
+#include "CheckpointWriter.h"
+#include "CheckpointIO.h"
+#include "BondedGroupData.h"
+
+#ifdef ENABLE_MPI
+#include "HOOMDMPI.h"
+#endif
+
+#include <fstream>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+namespace py = pybind11;
+
+using namespace std;
+
+/*! \param sysdef SystemDefinition containing the data to write
+    \param prefix Prefix of the checkpoint file names
+*/
+CheckpointWriter::CheckpointWriter(std::shared_ptr<SystemDefinition> sysdef, const std::string &prefix)
+    : Analyzer(sysdef), m_prefix(prefix)
+    {
+    m_exec_conf->msg->notice(5) << "Constructing CheckpointWriter: " << prefix << endl;
+    }
+
+CheckpointWriter::~CheckpointWriter()
+    {
+    m_exec_conf->msg->notice(5) << "Destroying CheckpointWriter" << endl;
+    }
+
+//! Read the time step and the number of ranks of an existing manifest
+/*! \param fname File name of the manifest
+    \param timestep Time step of the checkpoint (output)
+    \param nranks Number of ranks that wrote the checkpoint (output)
+    \returns true if the manifest exists and belongs to a checkpoint
+*/
+static bool read_manifest_header(const std::string& fname, uint64_t& timestep, uint32_t& nranks)
+    {
+    ifstream in(fname.c_str(), ios::in | ios::binary);
+    char magic[sizeof(CHECKPOINT_MANIFEST_MAGIC)];
+    uint32_t version = 0;
+    uint32_t scalar_size = 0;
+    in.read(magic, sizeof(magic));
+    checkpoint_read(in, version);
+    checkpoint_read(in, scalar_size);
+    checkpoint_read(in, timestep);
+    checkpoint_read(in, nranks);
+    return in && memcmp(magic, CHECKPOINT_MANIFEST_MAGIC, sizeof(magic)) == 0;
+    }
+
+/*! \param timestep Current time step of the simulation
+
+    All ranks write their files to temporary names first and rename them to the names of this time step. The
+    manifest is replaced only after every rank has succeeded, and the files of the previous checkpoint are removed
+    after that. This is a collective call.
+*/
+void CheckpointWriter::analyze(unsigned int timestep)
+    {
+    if (m_prof)
+        m_prof->push("Checkpoint");
+
+    unsigned int rank = m_exec_conf->getRank();
+    string fname = checkpoint_rank_filename(m_prefix, timestep, rank);
+    string tmp_fname = fname + ".part";
+
+        {
+        ofstream out(tmp_fname.c_str(), ios::out | ios::binary | ios::trunc);
+        if (out)
+            writeRankData(out, timestep);
+        out.close();
+
+        int ok = bool(out);
+        if (! ok)
+            m_exec_conf->msg->error() << "dump.checkpoint: " << strerror(errno) << " - " << tmp_fname << endl;
+
+        #ifdef ENABLE_MPI
+        MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_LAND, m_exec_conf->getMPICommunicator());
+        #endif
+
+        if (! ok)
+            throw runtime_error("Error writing checkpoint");
+        }
+
+    // all ranks have written the new checkpoint, the previous manifest still refers to the previous files
+    int ok = (rename(tmp_fname.c_str(), fname.c_str()) == 0);
+    if (! ok)
+        m_exec_conf->msg->error() << "dump.checkpoint: " << strerror(errno) << " - " << fname << endl;
+
+    #ifdef ENABLE_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_LAND, m_exec_conf->getMPICommunicator());
+    #endif
+
+    if (! ok)
+        throw runtime_error("Error writing checkpoint");
+
+    int have_previous = 0;
+    uint64_t previous_timestep = 0;
+    uint32_t previous_nranks = 0;
+    if (m_exec_conf->isRoot())
+        {
+        string manifest_fname = checkpoint_manifest_filename(m_prefix);
+        string tmp_manifest_fname = manifest_fname + ".part";
+
+        have_previous = read_manifest_header(manifest_fname, previous_timestep, previous_nranks);
+
+        ofstream out(tmp_manifest_fname.c_str(), ios::out | ios::binary | ios::trunc);
+        if (out)
+            writeManifest(out, timestep);
+        out.close();
+
+        ok = bool(out) && rename(tmp_manifest_fname.c_str(), manifest_fname.c_str()) == 0;
+        if (! ok)
+            m_exec_conf->msg->error() << "dump.checkpoint: " << strerror(errno) << " - " << manifest_fname << endl;
+        }
+
+    #ifdef ENABLE_MPI
+    bcast(ok, 0, m_exec_conf->getMPICommunicator());
+    bcast(have_previous, 0, m_exec_conf->getMPICommunicator());
+    bcast(previous_timestep, 0, m_exec_conf->getMPICommunicator());
+    bcast(previous_nranks, 0, m_exec_conf->getMPICommunicator());
+    #endif
+
+    if (! ok)
+        throw runtime_error("Error writing checkpoint");
+
+    // the new manifest is in place, remove the files of the previous checkpoint. The root rank also removes the files
+    // of ranks that do not exist anymore. Files that are left behind do not affect the checkpoint.
+    if (have_previous && previous_timestep != timestep)
+        {
+        if (rank < previous_nranks)
+            remove(checkpoint_rank_filename(m_prefix, previous_timestep, rank).c_str());
+
+        if (m_exec_conf->isRoot())
+            {
+            for (unsigned int r = m_exec_conf->getNRanks(); r < previous_nranks; r++)
+                remove(checkpoint_rank_filename(m_prefix, previous_timestep, r).c_str());
+            }
+        }
+
+    if (m_prof)
+        m_prof->pop();
+    }
+
+/*! \param out Stream to write to
+    \param timestep Current time step of the simulation
+
+    The header identifies the rank and its position in the domain grid, followed by the local particle data and the
+    local bonded groups of all kinds.
+*/
+void CheckpointWriter::writeRankData(std::ostream& out, unsigned int timestep)
+    {
+    uint32_t rank = m_exec_conf->getRank();
+    uint32_t nranks = m_exec_conf->getNRanks();
+    uint32_t grid_idx = 0;
+
+    #ifdef ENABLE_MPI
+    std::shared_ptr<DomainDecomposition> decomposition = m_pdata->getDomainDecomposition();
+    if (decomposition)
+        {
+        ArrayHandle<unsigned int> h_cart_ranks_inv(decomposition->getInverseCartRanks(), access_location::host, access_mode::read);
+        grid_idx = h_cart_ranks_inv.data[rank];
+        }
+    #endif
+
+    out.write(CHECKPOINT_RANK_MAGIC, sizeof(CHECKPOINT_RANK_MAGIC));
+    checkpoint_write(out, CHECKPOINT_VERSION);
+    checkpoint_write(out, uint32_t(sizeof(Scalar)));
+    checkpoint_write(out, uint64_t(timestep));
+    checkpoint_write(out, nranks);
+    checkpoint_write(out, rank);
+    checkpoint_write(out, grid_idx);
+
+    m_pdata->writeCheckpoint(out);
+    m_sysdef->getBondData()->writeCheckpoint(out);
+    m_sysdef->getAngleData()->writeCheckpoint(out);
+    m_sysdef->getDihedralData()->writeCheckpoint(out);
+    m_sysdef->getImproperData()->writeCheckpoint(out);
+    m_sysdef->getConstraintData()->writeCheckpoint(out);
+    m_sysdef->getPairData()->writeCheckpoint(out);
+    }
+
+//! Helper function to collect the type names of a data structure
+template<class T>
+static std::vector<std::string> get_type_mapping(const T& data)
+    {
+    std::vector<std::string> type_mapping(data.getNTypes());
+    for (unsigned int i = 0; i < type_mapping.size(); i++)
+        type_mapping[i] = data.getNameByType(i);
+    return type_mapping;
+    }
+
+/*! \param out Stream to write to
+    \param timestep Current time step of the simulation
+*/
+void CheckpointWriter::writeManifest(std::ostream& out, unsigned int timestep)
+    {
+    out.write(CHECKPOINT_MANIFEST_MAGIC, sizeof(CHECKPOINT_MANIFEST_MAGIC));
+    checkpoint_write(out, CHECKPOINT_VERSION);
+    checkpoint_write(out, uint32_t(sizeof(Scalar)));
+    checkpoint_write(out, uint64_t(timestep));
+    checkpoint_write(out, uint32_t(m_exec_conf->getNRanks()));
+    checkpoint_write(out, uint32_t(m_sysdef->getNDimensions()));
+
+    const BoxDim& box = m_pdata->getGlobalBox();
+    checkpoint_write(out, box.getLo());
+    checkpoint_write(out, box.getHi());
+    checkpoint_write(out, box.getTiltFactorXY());
+    checkpoint_write(out, box.getTiltFactorXZ());
+    checkpoint_write(out, box.getTiltFactorYZ());
+    checkpoint_write(out, box.getPeriodic());
+
+    checkpoint_write(out, get_type_mapping(*m_pdata));
+    checkpoint_write(out, get_type_mapping(*m_sysdef->getBondData()));
+    checkpoint_write(out, get_type_mapping(*m_sysdef->getAngleData()));
+    checkpoint_write(out, get_type_mapping(*m_sysdef->getDihedralData()));
+    checkpoint_write(out, get_type_mapping(*m_sysdef->getImproperData()));
+    checkpoint_write(out, get_type_mapping(*m_sysdef->getPairData()));
+
+    // thermostat and barostat variables
+    std::shared_ptr<IntegratorData> integrator_data = m_sysdef->getIntegratorData();
+    uint32_t n_integrators = integrator_data->getNumIntegrators();
+    checkpoint_write(out, n_integrators);
+    for (unsigned int i = 0; i < n_integrators; i++)
+        {
+        const IntegratorVariables& v = integrator_data->getIntegratorVariables(i);
+        checkpoint_write(out, v.type);
+        checkpoint_write(out, v.variable);
+        }
+
+    // the domain decomposition, including the cut planes moved by load balancing
+    uint3 grid = make_uint3(0,0,0);
+    uint8_t staggered = 0;
+    std::vector<Scalar> frac_x, frac_y, frac_z;
+    std::vector<unsigned int> cart_ranks;
+
+    #ifdef ENABLE_MPI
+    std::shared_ptr<DomainDecomposition> decomposition = m_pdata->getDomainDecomposition();
+    if (decomposition)
+        {
+        grid = decomposition->getGridSize();
+        staggered = decomposition->isStaggered();
+        frac_x = decomposition->getCumulativeFractions(0);
+        if (staggered)
+            {
+            frac_y = decomposition->getStaggeredFractions(1);
+            frac_z = decomposition->getStaggeredFractions(2);
+            }
+        else
+            {
+            frac_y = decomposition->getCumulativeFractions(1);
+            frac_z = decomposition->getCumulativeFractions(2);
+            }
+
+        ArrayHandle<unsigned int> h_cart_ranks(decomposition->getCartRanks(), access_location::host, access_mode::read);
+        cart_ranks.assign(h_cart_ranks.data, h_cart_ranks.data + decomposition->getCartRanks().getNumElements());
+        }
+    #endif
+
+    checkpoint_write(out, grid);
+    checkpoint_write(out, staggered);
+    checkpoint_write(out, frac_x);
+    checkpoint_write(out, frac_y);
+    checkpoint_write(out, frac_z);
+    checkpoint_write(out, cart_ranks);
+    }
+
+void export_CheckpointWriter(py::module& m)
+    {
+    py::class_<CheckpointWriter, std::shared_ptr<CheckpointWriter> >(m,"CheckpointWriter",py::base<Analyzer>())
+    .def(py::init< std::shared_ptr<SystemDefinition>, std::string >())
+    ;
+    }
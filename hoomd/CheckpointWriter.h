@@ -0,0 +1,66 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file CheckpointWriter.h
+    \brief Declares the CheckpointWriter class
+*/
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+#ifndef __CHECKPOINT_WRITER_H__
+#define __CHECKPOINT_WRITER_H__
+
+#include "Analyzer.h"
+
+#include <string>
+#include <memory>
+#include <iosfwd>
+
+#include <hoomd/extern/pybind/include/pybind11/pybind11.h>
+
+//! Analyzer for writing per-rank checkpoint files
+/*! Every time analyze() is called, every rank writes the raw contents of its local ParticleData and BondedGroupData
+    arrays to its own file <prefix>.<timestep>.<rank>.bin, without any communication of particle data. Once all ranks
+    have written their file, the root rank writes the small manifest <prefix>.manifest with the time step, the box,
+    the type names, the integrator variables and the domain decomposition.
+
+    The rank files of every checkpoint have new names, and the manifest selects the set of files by its time step. The
+    manifest is replaced atomically once all ranks have written their files completely, and the files of the previous
+    checkpoint are removed only after that. A crash at any point leaves a manifest with a complete set of files. Every
+    file also carries the time step, so that CheckpointReader detects files that do not belong to the manifest.
+
+    The random number streams in HOOMD are seeded by the time step, restoring the time step restores them. Together
+    with the integrator variables (thermostat and barostat degrees of freedom), a restart from a checkpoint continues
+    the trajectory exactly, when it is run with the same script on the same number of ranks.
+
+    \ingroup analyzers
+*/
+class PYBIND11_EXPORT CheckpointWriter : public Analyzer
+    {
+    public:
+        //! Construct the writer
+        CheckpointWriter(std::shared_ptr<SystemDefinition> sysdef, const std::string &prefix);
+
+        //! Destructor
+        ~CheckpointWriter();
+
+        //! Write a checkpoint of the current state
+        void analyze(unsigned int timestep);
+
+    private:
+        std::string m_prefix;   //!< Prefix of the checkpoint file names
+
+        //! Write the local data of this rank to a stream
+        void writeRankData(std::ostream& out, unsigned int timestep);
+
+        //! Write the manifest to a stream
+        void writeManifest(std::ostream& out, unsigned int timestep);
+    };
+
+//! Exports the CheckpointWriter class to python
+void export_CheckpointWriter(pybind11::module& m);
+
+#endif
@@ -14,8 +14,15 @@
 #include "System.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <hoomd/extern/pybind/include/pybind11/stl.h>
 
+#ifdef ENABLE_TBB
+#include <tbb/tbb.h>
+#endif
+
 
 using namespace std;
 namespace py = pybind11;
@@ -715,7 +722,18 @@ void Communicator::GroupCommunicator<group_data>::markGhostParticles(
 
         unsigned int ngroups = m_gdata->getN();
 
+        // the plan flags are collected per group member in parallel, and merged into the particle plans afterwards,
+        // because several groups may share a particle
+        m_member_plans.assign(ngroups*group_data::size, 0);
+
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, ngroups),
+            [&](const tbb::blocked_range<unsigned int>& range)
+            {
+            for (unsigned int group_idx = range.begin(); group_idx != range.end(); ++group_idx)
+        #else
         for (unsigned int group_idx = 0; group_idx < ngroups; ++group_idx)
+        #endif
             {
             typename group_data::members_t g = h_groups.data[group_idx];
             typename group_data::ranks_t r = h_group_ranks.data[group_idx];
@@ -785,12 +803,27 @@ void Communicator::GroupCommunicator<group_data>::markGhostParticles(
                                 flags &= ~(f.z > Scalar(0.5) ? send_down : send_up);
                                 }
 
-                            h_plan.data[rtag_j] |= flags;
+                            m_member_plans[group_idx*group_data::size + j] |= flags;
                             }
                         } // end inner loop over group members
                     }
                 } // end outer loop over group members
             } // end loop over groups
+        #ifdef ENABLE_TBB
+            });
+        #endif
+
+        // merge into the particle plans
+        for (unsigned int group_idx = 0; group_idx < ngroups; ++group_idx)
+            {
+            typename group_data::members_t g = h_groups.data[group_idx];
+            for (unsigned int j = 0; j < group_data::size; ++j)
+                {
+                unsigned int flags = m_member_plans[group_idx*group_data::size + j];
+                if (flags)
+                    h_plan.data[h_rtag.data[g.tag[j]]] |= flags;
+                }
+            }
         }
     }
 
@@ -1083,6 +1116,26 @@ Communicator::Communicator(std::shared_ptr<SystemDefinition> sysdef,
             m_tag_reverse(m_exec_conf),
             m_netforce_reverse_copybuf(m_exec_conf),
             m_netforce_reverse_recvbuf(m_exec_conf),
+            m_direct_ghost_update(false),
+            m_direct_plan_valid(false),
+            m_persistent_ghost_update(false),
+            m_persistent_reqs_valid(false),
+            m_shared_ghost_update(false),
+            m_node_comm(MPI_COMM_NULL),
+            m_shared_win(MPI_WIN_NULL),
+            m_shared_sendbuf(NULL),
+            m_shared_capacity(0),
+            m_shared_parity(0),
+            m_ghost_position_bits(0),
+            m_ghost_position_range(Scalar(0.0)),
+            m_ghost_update_period(1),
+            m_ghost_max_drift(Scalar(0.0)),
+            m_ghost_steps(0),
+            m_ghost_drift(Scalar(0.0)),
+            m_ghost_v_max(Scalar(0.0)),
+            m_deltaT(Scalar(0.0)),
+            m_compute_time(0),
+            m_wait_time(0),
             m_r_ghost_max(Scalar(0.0)),
             m_r_extra_ghost_max(Scalar(0.0)),
             m_ghosts_added(0),
@@ -1202,6 +1255,17 @@ Communicator::~Communicator()
     m_sysdef->getImproperData()->getGroupNumChangeSignal().disconnect<Communicator, &Communicator::setImpropersChanged>(this);
     m_sysdef->getConstraintData()->getGroupNumChangeSignal().disconnect<Communicator, &Communicator::setConstraintsChanged>(this);
     m_sysdef->getPairData()->getGroupNumChangeSignal().disconnect<Communicator, &Communicator::setPairsChanged>(this);
+
+    // the persistent requests, the shared window and the node communicator can only be freed while MPI is active
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (! finalized)
+        {
+        freePersistentGhostRequests();
+        freeSharedGhostWindow();
+        if (m_node_comm != MPI_COMM_NULL)
+            MPI_Comm_free(&m_node_comm);
+        }
     }
 
 void Communicator::initializeNeighborArrays()
@@ -1310,6 +1374,14 @@ void Communicator::communicate(unsigned int timestep)
                                         }
                                       , timestep);
 
+    // ghost velocities are needed to extrapolate the ghost positions between updates
+    Scalar v_max(0.0);
+    if (m_ghost_update_period > 1)
+        {
+        m_flags[comm_flag::velocity] = 1;
+        v_max = getGlobalMaxSpeed();
+        }
+
     if (!m_force_migrate && !m_compute_callbacks.empty() && m_has_ghost_particles)
         {
         // do an obligatory update before determining whether to migrate
@@ -1340,9 +1412,21 @@ void Communicator::communicate(unsigned int timestep)
     // Update ghosts if we are not migrating
     if (!migrate && m_compute_callbacks.empty())
         {
-        beginUpdateGhosts(timestep);
+        // every rank takes the same decision, because it is based on global quantities
+        if (m_ghost_update_period > 1 && ! m_flags[comm_flag::orientation] && checkGhostExtrapolation(v_max))
+            extrapolateGhosts();
+        else
+            {
+            beginUpdateGhosts(timestep);
 
-        finishUpdateGhosts(timestep);
+            // compute on interior particles while the ghost update is in flight
+            if (m_comm_pending)
+                m_interior_compute_callbacks.emit(timestep);
+
+            finishUpdateGhosts(timestep);
+
+            resetGhostExtrapolation(v_max);
+            }
         }
 
     // Check if migration of particles is requested
@@ -1360,6 +1444,8 @@ void Communicator::communicate(unsigned int timestep)
         m_compute_callbacks.emit(timestep);
 
         m_has_ghost_particles = true;
+
+        resetGhostExtrapolation(v_max);
         }
 
     m_is_communicating = false;
@@ -1396,7 +1482,14 @@ void Communicator::migrateParticles()
             // mark all particles which have left the box for sending (rtag=NOT_LOCAL)
             unsigned int N = m_pdata->getN();
 
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(0, N),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int idx = r.begin(); idx != r.end(); ++idx)
+            #else
             for (unsigned int idx = 0; idx < N; ++idx)
+            #endif
                 {
                 const Scalar4& postype = h_pos.data[idx];
                 Scalar3 pos = make_scalar3(postype.x, postype.y, postype.z);
@@ -1413,6 +1506,9 @@ void Communicator::migrateParticles()
 
                 h_comm_flag.data[idx] = flags;
                 }
+            #ifdef ENABLE_TBB
+                });
+            #endif
             }
 
         /*
@@ -1485,7 +1581,14 @@ void Communicator::migrateParticles()
 
         // wrap received particles across a global boundary back into global box
         const BoxDim shifted_box = getShiftedBox();
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, n_recv_ptls),
+            [&](const tbb::blocked_range<unsigned int>& r)
+            {
+            for (unsigned int idx = r.begin(); idx != r.end(); ++idx)
+        #else
         for (unsigned int idx = 0; idx < n_recv_ptls; idx++)
+        #endif
             {
             pdata_element& p = m_recvbuf[idx];
             Scalar4& postype = p.pos;
@@ -1493,6 +1596,9 @@ void Communicator::migrateParticles()
 
             shifted_box.wrap(postype, image);
             }
+        #ifdef ENABLE_TBB
+            });
+        #endif
 
         // remove particles that were sent and fill particle data with received particles
         m_pdata->addParticles(m_recvbuf);
@@ -1530,6 +1636,11 @@ void Communicator::updateGhostWidth()
                                                             if (r > r_ghost_i) r_ghost_i = r;
                                                             }
                                                             ,cur_type);
+
+            // extrapolated ghosts may come closer than their particles by up to the maximum drift
+            if (m_ghost_update_period > 1)
+                r_ghost_i += m_ghost_max_drift;
+
             h_r_ghost.data[cur_type] = r_ghost_i;
             if (r_ghost_i > r_ghost_max) r_ghost_max = r_ghost_i;
             }
@@ -1575,15 +1686,13 @@ void Communicator::exchangeGhosts()
     //          construct plans (= itineraries for ghost particles)
     // Stage 2: fill send buffers, exchange ghosts according to plans (sending the plan along with the particle)
 
-    // resize and reset plans
+    // resize plans, every local plan is overwritten below
     m_plan.resize(m_pdata->getN());
 
-        {
-        ArrayHandle<unsigned int> h_plan(m_plan, access_location::host, access_mode::readwrite);
-
-        for (unsigned int i = 0; i < m_pdata->getN(); ++i)
-            h_plan.data[i] = 0;
-        }
+    // the owner of every ghost travels along with it, to set up direct ghost updates
+    m_direct_plan_valid = false;
+    if (m_direct_ghost_update)
+        m_ghost_origin.assign(m_pdata->getN(), m_exec_conf->getRank());
 
     /*
      * Mark non-bonded atoms for sending
@@ -1606,9 +1715,17 @@ void Communicator::exchangeGhosts()
         // scan all local atom positions if they are within r_ghost from a neighbor
         ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
         ArrayHandle<unsigned int> h_body(m_pdata->getBodies(), access_location::host, access_mode::read);
-        ArrayHandle<unsigned int> h_plan(m_plan, access_location::host, access_mode::readwrite);
+        ArrayHandle<unsigned int> h_plan(m_plan, access_location::host, access_mode::overwrite);
 
+        // every particle only writes its own plan
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_pdata->getN()),
+            [&](const tbb::blocked_range<unsigned int>& r)
+            {
+            for (unsigned int idx = r.begin(); idx != r.end(); ++idx)
+        #else
         for (unsigned int idx = 0; idx < m_pdata->getN(); idx++)
+        #endif
             {
             Scalar4 postype = h_pos.data[idx];
             Scalar3 pos = make_scalar3(postype.x, postype.y, postype.z);
@@ -1623,24 +1740,30 @@ void Communicator::exchangeGhosts()
                 }
 
             Scalar3 f = box.makeFraction(pos);
+            unsigned int plan = 0;
             if (f.x >= Scalar(1.0) - ghost_fraction.x)
-                h_plan.data[idx] |= send_east;
+                plan |= send_east;
 
             if (f.x < ghost_fraction.x)
-                h_plan.data[idx] |= send_west;
+                plan |= send_west;
 
             if (f.y >= Scalar(1.0) - ghost_fraction.y)
-                h_plan.data[idx] |= send_north;
+                plan |= send_north;
 
             if (f.y < ghost_fraction.y)
-                h_plan.data[idx] |= send_south;
+                plan |= send_south;
 
             if (f.z >= Scalar(1.0) - ghost_fraction.z)
-                h_plan.data[idx] |= send_up;
+                plan |= send_up;
 
             if (f.z < ghost_fraction.z)
-                h_plan.data[idx] |= send_down;
+                plan |= send_down;
+
+            h_plan.data[idx] = plan;
             }
+        #ifdef ENABLE_TBB
+            });
+        #endif
         }
 
     unsigned int mask = 0;
@@ -1674,6 +1797,14 @@ void Communicator::exchangeGhosts()
     // ghost particle flags
     CommFlags flags = getFlags();
 
+    // in a staggered decomposition, the plans of the ghosts are extended by every rank they pass through, so they
+    // cannot be inverted to send forces back
+    if (m_decomposition->isStaggered() && flags[comm_flag::reverse_net_force])
+        {
+        m_exec_conf->msg->error() << "comm: reverse ghost communication is not supported with a staggered decomposition" << std::endl;
+        throw std::runtime_error("Error during communication");
+        }
+
     for (unsigned int dir = 0; dir < 6; dir ++)
         {
         if (! isCommunicating(dir) ) continue;
@@ -1710,6 +1841,9 @@ void Communicator::exchangeGhosts()
             m_orientation_copybuf.resize(max_copy_ghosts);
             }
 
+        if (m_direct_ghost_update)
+            m_origin_copybuf.resize(max_copy_ghosts);
+
             {
             // we fill all fields, but send only those that are requested by the CommFlags bitset
             ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
@@ -1732,25 +1866,41 @@ void Communicator::exchangeGhosts()
             ArrayHandle<Scalar4> h_velocity_copybuf(m_velocity_copybuf, access_location::host, access_mode::overwrite);
             ArrayHandle<Scalar4> h_orientation_copybuf(m_orientation_copybuf, access_location::host, access_mode::overwrite);
 
+            // select the particles to send with a cheap serial pass, the particle data is gathered in parallel
+            m_ghost_send_idx.resize(max_copy_ghosts);
             for (unsigned int idx = 0; idx < m_pdata->getN() + m_pdata->getNGhosts(); idx++)
                 {
-
                 if (h_plan.data[idx] & (1 << dir))
-                    {
-                    // send with next message
-                    if (flags[comm_flag::position]) h_pos_copybuf.data[m_num_copy_ghosts[dir]] = h_pos.data[idx];
-                    if (flags[comm_flag::charge]) h_charge_copybuf.data[m_num_copy_ghosts[dir]] = h_charge.data[idx];
-                    if (flags[comm_flag::diameter]) h_diameter_copybuf.data[m_num_copy_ghosts[dir]] = h_diameter.data[idx];
-                    if (flags[comm_flag::body]) h_body_copybuf.data[m_num_copy_ghosts[dir]] = h_body.data[idx];
-                    if (flags[comm_flag::image]) h_image_copybuf.data[m_num_copy_ghosts[dir]] = h_image.data[idx];
-                    if (flags[comm_flag::velocity]) h_velocity_copybuf.data[m_num_copy_ghosts[dir]] = h_vel.data[idx];
-                    if (flags[comm_flag::orientation]) h_orientation_copybuf.data[m_num_copy_ghosts[dir]] = h_orientation.data[idx];
-                    h_plan_copybuf.data[m_num_copy_ghosts[dir]] = h_plan.data[idx];
-
-                    h_copy_ghosts.data[m_num_copy_ghosts[dir]] = h_tag.data[idx];
-                    m_num_copy_ghosts[dir]++;
-                    }
+                    m_ghost_send_idx[m_num_copy_ghosts[dir]++] = idx;
+                }
+
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_num_copy_ghosts[dir]),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int i = r.begin(); i != r.end(); ++i)
+            #else
+            for (unsigned int i = 0; i < m_num_copy_ghosts[dir]; ++i)
+            #endif
+                {
+                const unsigned int idx = m_ghost_send_idx[i];
+
+                // send with next message
+                if (flags[comm_flag::position]) h_pos_copybuf.data[i] = h_pos.data[idx];
+                if (flags[comm_flag::charge]) h_charge_copybuf.data[i] = h_charge.data[idx];
+                if (flags[comm_flag::diameter]) h_diameter_copybuf.data[i] = h_diameter.data[idx];
+                if (flags[comm_flag::body]) h_body_copybuf.data[i] = h_body.data[idx];
+                if (flags[comm_flag::image]) h_image_copybuf.data[i] = h_image.data[idx];
+                if (flags[comm_flag::velocity]) h_velocity_copybuf.data[i] = h_vel.data[idx];
+                if (flags[comm_flag::orientation]) h_orientation_copybuf.data[i] = h_orientation.data[idx];
+                h_plan_copybuf.data[i] = h_plan.data[idx];
+                if (m_direct_ghost_update) m_origin_copybuf[i] = m_ghost_origin[idx];
+
+                h_copy_ghosts.data[i] = h_tag.data[idx];
                 }
+            #ifdef ENABLE_TBB
+                });
+            #endif
             }
         unsigned int send_neighbor = m_decomposition->getNeighborRank(dir);
 
@@ -1800,6 +1950,9 @@ void Communicator::exchangeGhosts()
         // resize plan array
         m_plan.resize(m_pdata->getN() + m_pdata->getNGhosts());
 
+        if (m_direct_ghost_update)
+            m_ghost_origin.resize(m_pdata->getN() + m_pdata->getNGhosts());
+
         // exchange particle data, write directly to the particle data arrays
         if (m_prof)
             {
@@ -2006,6 +2159,26 @@ void Communicator::exchangeGhosts()
                 m_reqs.push_back(req);
                 }
 
+            if (m_direct_ghost_update)
+                {
+                MPI_Isend(m_origin_copybuf.data(),
+                    m_num_copy_ghosts[dir]*sizeof(unsigned int),
+                    MPI_BYTE,
+                    send_neighbor,
+                    10,
+                    m_mpi_comm,
+                    &req);
+                m_reqs.push_back(req);
+                MPI_Irecv(m_ghost_origin.data() + start_idx,
+                    m_num_recv_ghosts[dir]*sizeof(unsigned int),
+                    MPI_BYTE,
+                    recv_neighbor,
+                    10,
+                    m_mpi_comm,
+                    &req);
+                m_reqs.push_back(req);
+                }
+
             m_stats.resize(m_reqs.size());
             MPI_Waitall(m_reqs.size(), &m_reqs.front(), &m_stats.front());
             }
@@ -2021,7 +2194,14 @@ void Communicator::exchangeGhosts()
 
             const BoxDim shifted_box = getShiftedBox();
 
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(start_idx, start_idx + m_num_recv_ghosts[dir]),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int idx = r.begin(); idx != r.end(); ++idx)
+            #else
             for (unsigned int idx = start_idx; idx < start_idx + m_num_recv_ghosts[dir]; idx++)
+            #endif
                 {
                 Scalar4& pos = h_pos.data[idx];
 
@@ -2029,25 +2209,93 @@ void Communicator::exchangeGhosts()
                 int3& img = h_image.data[idx];
                 shifted_box.wrap(pos,img);
                 }
+            #ifdef ENABLE_TBB
+                });
+            #endif
             }
 
+        // in a staggered decomposition, the domains along the remaining dimensions are not the same as those of the
+        // sender, so the received ghosts are also routed on from the local domain
+        if (m_decomposition->isStaggered() && flags[comm_flag::position] && dir < face_up)
             {
-            // set reverse-lookup tag -> idx
+            ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+            ArrayHandle<unsigned int> h_body(m_pdata->getBodies(), access_location::host, access_mode::read);
+            ArrayHandle<unsigned int> h_plan(m_plan, access_location::host, access_mode::readwrite);
+
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(start_idx, start_idx + m_num_recv_ghosts[dir]),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int idx = r.begin(); idx != r.end(); ++idx)
+            #else
+            for (unsigned int idx = start_idx; idx < start_idx + m_num_recv_ghosts[dir]; idx++)
+            #endif
+                {
+                Scalar4 postype = h_pos.data[idx];
+                Scalar3 pos = make_scalar3(postype.x, postype.y, postype.z);
+
+                const unsigned int type = __scalar_as_int(postype.w);
+                Scalar3 ghost_fraction = ghost_fractions[type];
+
+                // without the body flags, assume that every ghost may belong to a rigid body
+                if (!flags[comm_flag::body] || h_body.data[idx] < MIN_FLOPPY)
+                    {
+                    ghost_fraction += ghost_fractions_body[type];
+                    }
+
+                Scalar3 f = box.makeFraction(pos);
+                unsigned int plan = 0;
+                if (dir < face_north)
+                    {
+                    if (f.y >= Scalar(1.0) - ghost_fraction.y)
+                        plan |= send_north;
+
+                    if (f.y < ghost_fraction.y)
+                        plan |= send_south;
+                    }
+
+                if (f.z >= Scalar(1.0) - ghost_fraction.z)
+                    plan |= send_up;
+
+                if (f.z < ghost_fraction.z)
+                    plan |= send_down;
+
+                h_plan.data[idx] |= plan;
+                }
+            #ifdef ENABLE_TBB
+                });
+            #endif
+            }
+
+            {
+            // set reverse-lookup tag -> idx, tags are unique so the writes do not conflict
             ArrayHandle<unsigned int> h_tag(m_pdata->getTags(), access_location::host, access_mode::read);
             ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::readwrite);
 
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(start_idx, start_idx + m_num_recv_ghosts[dir]),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int idx = r.begin(); idx != r.end(); ++idx)
+            #else
             for (unsigned int idx = start_idx; idx < start_idx + m_num_recv_ghosts[dir]; idx++)
+            #endif
                 {
                 assert(h_tag.data[idx] <= m_pdata->getMaximumTag());
                 assert(h_rtag.data[h_tag.data[idx]] == NOT_LOCAL);
                 h_rtag.data[h_tag.data[idx]] = idx;
                 }
-
+            #ifdef ENABLE_TBB
+                });
+            #endif
             }
         } // end dir loop
 
     m_ghosts_added = m_pdata->getNGhosts();
 
+    if (m_direct_ghost_update)
+        setupDirectGhostUpdate();
+
     // exchange ghost constraints along with ghost particles
     m_constraint_comm.exchangeGhostGroups(m_plan, mask);
 
@@ -2297,6 +2545,13 @@ void Communicator::exchangeGhosts()
 //! update positions of ghost particles
 void Communicator::beginUpdateGhosts(unsigned int timestep)
     {
+    if (m_direct_ghost_update && m_direct_plan_valid)
+        {
+        // the messages are completed in finishUpdateGhosts()
+        beginUpdateGhostsDirect();
+        return;
+        }
+
     // we have a current m_copy_ghosts liss which contain the indices of particles
     // to send to neighboring processors
     if (m_prof)
@@ -2322,7 +2577,14 @@ void Communicator::beginUpdateGhosts(unsigned int timestep)
             ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
 
             // copy positions of ghost particles
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_num_copy_ghosts[dir]),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int ghost_idx = r.begin(); ghost_idx != r.end(); ++ghost_idx)
+            #else
             for (unsigned int ghost_idx = 0; ghost_idx < m_num_copy_ghosts[dir]; ghost_idx++)
+            #endif
                 {
                 unsigned int idx = h_rtag.data[h_copy_ghosts.data[ghost_idx]];
 
@@ -2331,6 +2593,9 @@ void Communicator::beginUpdateGhosts(unsigned int timestep)
                 // copy position into send buffer
                 h_pos_copybuf.data[ghost_idx] = h_pos.data[idx];
                 }
+            #ifdef ENABLE_TBB
+                });
+            #endif
             }
 
         if (flags[comm_flag::velocity])
@@ -2341,7 +2606,14 @@ void Communicator::beginUpdateGhosts(unsigned int timestep)
             ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
 
             // copy velocity of ghost particles
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_num_copy_ghosts[dir]),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int ghost_idx = r.begin(); ghost_idx != r.end(); ++ghost_idx)
+            #else
             for (unsigned int ghost_idx = 0; ghost_idx < m_num_copy_ghosts[dir]; ghost_idx++)
+            #endif
                 {
                 unsigned int idx = h_rtag.data[h_copy_ghosts.data[ghost_idx]];
 
@@ -2350,6 +2622,9 @@ void Communicator::beginUpdateGhosts(unsigned int timestep)
                 // copy velocity into send buffer
                 h_velocity_copybuf.data[ghost_idx] = h_vel.data[idx];
                 }
+            #ifdef ENABLE_TBB
+                });
+            #endif
             }
 
         if (flags[comm_flag::orientation])
@@ -2360,7 +2635,14 @@ void Communicator::beginUpdateGhosts(unsigned int timestep)
             ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
 
             // copy orientation of ghost particles
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_num_copy_ghosts[dir]),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int ghost_idx = r.begin(); ghost_idx != r.end(); ++ghost_idx)
+            #else
             for (unsigned int ghost_idx = 0; ghost_idx < m_num_copy_ghosts[dir]; ghost_idx++)
+            #endif
                 {
                 unsigned int idx = h_rtag.data[h_copy_ghosts.data[ghost_idx]];
 
@@ -2369,6 +2651,9 @@ void Communicator::beginUpdateGhosts(unsigned int timestep)
                 // copy orientation into send buffer
                 h_orientation_copybuf.data[ghost_idx] = h_orientation.data[idx];
                 }
+            #ifdef ENABLE_TBB
+                });
+            #endif
             }
 
 
@@ -2452,7 +2737,14 @@ void Communicator::beginUpdateGhosts(unsigned int timestep)
             ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
 
             const BoxDim shifted_box = getShiftedBox();
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(start_idx, start_idx + m_num_recv_ghosts[dir]),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int idx = r.begin(); idx != r.end(); ++idx)
+            #else
             for (unsigned int idx = start_idx; idx < start_idx + m_num_recv_ghosts[dir]; idx++)
+            #endif
                 {
                 Scalar4& pos = h_pos.data[idx];
 
@@ -2460,6 +2752,9 @@ void Communicator::beginUpdateGhosts(unsigned int timestep)
                 int3 img = make_int3(0,0,0);
                 shifted_box.wrap(pos, img);
                 }
+            #ifdef ENABLE_TBB
+                });
+            #endif
             }
 
         } // end dir loop
@@ -2789,6 +3084,869 @@ void Communicator::updateNetForce(unsigned int timestep)
     }
 
 
+/*! Ghosts are grouped by the rank that owns them, and every neighbor is told which of its particles to send,
+    in which order. The lists stay valid until the next ghost exchange.
+ */
+void Communicator::setupDirectGhostUpdate()
+    {
+    if (m_prof)
+        m_prof->push("comm_ghost_direct_setup");
+
+    // the persistent requests refer to the old plan
+    freePersistentGhostRequests();
+
+    const unsigned int N = m_pdata->getN();
+    const unsigned int n_ghosts = m_pdata->getNGhosts();
+    assert(m_ghost_origin.size() == N + n_ghosts);
+
+    ArrayHandle<unsigned int> h_unique_neighbors(m_unique_neighbors, access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag(m_pdata->getTags(), access_location::host, access_mode::read);
+
+    // map owner rank to the index of the unique neighbor
+    std::map<unsigned int, unsigned int> neigh_idx;
+    for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+        neigh_idx[h_unique_neighbors.data[ineigh]] = ineigh;
+
+    // group ghosts by owner with a counting sort, keeping the ghost order for every owner
+    std::vector<unsigned int> ghost_neigh(n_ghosts);
+    m_direct_recv_begin.assign(m_n_unique_neigh+1, 0);
+    for (unsigned int i = 0; i < n_ghosts; ++i)
+        {
+        std::map<unsigned int, unsigned int>::const_iterator it = neigh_idx.find(m_ghost_origin[N+i]);
+        if (it == neigh_idx.end())
+            {
+            m_exec_conf->msg->error() << "comm: ghost particle " << h_tag.data[N+i] << " is owned by rank "
+                << m_ghost_origin[N+i] << ", which is not a neighbor" << std::endl;
+            throw std::runtime_error("Error setting up direct ghost updates");
+            }
+        ghost_neigh[i] = it->second;
+        m_direct_recv_begin[it->second+1]++;
+        }
+    for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+        m_direct_recv_begin[ineigh+1] += m_direct_recv_begin[ineigh];
+
+    m_direct_recv_idx.resize(n_ghosts);
+    std::vector<unsigned int> request_tags(n_ghosts);
+        {
+        std::vector<unsigned int> offset(m_direct_recv_begin.begin(), m_direct_recv_begin.end()-1);
+        for (unsigned int i = 0; i < n_ghosts; ++i)
+            {
+            unsigned int pos = offset[ghost_neigh[i]]++;
+            m_direct_recv_idx[pos] = N+i;
+            request_tags[pos] = h_tag.data[N+i];
+            }
+        }
+
+    // exchange the number of requested particles with every neighbor
+    std::vector<unsigned int> n_request(m_n_unique_neigh);
+    std::vector<unsigned int> n_requested(m_n_unique_neigh);
+    m_reqs.resize(2*m_n_unique_neigh);
+    for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+        {
+        n_request[ineigh] = m_direct_recv_begin[ineigh+1] - m_direct_recv_begin[ineigh];
+        MPI_Isend(&n_request[ineigh], 1, MPI_UNSIGNED, h_unique_neighbors.data[ineigh], 0, m_mpi_comm, &m_reqs[2*ineigh]);
+        MPI_Irecv(&n_requested[ineigh], 1, MPI_UNSIGNED, h_unique_neighbors.data[ineigh], 0, m_mpi_comm, &m_reqs[2*ineigh+1]);
+        }
+    m_stats.resize(m_reqs.size());
+    if (m_reqs.size())
+        MPI_Waitall(m_reqs.size(), &m_reqs.front(), &m_stats.front());
+
+    m_direct_send_begin.assign(m_n_unique_neigh+1, 0);
+    for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+        m_direct_send_begin[ineigh+1] = m_direct_send_begin[ineigh] + n_requested[ineigh];
+    m_direct_send_tags.resize(m_direct_send_begin[m_n_unique_neigh]);
+
+    // exchange the tags of the requested particles
+    m_reqs.clear();
+    MPI_Request req;
+    for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+        {
+        if (n_request[ineigh])
+            {
+            MPI_Isend(&request_tags[m_direct_recv_begin[ineigh]], n_request[ineigh], MPI_UNSIGNED,
+                h_unique_neighbors.data[ineigh], 1, m_mpi_comm, &req);
+            m_reqs.push_back(req);
+            }
+        if (n_requested[ineigh])
+            {
+            MPI_Irecv(&m_direct_send_tags[m_direct_send_begin[ineigh]], n_requested[ineigh], MPI_UNSIGNED,
+                h_unique_neighbors.data[ineigh], 1, m_mpi_comm, &req);
+            m_reqs.push_back(req);
+            }
+        }
+    m_stats.resize(m_reqs.size());
+    if (m_reqs.size())
+        MPI_Waitall(m_reqs.size(), &m_reqs.front(), &m_stats.front());
+
+    // positions at the time of the exchange, the reference for compressed position updates
+        {
+        ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
+
+        m_direct_send_ref.resize(m_direct_send_tags.size());
+        for (unsigned int i = 0; i < m_direct_send_tags.size(); ++i)
+            {
+            unsigned int idx = h_rtag.data[m_direct_send_tags[i]];
+            assert(idx < N);
+            m_direct_send_ref[i] = make_scalar3(h_pos.data[idx].x, h_pos.data[idx].y, h_pos.data[idx].z);
+            }
+
+        m_direct_recv_ref.resize(n_ghosts);
+        for (unsigned int i = 0; i < n_ghosts; ++i)
+            {
+            unsigned int idx = m_direct_recv_idx[i];
+            m_direct_recv_ref[i] = make_scalar3(h_pos.data[idx].x, h_pos.data[idx].y, h_pos.data[idx].z);
+            }
+        }
+    m_ghost_position_range = m_r_ghost_max;
+
+    // neighbors on the same node read the ghost data from a shared window
+    m_neigh_node_rank.assign(m_n_unique_neigh, -1);
+    if (m_shared_ghost_update)
+        setupSharedGhostUpdate();
+
+    m_direct_plan_valid = true;
+
+    if (m_prof)
+        m_prof->pop();
+    }
+
+/*! \param flags Ghost communication flags
+    \returns The number of bytes per particle in a direct ghost update message
+ */
+unsigned int Communicator::getDirectRecordSize(const CommFlags& flags) const
+    {
+    const unsigned int position_bits = getDirectPositionBits();
+
+    unsigned int size = 0;
+    if (flags[comm_flag::position])
+        {
+        if (position_bits == 16)
+            size += 3*sizeof(int16_t);
+        else if (position_bits == 32)
+            size += 3*sizeof(int32_t);
+        else
+            size += sizeof(Scalar4);
+        }
+    if (flags[comm_flag::velocity])
+        size += sizeof(Scalar4);
+    if (flags[comm_flag::orientation])
+        size += sizeof(Scalar4);
+    return size;
+    }
+
+/*! Positions, velocities and orientations (as requested by the communication flags) of all ghosts owned by
+    one neighbor are packed into a single message. All messages are posted at once, so the update completes
+    in one round regardless of the number of neighbors. Positions are wrapped into the shifted global box,
+    which yields the same ghost image as the staged update.
+
+    With compressed positions, only the displacement since the last ghost exchange is sent, as fixed point
+    numbers relative to the ghost layer width. The particle type is not updated in this case.
+
+    With shared memory ghost updates, the data for neighbors on the same node is packed into a shared window
+    instead, and the neighbors read it in place after a zero-byte notification. The window is double buffered,
+    so that a rank never overwrites data a neighbor may still be reading: before packing into the same half
+    again, it has received the notification of the intermediate update from every neighbor.
+ */
+void Communicator::beginUpdateGhostsDirect()
+    {
+    if (m_prof)
+        m_prof->push("comm_ghost_update");
+
+    m_exec_conf->msg->notice(7) << "Communicator: update ghosts (direct)" << std::endl;
+
+    CommFlags flags = getFlags();
+    const unsigned int record_size = getDirectRecordSize(flags);
+
+    if (! record_size)
+        {
+        if (m_prof)
+            m_prof->pop();
+        return;
+        }
+
+    unsigned int n_send = m_direct_send_tags.size();
+    unsigned int n_recv = m_direct_recv_idx.size();
+    m_direct_sendbuf.resize(n_send*record_size);
+    m_direct_recvbuf.resize(n_recv*record_size);
+
+    // the buffers remain at their location until the next ghost exchange or change of fields
+    if (m_persistent_ghost_update && (! m_persistent_reqs_valid || m_persistent_flags != flags))
+        {
+        setupPersistentGhostRequests(record_size);
+        m_persistent_flags = flags;
+        }
+
+        {
+        // pack the requested fields of every particle contiguously
+        ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_orientation(m_pdata->getOrientationArray(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
+
+        const BoxDim& global_box = m_pdata->getGlobalBox();
+        const unsigned int position_bits = getDirectPositionBits();
+        const Scalar pos_scale = position_bits ?
+            (position_bits == 16 ? Scalar(INT16_MAX) : Scalar(INT32_MAX))/m_ghost_position_range : Scalar(0.0);
+
+        // set from inside the (possibly threaded) packing loop
+        std::atomic<bool> overflow(false);
+
+        for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+            {
+            if (m_direct_send_begin[ineigh] == m_direct_send_begin[ineigh+1])
+                continue;
+
+            // neighbors on the same node read from the current half of the shared window
+            char *sendbuf = (m_neigh_node_rank[ineigh] >= 0) ?
+                m_shared_sendbuf + m_shared_parity*m_shared_capacity : &m_direct_sendbuf.front();
+
+            // every particle has its own record in the buffer
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(m_direct_send_begin[ineigh], m_direct_send_begin[ineigh+1]),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int i = r.begin(); i != r.end(); ++i)
+            #else
+            for (unsigned int i = m_direct_send_begin[ineigh]; i < m_direct_send_begin[ineigh+1]; ++i)
+            #endif
+                {
+                unsigned int idx = h_rtag.data[m_direct_send_tags[i]];
+                assert(idx < m_pdata->getN());
+
+                char *buf = sendbuf + i*record_size;
+                if (flags[comm_flag::position])
+                    {
+                    if (position_bits)
+                        {
+                        // displacement since the ghost exchange, the particle may have crossed the global boundary
+                        Scalar3 delta = global_box.minImage(make_scalar3(h_pos.data[idx].x, h_pos.data[idx].y, h_pos.data[idx].z)
+                            - m_direct_send_ref[i]);
+                        Scalar q[3] = {delta.x*pos_scale, delta.y*pos_scale, delta.z*pos_scale};
+
+                        for (unsigned int k = 0; k < 3; ++k)
+                            {
+                            if (position_bits == 16)
+                                {
+                                if (fabs(q[k]) > Scalar(INT16_MAX))
+                                    overflow = true;
+                                int16_t val = (int16_t) lround(q[k]);
+                                memcpy(buf, &val, sizeof(int16_t));
+                                buf += sizeof(int16_t);
+                                }
+                            else
+                                {
+                                if (fabs(q[k]) > Scalar(INT32_MAX))
+                                    overflow = true;
+                                int32_t val = (int32_t) lround(q[k]);
+                                memcpy(buf, &val, sizeof(int32_t));
+                                buf += sizeof(int32_t);
+                                }
+                            }
+                        }
+                    else
+                        {
+                        memcpy(buf, &h_pos.data[idx], sizeof(Scalar4));
+                        buf += sizeof(Scalar4);
+                        }
+                    }
+                if (flags[comm_flag::velocity])
+                    {
+                    memcpy(buf, &h_vel.data[idx], sizeof(Scalar4));
+                    buf += sizeof(Scalar4);
+                    }
+                if (flags[comm_flag::orientation])
+                    {
+                    memcpy(buf, &h_orientation.data[idx], sizeof(Scalar4));
+                    buf += sizeof(Scalar4);
+                    }
+                }
+            #ifdef ENABLE_TBB
+                });
+            #endif
+            }
+
+        if (overflow)
+            {
+            m_exec_conf->msg->error() << "comm: A particle moved farther than the ghost layer width since the last "
+                << "ghost exchange, its compressed position cannot be sent" << std::endl;
+            throw std::runtime_error("Error updating ghost particles");
+            }
+        }
+
+    ArrayHandle<unsigned int> h_unique_neighbors(m_unique_neighbors, access_location::host, access_mode::read);
+
+    m_reqs.clear();
+    MPI_Request req;
+
+    if (m_shared_win != MPI_WIN_NULL)
+        {
+        // make the packed data visible to the other ranks on the node, then notify the neighbors
+        MPI_Win_sync(m_shared_win);
+
+        for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+            {
+            if (m_neigh_node_rank[ineigh] < 0)
+                continue;
+
+            if (m_direct_send_begin[ineigh] == m_direct_send_begin[ineigh+1]
+                && m_direct_recv_begin[ineigh] == m_direct_recv_begin[ineigh+1])
+                continue;
+
+            MPI_Isend(NULL, 0, MPI_BYTE, h_unique_neighbors.data[ineigh], 4, m_mpi_comm, &req);
+            m_reqs.push_back(req);
+            MPI_Irecv(NULL, 0, MPI_BYTE, h_unique_neighbors.data[ineigh], 4, m_mpi_comm, &req);
+            m_reqs.push_back(req);
+            }
+        }
+
+    if (m_persistent_ghost_update)
+        {
+        // start all messages, the received data is unpacked in finishUpdateGhostsDirect()
+        if (m_persistent_reqs.size())
+            MPI_Startall(m_persistent_reqs.size(), &m_persistent_reqs.front());
+        }
+    else
+        {
+        // post all messages, the received data is unpacked in finishUpdateGhostsDirect()
+        for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+            {
+            if (m_neigh_node_rank[ineigh] >= 0)
+                continue;
+
+            unsigned int n_send_neigh = m_direct_send_begin[ineigh+1] - m_direct_send_begin[ineigh];
+            unsigned int n_recv_neigh = m_direct_recv_begin[ineigh+1] - m_direct_recv_begin[ineigh];
+
+            if (n_send_neigh)
+                {
+                MPI_Isend(&m_direct_sendbuf[m_direct_send_begin[ineigh]*record_size],
+                    n_send_neigh*record_size, MPI_BYTE, h_unique_neighbors.data[ineigh], 1, m_mpi_comm, &req);
+                m_reqs.push_back(req);
+                }
+            if (n_recv_neigh)
+                {
+                MPI_Irecv(&m_direct_recvbuf[m_direct_recv_begin[ineigh]*record_size],
+                    n_recv_neigh*record_size, MPI_BYTE, h_unique_neighbors.data[ineigh], 1, m_mpi_comm, &req);
+                m_reqs.push_back(req);
+                }
+            }
+        }
+
+    m_direct_flags = flags;
+    m_comm_pending = true;
+
+    if (m_prof)
+        m_prof->pop();
+    }
+
+void Communicator::finishUpdateGhosts(unsigned int timestep)
+    {
+    // only direct ghost updates are completed asynchronously on the CPU
+    if (m_comm_pending)
+        finishUpdateGhostsDirect();
+
+    m_comm_pending = false;
+
+    // the ghost positions have changed
+    m_pdata->invalidateGhostPositionsSoA();
+    }
+
+void Communicator::finishUpdateGhostsDirect()
+    {
+    if (m_prof)
+        m_prof->push("comm_ghost_update");
+
+    const CommFlags flags = m_direct_flags;
+    const unsigned int record_size = getDirectRecordSize(flags);
+
+    unsigned int n_send = m_direct_send_tags.size();
+    unsigned int n_recv = m_direct_recv_idx.size();
+
+    if (m_prof)
+        m_prof->push("MPI send/recv");
+
+    // persistent requests become inactive on completion and are restarted with the next update
+    if (m_persistent_ghost_update && m_persistent_reqs.size())
+        {
+        m_stats.resize(m_persistent_reqs.size());
+        MPI_Waitall(m_persistent_reqs.size(), &m_persistent_reqs.front(), &m_stats.front());
+        }
+
+    m_stats.resize(m_reqs.size());
+    if (m_reqs.size())
+        MPI_Waitall(m_reqs.size(), &m_reqs.front(), &m_stats.front());
+
+    // all neighbors on the node have packed their data
+    if (m_shared_win != MPI_WIN_NULL)
+        MPI_Win_sync(m_shared_win);
+
+    if (m_prof)
+        m_prof->pop(0, (n_send+n_recv)*record_size);
+
+        {
+        // unpack into the ghost particle data
+        ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
+        ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
+        ArrayHandle<Scalar4> h_orientation(m_pdata->getOrientationArray(), access_location::host, access_mode::readwrite);
+
+        const BoxDim shifted_box = getShiftedBox();
+        const unsigned int position_bits = getDirectPositionBits();
+        const Scalar pos_scale = m_ghost_position_range/(position_bits == 16 ? Scalar(INT16_MAX) : Scalar(INT32_MAX));
+
+        for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+            {
+            const unsigned int recv_begin = m_direct_recv_begin[ineigh];
+            if (recv_begin == m_direct_recv_begin[ineigh+1])
+                continue;
+
+            // read the data of neighbors on the same node in place
+            const char *recvbuf = (m_neigh_node_rank[ineigh] >= 0) ?
+                m_neigh_shared_base[ineigh] + m_shared_parity*m_shared_capacity + m_neigh_shared_offset[ineigh]*record_size :
+                &m_direct_recvbuf[recv_begin*record_size];
+
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(recv_begin, m_direct_recv_begin[ineigh+1]),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int i = r.begin(); i != r.end(); ++i)
+            #else
+            for (unsigned int i = recv_begin; i < m_direct_recv_begin[ineigh+1]; ++i)
+            #endif
+                {
+                unsigned int idx = m_direct_recv_idx[i];
+                assert(idx >= m_pdata->getN() && idx < m_pdata->getN() + m_pdata->getNGhosts());
+
+                const char *buf = recvbuf + (i-recv_begin)*record_size;
+                if (flags[comm_flag::position])
+                    {
+                    Scalar4 pos;
+                    if (position_bits)
+                        {
+                        Scalar q[3];
+                        for (unsigned int k = 0; k < 3; ++k)
+                            {
+                            if (position_bits == 16)
+                                {
+                                int16_t val;
+                                memcpy(&val, buf, sizeof(int16_t));
+                                buf += sizeof(int16_t);
+                                q[k] = Scalar(val);
+                                }
+                            else
+                                {
+                                int32_t val;
+                                memcpy(&val, buf, sizeof(int32_t));
+                                buf += sizeof(int32_t);
+                                q[k] = Scalar(val);
+                                }
+                            }
+
+                        // the type is not sent with compressed positions
+                        const Scalar3& ref = m_direct_recv_ref[i];
+                        pos = make_scalar4(ref.x + q[0]*pos_scale, ref.y + q[1]*pos_scale, ref.z + q[2]*pos_scale,
+                            h_pos.data[idx].w);
+                        }
+                    else
+                        {
+                        memcpy(&pos, buf, sizeof(Scalar4));
+                        buf += sizeof(Scalar4);
+                        }
+
+                    // wrap particles received across a global boundary
+                    int3 img = make_int3(0,0,0);
+                    shifted_box.wrap(pos, img);
+                    h_pos.data[idx] = pos;
+                    }
+                if (flags[comm_flag::velocity])
+                    {
+                    memcpy(&h_vel.data[idx], buf, sizeof(Scalar4));
+                    buf += sizeof(Scalar4);
+                    }
+                if (flags[comm_flag::orientation])
+                    {
+                    memcpy(&h_orientation.data[idx], buf, sizeof(Scalar4));
+                    buf += sizeof(Scalar4);
+                    }
+                }
+            #ifdef ENABLE_TBB
+                });
+            #endif
+            }
+        }
+
+    // the next update packs into the other half of the shared window
+    m_shared_parity ^= 1;
+
+    if (m_prof)
+        m_prof->pop();
+    }
+
+/*! \param record_size Number of bytes per particle in the direct ghost update buffers
+ */
+void Communicator::setupPersistentGhostRequests(unsigned int record_size)
+    {
+    freePersistentGhostRequests();
+
+    ArrayHandle<unsigned int> h_unique_neighbors(m_unique_neighbors, access_location::host, access_mode::read);
+
+    MPI_Request req;
+    for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+        {
+        // neighbors on the same node exchange through the shared window
+        if (m_neigh_node_rank[ineigh] >= 0)
+            continue;
+
+        unsigned int n_send_neigh = m_direct_send_begin[ineigh+1] - m_direct_send_begin[ineigh];
+        unsigned int n_recv_neigh = m_direct_recv_begin[ineigh+1] - m_direct_recv_begin[ineigh];
+
+        if (n_send_neigh)
+            {
+            MPI_Send_init(&m_direct_sendbuf[m_direct_send_begin[ineigh]*record_size],
+                n_send_neigh*record_size, MPI_BYTE, h_unique_neighbors.data[ineigh], 1, m_mpi_comm, &req);
+            m_persistent_reqs.push_back(req);
+            }
+        if (n_recv_neigh)
+            {
+            MPI_Recv_init(&m_direct_recvbuf[m_direct_recv_begin[ineigh]*record_size],
+                n_recv_neigh*record_size, MPI_BYTE, h_unique_neighbors.data[ineigh], 1, m_mpi_comm, &req);
+            m_persistent_reqs.push_back(req);
+            }
+        }
+
+    m_persistent_reqs_valid = true;
+    }
+
+void Communicator::freePersistentGhostRequests()
+    {
+    for (unsigned int i = 0; i < m_persistent_reqs.size(); ++i)
+        MPI_Request_free(&m_persistent_reqs[i]);
+
+    m_persistent_reqs.clear();
+    m_persistent_reqs_valid = false;
+    }
+
+/*! Identifies the neighbors on the same node, exchanges the offsets of the ghost data in the send buffers,
+    and (re-)allocates the shared window if any rank on the node needs more space. All ranks on a node use
+    the same capacity, so that the location of the second half of a neighbor's window is known.
+
+    \pre m_direct_send_begin is current
+ */
+void Communicator::setupSharedGhostUpdate()
+    {
+    if (m_node_comm == MPI_COMM_NULL)
+        MPI_Comm_split_type(m_mpi_comm, MPI_COMM_TYPE_SHARED, m_exec_conf->getRank(), MPI_INFO_NULL, &m_node_comm);
+
+    ArrayHandle<unsigned int> h_unique_neighbors(m_unique_neighbors, access_location::host, access_mode::read);
+
+    // translate the neighbor ranks into ranks on the node
+        {
+        MPI_Group group, node_group;
+        MPI_Comm_group(m_mpi_comm, &group);
+        MPI_Comm_group(m_node_comm, &node_group);
+
+        std::vector<int> neigh_ranks(h_unique_neighbors.data, h_unique_neighbors.data + m_n_unique_neigh);
+        std::vector<int> node_ranks(m_n_unique_neigh, MPI_UNDEFINED);
+        if (m_n_unique_neigh)
+            MPI_Group_translate_ranks(group, m_n_unique_neigh, &neigh_ranks.front(), node_group, &node_ranks.front());
+
+        MPI_Group_free(&group);
+        MPI_Group_free(&node_group);
+
+        for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+            m_neigh_node_rank[ineigh] = (node_ranks[ineigh] == MPI_UNDEFINED) ? -1 : node_ranks[ineigh];
+        }
+
+    // exchange the offsets of the ghost data with the neighbors on the node
+    m_neigh_shared_offset.assign(m_n_unique_neigh, 0);
+    m_reqs.clear();
+    MPI_Request req;
+    for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+        {
+        if (m_neigh_node_rank[ineigh] < 0)
+            continue;
+
+        MPI_Isend(&m_direct_send_begin[ineigh], 1, MPI_UNSIGNED, h_unique_neighbors.data[ineigh], 2, m_mpi_comm, &req);
+        m_reqs.push_back(req);
+        MPI_Irecv(&m_neigh_shared_offset[ineigh], 1, MPI_UNSIGNED, h_unique_neighbors.data[ineigh], 2, m_mpi_comm, &req);
+        m_reqs.push_back(req);
+        }
+    m_stats.resize(m_reqs.size());
+    if (m_reqs.size())
+        MPI_Waitall(m_reqs.size(), &m_reqs.front(), &m_stats.front());
+
+    // every half of the window holds up to three uncompressed fields per particle
+    unsigned int capacity = 3*sizeof(Scalar4)*m_direct_send_tags.size();
+    unsigned int max_capacity = 0;
+    MPI_Allreduce(&capacity, &max_capacity, 1, MPI_UNSIGNED, MPI_MAX, m_node_comm);
+
+    if (m_shared_win == MPI_WIN_NULL || max_capacity > m_shared_capacity)
+        {
+        freeSharedGhostWindow();
+
+        // leave some room for growth, so that the window is not reallocated at every neighbor list build
+        m_shared_capacity = max_capacity + max_capacity/4 + 1;
+        MPI_Aint size = 2*m_shared_capacity;
+        MPI_Win_allocate_shared(size, 1, MPI_INFO_NULL, m_node_comm, &m_shared_sendbuf, &m_shared_win);
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, m_shared_win);
+        }
+
+    // locate the windows of the neighbors on the node
+    m_neigh_shared_base.assign(m_n_unique_neigh, NULL);
+    for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+        {
+        if (m_neigh_node_rank[ineigh] < 0)
+            continue;
+
+        MPI_Aint size;
+        int disp_unit;
+        char *base;
+        MPI_Win_shared_query(m_shared_win, m_neigh_node_rank[ineigh], &size, &disp_unit, &base);
+        m_neigh_shared_base[ineigh] = base;
+        }
+
+    m_shared_parity = 0;
+    }
+
+void Communicator::freeSharedGhostWindow()
+    {
+    if (m_shared_win == MPI_WIN_NULL)
+        return;
+
+    MPI_Win_unlock_all(m_shared_win);
+    MPI_Win_free(&m_shared_win);
+    m_shared_sendbuf = NULL;
+    m_shared_capacity = 0;
+    }
+
+/*! \param period Maximum number of steps between ghost updates (1: update every step)
+    \param max_drift Maximum deviation of the ghost positions between updates
+
+    The ghost layer is widened by \a max_drift, so the widened layer must still fit into the domains.
+ */
+void Communicator::setGhostUpdatePeriod(unsigned int period, Scalar max_drift)
+    {
+    if (period == 0 || max_drift < Scalar(0.0))
+        {
+        m_exec_conf->msg->error() << "comm: The ghost update period must be positive and the maximum drift "
+            << "non-negative" << std::endl;
+        throw std::runtime_error("Error setting ghost update period");
+        }
+
+    unsigned int old_period = m_ghost_update_period;
+    Scalar old_max_drift = m_ghost_max_drift;
+    m_ghost_update_period = period;
+    m_ghost_max_drift = max_drift;
+
+    updateGhostWidth();
+    if (! ghostLayerFits())
+        {
+        m_exec_conf->msg->error() << "comm: The ghost layer widened by the maximum drift (" << max_drift
+            << ") does not fit into the domains" << std::endl;
+
+        m_ghost_update_period = old_period;
+        m_ghost_max_drift = old_max_drift;
+        updateGhostWidth();
+        throw std::runtime_error("Error setting ghost update period");
+        }
+
+    // the ghost velocities are sent and the widened ghosts exchanged starting with the next ghost exchange
+    m_ghost_steps = 0;
+    m_ghost_drift = Scalar(0.0);
+    forceMigrate();
+    }
+
+/*! \returns The maximum speed of the local particles, reduced over all ranks
+ */
+Scalar Communicator::getGlobalMaxSpeed()
+    {
+    Scalar v_max_sq(0.0);
+        {
+        ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::read);
+        for (unsigned int idx = 0; idx < m_pdata->getN(); ++idx)
+            {
+            Scalar4 vel = h_vel.data[idx];
+            v_max_sq = std::max(v_max_sq, vel.x*vel.x + vel.y*vel.y + vel.z*vel.z);
+            }
+        }
+    MPI_Allreduce(MPI_IN_PLACE, &v_max_sq, 1, MPI_HOOMD_SCALAR, MPI_MAX, m_mpi_comm);
+    return sqrt(v_max_sq);
+    }
+
+/*! \param v_max Maximum speed of all particles in the current step
+    \returns True if the ghosts may be extrapolated for another step
+
+    In the last step, every particle moved by at most \a v_max times the time step, and every extrapolated ghost
+    moves by at most the maximum speed at the last update times the time step. The sum of both over all extrapolated
+    steps bounds the deviation of the ghost positions, which must not exceed m_ghost_max_drift.
+ */
+bool Communicator::checkGhostExtrapolation(Scalar v_max)
+    {
+    if (m_ghost_steps + 1 >= m_ghost_update_period)
+        return false;
+
+    Scalar drift = m_ghost_drift + (v_max + m_ghost_v_max)*m_deltaT;
+    if (drift > m_ghost_max_drift)
+        return false;
+
+    m_ghost_drift = drift;
+    m_ghost_steps++;
+    return true;
+    }
+
+/*! \param v_max Maximum speed of all particles in the current step, which bounds the speed of the ghosts
+ */
+void Communicator::resetGhostExtrapolation(Scalar v_max)
+    {
+    m_ghost_steps = 0;
+    m_ghost_drift = Scalar(0.0);
+    m_ghost_v_max = v_max;
+    }
+
+/*! Ghost positions are advanced with the ghost velocities of the last update. The result is not wrapped, ghosts
+    stay in the frame of the shifted box they were received in.
+ */
+void Communicator::extrapolateGhosts()
+    {
+    if (m_prof)
+        m_prof->push("comm_ghost_extrapolate");
+
+    ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::read);
+
+    const unsigned int N = m_pdata->getN();
+    const Scalar dt = m_deltaT;
+
+    #ifdef ENABLE_TBB
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(N, N + m_pdata->getNGhosts()),
+        [&](const tbb::blocked_range<unsigned int>& r)
+        {
+        for (unsigned int idx = r.begin(); idx != r.end(); ++idx)
+    #else
+    for (unsigned int idx = N; idx < N + m_pdata->getNGhosts(); ++idx)
+    #endif
+        {
+        Scalar4 vel = h_vel.data[idx];
+        h_pos.data[idx].x += vel.x*dt;
+        h_pos.data[idx].y += vel.y*dt;
+        h_pos.data[idx].z += vel.z*dt;
+        }
+    #ifdef ENABLE_TBB
+        });
+    #endif
+
+    m_pdata->invalidateGhostPositionsSoA();
+
+    if (m_prof)
+        m_prof->pop();
+    }
+
+void Communicator::updateGhostScalars(GPUArray<Scalar>& values)
+    {
+    // force computes call this, the time is not part of their cost
+    int64_t start_time = m_clk.getTime();
+
+    if (m_prof)
+        m_prof->push("comm_ghost_scalar");
+
+    assert(values.getNumElements() >= m_pdata->getN() + m_pdata->getNGhosts());
+
+    if (m_direct_ghost_update && m_direct_plan_valid)
+        {
+        // one message per neighbor, see beginUpdateGhostsDirect()
+        ArrayHandle<Scalar> h_values(values, access_location::host, access_mode::readwrite);
+        ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_unique_neighbors(m_unique_neighbors, access_location::host, access_mode::read);
+
+        std::vector<Scalar> sendbuf(m_direct_send_tags.size());
+        std::vector<Scalar> recvbuf(m_direct_recv_idx.size());
+        for (unsigned int i = 0; i < sendbuf.size(); ++i)
+            sendbuf[i] = h_values.data[h_rtag.data[m_direct_send_tags[i]]];
+
+        m_reqs.clear();
+        MPI_Request req;
+        for (unsigned int ineigh = 0; ineigh < m_n_unique_neigh; ++ineigh)
+            {
+            unsigned int n_send_neigh = m_direct_send_begin[ineigh+1] - m_direct_send_begin[ineigh];
+            unsigned int n_recv_neigh = m_direct_recv_begin[ineigh+1] - m_direct_recv_begin[ineigh];
+
+            if (n_send_neigh)
+                {
+                MPI_Isend(&sendbuf[m_direct_send_begin[ineigh]], n_send_neigh*sizeof(Scalar), MPI_BYTE,
+                    h_unique_neighbors.data[ineigh], 1, m_mpi_comm, &req);
+                m_reqs.push_back(req);
+                }
+            if (n_recv_neigh)
+                {
+                MPI_Irecv(&recvbuf[m_direct_recv_begin[ineigh]], n_recv_neigh*sizeof(Scalar), MPI_BYTE,
+                    h_unique_neighbors.data[ineigh], 1, m_mpi_comm, &req);
+                m_reqs.push_back(req);
+                }
+            }
+
+        m_stats.resize(m_reqs.size());
+        if (m_reqs.size())
+            MPI_Waitall(m_reqs.size(), &m_reqs.front(), &m_stats.front());
+
+        for (unsigned int i = 0; i < recvbuf.size(); ++i)
+            h_values.data[m_direct_recv_idx[i]] = recvbuf[i];
+
+        if (m_prof)
+            m_prof->pop();
+
+        m_wait_time += m_clk.getTime() - start_time;
+        return;
+        }
+
+    unsigned int num_tot_recv_ghosts = 0; // total number of ghosts received
+    std::vector<Scalar> copybuf;
+
+    for (unsigned int dir = 0; dir < 6; dir ++)
+        {
+        if (! isCommunicating(dir) ) continue;
+
+        unsigned int start_idx = m_pdata->getN() + num_tot_recv_ghosts;
+        num_tot_recv_ghosts += m_num_recv_ghosts[dir];
+
+        ArrayHandle<Scalar> h_values(values, access_location::host, access_mode::readwrite);
+
+            {
+            ArrayHandle<unsigned int> h_copy_ghosts(m_copy_ghosts[dir], access_location::host, access_mode::read);
+            ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
+
+            // pack values of ghost particles, including ghosts received in a previous direction
+            copybuf.resize(m_num_copy_ghosts[dir]);
+            for (unsigned int ghost_idx = 0; ghost_idx < m_num_copy_ghosts[dir]; ghost_idx++)
+                {
+                unsigned int idx = h_rtag.data[h_copy_ghosts.data[ghost_idx]];
+                assert(idx < m_pdata->getN() + m_pdata->getNGhosts());
+                copybuf[ghost_idx] = h_values.data[idx];
+                }
+            }
+
+        unsigned int send_neighbor = m_decomposition->getNeighborRank(dir);
+
+        // we receive from the direction opposite to the one we send to
+        unsigned int recv_neighbor;
+        if (dir % 2 == 0)
+            recv_neighbor = m_decomposition->getNeighborRank(dir+1);
+        else
+            recv_neighbor = m_decomposition->getNeighborRank(dir-1);
+
+        m_reqs.resize(2);
+        m_stats.resize(2);
+
+        // write directly into the ghost range of the array
+        MPI_Isend(copybuf.data(), m_num_copy_ghosts[dir]*sizeof(Scalar), MPI_BYTE, send_neighbor, 1, m_mpi_comm, &m_reqs[0]);
+        MPI_Irecv(h_values.data + start_idx, m_num_recv_ghosts[dir]*sizeof(Scalar), MPI_BYTE, recv_neighbor, 1, m_mpi_comm, &m_reqs[1]);
+        MPI_Waitall(2, &m_reqs.front(), &m_stats.front());
+        } // end dir loop
+
+    if (m_prof)
+        m_prof->pop();
+
+    m_wait_time += m_clk.getTime() - start_time;
+    }
+
 void Communicator::removeGhostParticleTags()
     {
     // wipe out reverse-lookup tag -> idx for old ghost atoms
@@ -2891,6 +4049,17 @@ const BoxDim Communicator::getShiftedBox() const
 void export_Communicator(py::module& m)
     {
     py::class_<Communicator, std::shared_ptr<Communicator> >(m,"Communicator")
-    .def(py::init<std::shared_ptr<SystemDefinition>, std::shared_ptr<DomainDecomposition> >());
+    .def(py::init<std::shared_ptr<SystemDefinition>, std::shared_ptr<DomainDecomposition> >())
+    .def("setDirectGhostUpdate", &Communicator::setDirectGhostUpdate)
+    .def("getDirectGhostUpdate", &Communicator::getDirectGhostUpdate)
+    .def("setPersistentGhostUpdate", &Communicator::setPersistentGhostUpdate)
+    .def("getPersistentGhostUpdate", &Communicator::getPersistentGhostUpdate)
+    .def("setSharedGhostUpdate", &Communicator::setSharedGhostUpdate)
+    .def("getSharedGhostUpdate", &Communicator::getSharedGhostUpdate)
+    .def("setGhostPositionBits", &Communicator::setGhostPositionBits)
+    .def("getGhostPositionBits", &Communicator::getGhostPositionBits)
+    .def("setGhostUpdatePeriod", &Communicator::setGhostUpdatePeriod)
+    .def("getGhostUpdatePeriod", &Communicator::getGhostUpdatePeriod)
+    ;
     }
 #endif // ENABLE_MPI
@@ -23,6 +23,7 @@
 #include "ParticleData.h"
 #include "BondedGroupData.h"
 #include "DomainDecomposition.h"
+#include "ClockSource.h"
 
 #include <memory>
 #include <hoomd/extern/nano-signal-slot/nano_signal_slot.hpp>
@@ -238,6 +239,20 @@ class PYBIND11_EXPORT Communicator
             return m_compute_callbacks;
             }
 
+        //! Subscribe to list of *optional* call-backs for computation on interior particles
+        /*!
+         * Subscribe to a list of call-backs that are called while a ghost update is in flight. Subscribers
+         * may only read local particle data, ghost particle data is updated when the call-backs return.
+         *
+         * The call-backs are only called on time steps without particle migration and without compute call-backs.
+         *
+         * \return A Nano::Signal object reference to be used for connect and disconnect calls.
+         */
+        Nano::Signal<void (unsigned int timestep)>& getInteriorComputeCallbackSignal()
+            {
+            return m_interior_compute_callbacks;
+            }
+
         //! Get the ghost communication flags
         CommFlags getFlags() { return m_flags; }
 
@@ -253,6 +268,168 @@ class PYBIND11_EXPORT Communicator
             return m_unique_neighbors;
             }
 
+        //! Enable or disable direct ghost updates
+        /*! In direct mode, the ghost exchange additionally records the rank that owns every ghost particle,
+         *  and each rank tells its (up to 26) neighbors which of their particles it holds as ghosts. Ghost
+         *  updates then exchange data with all neighbors at once, in a single round of messages, instead of
+         *  in six sequential stages.
+         *
+         * \param enable True to enable direct ghost updates
+         */
+        void setDirectGhostUpdate(bool enable)
+            {
+            m_direct_ghost_update = enable;
+            m_direct_plan_valid = false;
+
+            // the exchange plan is built during the next ghost exchange
+            forceMigrate();
+            }
+
+        //! Returns true if ghost updates are exchanged directly with all neighbors
+        bool getDirectGhostUpdate() const
+            {
+            return m_direct_ghost_update;
+            }
+
+        //! Enable or disable persistent requests for direct ghost updates
+        /*! With persistent requests, the messages of a direct ghost update are set up once per ghost exchange
+         *  (MPI_Send_init/MPI_Recv_init) on preallocated buffers, and every ghost update only starts and completes
+         *  them. Only has an effect in direct mode.
+         *
+         * \param enable True to enable persistent requests
+         */
+        void setPersistentGhostUpdate(bool enable)
+            {
+            m_persistent_ghost_update = enable;
+            freePersistentGhostRequests();
+            }
+
+        //! Returns true if direct ghost updates use persistent requests
+        bool getPersistentGhostUpdate() const
+            {
+            return m_persistent_ghost_update;
+            }
+
+        //! Enable or disable shared memory ghost updates between ranks on the same node
+        /*! Ranks on the same node pack the ghost data into an MPI-3 shared memory window, from which the
+         *  neighbors read it in place. Messages are only exchanged with neighbors on other nodes. Only has an
+         *  effect in direct mode.
+         *
+         * \param enable True to enable shared memory ghost updates
+         */
+        void setSharedGhostUpdate(bool enable)
+            {
+            m_shared_ghost_update = enable;
+            m_direct_plan_valid = false;
+            freePersistentGhostRequests();
+
+            // the neighbors on the node are determined during the next ghost exchange
+            forceMigrate();
+            }
+
+        //! Returns true if ranks on the same node exchange ghost updates through shared memory
+        bool getSharedGhostUpdate() const
+            {
+            return m_shared_ghost_update;
+            }
+
+        //! Set the precision of ghost positions in direct ghost updates
+        /*! With 16 or 32 bits, every position component is sent as a fixed point displacement since the last ghost
+         *  exchange, in units of the ghost layer width divided by the largest integer. The error is at most half of
+         *  that unit. Only has an effect in direct mode. Full positions are sent while the ghost layer has zero width.
+         *
+         * \param bits Bits per position component (16 or 32), or 0 to send full positions
+         */
+        void setGhostPositionBits(unsigned int bits)
+            {
+            if (bits != 0 && bits != 16 && bits != 32)
+                {
+                m_exec_conf->msg->error() << "comm: Compressed ghost positions need 16 or 32 bits, got " << bits << std::endl;
+                throw std::runtime_error("Error setting ghost position precision");
+                }
+
+            m_ghost_position_bits = bits;
+
+            // the message sizes change
+            freePersistentGhostRequests();
+            }
+
+        //! Get the precision of ghost positions in direct ghost updates
+        unsigned int getGhostPositionBits() const
+            {
+            return m_ghost_position_bits;
+            }
+
+        //! Set the number of steps between ghost updates
+        /*! This is an approximate mode. Between ghost updates, every rank advances the positions of its ghost
+         *  particles with the ghost velocities received at the last update, instead of communicating. The forces on
+         *  the ghosts are not taken into account, so the forces near the domain boundaries, and the trajectories,
+         *  depend on the decomposition.
+         *
+         *  The maximum speed of all particles is reduced over all ranks at every step. Ghosts are extrapolated only
+         *  as long as the distance the particles may have moved since the last update, plus the distance the ghosts
+         *  have been extrapolated, is at most \a max_drift. This bounds the deviation of every ghost from the
+         *  position of its particle. The ghost layer is widened by \a max_drift, and neighbor lists are rebuilt
+         *  earlier by the same distance, so that no interaction is missed. Ghosts are always updated when their
+         *  orientations are needed, or when compute callbacks are registered.
+         *
+         * \param period Maximum number of steps between ghost updates (1: update every step)
+         * \param max_drift Maximum deviation of the ghost positions between updates
+         */
+        void setGhostUpdatePeriod(unsigned int period, Scalar max_drift);
+
+        //! Get the maximum number of steps between ghost updates
+        unsigned int getGhostUpdatePeriod() const
+            {
+            return m_ghost_update_period;
+            }
+
+        //! Get the maximum deviation of the ghost positions between updates
+        Scalar getGhostMaxDrift() const
+            {
+            return m_ghost_max_drift;
+            }
+
+        //! Set the time step size used to extrapolate ghost positions
+        void setDeltaT(Scalar deltaT)
+            {
+            m_deltaT = deltaT;
+            }
+
+        //! Add to the wall time spent computing forces on this rank
+        /*! \param t Time in nanoseconds
+         */
+        void addComputeTime(int64_t t)
+            {
+            m_compute_time += t;
+            }
+
+        //! Get the accumulated wall time spent computing forces on this rank, in nanoseconds
+        /*! The time is measured by the Integrator, and used by the LoadBalancer to weight particles by their cost.
+         *  It excludes the time the force computes spend communicating (see getWaitTime()).
+         */
+        int64_t getComputeTime() const
+            {
+            return m_compute_time;
+            }
+
+        //! Add to the wall time spent communicating from within force computations
+        /*! \param t Time in nanoseconds
+         */
+        void addWaitTime(int64_t t)
+            {
+            m_wait_time += t;
+            }
+
+        //! Get the accumulated wall time spent communicating from within force computations, in nanoseconds
+        /*! This includes ghost scalar updates and the global reductions of the neighbor list checks, which mostly
+         *  wait for other ranks.
+         */
+        int64_t getWaitTime() const
+            {
+            return m_wait_time;
+            }
+
         //! Get the current ghost layer width array
         const GlobalArray<Scalar>& getGhostLayerWidth() const
             {
@@ -310,17 +487,24 @@ class PYBIND11_EXPORT Communicator
          *
          * \param timestep The time step
          */
-        virtual void finishUpdateGhosts(unsigned int timestep)
-            {
-            // the base class implementation is currently empty
-            m_comm_pending = false;
-            }
+        virtual void finishUpdateGhosts(unsigned int timestep);
 
         /*! Communicate the net particle force
          * \parm timestep The time step
          */
         virtual void updateNetForce(unsigned int timestep);
 
+        /*! Copy a per-particle scalar from local particles to their ghost copies
+         *
+         * Uses the ghost exchange lists of the last call to exchangeGhosts(), so the entries of \a values
+         * with index >= N are overwritten in the same order as the ghost particle data.
+         *
+         * \param values Per-particle array with at least N+Nghosts elements
+         *
+         * \note This is a host-only method; it is not implemented for the GPU communication path
+         */
+        void updateGhostScalars(GPUArray<Scalar>& values);
+
         /*! This methods finds all the particles that are no longer inside the domain
          * boundaries and transfers them to neighboring processors.
          *
@@ -431,6 +615,8 @@ class PYBIND11_EXPORT Communicator
 
                 std::vector<typename group_data::packed_t> m_groups_sendbuf;     //!< Send buffer for group elements
                 std::vector<typename group_data::packed_t> m_groups_recvbuf;     //!< Receive buffer for group elements
+
+                std::vector<unsigned int> m_member_plans;       //!< Plan flags of every group member, for ghost marking
             };
 
         //! Returns true if we are communicating particles along a given direction
@@ -491,6 +677,7 @@ class PYBIND11_EXPORT Communicator
         GlobalVector<Scalar> m_netvirial_recvbuf;   //!< Buffer for net virial (receive)
 
         GlobalVector<unsigned int> m_copy_ghosts[6]; //!< Per-direction list of indices of particles to send as ghosts
+        std::vector<unsigned int> m_ghost_send_idx;  //!< Indices of the particles sent as ghosts in the current direction
         unsigned int m_num_copy_ghosts[6];       //!< Number of local particles that are sent to neighboring processors
         unsigned int m_num_recv_ghosts[6];       //!< Number of ghosts received per direction
 
@@ -513,6 +700,48 @@ class PYBIND11_EXPORT Communicator
         GlobalVector<Scalar4> m_netforce_reverse_copybuf;            //!< Buffer for reverse net force from ghosts
         GlobalVector<Scalar4> m_netforce_reverse_recvbuf;            //!< Buffer for the reverse net force. Receive buffer for m_netforce_reverse_copybuf
 
+        // Variables for direct ghost updates
+        bool m_direct_ghost_update;                         //!< True if ghost updates are exchanged directly with all neighbors
+        bool m_direct_plan_valid;                           //!< True if the direct exchange plan matches the current ghosts
+        std::vector<unsigned int> m_ghost_origin;           //!< Rank owning every local and ghost particle
+        std::vector<unsigned int> m_origin_copybuf;         //!< Buffer for owner ranks of ghosts to be copied
+        std::vector<unsigned int> m_direct_send_tags;       //!< Tags of local particles to send, grouped by unique neighbor
+        std::vector<unsigned int> m_direct_send_begin;      //!< Offset of every unique neighbor in m_direct_send_tags
+        std::vector<unsigned int> m_direct_recv_idx;        //!< Ghost indices to receive, grouped by unique neighbor
+        std::vector<unsigned int> m_direct_recv_begin;      //!< Offset of every unique neighbor in m_direct_recv_idx
+        std::vector<char> m_direct_sendbuf;                 //!< Send buffer for direct ghost updates
+        std::vector<char> m_direct_recvbuf;                 //!< Receive buffer for direct ghost updates
+        CommFlags m_direct_flags;                           //!< Fields exchanged by the direct ghost update in flight
+        bool m_persistent_ghost_update;                     //!< True if direct ghost updates use persistent requests
+        bool m_persistent_reqs_valid;                       //!< True if the persistent requests match the plan and buffers
+        CommFlags m_persistent_flags;                       //!< Fields the persistent requests were set up for
+        std::vector<MPI_Request> m_persistent_reqs;         //!< Persistent requests for direct ghost updates
+        bool m_shared_ghost_update;                         //!< True if ranks on the same node share ghost data in memory
+        MPI_Comm m_node_comm;                               //!< Communicator of the ranks on this node
+        MPI_Win m_shared_win;                               //!< Shared memory window holding the packed ghost data
+        char *m_shared_sendbuf;                             //!< Local part of the shared window
+        unsigned int m_shared_capacity;                     //!< Number of bytes per half of a window
+        unsigned int m_shared_parity;                       //!< Half of the window used by the next ghost update
+        std::vector<int> m_neigh_node_rank;                 //!< Rank of every unique neighbor on the node, -1 if off-node
+        std::vector<const char *> m_neigh_shared_base;      //!< Shared window of every unique neighbor on the node
+        std::vector<unsigned int> m_neigh_shared_offset;    //!< Offset of our ghosts in the neighbor's window, in particles
+        unsigned int m_ghost_position_bits;                 //!< Bits per compressed position component, 0 if uncompressed
+        Scalar m_ghost_position_range;                      //!< Largest displacement representable by compressed positions
+        std::vector<Scalar3> m_direct_send_ref;             //!< Positions of the sent particles at the last exchange
+        std::vector<Scalar3> m_direct_recv_ref;             //!< Positions of the received ghosts at the last exchange
+
+        // Variables for extrapolated ghost updates
+        unsigned int m_ghost_update_period;                 //!< Maximum number of steps between ghost updates
+        Scalar m_ghost_max_drift;                           //!< Maximum deviation of the ghost positions between updates
+        unsigned int m_ghost_steps;                         //!< Number of steps extrapolated since the last update
+        Scalar m_ghost_drift;                               //!< Bound on the deviation of the ghost positions
+        Scalar m_ghost_v_max;                               //!< Maximum speed of all particles at the last ghost update
+        Scalar m_deltaT;                                    //!< Time step size for ghost extrapolation
+
+        int64_t m_compute_time;                             //!< Accumulated wall time of force computations (ns)
+        int64_t m_wait_time;                                //!< Accumulated wall time of communication in force computations (ns)
+        ClockSource m_clk;                                  //!< Clock to measure the communication time
+
         BoxDim m_global_box;                     //!< Global simulation box
         GlobalArray<Scalar> m_r_ghost;              //!< Width of ghost layer
         GlobalArray<Scalar> m_r_ghost_body;         //!< Extra ghost width for rigid bodies
@@ -525,6 +754,50 @@ class PYBIND11_EXPORT Communicator
         //! Update the ghost width array
         void updateGhostWidth();
 
+        //! Build the per-neighbor send and receive lists for direct ghost updates
+        void setupDirectGhostUpdate();
+
+        //! Post the messages of a direct ghost update to all neighbors
+        void beginUpdateGhostsDirect();
+
+        //! Wait for a direct ghost update to complete and unpack the received ghost data
+        void finishUpdateGhostsDirect();
+
+        //! Get the number of bytes per particle in a direct ghost update
+        unsigned int getDirectRecordSize(const CommFlags& flags) const;
+
+        //! Get the bits per compressed position component in the current direct update plan
+        /*! Positions cannot be compressed relative to a ghost layer of zero width, they are sent in full instead.
+         */
+        unsigned int getDirectPositionBits() const
+            {
+            return (m_ghost_position_range > Scalar(0.0)) ? m_ghost_position_bits : 0;
+            }
+
+        //! Set up persistent requests on the direct ghost update buffers
+        void setupPersistentGhostRequests(unsigned int record_size);
+
+        //! Free the persistent requests
+        void freePersistentGhostRequests();
+
+        //! Identify the neighbors on the same node and set up the shared memory window
+        void setupSharedGhostUpdate();
+
+        //! Free the shared memory window
+        void freeSharedGhostWindow();
+
+        //! Get the maximum speed of all particles on all ranks
+        Scalar getGlobalMaxSpeed();
+
+        //! Check if the ghosts may be extrapolated for another step
+        bool checkGhostExtrapolation(Scalar v_max);
+
+        //! Start extrapolating from the ghost positions of an update or exchange
+        void resetGhostExtrapolation(Scalar v_max);
+
+        //! Advance the ghost positions by one step with their velocities
+        void extrapolateGhosts();
+
         Nano::Signal<bool(unsigned int timestep)>
             m_migrate_requests; //!< List of functions that may request particle migration
 
@@ -540,6 +813,9 @@ class PYBIND11_EXPORT Communicator
         Nano::Signal<void (unsigned int timestep)>
             m_compute_callbacks;   //!< List of functions that are called after ghost communication
 
+        Nano::Signal<void (unsigned int timestep)>
+            m_interior_compute_callbacks;   //!< List of functions that are called during ghost communication
+
         Nano::Signal<void (const GlobalArray<unsigned int>& )>
             m_comm_callbacks;   //!< List of functions that are called after the compute callbacks
 
@@ -595,16 +871,22 @@ class PYBIND11_EXPORT Communicator
         //! Remove tags of ghost particles
         virtual void removeGhostParticleTags();
 
-        // check if box is sufficiently large for communication
-        void checkBoxSize()
+        //! Check if the ghost layer fits into the local box
+        bool ghostLayerFits() const
             {
             Scalar3 L= m_pdata->getBox().getNearestPlaneDistance();
             const Index3D& di = m_decomposition->getDomainIndexer();
 
             Scalar r_ghost_max = getGhostLayerMaxWidth();
-            if ((r_ghost_max >= L.x/Scalar(2.0) && di.getW() > 1) ||
-                (r_ghost_max >= L.y/Scalar(2.0) && di.getH() > 1) ||
-                (r_ghost_max >= L.z/Scalar(2.0) && di.getD() > 1))
+            return ! ((r_ghost_max >= L.x/Scalar(2.0) && di.getW() > 1) ||
+                      (r_ghost_max >= L.y/Scalar(2.0) && di.getH() > 1) ||
+                      (r_ghost_max >= L.z/Scalar(2.0) && di.getD() > 1));
+            }
+
+        // check if box is sufficiently large for communication
+        void checkBoxSize()
+            {
+            if (! ghostLayerFits())
                 {
                 m_exec_conf->msg->error() << "Simulation box too small for domain decomposition." << std::endl;
                 throw std::runtime_error("Error during communication");
@@ -32,6 +32,13 @@ CommunicatorGPU::CommunicatorGPU(std::shared_ptr<SystemDefinition> sysdef,
       m_constraint_comm(*this, m_sysdef->getConstraintData()),
       m_pair_comm(*this, m_sysdef->getPairData())
     {
+    // the particles are routed directly to the grid neighbors of their target direction
+    if (decomposition->isStaggered())
+        {
+        m_exec_conf->msg->error() << "comm: staggered domain decompositions are not supported on the GPU" << std::endl;
+        throw std::runtime_error("Error initializing CommunicatorGPU");
+        }
+
     if (m_exec_conf->allConcurrentManagedAccess())
         {
         // inform the user to use a cuda-aware MPI
@@ -18,7 +18,13 @@
 #include "Communicator.h"
 #endif
 
+#ifdef ENABLE_TBB
+#include <tbb/tbb.h>
+#endif
+
 #include <stdexcept>
+#include <algorithm>
+#include <atomic>
 
 namespace py = pybind11;
 
@@ -70,7 +76,8 @@ DCDDumpWriter::DCDDumpWriter(std::shared_ptr<SystemDefinition> sysdef,
     : Analyzer(sysdef), m_fname(fname), m_start_timestep(0), m_period(period), m_group(group),
       m_num_frames_written(0), m_last_written_step(0), m_appending(false),
       m_unwrap_full(false), m_unwrap_rigid(false), m_angle(false),
-      m_overwrite(overwrite), m_is_initialized(false)
+      m_overwrite(overwrite), m_is_initialized(false), m_parallel(false),
+      m_writer(m_exec_conf, 1), m_cur_frame(0)
     {
     m_exec_conf->msg->notice(5) << "Constructing DCDDumpWriter: " << fname << " " << period << " " << overwrite << endl;
     }
@@ -130,6 +137,9 @@ DCDDumpWriter::~DCDDumpWriter()
     {
     m_exec_conf->msg->notice(5) << "Destroying DCDDumpWriter" << endl;
 
+    // write out the queued frames before the file is closed
+    m_writer.stop();
+
     if (m_is_initialized)
         {
         m_file.close();
@@ -144,6 +154,16 @@ DCDDumpWriter::~DCDDumpWriter()
 */
 void DCDDumpWriter::analyze(unsigned int timestep)
     {
+    // rigid body unwrapping needs the image of the central particle, which may be on another rank
+    if (m_parallel && (m_unwrap_full || !m_unwrap_rigid))
+        {
+        analyzeParallel(timestep);
+        return;
+        }
+
+    // the frames written in the background come first
+    flush();
+
     if (m_prof)
         m_prof->push("Dump DCD");
 
@@ -272,6 +292,24 @@ void DCDDumpWriter::write_file_header(std::fstream &file)
 void DCDDumpWriter::write_frame_header(std::fstream &file)
     {
     double unitcell[6];
+    getUnitCell(unitcell);
+
+    write_int(file, 48);
+    file.write((char *)unitcell, 48);
+    write_int(file, 48);
+
+    // check for errors
+    if (!file.good())
+        {
+        m_exec_conf->msg->error() << "dump.dcd: I/O error while writing DCD frame header" << endl;
+        throw runtime_error("Error writing DCD file");
+        }
+    }
+
+/*! \param unitcell Array of 6 values to store the unit cell in
+*/
+void DCDDumpWriter::getUnitCell(double *unitcell)
+    {
     BoxDim box = m_pdata->getGlobalBox();
     // set box dimensions
     Scalar a,b,c,alpha,beta,gamma;
@@ -292,17 +330,6 @@ void DCDDumpWriter::write_frame_header(std::fstream &file)
     unitcell[1] = gamma;
     unitcell[3] = beta;
     unitcell[4] = alpha;
-
-    write_int(file, 48);
-    file.write((char *)unitcell, 48);
-    write_int(file, 48);
-
-    // check for errors
-    if (!file.good())
-        {
-        m_exec_conf->msg->error() << "dump.dcd: I/O error while writing DCD frame header" << endl;
-        throw runtime_error("Error writing DCD file");
-        }
     }
 
 /*! \param file File to write to
@@ -409,6 +436,325 @@ void DCDDumpWriter::write_updated_header(std::fstream &file, unsigned int timest
     write_int(file, timestep);
     }
 
+/*! \param enable True to pack the frames on all ranks and write them in the background
+
+    Disabling parallel mode writes out the queued frames first.
+*/
+void DCDDumpWriter::setParallel(bool enable)
+    {
+    if (!enable)
+        {
+        m_writer.stop();
+        m_writer.checkError();
+        }
+
+    m_parallel = enable;
+    }
+
+/*! Waits until the writer thread has written all queued frames and raises any error that occurred while writing.
+*/
+void DCDDumpWriter::flush()
+    {
+    m_writer.flush();
+
+    if (m_file.is_open())
+        m_file.flush();
+    }
+
+/*! \param timestep Current time step of the simulation
+
+    Every rank packs the coordinates of its local group members, the root rank places them in a frame buffer in group
+    order and queues the frame for the writer thread. This is a collective call.
+*/
+void DCDDumpWriter::analyzeParallel(unsigned int timestep)
+    {
+    if (m_prof)
+        m_prof->push("Dump DCD");
+
+    // the member tags are known on all ranks, so all ranks agree on errors raised here
+    updateGroupIndex();
+
+    bool root = m_exec_conf->isRoot();
+    int write = 1;
+    if (root)
+        {
+        m_writer.checkError();
+
+        if (! m_is_initialized)
+            initFileIO(timestep);
+
+        if (m_appending && timestep <= m_last_written_step)
+            {
+            m_exec_conf->msg->warning() << "dump.dcd: not writing output at timestep " << timestep << " because the file reports that it already has data up to step " << m_last_written_step << endl;
+            write = 0;
+            }
+        else if ( (timestep - m_start_timestep) % m_period != 0)
+            {
+            // verify the period on subsequent frames
+            m_exec_conf->msg->warning() << "dump.dcd: writing time step " << timestep << " which is not specified in the period of the DCD file: " << m_start_timestep << " + i * " << m_period << endl;
+            }
+        }
+
+#ifdef ENABLE_MPI
+    if (m_comm)
+        bcast(write, 0, m_exec_conf->getMPICommunicator());
+#endif
+
+    if (!write)
+        {
+        if (m_prof)
+            m_prof->pop();
+        return;
+        }
+
+    unsigned int nparticles = m_group->getNumMembersGlobal();
+    size_t block_size = 2*sizeof(unsigned int) + nparticles*sizeof(float);
+
+    std::shared_ptr<Frame> frame;
+    float *x = NULL;
+    float *y = NULL;
+    float *z = NULL;
+    if (root)
+        {
+        frame = getFreeFrame(2*sizeof(unsigned int) + 6*sizeof(double) + 3*block_size);
+        char *coords = &frame->data[0] + 2*sizeof(unsigned int) + 6*sizeof(double);
+        x = (float *)(coords + sizeof(unsigned int));
+        y = (float *)(coords + block_size + sizeof(unsigned int));
+        z = (float *)(coords + 2*block_size + sizeof(unsigned int));
+        }
+
+#ifdef ENABLE_MPI
+    if (m_comm)
+        {
+        // pack the local members and gather them on the root rank
+        m_send_buf.resize(m_group->getNumMembers());
+        int valid = packLocalPositions(NULL, NULL, NULL, m_send_buf.empty() ? NULL : &m_send_buf[0]);
+
+        MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+        MPI_Allreduce(MPI_IN_PLACE, &valid, 1, MPI_INT, MPI_LAND, mpi_comm);
+        if (!valid)
+            {
+            m_exec_conf->msg->error() << "dump.dcd: Group member not found in the DCD member index" << endl;
+            throw runtime_error("Error writing DCD file");
+            }
+
+        unsigned int nranks = m_exec_conf->getNRanks();
+        int n_send = (int)m_send_buf.size();
+        std::vector<int> counts(nranks), displs(nranks);
+        MPI_Gather(&n_send, 1, MPI_INT, &counts[0], 1, MPI_INT, 0, mpi_comm);
+
+        if (root)
+            {
+            int offset = 0;
+            for (unsigned int i = 0; i < nranks; i++)
+                {
+                displs[i] = offset;
+                offset += counts[i];
+                }
+            m_recv_buf.resize(offset);
+            }
+
+        MPI_Datatype mpi_packed;
+        MPI_Type_contiguous(sizeof(PackedPosition), MPI_BYTE, &mpi_packed);
+        MPI_Type_commit(&mpi_packed);
+        MPI_Gatherv(m_send_buf.empty() ? NULL : &m_send_buf[0], n_send, mpi_packed,
+                    m_recv_buf.empty() ? NULL : &m_recv_buf[0], &counts[0], &displs[0], mpi_packed, 0, mpi_comm);
+        MPI_Type_free(&mpi_packed);
+
+        if (root)
+            {
+            const PackedPosition *recv = m_recv_buf.empty() ? NULL : &m_recv_buf[0];
+
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(0, (unsigned int)m_recv_buf.size()),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int i = r.begin(); i != r.end(); ++i)
+            #else
+            for (unsigned int i = 0; i < m_recv_buf.size(); i++)
+            #endif
+                    {
+                    const PackedPosition& p = recv[i];
+                    x[p.group_idx] = p.x;
+                    y[p.group_idx] = p.y;
+                    z[p.group_idx] = p.z;
+                    }
+            #ifdef ENABLE_TBB
+                });
+            #endif
+            }
+        }
+    else
+#endif
+        {
+        // all members are local, pack them directly into the frame
+        if (!packLocalPositions(x, y, z, NULL))
+            {
+            m_exec_conf->msg->error() << "dump.dcd: Group member not found in the DCD member index" << endl;
+            throw runtime_error("Error writing DCD file");
+            }
+        }
+
+    if (root)
+        {
+        // record markers and unit cell
+        char *data = &frame->data[0];
+        unsigned int cell_size = 6*sizeof(double);
+        unsigned int coords_size = nparticles*sizeof(float);
+        memcpy(data, &cell_size, sizeof(unsigned int));
+        getUnitCell((double *)(data + sizeof(unsigned int)));
+        memcpy(data + sizeof(unsigned int) + cell_size, &cell_size, sizeof(unsigned int));
+
+        char *coords = data + 2*sizeof(unsigned int) + cell_size;
+        for (unsigned int c = 0; c < 3; c++)
+            {
+            memcpy(coords + c*block_size, &coords_size, sizeof(unsigned int));
+            memcpy(coords + c*block_size + sizeof(unsigned int) + coords_size, &coords_size, sizeof(unsigned int));
+            }
+
+        m_num_frames_written++;
+        frame->num_frames = m_num_frames_written;
+        frame->timestep = timestep;
+
+        m_writer.queue([this, frame]{ writeFrame(*frame); });
+        }
+
+    if (m_prof)
+        m_prof->pop();
+    }
+
+/*! \param x Destination of the x coordinates in group order, or NULL
+    \param y Destination of the y coordinates in group order, or NULL
+    \param z Destination of the z coordinates (or orientation angles) in group order, or NULL
+    \param packed Destination of the packed coordinates in local member order, or NULL
+
+    Either \a x, \a y and \a z or \a packed must be given.
+
+    \returns False if a local member is missing from the index of the group members
+*/
+bool DCDDumpWriter::packLocalPositions(float *x, float *y, float *z, PackedPosition *packed)
+    {
+    const BoxDim& box = m_pdata->getGlobalBox();
+    unsigned int n_members = m_group->getNumMembers();
+    unsigned int n_members_global = (unsigned int)m_member_tags.size();
+    std::atomic<bool> valid(true);
+
+    ArrayHandle<unsigned int> h_member_idx(m_group->getIndexArray(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<int3> h_image(m_pdata->getImages(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_orientation(m_pdata->getOrientationArray(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag(m_pdata->getTags(), access_location::host, access_mode::read);
+
+    #ifdef ENABLE_TBB
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, n_members),
+        [&](const tbb::blocked_range<unsigned int>& r)
+        {
+        for (unsigned int j = r.begin(); j != r.end(); ++j)
+    #else
+    for (unsigned int j = 0; j < n_members; j++)
+    #endif
+            {
+            unsigned int idx = h_member_idx.data[j];
+            unsigned int tag = h_tag.data[idx];
+            unsigned int group_idx = tag < m_group_idx.size() ? m_group_idx[tag] : NOT_LOCAL;
+            if (group_idx >= n_members_global)
+                {
+                valid = false;
+                continue;
+                }
+
+            vec3<Scalar> pos(h_pos.data[idx]);
+            if (m_unwrap_full)
+                pos = box.shift(pos, h_image.data[idx]);
+
+            float pz = float(pos.z);
+
+            // m_angle set to True turns on a hack where the particle orientation angle is written out to the z component
+            // this only works in 2D simulations, obviously
+            if (m_angle)
+                pz = float(atan2(h_orientation.data[idx].w, h_orientation.data[idx].x) * 2);
+
+            if (packed)
+                {
+                packed[j].group_idx = group_idx;
+                packed[j].x = float(pos.x);
+                packed[j].y = float(pos.y);
+                packed[j].z = pz;
+                }
+            else
+                {
+                x[group_idx] = float(pos.x);
+                y[group_idx] = float(pos.y);
+                z[group_idx] = pz;
+                }
+            }
+    #ifdef ENABLE_TBB
+        });
+    #endif
+
+    return valid;
+    }
+
+/*! The index maps particle tags to their position in the group, which is the order of the particles in the frames.
+    It is rebuilt when the group members change, e.g. after a dynamic group is updated. The DCD file format stores a
+    fixed number of particles, so a change in the number of group members is an error.
+*/
+void DCDDumpWriter::updateGroupIndex()
+    {
+    unsigned int n_members = m_group->getNumMembersGlobal();
+    if (m_group_idx.size() > 0 && n_members != m_member_tags.size())
+        {
+        m_exec_conf->msg->error() << "analyze.dcd: Change in number of group members unsupported by DCD file format."
+            << std::endl;
+        throw std::runtime_error("Error writing DCD file");
+        }
+
+    ArrayHandle<unsigned int> h_member_tags(m_group->getMemberTagArray(), access_location::host, access_mode::read);
+    if (m_group_idx.size() > 0 && std::equal(m_member_tags.begin(), m_member_tags.end(), h_member_tags.data))
+        return;
+
+    m_member_tags.assign(h_member_tags.data, h_member_tags.data + n_members);
+    m_group_idx.assign(m_pdata->getMaximumTag()+1, NOT_LOCAL);
+    for (unsigned int group_idx = 0; group_idx < n_members; group_idx++)
+        m_group_idx[m_member_tags[group_idx]] = group_idx;
+    }
+
+/*! \param frame_size Size of the frame in bytes
+    \returns A frame buffer that is not queued for writing
+
+    The two frame buffers are filled in turn. The writer queues at most one frame, so the buffer filled next has been
+    written when the frame in the other buffer was queued.
+*/
+std::shared_ptr<DCDDumpWriter::Frame> DCDDumpWriter::getFreeFrame(size_t frame_size)
+    {
+    std::shared_ptr<Frame>& frame = m_frames[m_cur_frame];
+    m_cur_frame = 1 - m_cur_frame;
+
+    if (!frame)
+        frame = std::shared_ptr<Frame>(new Frame());
+    frame->data.resize(frame_size);
+    return frame;
+    }
+
+/*! \param frame Frame to append to the file
+
+    Called on the writer thread, errors are reported by the exception.
+*/
+void DCDDumpWriter::writeFrame(const Frame& frame)
+    {
+    m_file.seekp(0, std::ios_base::end);
+    m_file.write(&frame.data[0], frame.data.size());
+
+    // update the header with the number of frames written
+    m_file.seekp(NFILE_POS);
+    write_int(m_file, frame.num_frames);
+    m_file.seekp(NSTEP_POS);
+    write_int(m_file, frame.timestep);
+
+    if (!m_file.good())
+        throw runtime_error("dump.dcd: I/O error while writing DCD frame to " + m_fname);
+    }
+
 void export_DCDDumpWriter(py::module& m)
     {
     py::class_<DCDDumpWriter, std::shared_ptr<DCDDumpWriter> >(m,"DCDDumpWriter",py::base<Analyzer>())
@@ -416,5 +762,7 @@ void export_DCDDumpWriter(py::module& m)
     .def("setUnwrapFull", &DCDDumpWriter::setUnwrapFull)
     .def("setUnwrapRigid", &DCDDumpWriter::setUnwrapRigid)
     .def("setAngleZ", &DCDDumpWriter::setAngleZ)
+    .def("setParallel", &DCDDumpWriter::setParallel)
+    .def("flush", &DCDDumpWriter::flush)
     ;
     }
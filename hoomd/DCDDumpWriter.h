@@ -13,6 +13,8 @@
 #include <string>
 #include <memory>
 #include <fstream>
+#include <vector>
+#include "BackgroundWriter.h"
 
 /*! \file DCDDumpWriter.h
     \brief Declares the DCDDumpWriter class
@@ -46,6 +48,13 @@
     Due to a limitation in the DCD format, the time step period between calls to
     analyze() \b must be specified up front. If analyze() detects that this period is
     not being maintained, it will print a warning but continue.
+
+    In parallel mode (setParallel()), analyze() does not take a snapshot. Every rank converts the positions of its
+    local group members to float, unwrapped with the local image flags, and the root rank gathers only these
+    coordinates with their index in the group. The root rank places them in a preallocated frame buffer that holds the
+    complete frame record, and a writer thread writes it to the file while the simulation continues. Two frame buffers
+    are reused for all frames. Rigid body unwrapping needs the image of the central particle and still uses a snapshot.
+    The index of the group members is rebuilt when the group changes, the number of members must stay the same.
     \ingroup analyzers
 */
 class PYBIND11_EXPORT DCDDumpWriter : public Analyzer
@@ -82,6 +91,12 @@ class PYBIND11_EXPORT DCDDumpWriter : public Analyzer
             m_angle = enable;
             }
 
+        //! Set whether frames are packed on all ranks and written in the background
+        void setParallel(bool enable);
+
+        //! Wait until all frames are written
+        void flush();
+
     private:
         std::string m_fname;                //!< The file name we are writing to
         unsigned int m_start_timestep;      //!< First time step written to the file
@@ -101,6 +116,33 @@ class PYBIND11_EXPORT DCDDumpWriter : public Analyzer
         float *m_staging_buffer;            //!< Buffer for staging particle positions in tag order
         std::fstream m_file;                //!< The file object
 
+        //! A frame record, ready to be written to the file
+        struct Frame
+            {
+            std::vector<char> data;         //!< Unit cell and coordinate blocks, including the record markers
+            unsigned int num_frames;        //!< Number of frames in the file after this frame
+            unsigned int timestep;          //!< Time step of the frame
+            };
+
+        //! Coordinates of a group member, packed for the root rank
+        struct PackedPosition
+            {
+            unsigned int group_idx;         //!< Index of the particle in the group
+            float x;                        //!< x coordinate
+            float y;                        //!< y coordinate
+            float z;                        //!< z coordinate (or orientation angle)
+            };
+
+        bool m_parallel;                    //!< True if frames are packed on all ranks and written in the background
+        std::vector<unsigned int> m_member_tags; //!< Group members the index was built for
+        std::vector<unsigned int> m_group_idx; //!< Index in the group by particle tag (NOT_LOCAL if not a member)
+        std::vector<PackedPosition> m_send_buf;  //!< Packed coordinates of the local group members
+        std::vector<PackedPosition> m_recv_buf;  //!< Packed coordinates of all group members (root rank)
+
+        BackgroundWriter m_writer;          //!< Writes the frames on the root rank, one at a time
+        std::shared_ptr<Frame> m_frames[2]; //!< Frame buffers, filled in turn
+        unsigned int m_cur_frame;           //!< Frame buffer filled next
+
         // helper functions
 
         //! Initializes the file header
@@ -113,6 +155,19 @@ class PYBIND11_EXPORT DCDDumpWriter : public Analyzer
         void write_updated_header(std::fstream &file, unsigned int timestep);
         //! Initializes the output file for writing
         void initFileIO(unsigned int timestep);
+        //! Computes the unit cell of the current box
+        void getUnitCell(double *unitcell);
+
+        //! Writes the data for the current timestep in parallel mode
+        void analyzeParallel(unsigned int timestep);
+        //! Rebuild the index of the group members if the membership changed
+        void updateGroupIndex();
+        //! Converts the coordinates of the local group members
+        bool packLocalPositions(float *x, float *y, float *z, PackedPosition *packed);
+        //! Get a frame buffer to fill
+        std::shared_ptr<Frame> getFreeFrame(size_t frame_size);
+        //! Write a frame to the file on the writer thread
+        void writeFrame(const Frame& frame);
 
     };
 
@@ -33,14 +33,15 @@ DomainDecomposition::DomainDecomposition(std::shared_ptr<ExecutionConfiguration>
                                unsigned int nx,
                                unsigned int ny,
                                unsigned int nz,
-                               bool twolevel
+                               bool twolevel,
+                               bool twolevel_fixed
                                )
-      : m_exec_conf(exec_conf), m_mpi_comm(m_exec_conf->getMPICommunicator())
+      : m_exec_conf(exec_conf), m_mpi_comm(m_exec_conf->getMPICommunicator()), m_staggered(false)
     {
     m_exec_conf->msg->notice(5) << "Constructing DomainDecomposition" << endl;
 
     // setup the decomposition grid
-    initializeDomainGrid(L, nx, ny, nz, twolevel);
+    initializeDomainGrid(L, nx, ny, nz, twolevel, twolevel_fixed);
 
     // default initialization is to uniform slices
     std::vector<Scalar> cur_fxs(m_nx-1, Scalar(1.0)/Scalar(m_nx));
@@ -55,6 +56,8 @@ DomainDecomposition::DomainDecomposition(std::shared_ptr<ExecutionConfiguration>
  * \param fxs Array of fractions to decompose box in x for first nx-1 processors
  * \param fys Array of fractions to decompose box in y for first ny-1 processors
  * \param fzs Array of fractions to decompose box in z for first nz-1 processors
+ * \param twolevel If true, attempt two level decomposition (default == false)
+ * \param twolevel_fixed If true, also attempt it for the given fractions (default == false)
  *
  * If a fraction is not specified, a default value is chosen with uniform spacing. Note that the chosen value for the
  * number of processors is not guaranteed to be optimal.
@@ -63,15 +66,17 @@ DomainDecomposition::DomainDecomposition(std::shared_ptr<ExecutionConfiguration>
                                          Scalar3 L,
                                          const std::vector<Scalar>& fxs,
                                          const std::vector<Scalar>& fys,
-                                         const std::vector<Scalar>& fzs)
-    : m_exec_conf(exec_conf), m_mpi_comm(m_exec_conf->getMPICommunicator())
+                                         const std::vector<Scalar>& fzs,
+                                         bool twolevel,
+                                         bool twolevel_fixed)
+    : m_exec_conf(exec_conf), m_mpi_comm(m_exec_conf->getMPICommunicator()), m_staggered(false)
     {
     m_exec_conf->msg->notice(5) << "Constructing DomainDecomposition" << endl;
 
     unsigned int nx = (fxs.size() > 0) ? (fxs.size() + 1) : 0;
     unsigned int ny = (fys.size() > 0) ? (fys.size() + 1) : 0;
     unsigned int nz = (fzs.size() > 0) ? (fzs.size() + 1) : 0;
-    initializeDomainGrid(L, nx, ny, nz, false);
+    initializeDomainGrid(L, nx, ny, nz, twolevel, twolevel_fixed);
 
     std::vector<Scalar> try_fxs = fxs;
     std::vector<Scalar> try_fys = fys;
@@ -111,12 +116,16 @@ DomainDecomposition::DomainDecomposition(std::shared_ptr<ExecutionConfiguration>
  * \param ny Requested number of domains along the y direction (0 == choose default)
  * \param nz Requested number of domains along the z direction (0 == choose default)
  * \param twolevel If true, attempt two level decomposition (default == false)
+ * \param twolevel_fixed If true, also attempt it when the grid dimensions are given (default == false)
+ *
+ * A grid given by the user keeps the sequential order of the ranks, unless \a twolevel_fixed is set.
  */
 void DomainDecomposition::initializeDomainGrid(Scalar3 L,
                                                unsigned int nx,
                                                unsigned int ny,
                                                unsigned int nz,
-                                               bool twolevel)
+                                               bool twolevel,
+                                               bool twolevel_fixed)
     {
     unsigned int rank = m_exec_conf->getRank();
     unsigned int nranks = m_exec_conf->getNRanks();
@@ -125,6 +134,9 @@ void DomainDecomposition::initializeDomainGrid(Scalar3 L,
     findCommonNodes();
 
     m_max_n_node = 0;
+
+    if ((nx || ny || nz) && !twolevel_fixed)
+        twolevel = false;
     m_twolevel = twolevel;
 
     if (twolevel)
@@ -136,35 +148,36 @@ void DomainDecomposition::initializeDomainGrid(Scalar3 L,
     unsigned int nx_node =0, ny_node = 0, nz_node = 0;
     unsigned int nx_intra = 0, ny_intra = 0, nz_intra = 0;
 
-    if (nx || ny || nz) m_twolevel = false;
-
     if (rank == 0)
         {
+        bool found_decomposition = findDecomposition(nranks, L, nx, ny, nz);
+        if (! found_decomposition)
+            {
+            m_exec_conf->msg->warning() << "Unable to find a decomposition with"
+                 << " requested dimensions. Choosing default decomposition." << endl;
+
+            nx = ny = nz = 0;
+            findDecomposition(nranks, L, nx,ny,nz);
+            }
+
         if (m_twolevel)
             {
             // every node has the same number of ranks, so nranks == num_nodes * num_ranks_per_node
             unsigned int n_nodes = m_nodes.size();
 
-            // subdivide the global grid
-            findDecomposition(nranks, L, nx, ny, nz);
-
-            // subdivide the local grid
-            subdivide(nranks/n_nodes, L, nx, ny, nz, nx_intra, ny_intra, nz_intra);
+            // assign a compact block of the global grid to every node, if the grid can be divided evenly
+            m_twolevel = subdivide(nranks/n_nodes, L, nx, ny, nz, nx_intra, ny_intra, nz_intra);
 
-            nx_node = nx/nx_intra;
-            ny_node = ny/ny_intra;
-            nz_node = nz/nz_intra;
-            }
-        else
-            {
-            bool found_decomposition = findDecomposition(nranks, L, nx, ny, nz);
-            if (! found_decomposition)
+            if (m_twolevel)
                 {
-                m_exec_conf->msg->warning() << "Unable to find a decomposition with"
-                     << " requested dimensions. Choosing default decomposition." << endl;
-
-                nx = ny = nz = 0;
-                findDecomposition(nranks, L, nx,ny,nz);
+                nx_node = nx/nx_intra;
+                ny_node = ny/ny_intra;
+                nz_node = nz/nz_intra;
+                }
+            else
+                {
+                m_exec_conf->msg->notice(2) << "The " << nx << " x " << ny << " x " << nz << " grid cannot be divided into "
+                    << n_nodes << " nodes, mapping ranks in sequential order" << endl;
                 }
             }
         m_nx = nx;
@@ -176,6 +189,7 @@ void DomainDecomposition::initializeDomainGrid(Scalar3 L,
     bcast(m_nx, 0, m_mpi_comm);
     bcast(m_ny, 0, m_mpi_comm);
     bcast(m_nz, 0, m_mpi_comm);
+    bcast(m_twolevel, 0, m_mpi_comm);
 
     // Initialize domain indexer
     m_index = Index3D(m_nx,m_ny,m_nz);
@@ -204,7 +218,7 @@ void DomainDecomposition::initializeDomainGrid(Scalar3 L,
         m_intra_node_grid = Index3D(nx_intra, ny_intra, nz_intra);
 
         std::vector<unsigned int> node_ranks(m_max_n_node);
-        std::set<std::string>::iterator node_it = m_nodes.begin();
+        std::set<unsigned int>::iterator node_it = m_nodes.begin();
 
         std::set<unsigned int> node_rank_set;
 
@@ -214,8 +228,8 @@ void DomainDecomposition::initializeDomainGrid(Scalar3 L,
                 for (unsigned int iz_node = 0; iz_node < m_node_grid.getD(); iz_node++)
                     {
                     // get ranks for this node
-                    typedef std::multimap<std::string, unsigned int> map_t;
-                    std::string node = *(node_it++);
+                    typedef std::multimap<unsigned int, unsigned int> map_t;
+                    unsigned int node = *(node_it++);
                     std::pair<map_t::iterator, map_t::iterator> p = m_node_map.equal_range(node);
 
                     // Insert ranks per node into an ordered set (multimap doesn't guarantee order
@@ -229,7 +243,7 @@ void DomainDecomposition::initializeDomainGrid(Scalar3 L,
                     std::set<unsigned int>::iterator set_it;
 
                     std::ostringstream oss;
-                    oss << "Node " << node << ": ranks";
+                    oss << "Node of rank " << node << ": ranks";
                     unsigned int i = 0;
                     for (set_it= node_rank_set.begin(); set_it != node_rank_set.end(); ++set_it)
                         {
@@ -371,7 +385,12 @@ bool DomainDecomposition::findDecomposition(unsigned int nranks, const Scalar3 L
     }
 
 //! Find a two-level decomposition of the global grid
-void DomainDecomposition::subdivide(unsigned int n_node_ranks, Scalar3 L,
+/*! Among the blocks of \a n_node_ranks domains that tile the global grid, the one with the smallest surface area
+    towards other nodes is chosen, since the ghost layers across that surface are exchanged over the network.
+
+    \returns true if the global grid can be divided into blocks of \a n_node_ranks domains
+ */
+bool DomainDecomposition::subdivide(unsigned int n_node_ranks, Scalar3 L,
     unsigned int nx, unsigned int ny, unsigned int nz,
     unsigned int& nx_intra, unsigned int &ny_intra, unsigned int& nz_intra)
     {
@@ -384,6 +403,9 @@ void DomainDecomposition::subdivide(unsigned int n_node_ranks, Scalar3 L,
     ny_intra = 1;
     nz_intra = n_node_ranks;
 
+    bool found_decomposition = false;
+    double min_surface_area = 0.0;
+
     for (unsigned int nx_intra_try = 1; nx_intra_try <= n_node_ranks; nx_intra_try++)
         for (unsigned int ny_intra_try = 1; nx_intra_try*ny_intra_try <= n_node_ranks; ny_intra_try++)
             for (unsigned int nz_intra_try = 1; nx_intra_try*ny_intra_try*nz_intra_try <= n_node_ranks; nz_intra_try++)
@@ -391,10 +413,29 @@ void DomainDecomposition::subdivide(unsigned int n_node_ranks, Scalar3 L,
                 if (nx_intra_try*ny_intra_try*nz_intra_try != n_node_ranks) continue;
                 if (nx % nx_intra_try || ny % ny_intra_try || nz % nz_intra_try) continue;
 
-                nx_intra = nx_intra_try;
-                ny_intra = ny_intra_try;
-                nz_intra = nz_intra_try;
+                // dimensions of the block of domains on a node
+                double lx = L.x*(double)nx_intra_try/(double)nx;
+                double ly = L.y*(double)ny_intra_try/(double)ny;
+                double lz = L.z*(double)nz_intra_try/(double)nz;
+
+                // only faces between different nodes count, a node that spans the box along a direction
+                // communicates with itself across the periodic boundary
+                double surface_area = 0.0;
+                if (nx_intra_try < nx) surface_area += ly*lz;
+                if (ny_intra_try < ny) surface_area += lx*lz;
+                if (nz_intra_try < nz) surface_area += lx*ly;
+
+                if (!found_decomposition || surface_area < min_surface_area)
+                    {
+                    nx_intra = nx_intra_try;
+                    ny_intra = ny_intra_try;
+                    nz_intra = nz_intra_try;
+                    min_surface_area = surface_area;
+                    found_decomposition = true;
+                    }
                 }
+
+    return found_decomposition;
     }
 
 
@@ -451,6 +492,8 @@ bool DomainDecomposition::isAtBoundary(unsigned int dir) const
  *
  * \note Setting the cumulative fractions is a collective call requiring all ranks to participate in order to keep the
  *       decomposition properly synchronized between ranks.
+ *
+ * In a staggered decomposition, the y or z cuts are set to \a cum_frac in all slabs or columns.
  */
 void DomainDecomposition::setCumulativeFractions(unsigned int dir,
                                                  const std::vector<Scalar>& cum_frac,
@@ -516,6 +559,18 @@ void DomainDecomposition::setCumulativeFractions(unsigned int dir,
                 throw std::runtime_error("comm: specified fractions are invalid");
                 }
             }
+
+        // the cut planes are aligned again in all slabs or columns
+        if (m_staggered && dir == 1)
+            {
+            for (unsigned int i = 0; i < m_nx; ++i)
+                std::copy(m_cum_frac_y.begin(), m_cum_frac_y.end(), m_stag_frac_y.begin() + i*(m_ny+1));
+            }
+        else if (m_staggered && dir == 2)
+            {
+            for (unsigned int col = 0; col < m_nx*m_ny; ++col)
+                std::copy(m_cum_frac_z.begin(), m_cum_frac_z.end(), m_stag_frac_z.begin() + col*(m_nz+1));
+            }
         }
     else // if no change, it's because things don't match up
         {
@@ -524,6 +579,116 @@ void DomainDecomposition::setCumulativeFractions(unsigned int dir,
         }
     }
 
+/*!
+ * \param dir Direction (0=x, 1=y, 2=z) to get fractions
+ * \param pos Position in the domain grid
+ * \returns Cumulative fractions of global box length along \a dir in the slab (y) or column (z) that contains \a pos
+ */
+std::vector<Scalar> DomainDecomposition::getCumulativeFractions(unsigned int dir, const uint3& pos) const
+    {
+    if (dir == 0) return m_cum_frac_x;
+    else if (dir == 1)
+        {
+        if (!m_staggered) return m_cum_frac_y;
+        std::vector<Scalar>::const_iterator first = m_stag_frac_y.begin() + getSlabOffset(pos);
+        return std::vector<Scalar>(first, first + m_ny + 1);
+        }
+    else if (dir == 2)
+        {
+        if (!m_staggered) return m_cum_frac_z;
+        std::vector<Scalar>::const_iterator first = m_stag_frac_z.begin() + getColumnOffset(pos);
+        return std::vector<Scalar>(first, first + m_nz + 1);
+        }
+    else
+        {
+        m_exec_conf->msg->error() << "comm: requested direction does not exist" << std::endl;
+        throw std::runtime_error("comm: requested direction does not exist");
+        }
+    }
+
+/*!
+ * \param staggered True to set the y cuts per slab and the z cuts per column
+ *
+ * When the staggered decomposition is enabled, all slabs and columns start out with the current y and z cuts. When it
+ * is disabled, the cut planes are aligned again to the y and z cuts the decomposition was constructed with, or last set
+ * with setCumulativeFractions(). This must be called identically on all ranks, and before the particles are
+ * distributed, since the local boxes may change.
+ */
+void DomainDecomposition::setStaggered(bool staggered)
+    {
+    m_staggered = staggered;
+    if (m_staggered)
+        {
+        m_stag_frac_y.resize(m_nx*(m_ny+1));
+        for (unsigned int i = 0; i < m_nx; ++i)
+            std::copy(m_cum_frac_y.begin(), m_cum_frac_y.end(), m_stag_frac_y.begin() + i*(m_ny+1));
+
+        m_stag_frac_z.resize(m_nx*m_ny*(m_nz+1));
+        for (unsigned int col = 0; col < m_nx*m_ny; ++col)
+            std::copy(m_cum_frac_z.begin(), m_cum_frac_z.end(), m_stag_frac_z.begin() + col*(m_nz+1));
+        }
+    else
+        {
+        m_stag_frac_y.clear();
+        m_stag_frac_z.clear();
+        }
+    }
+
+/*!
+ * \param dir Direction (1=y, 2=z) to set fractions
+ * \param cum_frac Concatenated cumulative fractions of all slabs (y) or columns (z), each beginning with 0 and ending
+ *        with 1, in the order of getStaggeredFractions()
+ * \param root Rank to broadcast the set fractions from
+ *
+ * \note Setting the fractions is a collective call requiring all ranks to participate in order to keep the
+ *       decomposition properly synchronized between ranks. The caller is responsible for keeping the cuts of adjacent
+ *       slabs and columns interleaved.
+ */
+void DomainDecomposition::setStaggeredFractions(unsigned int dir,
+                                                const std::vector<Scalar>& cum_frac,
+                                                unsigned int root)
+    {
+    if (!m_staggered)
+        {
+        m_exec_conf->msg->error() << "comm: domain decomposition is not staggered" << std::endl;
+        throw std::runtime_error("comm: domain decomposition is not staggered");
+        }
+    if (dir != 1 && dir != 2)
+        {
+        m_exec_conf->msg->error() << "comm: staggered fractions only exist in y and z" << std::endl;
+        throw std::runtime_error("comm: requested direction does not exist");
+        }
+
+    std::vector<Scalar>& stag_frac = (dir == 1) ? m_stag_frac_y : m_stag_frac_z;
+    const unsigned int n = (dir == 1) ? m_ny : m_nz;
+
+    bool changed = false;
+    if (m_exec_conf->getRank() == root && cum_frac.size() == stag_frac.size())
+        {
+        stag_frac = cum_frac;
+        changed = true;
+        }
+
+    // sync the update from the root to all ranks
+    bcast(changed, root, m_mpi_comm);
+    if (! changed)
+        {
+        m_exec_conf->msg->error() << "comm: domain decomposition cannot change topology after construction" << std::endl;
+        throw std::runtime_error("comm: domain decomposition cannot change topology after construction");
+        }
+
+    MPI_Bcast(&stag_frac[0], stag_frac.size(), MPI_HOOMD_SCALAR, root, m_mpi_comm);
+
+    for (unsigned int offset = 0; offset < stag_frac.size(); offset += n+1)
+        {
+        if (stag_frac[offset] != Scalar(0.0) || stag_frac[offset+n] != Scalar(1.0))
+            {
+            m_exec_conf->msg->error() << "comm: specified fractions are invalid" << std::endl;
+            throw std::runtime_error("comm: specified fractions are invalid");
+            }
+        }
+    }
+
 /*!
  * \param global_box The global simulation box
  * \returns The local simulation box for the current rank
@@ -535,10 +700,14 @@ const BoxDim DomainDecomposition::calculateLocalBox(const BoxDim & global_box)
     Scalar3 L = global_box.getL();
 
     // position of this domain in the grid
-    Scalar3 lo_cum_frac = make_scalar3(m_cum_frac_x[m_grid_pos.x], m_cum_frac_y[m_grid_pos.y], m_cum_frac_z[m_grid_pos.z]);
+    Scalar3 lo_cum_frac = make_scalar3(getCumulativeFraction(0, m_grid_pos.x),
+                                       getCumulativeFraction(1, m_grid_pos.y),
+                                       getCumulativeFraction(2, m_grid_pos.z));
     Scalar3 lo = global_box.getLo() + lo_cum_frac * L;
 
-    Scalar3 hi_cum_frac = make_scalar3(m_cum_frac_x[m_grid_pos.x+1], m_cum_frac_y[m_grid_pos.y+1], m_cum_frac_z[m_grid_pos.z+1]);
+    Scalar3 hi_cum_frac = make_scalar3(getCumulativeFraction(0, m_grid_pos.x+1),
+                                       getCumulativeFraction(1, m_grid_pos.y+1),
+                                       getCumulativeFraction(2, m_grid_pos.z+1));
     Scalar3 hi = global_box.getLo() + hi_cum_frac * L;
 
     // set periodic flags
@@ -593,15 +762,30 @@ unsigned int DomainDecomposition::placeParticle(const BoxDim& global_box, Scalar
     else if (ix >= (int)m_nx)
         ix--;
 
-    it = std::lower_bound(m_cum_frac_y.begin(), m_cum_frac_y.end(), f.y);
-    int iy = it - 1 - m_cum_frac_y.begin();
+    // in a staggered decomposition, search the cuts of the slab and then of the column
+    std::vector<Scalar>::iterator first_y = m_cum_frac_y.begin();
+    std::vector<Scalar>::iterator last_y = m_cum_frac_y.end();
+    if (m_staggered)
+        {
+        first_y = m_stag_frac_y.begin() + getSlabOffset(make_uint3(ix, 0, 0));
+        last_y = first_y + m_ny + 1;
+        }
+    it = std::lower_bound(first_y, last_y, f.y);
+    int iy = it - 1 - first_y;
     if (iy < 0)
         iy++;
     else if (iy >= (int)m_ny)
         iy--;
 
-    it = std::lower_bound(m_cum_frac_z.begin(), m_cum_frac_z.end(), f.z);
-    int iz = it - 1 - m_cum_frac_z.begin();
+    std::vector<Scalar>::iterator first_z = m_cum_frac_z.begin();
+    std::vector<Scalar>::iterator last_z = m_cum_frac_z.end();
+    if (m_staggered)
+        {
+        first_z = m_stag_frac_z.begin() + getColumnOffset(make_uint3(ix, iy, 0));
+        last_z = first_z + m_nz + 1;
+        }
+    it = std::lower_bound(first_z, last_z, f.z);
+    int iz = it - 1 - first_z;
     if (iz < 0)
         iz++;
     else if (iz >= (int)m_nz)
@@ -612,43 +796,42 @@ unsigned int DomainDecomposition::placeParticle(const BoxDim& global_box, Scalar
     return rank;
     }
 
+/*! The ranks that can share memory form a node, which is identified by its lowest rank. Unlike the processor names,
+    this does not depend on how the host names are configured.
+ */
 void DomainDecomposition::findCommonNodes()
     {
-    // get MPI node name
-    char procname[MPI_MAX_PROCESSOR_NAME];
-    int len;
-    MPI_Get_processor_name(procname, &len);
-    std::string s(procname, len);
-
-    // collect node names from all ranks on rank zero
-    std::vector<std::string> nodes;
-    gather_v(s, nodes, 0, m_exec_conf->getMPICommunicator());
-
-    // construct map of node names
-    if (m_exec_conf->getRank() == 0)
+    // split the communicator into the ranks of every node
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(m_mpi_comm, MPI_COMM_TYPE_SHARED, m_exec_conf->getRank(), MPI_INFO_NULL, &node_comm);
+
+    // the lowest rank on the node identifies it
+    unsigned int node = m_exec_conf->getRank();
+    MPI_Bcast(&node, 1, MPI_UNSIGNED, 0, node_comm);
+    MPI_Comm_free(&node_comm);
+
+    // collect the node of every rank on all ranks
+    unsigned int nranks = m_exec_conf->getNRanks();
+    std::vector<unsigned int> nodes(nranks);
+    MPI_Allgather(&node, 1, MPI_UNSIGNED, &nodes.front(), 1, MPI_UNSIGNED, m_mpi_comm);
+
+    // construct map of nodes
+    for (unsigned int r = 0; r < nranks; r++)
         {
-        unsigned int nranks = m_exec_conf->getNRanks();
-        for (unsigned int r = 0; r < nranks; r++)
-            {
-            // insert into set
-            m_nodes.insert(nodes[r]);
+        // insert into set
+        m_nodes.insert(nodes[r]);
 
-            // insert into map
-            m_node_map.insert(std::make_pair(nodes[r], r));
-            }
+        // insert into map
+        m_node_map.insert(std::make_pair(nodes[r], r));
         }
-
-    // broadcast to other ranks
-    bcast(m_nodes, 0, m_exec_conf->getMPICommunicator());
-    bcast(m_node_map, 0, m_exec_conf->getMPICommunicator());
     }
 
 void DomainDecomposition::initializeTwoLevel()
     {
-    typedef std::multimap<std::string, unsigned int> map_t;
+    typedef std::multimap<unsigned int, unsigned int> map_t;
     m_twolevel = true;
     m_max_n_node = 0;
-    for (std::set<std::string>::iterator it = m_nodes.begin(); it != m_nodes.end(); ++it)
+    for (std::set<unsigned int>::iterator it = m_nodes.begin(); it != m_nodes.end(); ++it)
         {
         std::pair<map_t::iterator, map_t::iterator> p = m_node_map.equal_range(*it);
         unsigned int n_node = std::distance(p.first, p.second);
@@ -671,13 +854,19 @@ void export_DomainDecomposition(py::module& m)
               unsigned int,
               unsigned int,
               unsigned int,
+              bool,
               bool>())
     .def(py::init<std::shared_ptr<ExecutionConfiguration>,
               Scalar3,
               const std::vector<Scalar>&,
               const std::vector<Scalar>&,
-              const std::vector<Scalar>&>())
-    .def("getCumulativeFractions", &DomainDecomposition::getCumulativeFractions)
+              const std::vector<Scalar>&,
+              bool,
+              bool>())
+    .def("getCumulativeFractions", (std::vector<Scalar> (DomainDecomposition::*)(unsigned int) const) &DomainDecomposition::getCumulativeFractions)
+    .def("setStaggered", &DomainDecomposition::setStaggered)
+    .def("isStaggered", &DomainDecomposition::isStaggered)
+    .def("getStaggeredFractions", &DomainDecomposition::getStaggeredFractions)
     ;
     }
 #endif // ENABLE_MPI
@@ -44,6 +44,18 @@
  *  ranks does not match the number that is available, behavior is reverted to the normal default with
  *  uniform cuts along each dimension.
  *
+ *  In a staggered decomposition, the cut planes are no longer shared by all domains. The x cuts divide the box into
+ *  slabs, every slab has its own y cuts that divide it into columns, and every column has its own z cuts. This is a
+ *  k-d tree with a fixed cut order, so that the load can be balanced in several dimensions at once (e.g. a droplet on
+ *  a surface). The ranks keep their position in the grid, and the grid neighbors remain the routing neighbors of the
+ *  Communicator. The cuts of adjacent slabs and columns must therefore interleave, i.e. every domain only overlaps the
+ *  grid neighbors of its own grid position in the adjacent slabs and columns.
+ *
+ *  With a two-level decomposition, the ranks that share memory (as reported by MPI_Comm_split_type) are assigned a
+ *  compact block of the grid, which is chosen to have the smallest surface towards other nodes. Most of the ghost
+ *  layers are then exchanged within a node. If the grid cannot be divided evenly into such blocks, the ranks are
+ *  mapped in sequential order.
+ *
  *  The initialization of the domain decomposition scheme is performed in the constructor.
  */
 class PYBIND11_EXPORT DomainDecomposition
@@ -57,20 +69,24 @@ class PYBIND11_EXPORT DomainDecomposition
          * \param ny Requested number of domains along the y direction (0 == choose default)
          * \param nz Requested number of domains along the z direction (0 == choose default)
          * \param twolevel If true, attempt two level decomposition (default == false)
+         * \param twolevel_fixed If true, also attempt it when the grid dimensions are given (default == false)
          */
         DomainDecomposition(std::shared_ptr<ExecutionConfiguration> exec_conf,
                        Scalar3 L,
                        unsigned int nx = 0,
                        unsigned int ny = 0,
                        unsigned int nz = 0,
-                       bool twolevel = false);
+                       bool twolevel = false,
+                       bool twolevel_fixed = false);
 
         //! Constructor for fixed fractions
         DomainDecomposition(std::shared_ptr<ExecutionConfiguration> exec_conf,
                             Scalar3 L,
                             const std::vector<Scalar>& fxs,
                             const std::vector<Scalar>& fys,
-                            const std::vector<Scalar>& fzs);
+                            const std::vector<Scalar>& fzs,
+                            bool twolevel = false,
+                            bool twolevel_fixed = false);
 
         //! Calculate MPI ranks of neighboring domain.
         unsigned int getNeighborRank(unsigned int dir) const;
@@ -93,6 +109,12 @@ class PYBIND11_EXPORT DomainDecomposition
             return m_cart_ranks_inv;
             }
 
+        //! Returns true if the ranks of every node are mapped onto a compact block of the grid
+        bool isTwoLevel() const
+            {
+            return m_twolevel;
+            }
+
         //! Get the grid position of this rank
         uint3 getGridPos() const
             {
@@ -107,6 +129,8 @@ class PYBIND11_EXPORT DomainDecomposition
          * \param dir Direction (0=x, 1=y, 2=z) to get fraction
          * \param idx The rank index to get the cumulative fraction below (0 to N+1)
          * \returns Cumulative fraction of global box length below rank at \a idx
+         *
+         * In a staggered decomposition, the fractions of the slab or column of this rank are returned.
          */
         Scalar getCumulativeFraction(unsigned int dir, unsigned int idx) const
             {
@@ -118,12 +142,12 @@ class PYBIND11_EXPORT DomainDecomposition
             else if (dir == 1)
                 {
                 assert(idx >= 0 && idx < m_ny+1);
-                return m_cum_frac_y[idx];
+                return m_staggered ? m_stag_frac_y[getSlabOffset(m_grid_pos) + idx] : m_cum_frac_y[idx];
                 }
             else if (dir == 2)
                 {
                 assert(idx >= 0 && idx < m_nz+1);
-                return m_cum_frac_z[idx];
+                return m_staggered ? m_stag_frac_z[getColumnOffset(m_grid_pos) + idx] : m_cum_frac_z[idx];
                 }
             else
                 {
@@ -136,21 +160,59 @@ class PYBIND11_EXPORT DomainDecomposition
         /*!
          * \param dir Direction (0=x, 1=y, 2=z) to get fraction
          * \returns Array of cumulative fractions of global box length below rank
+         *
+         * In a staggered decomposition, the fractions of the slab or column of this rank are returned.
          */
         std::vector<Scalar> getCumulativeFractions(unsigned int dir) const
             {
-            if (dir == 0) return m_cum_frac_x;
-            else if (dir == 1) return m_cum_frac_y;
-            else if (dir == 2) return m_cum_frac_z;
+            return getCumulativeFractions(dir, m_grid_pos);
+            }
+
+        //! Get the cumulative box fractions along a dimension in the slab or column of a grid position
+        std::vector<Scalar> getCumulativeFractions(unsigned int dir, const uint3& pos) const;
+
+        //! Collectively set the cumulative fractions along a dimension from a given rank
+        void setCumulativeFractions(unsigned int dir, const std::vector<Scalar>& cum_frac, unsigned int root);
+
+        //! Enable or disable the staggered decomposition
+        void setStaggered(bool staggered);
+
+        //! Returns true if the y and z cut planes are set independently in every slab and column
+        bool isStaggered() const
+            {
+            return m_staggered;
+            }
+
+        //! Get the cumulative fractions along a dimension in all slabs (y) or columns (z)
+        /*!
+         * \param dir Direction (1=y, 2=z)
+         * \returns Concatenated cumulative fractions, the slabs in x order and the columns in x-major order
+         */
+        const std::vector<Scalar>& getStaggeredFractions(unsigned int dir) const
+            {
+            if (dir == 1) return m_stag_frac_y;
+            else if (dir == 2) return m_stag_frac_z;
             else
                 {
-                m_exec_conf->msg->error() << "comm: requested direction does not exist" << std::endl;
+                m_exec_conf->msg->error() << "comm: staggered fractions only exist in y and z" << std::endl;
                 throw std::runtime_error("comm: requested direction does not exist");
                 }
             }
 
-        //! Collectively set the cumulative fractions along a dimension from a given rank
-        void setCumulativeFractions(unsigned int dir, const std::vector<Scalar>& cum_frac, unsigned int root);
+        //! Collectively set the cumulative fractions along a dimension in all slabs or columns from a given rank
+        void setStaggeredFractions(unsigned int dir, const std::vector<Scalar>& cum_frac, unsigned int root);
+
+        //! Get the offset of the y fractions of the slab that contains a grid position
+        unsigned int getSlabOffset(const uint3& pos) const
+            {
+            return pos.x*(m_ny+1);
+            }
+
+        //! Get the offset of the z fractions of the column that contains a grid position
+        unsigned int getColumnOffset(const uint3& pos) const
+            {
+            return (pos.x*m_ny + pos.y)*(m_nz+1);
+            }
 
         //! Get the dimensions of the local simulation box
         const BoxDim calculateLocalBox(const BoxDim& global_box);
@@ -170,8 +232,8 @@ class PYBIND11_EXPORT DomainDecomposition
         Index3D m_node_grid;         //!< Indexer of the grid of nodes
         Index3D m_intra_node_grid;   //!< The grid in every node
 
-        std::set<std::string> m_nodes; //!< List of nodes
-        std::multimap<std::string, unsigned int> m_node_map; //!< Map of ranks per node
+        std::set<unsigned int> m_nodes; //!< List of nodes, identified by their lowest rank
+        std::multimap<unsigned int, unsigned int> m_node_map; //!< Map of ranks per node
         unsigned int m_max_n_node;   //!< Maximum number of ranks on a node
         bool m_twolevel;             //!< Whether we use a two-level decomposition
 
@@ -183,7 +245,7 @@ class PYBIND11_EXPORT DomainDecomposition
             unsigned int& nx, unsigned int& ny, unsigned int& nz);
 
         //! Find a two-level decomposition of the global grid
-        void subdivide(unsigned int n_node_ranks, Scalar3 L,
+        bool subdivide(unsigned int n_node_ranks, Scalar3 L,
             unsigned int nx, unsigned int ny, unsigned int nz,
             unsigned int& nx_intra, unsigned int &ny_intra, unsigned int& nz_intra);
 
@@ -198,7 +260,8 @@ class PYBIND11_EXPORT DomainDecomposition
                                   unsigned int nx,
                                   unsigned int ny,
                                   unsigned int nz,
-                                  bool twolevel);
+                                  bool twolevel,
+                                  bool twolevel_fixed);
 
         //! Helper function to perform partial sums on fractional domain widths
         void initializeCumulativeFractions(const std::vector<Scalar>& fxs,
@@ -211,6 +274,10 @@ class PYBIND11_EXPORT DomainDecomposition
         std::vector<Scalar> m_cum_frac_x;   //!< Cumulative fractions in x below cut plane index
         std::vector<Scalar> m_cum_frac_y;   //!< Cumulative fractions in y below cut plane index
         std::vector<Scalar> m_cum_frac_z;   //!< Cumulative fractions in z below cut plane index
+
+        bool m_staggered;                   //!< True if the decomposition is staggered
+        std::vector<Scalar> m_stag_frac_y;  //!< Cumulative fractions in y in every slab
+        std::vector<Scalar> m_stag_frac_z;  //!< Cumulative fractions in z in every column
 #endif // ENABLE_MPI
    };
 
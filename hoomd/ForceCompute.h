@@ -69,6 +69,13 @@ class PYBIND11_EXPORT ForceCompute : public Compute
          * and can be used to overlap computation with communication
          */
         virtual void preCompute(unsigned int timestep){}
+
+        //! Pre-compute the forces on interior particles
+        /*! This method is called in MPI simulations while the ghost positions are being updated. Implementations
+         * may compute the contributions that do not depend on ghost particles, and complete the forces in the
+         * following call to compute().
+         */
+        virtual void preComputeInterior(unsigned int timestep){}
         #endif
 
         //! Computes the forces
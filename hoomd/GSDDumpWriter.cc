@@ -9,6 +9,7 @@
 */
 
 #include "GSDDumpWriter.h"
+#include "GSDPositionCodec.h"
 #include "Filesystem.h"
 #include "HOOMDVersion.h"
 
@@ -16,9 +17,15 @@
 #include "Communicator.h"
 #endif
 
+#ifdef ENABLE_TBB
+#include <tbb/tbb.h>
+#endif
+
 #include <string.h>
 #include <stdexcept>
 #include <list>
+#include <algorithm>
+#include <limits>
 using namespace std;
 namespace py = pybind11;
 
@@ -41,23 +48,38 @@ GSDDumpWriter::GSDDumpWriter(std::shared_ptr<SystemDefinition> sysdef,
     : Analyzer(sysdef), m_fname(fname), m_overwrite(overwrite),
                         m_truncate(truncate),
                         m_is_initialized(false),
-                        m_group(group)
+                        m_group(group),
+                        m_nframes(0),
+                        m_buffer_frames(0),
+                        m_write_signal_requested(false),
+                        m_writer(m_exec_conf, 1),
+                        m_parallel(false),
+                        m_position_bits(0),
+                        m_keyframe_period(1),
+                        m_keyframe_frame(std::numeric_limits<uint64_t>::max()),
+                        m_keyframe_first(0)
     {
     m_exec_conf->msg->notice(5) << "Constructing GSDDumpWriter: " << m_fname << " " << overwrite << " " << truncate << endl;
     }
 
+/*! \param retval Return value of a gsd function
+
+    checkError throws exceptions with the error message for common gsd error codes. It runs on the writer thread, so
+    the message is not printed here. The caller prints it (see BackgroundWriter).
+*/
 void GSDDumpWriter::checkError(int retval)
     {
-    // checkError prints errors and then throws exceptions for common gsd error codes
     if (retval == -1)
         {
-        m_exec_conf->msg->error() << "dump.gsd: " << strerror(errno) << " - " << m_fname << endl;
-        throw runtime_error("Error writing GSD file");
+        // capture errno before anything else can change it
+        int err = errno;
+        throw runtime_error("dump.gsd: " + string(strerror(err)) + " - " + m_fname);
         }
     else if (retval != 0)
         {
-        m_exec_conf->msg->error() << "dump.gsd: " << "Unknown error " << retval << " writing: " << m_fname << endl;
-        throw runtime_error("Error writing GSD file");
+        ostringstream s;
+        s << "dump.gsd: Unknown error " << retval << " writing: " << m_fname;
+        throw runtime_error(s.str());
         }
     }
 
@@ -133,6 +155,7 @@ void GSDDumpWriter::initFileIO()
         throw runtime_error("Error opening GSD file");
         }
 
+    m_nframes = gsd_get_nframes(&m_handle);
     m_is_initialized = true;
     }
 
@@ -140,6 +163,9 @@ GSDDumpWriter::~GSDDumpWriter()
     {
     m_exec_conf->msg->notice(5) << "Destroying GSDDumpWriter" << endl;
 
+    // write out the remaining frames, errors cannot be raised from the destructor
+    m_writer.stop();
+
     bool root=true;
     #ifdef ENABLE_MPI
     root = m_exec_conf->isRoot();
@@ -159,16 +185,35 @@ GSDDumpWriter::~GSDDumpWriter()
 */
 void GSDDumpWriter::analyze(unsigned int timestep)
     {
-    int retval;
     bool root=true;
 
     if (m_prof)
         m_prof->push("Dump GSD");
 
-    // take particle data snapshot
-    m_exec_conf->msg->notice(10) << "dump.gsd: taking particle data snapshot" << endl;
-    SnapshotParticleData<float> snapshot;
-    const std::map<unsigned int, unsigned int>& map = m_pdata->takeSnapshot<float>(snapshot);
+    // in parallel mode, the particle data is written by all ranks and not gathered
+    bool parallel = false;
+#ifdef ENABLE_MPI
+    parallel = m_parallel && m_pdata->getDomainDecomposition();
+#endif
+
+    // State written by slots of the write signal is written to the file synchronously
+    bool async = !parallel && m_buffer_frames > 0 && !m_write_signal_requested;
+
+    // raise errors of previous frames
+    if (async)
+        m_writer.checkError();
+    else
+        flush();
+
+    std::shared_ptr<Frame> frame(new Frame);
+    frame->timestep = timestep;
+
+    if (! parallel)
+        {
+        // take particle data snapshot
+        m_writer.notice(10) << "dump.gsd: taking particle data snapshot" << endl;
+        m_pdata->takeSnapshot<float>(frame->snapshot, frame->snap_idx);
+        }
 
 #ifdef ENABLE_MPI
     // if we are not the root processor, do not perform file I/O
@@ -179,107 +224,282 @@ void GSDDumpWriter::analyze(unsigned int timestep)
     if (! m_is_initialized && root)
         initFileIO();
 
-    // truncate the file if requested
-    if (m_truncate && root)
+    uint64_t nframes = 0;
+    if (root)
         {
-        m_exec_conf->msg->notice(10) << "dump.gsd: truncating file" << endl;
-        retval = gsd_truncate(&m_handle);
-        if (retval == -1)
+        if (async)
             {
-            m_exec_conf->msg->error() << "dump.gsd: " << strerror(errno) << " - " << m_fname << endl;
-            throw runtime_error("Error opening GSD file");
+            // the file is truncated or appended to by the writer thread
+            nframes = m_truncate ? 0 : m_nframes++;
             }
-        else if (retval == -2)
+        else
             {
-            m_exec_conf->msg->error() << "dump.gsd: " << m_fname << " is not a valid GSD file" << endl;
-            throw runtime_error("Error opening GSD file");
-            }
-        else if (retval == -3)
-            {
-            m_exec_conf->msg->error() << "dump.gsd: " << "Invalid GSD file version in " << m_fname << endl;
-            throw runtime_error("Error opening GSD file");
-            }
-        else if (retval == -4)
-            {
-            m_exec_conf->msg->error() << "dump.gsd: " << "Corrupt GSD file: " << m_fname << endl;
-            throw runtime_error("Error opening GSD file");
-            }
-        else if (retval == -5)
-            {
-            m_exec_conf->msg->error() << "dump.gsd: " << "Out of memory opening: " << m_fname << endl;
-            throw runtime_error("Error opening GSD file");
-            }
-        else if (retval != 0)
-            {
-            m_exec_conf->msg->error() << "dump.gsd: " << "Unknown error opening: " << m_fname << endl;
-            throw runtime_error("Error opening GSD file");
-            }
-        }
+            // truncate the file if requested
+            try
+                {
+                if (m_truncate)
+                    truncateFile();
+                }
+            catch (const std::exception& e)
+                {
+                m_exec_conf->msg->error() << e.what() << endl;
+                throw;
+                }
 
-    uint64_t nframes = 0;
-    if (root)
-        {
-        nframes = gsd_get_nframes(&m_handle);
-        m_exec_conf->msg->notice(10) << "dump.gsd: " << m_fname << " has " << nframes << " frames" << endl;
+            nframes = gsd_get_nframes(&m_handle);
+            }
+        m_writer.notice(10) << "dump.gsd: " << m_fname << " has " << nframes << " frames" << endl;
         }
 
     #ifdef ENABLE_MPI
     bcast(nframes, 0, m_exec_conf->getMPICommunicator());
     #endif
 
-    if (root)
+    // capture everything that is written out with the frame
+    frame->box = m_pdata->getGlobalBox();
+    frame->dimensions = m_sysdef->getNDimensions();
+    frame->N = m_group->getNumMembersGlobal();
+    if (root && ! parallel)
         {
-        // write out the frame header on all frames
-        writeFrameHeader(timestep);
-
-        // only write out data chunk categories if requested, or if on frame 0
-        if (m_write_attribute || nframes == 0)
-            writeAttributes(snapshot, map);
-        if (m_write_property || nframes == 0)
-            writeProperties(snapshot, map);
-        if (m_write_momentum || nframes == 0)
-            writeMomenta(snapshot, map);
+        frame->group_tags.resize(frame->N);
+        for (unsigned int group_idx = 0; group_idx < frame->N; group_idx++)
+            frame->group_tags[group_idx] = m_group->getMemberTag(group_idx);
         }
 
+    // only write out data chunk categories if requested, or if on frame 0
+    frame->write_attribute = m_write_attribute || nframes == 0;
+    frame->write_property = m_write_property || nframes == 0;
+    frame->write_momentum = m_write_momentum || nframes == 0;
+
     // topology is only meaningful if this is the all group
-    if (m_group->getNumMembersGlobal() == m_pdata->getNGlobal() && (m_write_topology || nframes == 0))
+    frame->write_topology = m_group->getNumMembersGlobal() == m_pdata->getNGlobal() && (m_write_topology || nframes == 0);
+    if (frame->write_topology)
         {
-        BondData::Snapshot bdata_snapshot;
-        m_sysdef->getBondData()->takeSnapshot(bdata_snapshot);
+        frame->bond = updateTopology(*m_sysdef->getBondData(), m_bond_cache, nframes);
+        frame->angle = updateTopology(*m_sysdef->getAngleData(), m_angle_cache, nframes);
+        frame->dihedral = updateTopology(*m_sysdef->getDihedralData(), m_dihedral_cache, nframes);
+        frame->improper = updateTopology(*m_sysdef->getImproperData(), m_improper_cache, nframes);
+        frame->constraint = updateTopology(*m_sysdef->getConstraintData(), m_constraint_cache, nframes);
+        frame->pair = updateTopology(*m_sysdef->getPairData(), m_pair_cache, nframes);
+        }
 
-        AngleData::Snapshot adata_snapshot;
-        m_sysdef->getAngleData()->takeSnapshot(adata_snapshot);
+    if (async)
+        {
+        // hand the frame over to the writer thread
+        if (root)
+            queueFrame(frame);
+        }
+    else
+        {
+        // the write helpers throw with the message instead of printing it, as they also run on the writer thread
+        try
+            {
+            if (parallel)
+                {
+                #ifdef ENABLE_MPI
+                if (root)
+                    writeFrameHeader(*frame);
 
-        DihedralData::Snapshot ddata_snapshot;
-        m_sysdef->getDihedralData()->takeSnapshot(ddata_snapshot);
+                writeParticlesParallel(*frame, nframes);
 
-        ImproperData::Snapshot idata_snapshot;
-        m_sysdef->getImproperData()->takeSnapshot(idata_snapshot);
+                if (root && frame->write_topology)
+                    writeTopology(*frame);
+                #endif
+                }
+            else if (root)
+                {
+                writeFrame(*frame);
+                }
 
-        ConstraintData::Snapshot cdata_snapshot;
-        m_sysdef->getConstraintData()->takeSnapshot(cdata_snapshot);
+            // emit on all ranks, the slot needs to handle the mpi logic.
+            m_write_signal.emit(m_handle);
 
-        PairData::Snapshot pdata_snapshot;
-        m_sysdef->getPairData()->takeSnapshot(pdata_snapshot);
+            if (root)
+                {
+                m_writer.notice(10) << "dump.gsd: ending frame" << endl;
+                int retval = gsd_end_frame(&m_handle);
+                checkError(retval);
+                m_nframes = gsd_get_nframes(&m_handle);
+                }
+            }
+        catch (const std::exception& e)
+            {
+            m_exec_conf->msg->error() << e.what() << endl;
+            throw;
+            }
+        }
 
-        if (root)
-            writeTopology(bdata_snapshot, adata_snapshot, ddata_snapshot, idata_snapshot, cdata_snapshot, pdata_snapshot);
+    if (m_prof)
+        m_prof->pop();
+    }
+
+//! Truncate the file to zero frames
+/*! Errors are thrown with the message, as the writer thread truncates the file of buffered frames.
+*/
+void GSDDumpWriter::truncateFile()
+    {
+    m_writer.notice(10) << "dump.gsd: truncating file" << endl;
+    int retval = gsd_truncate(&m_handle);
+    if (retval == -1)
+        {
+        int err = errno;
+        throw runtime_error("dump.gsd: " + string(strerror(err)) + " - " + m_fname);
         }
+    else if (retval == -2)
+        throw runtime_error("dump.gsd: " + m_fname + " is not a valid GSD file");
+    else if (retval == -3)
+        throw runtime_error("dump.gsd: Invalid GSD file version in " + m_fname);
+    else if (retval == -4)
+        throw runtime_error("dump.gsd: Corrupt GSD file: " + m_fname);
+    else if (retval == -5)
+        throw runtime_error("dump.gsd: Out of memory opening: " + m_fname);
+    else if (retval != 0)
+        throw runtime_error("dump.gsd: Unknown error opening: " + m_fname);
+    }
 
-    // emit on all ranks, the slot needs to handle the mpi logic.
-    m_write_signal.emit(m_handle);
+/*! \param frame Frame to write out
 
-    if (root)
+    Writes all data chunks of the frame, but does not end the frame.
+*/
+void GSDDumpWriter::writeFrame(const Frame& frame)
+    {
+    // write out the frame header on all frames
+    writeFrameHeader(frame);
+
+    if (frame.write_attribute)
+        writeAttributes(frame);
+    if (frame.write_property)
+        writeProperties(frame);
+    if (frame.write_momentum)
+        writeMomenta(frame);
+    if (frame.write_topology)
+        writeTopology(frame);
+    }
+
+/*! \param buffer_frames Maximum number of frames waiting to be written in the background (0 to write synchronously)
+
+    With \a buffer_frames > 0, analyze() only captures the frame and a writer thread on the root rank writes it to the
+    file while the simulation continues. analyze() blocks when \a buffer_frames frames are still being written.
+*/
+void GSDDumpWriter::setBufferFrames(unsigned int buffer_frames)
+    {
+    if (buffer_frames == 0)
+        m_writer.stop();
+    m_writer.checkError();
+
+    m_buffer_frames = buffer_frames;
+    m_writer.setMaxQueued(buffer_frames);
+    }
+
+/*! Waits until the writer thread has written all queued frames and raises any error that occurred while writing.
+*/
+void GSDDumpWriter::flush()
+    {
+    m_writer.flush();
+    }
+
+/*! \param frame Frame to write out
+
+    Blocks while the queue is full.
+*/
+void GSDDumpWriter::queueFrame(std::shared_ptr<Frame> frame)
+    {
+    m_writer.queue([this, frame]
         {
-        m_exec_conf->msg->notice(10) << "dump.gsd: ending frame" << endl;
-        retval = gsd_end_frame(&m_handle);
+        if (m_truncate)
+            truncateFile();
+
+        writeFrame(*frame);
+
+        m_writer.notice(10) << "dump.gsd: ending frame" << endl;
+        int retval = gsd_end_frame(&m_handle);
         checkError(retval);
+        });
+    }
+
+/*! \param bits Bits per quantized coordinate, or 0 to write plain positions
+    \param keyframe_period Number of frames between position keyframes
+*/
+void GSDDumpWriter::setPositionQuantization(unsigned int bits, unsigned int keyframe_period)
+    {
+    if (bits != 0 && (bits < GSDPositionCodec::min_bits || bits > GSDPositionCodec::max_bits))
+        {
+        m_exec_conf->msg->error() << "dump.gsd: position bits must be between " << GSDPositionCodec::min_bits
+                                  << " and " << GSDPositionCodec::max_bits << endl;
+        throw runtime_error("Error setting position quantization");
+        }
+    if (keyframe_period == 0)
+        {
+        m_exec_conf->msg->error() << "dump.gsd: the keyframe period must be positive" << endl;
+        throw runtime_error("Error setting position quantization");
         }
 
-    if (m_prof)
-        m_prof->pop();
+    // the buffered frames are encoded with the current settings
+    flush();
+
+    m_position_bits = bits;
+    m_keyframe_period = keyframe_period;
+
+    // start over with a keyframe
+    m_keyframe_q.clear();
+    m_keyframe_frame = std::numeric_limits<uint64_t>::max();
     }
 
+/*! \param box Box of the frame
+    \param pos Positions of the particles to encode (3*n floats)
+    \param n Number of particles to encode
+    \param first Index of the first encoded particle in the frame
+    \param N Number of particles in the frame
+    \param nframes Index of the frame
+    \param parallel True if every rank encodes a slice of the particles (collective call)
+    \param stream Output encoded stream, starting with the header on the root rank
+
+    A frame is a keyframe if it is the first frame of the file or written by this writer, keyframe_period frames
+    after the last keyframe, or when the particles changed.
+*/
+void GSDDumpWriter::encodePositions(const BoxDim& box,
+                                    const float *pos,
+                                    unsigned int n,
+                                    unsigned int first,
+                                    uint32_t N,
+                                    uint64_t nframes,
+                                    bool parallel,
+                                    std::vector<uint8_t>& stream)
+    {
+    std::vector<uint32_t> q(3*n);
+    GSDPositionCodec::quantize(box, pos, n, m_position_bits, q.data());
+
+    int keyframe = nframes == 0 || nframes < m_keyframe_frame || nframes - m_keyframe_frame >= m_keyframe_period
+                   || m_keyframe_q.size() != q.size() || m_keyframe_first != first;
+    #ifdef ENABLE_MPI
+    if (parallel)
+        MPI_Allreduce(MPI_IN_PLACE, &keyframe, 1, MPI_INT, MPI_LOR, m_exec_conf->getMPICommunicator());
+    #endif
+
+    stream.clear();
+    if (! parallel || m_exec_conf->isRoot())
+        {
+        GSDPositionCodec::Header header;
+        header.version = 1;
+        header.bits = uint8_t(m_position_bits);
+        header.keyframe = uint8_t(keyframe);
+        header.reserved = 0;
+        header.N = N;
+        header.keyframe_frame = keyframe ? nframes : m_keyframe_frame;
+
+        stream.resize(sizeof(header));
+        memcpy(&stream[0], &header, sizeof(header));
+        }
+
+    GSDPositionCodec::encode(q.data(), keyframe ? NULL : m_keyframe_q.data(), q.size(), m_position_bits, stream);
+
+    if (keyframe)
+        {
+        m_keyframe_q.swap(q);
+        m_keyframe_frame = nframes;
+        m_keyframe_first = first;
+        }
+    }
 
 void GSDDumpWriter::writeTypeMapping(std::string chunk, std::vector< std::string > type_mapping)
     {
@@ -291,7 +511,7 @@ void GSDDumpWriter::writeTypeMapping(std::string chunk, std::vector< std::string
     max_len += 1;  // for null
 
         {
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing " << chunk << endl;
+        m_writer.notice(10) << "dump.gsd: writing " << chunk << endl;
         std::vector<char> types(max_len * type_mapping.size());
         for (unsigned int i = 0; i < type_mapping.size(); i++)
             strncpy(&types[max_len*i], type_mapping[i].c_str(), max_len);
@@ -301,7 +521,7 @@ void GSDDumpWriter::writeTypeMapping(std::string chunk, std::vector< std::string
 
     }
 
-/*! \param timestep
+/*! \param frame Frame to write out
 
     Write the data chunks configuration/step, configuration/box, and particles/N. If this is frame 0, also write
     configuration/dimensions.
@@ -309,24 +529,24 @@ void GSDDumpWriter::writeTypeMapping(std::string chunk, std::vector< std::string
     N is not strictly necessary for constant N data, but is always written in case the user fails to select
     dynamic attributes with a variable N file.
 */
-void GSDDumpWriter::writeFrameHeader(unsigned int timestep)
+void GSDDumpWriter::writeFrameHeader(const Frame& frame)
     {
     int retval;
-    m_exec_conf->msg->notice(10) << "dump.gsd: writing configuration/step" << endl;
-    uint64_t step = timestep;
+    m_writer.notice(10) << "dump.gsd: writing configuration/step" << endl;
+    uint64_t step = frame.timestep;
     retval = gsd_write_chunk(&m_handle, "configuration/step", GSD_TYPE_UINT64, 1, 1, 0, (void *)&step);
     checkError(retval);
 
     if (gsd_get_nframes(&m_handle) == 0)
         {
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing configuration/dimensions" << endl;
-        uint8_t dimensions = m_sysdef->getNDimensions();
+        m_writer.notice(10) << "dump.gsd: writing configuration/dimensions" << endl;
+        uint8_t dimensions = frame.dimensions;
         retval = gsd_write_chunk(&m_handle, "configuration/dimensions", GSD_TYPE_UINT8, 1, 1, 0, (void *)&dimensions);
         checkError(retval);
         }
 
-    m_exec_conf->msg->notice(10) << "dump.gsd: writing configuration/box" << endl;
-    BoxDim box = m_pdata->getGlobalBox();
+    m_writer.notice(10) << "dump.gsd: writing configuration/box" << endl;
+    const BoxDim& box = frame.box;
     float box_a[6];
     box_a[0] = box.getL().x;
     box_a[1] = box.getL().y;
@@ -337,19 +557,21 @@ void GSDDumpWriter::writeFrameHeader(unsigned int timestep)
     retval = gsd_write_chunk(&m_handle, "configuration/box", GSD_TYPE_FLOAT, 6, 1, 0, (void *)box_a);
     checkError(retval);
 
-    m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/N" << endl;
-    uint32_t N = m_group->getNumMembersGlobal();
+    m_writer.notice(10) << "dump.gsd: writing particles/N" << endl;
+    uint32_t N = frame.N;
     retval = gsd_write_chunk(&m_handle, "particles/N", GSD_TYPE_UINT32, 1, 1, 0, (void *)&N);
     checkError(retval);
     }
 
-/*! \param snapshot particle data snapshot to write out to the file
+/*! \param frame Frame with the particle data snapshot to write out to the file
 
     Writes the data chunks types, typeid, mass, charge, diameter, body, moment_inertia in particles/.
 */
-void GSDDumpWriter::writeAttributes(const SnapshotParticleData<float>& snapshot, const std::map<unsigned int, unsigned int> &map)
+void GSDDumpWriter::writeAttributes(const Frame& frame)
     {
-    uint32_t N = m_group->getNumMembersGlobal();
+    const SnapshotParticleData<float>& snapshot = frame.snapshot;
+    const std::vector<unsigned int>& snap_idx = frame.snap_idx;
+    uint32_t N = frame.group_tags.size();
     int retval;
     uint64_t nframes = gsd_get_nframes(&m_handle);
 
@@ -362,21 +584,21 @@ void GSDDumpWriter::writeAttributes(const SnapshotParticleData<float>& snapshot,
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            if (snapshot.type[it->second] != 0)
+            if (snapshot.type[snap_id] != 0)
                 all_default = false;
 
-            type[group_idx] = uint32_t(snapshot.type[it->second]);
+            type[group_idx] = uint32_t(snapshot.type[snap_id]);
             }
 
         if (!all_default || (nframes > 0 && m_nondefault["particles/typeid"]))
             {
-            m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/typeid" << endl;
+            m_writer.notice(10) << "dump.gsd: writing particles/typeid" << endl;
             retval = gsd_write_chunk(&m_handle, "particles/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&type[0]);
             checkError(retval);
             if (nframes == 0)
@@ -391,21 +613,21 @@ void GSDDumpWriter::writeAttributes(const SnapshotParticleData<float>& snapshot,
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            if (snapshot.mass[it->second] != float(1.0))
+            if (snapshot.mass[snap_id] != float(1.0))
                 all_default = false;
 
-            data[group_idx] = float(snapshot.mass[it->second]);
+            data[group_idx] = float(snapshot.mass[snap_id]);
             }
 
         if (!all_default || (nframes > 0 && m_nondefault["particles/mass"]))
             {
-            m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/mass" << endl;
+            m_writer.notice(10) << "dump.gsd: writing particles/mass" << endl;
             retval = gsd_write_chunk(&m_handle, "particles/mass", GSD_TYPE_FLOAT, N, 1, 0, (void *)&data[0]);
             checkError(retval);
             if (nframes == 0)
@@ -416,20 +638,20 @@ void GSDDumpWriter::writeAttributes(const SnapshotParticleData<float>& snapshot,
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            if (snapshot.charge[it->second] != float(0.0))
+            if (snapshot.charge[snap_id] != float(0.0))
                 all_default = false;
-            data[group_idx] = float(snapshot.charge[it->second]);
+            data[group_idx] = float(snapshot.charge[snap_id]);
             }
 
         if (!all_default || (nframes > 0 && m_nondefault["particles/charge"]))
             {
-            m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/charge" << endl;
+            m_writer.notice(10) << "dump.gsd: writing particles/charge" << endl;
             retval = gsd_write_chunk(&m_handle, "particles/charge", GSD_TYPE_FLOAT, N, 1, 0, (void *)&data[0]);
             checkError(retval);
             if (nframes == 0)
@@ -440,21 +662,21 @@ void GSDDumpWriter::writeAttributes(const SnapshotParticleData<float>& snapshot,
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            if (snapshot.diameter[it->second] != float(1.0))
+            if (snapshot.diameter[snap_id] != float(1.0))
                 all_default = false;
 
-            data[group_idx] = float(snapshot.diameter[it->second]);
+            data[group_idx] = float(snapshot.diameter[snap_id]);
             }
 
         if (!all_default || (nframes > 0 && m_nondefault["particles/diameter"]))
             {
-            m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/diameter" << endl;
+            m_writer.notice(10) << "dump.gsd: writing particles/diameter" << endl;
             retval = gsd_write_chunk(&m_handle, "particles/diameter", GSD_TYPE_FLOAT, N, 1, 0, (void *)&data[0]);
             checkError(retval);
             if (nframes == 0)
@@ -469,21 +691,21 @@ void GSDDumpWriter::writeAttributes(const SnapshotParticleData<float>& snapshot,
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            if (snapshot.body[it->second] != NO_BODY)
+            if (snapshot.body[snap_id] != NO_BODY)
                 all_default = false;
 
-            body[group_idx] = int32_t(snapshot.body[it->second]);
+            body[group_idx] = int32_t(snapshot.body[snap_id]);
             }
 
         if (!all_default || (nframes > 0 && m_nondefault["particles/body"]))
             {
-            m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/body" << endl;
+            m_writer.notice(10) << "dump.gsd: writing particles/body" << endl;
             retval = gsd_write_chunk(&m_handle, "particles/body", GSD_TYPE_INT32, N, 1, 0, (void *)&body[0]);
             checkError(retval);
             if (nframes == 0)
@@ -498,27 +720,27 @@ void GSDDumpWriter::writeAttributes(const SnapshotParticleData<float>& snapshot,
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            if (snapshot.inertia[it->second].x != float(0.0) ||
-                snapshot.inertia[it->second].y != float(0.0) ||
-                snapshot.inertia[it->second].z != float(0.0))
+            if (snapshot.inertia[snap_id].x != float(0.0) ||
+                snapshot.inertia[snap_id].y != float(0.0) ||
+                snapshot.inertia[snap_id].z != float(0.0))
                 {
                 all_default = false;
                 }
 
-            data[group_idx*3+0] = float(snapshot.inertia[it->second].x);
-            data[group_idx*3+1] = float(snapshot.inertia[it->second].y);
-            data[group_idx*3+2] = float(snapshot.inertia[it->second].z);
+            data[group_idx*3+0] = float(snapshot.inertia[snap_id].x);
+            data[group_idx*3+1] = float(snapshot.inertia[snap_id].y);
+            data[group_idx*3+2] = float(snapshot.inertia[snap_id].z);
             }
 
         if (!all_default || (nframes > 0 && m_nondefault["particles/moment_inertia"]))
             {
-            m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/moment_inertia" << endl;
+            m_writer.notice(10) << "dump.gsd: writing particles/moment_inertia" << endl;
             retval = gsd_write_chunk(&m_handle, "particles/moment_inertia", GSD_TYPE_FLOAT, N, 3, 0, (void *)&data[0]);
             checkError(retval);
             if (nframes == 0)
@@ -527,13 +749,15 @@ void GSDDumpWriter::writeAttributes(const SnapshotParticleData<float>& snapshot,
         }
     }
 
-/*! \param snapshot particle data snapshot to write out to the file
+/*! \param frame Frame with the particle data snapshot to write out to the file
 
     Writes the data chunks position and orientation in particles/.
 */
-void GSDDumpWriter::writeProperties(const SnapshotParticleData<float>& snapshot, const std::map<unsigned int, unsigned int> &map)
+void GSDDumpWriter::writeProperties(const Frame& frame)
     {
-    uint32_t N = m_group->getNumMembersGlobal();
+    const SnapshotParticleData<float>& snapshot = frame.snapshot;
+    const std::vector<unsigned int>& snap_idx = frame.snap_idx;
+    uint32_t N = frame.group_tags.size();
     int retval;
     uint64_t nframes = gsd_get_nframes(&m_handle);
 
@@ -543,20 +767,32 @@ void GSDDumpWriter::writeProperties(const SnapshotParticleData<float>& snapshot,
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            data[group_idx*3+0] = float(snapshot.pos[it->second].x);
-            data[group_idx*3+1] = float(snapshot.pos[it->second].y);
-            data[group_idx*3+2] = float(snapshot.pos[it->second].z);
+            data[group_idx*3+0] = float(snapshot.pos[snap_id].x);
+            data[group_idx*3+1] = float(snapshot.pos[snap_id].y);
+            data[group_idx*3+2] = float(snapshot.pos[snap_id].z);
             }
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/position" << endl;
-        retval = gsd_write_chunk(&m_handle, "particles/position", GSD_TYPE_FLOAT, N, 3, 0, (void *)&data[0]);
-        checkError(retval);
+        if (m_position_bits > 0)
+            {
+            std::vector<uint8_t> stream;
+            encodePositions(frame.box, &data[0], N, 0, N, nframes, false, stream);
+
+            m_writer.notice(10) << "dump.gsd: writing particles/position_quantized" << endl;
+            retval = gsd_write_chunk(&m_handle, "particles/position_quantized", GSD_TYPE_UINT8, stream.size(), 1, 0, (void *)&stream[0]);
+            checkError(retval);
+            }
+        else
+            {
+            m_writer.notice(10) << "dump.gsd: writing particles/position" << endl;
+            retval = gsd_write_chunk(&m_handle, "particles/position", GSD_TYPE_FLOAT, N, 3, 0, (void *)&data[0]);
+            checkError(retval);
+            }
         }
 
         {
@@ -566,29 +802,29 @@ void GSDDumpWriter::writeProperties(const SnapshotParticleData<float>& snapshot,
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            if (snapshot.orientation[it->second].s != float(1.0) ||
-                snapshot.orientation[it->second].v.x != float(0.0) ||
-                snapshot.orientation[it->second].v.y != float(0.0) ||
-                snapshot.orientation[it->second].v.z != float(0.0))
+            if (snapshot.orientation[snap_id].s != float(1.0) ||
+                snapshot.orientation[snap_id].v.x != float(0.0) ||
+                snapshot.orientation[snap_id].v.y != float(0.0) ||
+                snapshot.orientation[snap_id].v.z != float(0.0))
                 {
                 all_default = false;
                 }
 
-            data[group_idx*4+0] = float(snapshot.orientation[it->second].s);
-            data[group_idx*4+1] = float(snapshot.orientation[it->second].v.x);
-            data[group_idx*4+2] = float(snapshot.orientation[it->second].v.y);
-            data[group_idx*4+3] = float(snapshot.orientation[it->second].v.z);
+            data[group_idx*4+0] = float(snapshot.orientation[snap_id].s);
+            data[group_idx*4+1] = float(snapshot.orientation[snap_id].v.x);
+            data[group_idx*4+2] = float(snapshot.orientation[snap_id].v.y);
+            data[group_idx*4+3] = float(snapshot.orientation[snap_id].v.z);
             }
 
         if (!all_default || (nframes > 0 && m_nondefault["particles/orientation"]))
             {
-            m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/orientation" << endl;
+            m_writer.notice(10) << "dump.gsd: writing particles/orientation" << endl;
             retval = gsd_write_chunk(&m_handle, "particles/orientation", GSD_TYPE_FLOAT, N, 4, 0, (void *)&data[0]);
             checkError(retval);
             if (nframes == 0)
@@ -597,13 +833,15 @@ void GSDDumpWriter::writeProperties(const SnapshotParticleData<float>& snapshot,
         }
     }
 
-/*! \param snapshot particle data snapshot to write out to the file
+/*! \param frame Frame with the particle data snapshot to write out to the file
 
     Writes the data chunks velocity, angmom, and image in particles/.
 */
-void GSDDumpWriter::writeMomenta(const SnapshotParticleData<float>& snapshot, const std::map<unsigned int, unsigned int> &map)
+void GSDDumpWriter::writeMomenta(const Frame& frame)
     {
-    uint32_t N = m_group->getNumMembersGlobal();
+    const SnapshotParticleData<float>& snapshot = frame.snapshot;
+    const std::vector<unsigned int>& snap_idx = frame.snap_idx;
+    uint32_t N = frame.group_tags.size();
     int retval;
     uint64_t nframes = gsd_get_nframes(&m_handle);
 
@@ -614,27 +852,27 @@ void GSDDumpWriter::writeMomenta(const SnapshotParticleData<float>& snapshot, co
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            if (snapshot.vel[it->second].x != float(0.0) ||
-                snapshot.vel[it->second].y != float(0.0) ||
-                snapshot.vel[it->second].z != float(0.0))
+            if (snapshot.vel[snap_id].x != float(0.0) ||
+                snapshot.vel[snap_id].y != float(0.0) ||
+                snapshot.vel[snap_id].z != float(0.0))
                 {
                 all_default = false;
                 }
 
-            data[group_idx*3+0] = float(snapshot.vel[it->second].x);
-            data[group_idx*3+1] = float(snapshot.vel[it->second].y);
-            data[group_idx*3+2] = float(snapshot.vel[it->second].z);
+            data[group_idx*3+0] = float(snapshot.vel[snap_id].x);
+            data[group_idx*3+1] = float(snapshot.vel[snap_id].y);
+            data[group_idx*3+2] = float(snapshot.vel[snap_id].z);
             }
 
         if (!all_default || (nframes > 0 && m_nondefault["particles/velocity"]))
             {
-            m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/velocity" << endl;
+            m_writer.notice(10) << "dump.gsd: writing particles/velocity" << endl;
             retval = gsd_write_chunk(&m_handle, "particles/velocity", GSD_TYPE_FLOAT, N, 3, 0, (void *)&data[0]);
             checkError(retval);
             if (nframes == 0)
@@ -649,29 +887,29 @@ void GSDDumpWriter::writeMomenta(const SnapshotParticleData<float>& snapshot, co
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            if (snapshot.angmom[it->second].s != float(0.0) ||
-                snapshot.angmom[it->second].v.x != float(0.0) ||
-                snapshot.angmom[it->second].v.y != float(0.0) ||
-                snapshot.angmom[it->second].v.z != float(0.0))
+            if (snapshot.angmom[snap_id].s != float(0.0) ||
+                snapshot.angmom[snap_id].v.x != float(0.0) ||
+                snapshot.angmom[snap_id].v.y != float(0.0) ||
+                snapshot.angmom[snap_id].v.z != float(0.0))
                 {
                 all_default = false;
                 }
 
-            data[group_idx*4+0] = float(snapshot.angmom[it->second].s);
-            data[group_idx*4+1] = float(snapshot.angmom[it->second].v.x);
-            data[group_idx*4+2] = float(snapshot.angmom[it->second].v.y);
-            data[group_idx*4+3] = float(snapshot.angmom[it->second].v.z);
+            data[group_idx*4+0] = float(snapshot.angmom[snap_id].s);
+            data[group_idx*4+1] = float(snapshot.angmom[snap_id].v.x);
+            data[group_idx*4+2] = float(snapshot.angmom[snap_id].v.y);
+            data[group_idx*4+3] = float(snapshot.angmom[snap_id].v.z);
             }
 
         if (!all_default || (nframes > 0 && m_nondefault["particles/angmom"]))
             {
-            m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/angmom" << endl;
+            m_writer.notice(10) << "dump.gsd: writing particles/angmom" << endl;
             retval = gsd_write_chunk(&m_handle, "particles/angmom", GSD_TYPE_FLOAT, N, 4, 0, (void *)&data[0]);
             checkError(retval);
             if (nframes == 0)
@@ -686,27 +924,27 @@ void GSDDumpWriter::writeMomenta(const SnapshotParticleData<float>& snapshot, co
 
         for (unsigned int group_idx = 0; group_idx < N; group_idx++)
             {
-            unsigned int t = m_group->getMemberTag(group_idx);
+            unsigned int t = frame.group_tags[group_idx];
 
             // look up tag in snapshot
-            auto it = map.find(t);
-            assert(it != map.end());
+            unsigned int snap_id = snap_idx[t];
+            assert(snap_id != NOT_LOCAL);
 
-            if (snapshot.image[it->second].x != 0 ||
-                snapshot.image[it->second].y != 0 ||
-                snapshot.image[it->second].z != 0)
+            if (snapshot.image[snap_id].x != 0 ||
+                snapshot.image[snap_id].y != 0 ||
+                snapshot.image[snap_id].z != 0)
                 {
                 all_default = false;
                 }
 
-            data[group_idx*3+0] = float(snapshot.image[it->second].x);
-            data[group_idx*3+1] = float(snapshot.image[it->second].y);
-            data[group_idx*3+2] = float(snapshot.image[it->second].z);
+            data[group_idx*3+0] = float(snapshot.image[snap_id].x);
+            data[group_idx*3+1] = float(snapshot.image[snap_id].y);
+            data[group_idx*3+2] = float(snapshot.image[snap_id].z);
             }
 
         if (!all_default || (nframes > 0 && m_nondefault["particles/image"]))
             {
-            m_exec_conf->msg->notice(10) << "dump.gsd: writing particles/image" << endl;
+            m_writer.notice(10) << "dump.gsd: writing particles/image" << endl;
             retval = gsd_write_chunk(&m_handle, "particles/image", GSD_TYPE_INT32, N, 3, 0, (void *)&data[0]);
             checkError(retval);
             if (nframes == 0)
@@ -715,133 +953,625 @@ void GSDDumpWriter::writeMomenta(const SnapshotParticleData<float>& snapshot, co
         }
     }
 
-/*! \param bond Bond data snapshot
-    \param angle Angle data snapshot
-    \param dihedral Dihedral data snapshot
-    \param improper Improper data snapshot
-    \param constraint Constraint data snapshot
-    \param pair Special pair data snapshot
+/*! \param frame Frame with the topology to write
 
-    Write out all the snapshot data to the GSD file
+    Write out the snapshots of the bonded group types selected for the frame. The number of groups of a selected type
+    is written even when it is zero, so that removed groups do not fall back to frame 0.
 */
-void GSDDumpWriter::writeTopology(BondData::Snapshot& bond,
-                                  AngleData::Snapshot& angle,
-                                  DihedralData::Snapshot& dihedral,
-                                  ImproperData::Snapshot& improper,
-                                  ConstraintData::Snapshot& constraint,
-                                  PairData::Snapshot& pair)
+void GSDDumpWriter::writeTopology(const Frame& frame)
     {
-    if (bond.size > 0)
+    if (frame.bond)
         {
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing bonds/N" << endl;
+        const BondData::Snapshot& bond = *frame.bond;
+        m_writer.notice(10) << "dump.gsd: writing bonds/N" << endl;
         uint32_t N = bond.size;
         int retval = gsd_write_chunk(&m_handle, "bonds/N", GSD_TYPE_UINT32, 1, 1, 0, (void *)&N);
         checkError(retval);
 
-        writeTypeMapping("bonds/types", bond.type_mapping);
+        if (N > 0)
+            {
+            writeTypeMapping("bonds/types", bond.type_mapping);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing bonds/typeid" << endl;
-        retval = gsd_write_chunk(&m_handle, "bonds/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&bond.type_id[0]);
-        checkError(retval);
+            m_writer.notice(10) << "dump.gsd: writing bonds/typeid" << endl;
+            retval = gsd_write_chunk(&m_handle, "bonds/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&bond.type_id[0]);
+            checkError(retval);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing bonds/group" << endl;
-        retval = gsd_write_chunk(&m_handle, "bonds/group", GSD_TYPE_UINT32, N, 2, 0, (void *)&bond.groups[0]);
-        checkError(retval);
+            m_writer.notice(10) << "dump.gsd: writing bonds/group" << endl;
+            retval = gsd_write_chunk(&m_handle, "bonds/group", GSD_TYPE_UINT32, N, 2, 0, (void *)&bond.groups[0]);
+            checkError(retval);
+            }
         }
-    if (angle.size > 0)
+    if (frame.angle)
         {
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing angles/N" << endl;
+        const AngleData::Snapshot& angle = *frame.angle;
+        m_writer.notice(10) << "dump.gsd: writing angles/N" << endl;
         uint32_t N = angle.size;
         int retval = gsd_write_chunk(&m_handle, "angles/N", GSD_TYPE_UINT32, 1, 1, 0, (void *)&N);
         checkError(retval);
 
-        writeTypeMapping("angles/types", angle.type_mapping);
+        if (N > 0)
+            {
+            writeTypeMapping("angles/types", angle.type_mapping);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing angles/typeid" << endl;
-        retval = gsd_write_chunk(&m_handle, "angles/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&angle.type_id[0]);
-        checkError(retval);
+            m_writer.notice(10) << "dump.gsd: writing angles/typeid" << endl;
+            retval = gsd_write_chunk(&m_handle, "angles/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&angle.type_id[0]);
+            checkError(retval);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing angles/group" << endl;
-        retval = gsd_write_chunk(&m_handle, "angles/group", GSD_TYPE_UINT32, N, 3, 0, (void *)&angle.groups[0]);
-        checkError(retval);
+            m_writer.notice(10) << "dump.gsd: writing angles/group" << endl;
+            retval = gsd_write_chunk(&m_handle, "angles/group", GSD_TYPE_UINT32, N, 3, 0, (void *)&angle.groups[0]);
+            checkError(retval);
+            }
         }
-    if (dihedral.size > 0)
+    if (frame.dihedral)
         {
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing dihedrals/N" << endl;
+        const DihedralData::Snapshot& dihedral = *frame.dihedral;
+        m_writer.notice(10) << "dump.gsd: writing dihedrals/N" << endl;
         uint32_t N = dihedral.size;
         int retval = gsd_write_chunk(&m_handle, "dihedrals/N", GSD_TYPE_UINT32, 1, 1, 0, (void *)&N);
         checkError(retval);
 
-        writeTypeMapping("dihedrals/types", dihedral.type_mapping);
+        if (N > 0)
+            {
+            writeTypeMapping("dihedrals/types", dihedral.type_mapping);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing dihedrals/typeid" << endl;
-        retval = gsd_write_chunk(&m_handle, "dihedrals/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&dihedral.type_id[0]);
-        checkError(retval);
+            m_writer.notice(10) << "dump.gsd: writing dihedrals/typeid" << endl;
+            retval = gsd_write_chunk(&m_handle, "dihedrals/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&dihedral.type_id[0]);
+            checkError(retval);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing dihedrals/group" << endl;
-        retval = gsd_write_chunk(&m_handle, "dihedrals/group", GSD_TYPE_UINT32, N, 4, 0, (void *)&dihedral.groups[0]);
-        checkError(retval);
+            m_writer.notice(10) << "dump.gsd: writing dihedrals/group" << endl;
+            retval = gsd_write_chunk(&m_handle, "dihedrals/group", GSD_TYPE_UINT32, N, 4, 0, (void *)&dihedral.groups[0]);
+            checkError(retval);
+            }
         }
-    if (improper.size > 0)
+    if (frame.improper)
         {
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing impropers/N" << endl;
+        const ImproperData::Snapshot& improper = *frame.improper;
+        m_writer.notice(10) << "dump.gsd: writing impropers/N" << endl;
         uint32_t N = improper.size;
         int retval = gsd_write_chunk(&m_handle, "impropers/N", GSD_TYPE_UINT32, 1, 1, 0, (void *)&N);
         checkError(retval);
 
-        writeTypeMapping("impropers/types", improper.type_mapping);
+        if (N > 0)
+            {
+            writeTypeMapping("impropers/types", improper.type_mapping);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing impropers/typeid" << endl;
-        retval = gsd_write_chunk(&m_handle, "impropers/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&improper.type_id[0]);
-        checkError(retval);
+            m_writer.notice(10) << "dump.gsd: writing impropers/typeid" << endl;
+            retval = gsd_write_chunk(&m_handle, "impropers/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&improper.type_id[0]);
+            checkError(retval);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing impropers/group" << endl;
-        retval = gsd_write_chunk(&m_handle, "impropers/group", GSD_TYPE_UINT32, N, 4, 0, (void *)&improper.groups[0]);
-        checkError(retval);
+            m_writer.notice(10) << "dump.gsd: writing impropers/group" << endl;
+            retval = gsd_write_chunk(&m_handle, "impropers/group", GSD_TYPE_UINT32, N, 4, 0, (void *)&improper.groups[0]);
+            checkError(retval);
+            }
         }
 
-    if (constraint.size > 0)
+    if (frame.constraint)
         {
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing constraints/N" << endl;
+        const ConstraintData::Snapshot& constraint = *frame.constraint;
+        m_writer.notice(10) << "dump.gsd: writing constraints/N" << endl;
         uint32_t N = constraint.size;
         int retval = gsd_write_chunk(&m_handle, "constraints/N", GSD_TYPE_UINT32, 1, 1, 0, (void *)&N);
         checkError(retval);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing constraints/value" << endl;
+        if (N > 0)
             {
-            std::vector<float> data(N);
-            data.reserve(1); //! make sure we allocate
-            for (unsigned int i = 0; i < N; i++)
-                data[i] = float(constraint.val[i]);
+            m_writer.notice(10) << "dump.gsd: writing constraints/value" << endl;
+                {
+                std::vector<float> data(N);
+                data.reserve(1); //! make sure we allocate
+                for (unsigned int i = 0; i < N; i++)
+                    data[i] = float(constraint.val[i]);
+
+                retval = gsd_write_chunk(&m_handle, "constraints/value", GSD_TYPE_FLOAT, N, 1, 0, (void *)&data[0]);
+                checkError(retval);
+                }
 
-            retval = gsd_write_chunk(&m_handle, "constraints/value", GSD_TYPE_FLOAT, N, 1, 0, (void *)&data[0]);
+            m_writer.notice(10) << "dump.gsd: writing constraints/group" << endl;
+            retval = gsd_write_chunk(&m_handle, "constraints/group", GSD_TYPE_UINT32, N, 2, 0, (void *)&constraint.groups[0]);
             checkError(retval);
             }
-
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing constraints/group" << endl;
-        retval = gsd_write_chunk(&m_handle, "constraints/group", GSD_TYPE_UINT32, N, 2, 0, (void *)&constraint.groups[0]);
-        checkError(retval);
         }
 
-    if (pair.size > 0)
+    if (frame.pair)
         {
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing pairs/N" << endl;
+        const PairData::Snapshot& pair = *frame.pair;
+        m_writer.notice(10) << "dump.gsd: writing pairs/N" << endl;
         uint32_t N = pair.size;
         int retval = gsd_write_chunk(&m_handle, "pairs/N", GSD_TYPE_UINT32, 1, 1, 0, (void *)&N);
         checkError(retval);
 
-        writeTypeMapping("pairs/types", pair.type_mapping);
+        if (N > 0)
+            {
+            writeTypeMapping("pairs/types", pair.type_mapping);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing pairs/typeid" << endl;
-        retval = gsd_write_chunk(&m_handle, "pairs/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&pair.type_id[0]);
-        checkError(retval);
+            m_writer.notice(10) << "dump.gsd: writing pairs/typeid" << endl;
+            retval = gsd_write_chunk(&m_handle, "pairs/typeid", GSD_TYPE_UINT32, N, 1, 0, (void *)&pair.type_id[0]);
+            checkError(retval);
 
-        m_exec_conf->msg->notice(10) << "dump.gsd: writing pairs/group" << endl;
-        retval = gsd_write_chunk(&m_handle, "pairs/group", GSD_TYPE_UINT32, N, 2, 0, (void *)&pair.groups[0]);
-        checkError(retval);
+            m_writer.notice(10) << "dump.gsd: writing pairs/group" << endl;
+            retval = gsd_write_chunk(&m_handle, "pairs/group", GSD_TYPE_UINT32, N, 2, 0, (void *)&pair.groups[0]);
+            checkError(retval);
+            }
+        }
+    }
+
+/*! \param data Bonded group data to gather
+    \param cache Last snapshot of \a data
+    \param nframes Number of frames in the file, before this frame
+    \returns The snapshot to write in this frame, or NULL if the type is not written
+
+    \a data is only gathered when its modification count differs from the count of the cached snapshot. Frame 0 gets
+    all types that have groups. Later frames get the types that changed since the frame 0 written by this writer, or
+    all types when appending to a file written by someone else. This is a collective call.
+*/
+template<class Data>
+std::shared_ptr<const typename Data::Snapshot> GSDDumpWriter::updateTopology(const Data& data,
+                                                                             TopologyCache<typename Data::Snapshot>& cache,
+                                                                             uint64_t nframes)
+    {
+    // the modification count is the same on all ranks, so all ranks take part in the gather
+    uint64_t count = data.getModificationCount();
+    if (! cache.valid || cache.count != count)
+        {
+        m_writer.notice(10) << "dump.gsd: taking " << Data::getName() << " data snapshot" << endl;
+
+        // the tag lookup of the groups is not needed
+        std::shared_ptr<typename Data::Snapshot> snapshot(new typename Data::Snapshot());
+        std::vector<unsigned int> group_snap_idx;
+        data.takeSnapshot(*snapshot, group_snap_idx);
+
+        cache.snapshot = snapshot;
+        cache.count = count;
+        cache.valid = true;
+        }
+
+    if (nframes == 0)
+        {
+        cache.frame0_count = count;
+        cache.frame0_valid = true;
+        if (cache.snapshot->size == 0)
+            return std::shared_ptr<const typename Data::Snapshot>();
+        return cache.snapshot;
+        }
+
+    // readers take the unchanged data from frame 0
+    if (cache.frame0_valid && cache.frame0_count == count)
+        return std::shared_ptr<const typename Data::Snapshot>();
+
+    return cache.snapshot;
+    }
+
+#ifdef ENABLE_MPI
+namespace
+    {
+    //! Data of one particle, sent to the rank that writes it out
+    struct ParticleRecord
+        {
+        uint32_t group_idx;     //!< Index of the particle in the group
+        uint32_t type;          //!< Type id
+        float mass;             //!< Mass
+        float charge;           //!< Charge
+        float diameter;         //!< Diameter
+        int32_t body;           //!< Rigid body id
+        float inertia[3];       //!< Principal moments of inertia
+        float pos[3];           //!< Position, wrapped into the global box
+        float orientation[4];   //!< Orientation quaternion
+        float vel[3];           //!< Velocity
+        float angmom[4];        //!< Angular momentum quaternion
+        int32_t image[3];       //!< Image flags
+        };
+    }
+
+/*! \param frame Frame to write out
+    \param nframes Number of frames in the file, before this frame
+
+    Writes the same particle data chunks as writeAttributes(), writeProperties() and writeMomenta() without gathering
+    the particles on the root rank. Rank r writes the group members with group indices in [N*r/P, N*(r+1)/P), so
+    every chunk is stored in group order. This is a collective call.
+*/
+void GSDDumpWriter::writeParticlesParallel(const Frame& frame, uint64_t nframes)
+    {
+    const MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+    unsigned int nranks = m_exec_conf->getNRanks();
+    unsigned int rank = m_exec_conf->getRank();
+    unsigned int N = frame.N;
+
+    // first group index written by every rank
+    std::vector<unsigned int> first(nranks+1);
+    for (unsigned int r = 0; r <= nranks; r++)
+        first[r] = (unsigned int)((uint64_t)N * r / nranks);
+
+    // pack the local group members together with their destination rank
+    unsigned int n_local = m_group->getNumMembers();
+    std::vector<ParticleRecord> records(n_local);
+    std::vector<unsigned int> dest(n_local);
+
+        {
+        // access the group arrays first, they may access the tags when the group is rebuilt
+        ArrayHandle<unsigned int> h_member_idx(m_group->getIndexArray(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_member_tags(m_group->getMemberTagArray(), access_location::host, access_mode::read);
+
+        ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_charge(m_pdata->getCharges(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_diameter(m_pdata->getDiameters(), access_location::host, access_mode::read);
+        ArrayHandle<int3> h_image(m_pdata->getImages(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_body(m_pdata->getBodies(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_orientation(m_pdata->getOrientationArray(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_angmom(m_pdata->getAngularMomentumArray(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar3> h_inertia(m_pdata->getMomentsOfInertiaArray(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_tag(m_pdata->getTags(), access_location::host, access_mode::read);
+
+        const BoxDim& global_box = m_pdata->getGlobalBox();
+        Scalar3 origin = m_pdata->getOrigin();
+        int3 o_image = m_pdata->getOriginImage();
+
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, n_local),
+            [&](const tbb::blocked_range<unsigned int>& r)
+            {
+            for (unsigned int j = r.begin(); j != r.end(); ++j)
+        #else
+        for (unsigned int j = 0; j < n_local; j++)
+        #endif
+                {
+                unsigned int idx = h_member_idx.data[j];
+                ParticleRecord& p = records[j];
+
+                // the member tags are sorted, so the group index follows from a binary search
+                const unsigned int *member = std::lower_bound(h_member_tags.data, h_member_tags.data + N, h_tag.data[idx]);
+                p.group_idx = member - h_member_tags.data;
+
+                p.type = __scalar_as_int(h_pos.data[idx].w);
+                p.mass = float(h_vel.data[idx].w);
+                p.charge = float(h_charge.data[idx]);
+                p.diameter = float(h_diameter.data[idx]);
+                p.body = int32_t(h_body.data[idx]);
+                p.inertia[0] = float(h_inertia.data[idx].x);
+                p.inertia[1] = float(h_inertia.data[idx].y);
+                p.inertia[2] = float(h_inertia.data[idx].z);
+
+                // positions are written relative to the origin and wrapped into the box, like in the snapshot
+                Scalar3 pos = make_scalar3(h_pos.data[idx].x, h_pos.data[idx].y, h_pos.data[idx].z) - origin;
+                int3 image = h_image.data[idx];
+                image.x -= o_image.x;
+                image.y -= o_image.y;
+                image.z -= o_image.z;
+                global_box.wrap(pos, image);
+
+                p.pos[0] = float(pos.x);
+                p.pos[1] = float(pos.y);
+                p.pos[2] = float(pos.z);
+                p.image[0] = image.x;
+                p.image[1] = image.y;
+                p.image[2] = image.z;
+
+                p.orientation[0] = float(h_orientation.data[idx].x);
+                p.orientation[1] = float(h_orientation.data[idx].y);
+                p.orientation[2] = float(h_orientation.data[idx].z);
+                p.orientation[3] = float(h_orientation.data[idx].w);
+                p.vel[0] = float(h_vel.data[idx].x);
+                p.vel[1] = float(h_vel.data[idx].y);
+                p.vel[2] = float(h_vel.data[idx].z);
+                p.angmom[0] = float(h_angmom.data[idx].x);
+                p.angmom[1] = float(h_angmom.data[idx].y);
+                p.angmom[2] = float(h_angmom.data[idx].z);
+                p.angmom[3] = float(h_angmom.data[idx].w);
+
+                dest[j] = std::upper_bound(first.begin(), first.end(), p.group_idx) - first.begin() - 1;
+                }
+        #ifdef ENABLE_TBB
+            });
+        #endif
+        }
+
+    // sort the records by destination rank
+    std::vector<int> send_counts(nranks, 0);
+    for (unsigned int j = 0; j < n_local; j++)
+        send_counts[dest[j]]++;
+
+    std::vector<int> send_displs(nranks, 0);
+    for (unsigned int r = 1; r < nranks; r++)
+        send_displs[r] = send_displs[r-1] + send_counts[r-1];
+
+    std::vector<ParticleRecord> send_buf(n_local);
+        {
+        std::vector<int> offset(send_displs);
+        for (unsigned int j = 0; j < n_local; j++)
+            send_buf[offset[dest[j]]++] = records[j];
+        }
+
+    // exchange the records
+    std::vector<int> recv_counts(nranks);
+    MPI_Alltoall(&send_counts[0], 1, MPI_INT, &recv_counts[0], 1, MPI_INT, mpi_comm);
+
+    std::vector<int> recv_displs(nranks, 0);
+    for (unsigned int r = 1; r < nranks; r++)
+        recv_displs[r] = recv_displs[r-1] + recv_counts[r-1];
+    unsigned int n_recv = recv_displs[nranks-1] + recv_counts[nranks-1];
+
+    MPI_Datatype mpi_record;
+    MPI_Type_contiguous(sizeof(ParticleRecord), MPI_BYTE, &mpi_record);
+    MPI_Type_commit(&mpi_record);
+
+    std::vector<ParticleRecord> recv_buf(n_recv);
+    MPI_Alltoallv(send_buf.data(), &send_counts[0], &send_displs[0], mpi_record,
+                  recv_buf.data(), &recv_counts[0], &recv_displs[0], mpi_record, mpi_comm);
+    MPI_Type_free(&mpi_record);
+
+    // every rank must have received exactly its range of particles
+    unsigned int begin = first[rank];
+    unsigned int n = first[rank+1] - first[rank];
+    int complete = n_recv == n;
+    MPI_Allreduce(MPI_IN_PLACE, &complete, 1, MPI_INT, MPI_LAND, mpi_comm);
+    if (! complete)
+        {
+        throw runtime_error("dump.gsd: Group members are missing or duplicated on the ranks");
+        }
+
+    // scatter the records into the chunk slices of this rank
+    std::vector<const ParticleRecord *> sorted(n);
+    for (unsigned int i = 0; i < n_recv; i++)
+        sorted[recv_buf[i].group_idx - begin] = &recv_buf[i];
+
+    MPI_File fh;
+    int retval = MPI_File_open(mpi_comm, (char *)m_fname.c_str(), MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+    if (retval != MPI_SUCCESS)
+        {
+        throw runtime_error("dump.gsd: Unable to open " + m_fname + " with MPI-IO");
+        }
+
+    if (frame.write_attribute)
+        {
+        if (m_exec_conf->isRoot())
+            {
+            std::vector<std::string> type_mapping;
+            for (unsigned int i = 0; i < m_pdata->getNTypes(); i++)
+                type_mapping.push_back(m_pdata->getNameByType(i));
+            writeTypeMapping("particles/types", type_mapping);
+            }
+
+        std::vector<uint32_t> type(n);
+        bool all_default = true;
+        for (unsigned int i = 0; i < n; i++)
+            {
+            type[i] = sorted[i]->type;
+            if (type[i] != 0)
+                all_default = false;
+            }
+        writeChunkParallel(fh, "particles/typeid", GSD_TYPE_UINT32, N, 1, begin, type, true, all_default, nframes);
+
+        std::vector<float> data(n);
+        all_default = true;
+        for (unsigned int i = 0; i < n; i++)
+            {
+            data[i] = sorted[i]->mass;
+            if (data[i] != float(1.0))
+                all_default = false;
+            }
+        writeChunkParallel(fh, "particles/mass", GSD_TYPE_FLOAT, N, 1, begin, data, true, all_default, nframes);
+
+        all_default = true;
+        for (unsigned int i = 0; i < n; i++)
+            {
+            data[i] = sorted[i]->charge;
+            if (data[i] != float(0.0))
+                all_default = false;
+            }
+        writeChunkParallel(fh, "particles/charge", GSD_TYPE_FLOAT, N, 1, begin, data, true, all_default, nframes);
+
+        all_default = true;
+        for (unsigned int i = 0; i < n; i++)
+            {
+            data[i] = sorted[i]->diameter;
+            if (data[i] != float(1.0))
+                all_default = false;
+            }
+        writeChunkParallel(fh, "particles/diameter", GSD_TYPE_FLOAT, N, 1, begin, data, true, all_default, nframes);
+
+        std::vector<int32_t> body(n);
+        all_default = true;
+        for (unsigned int i = 0; i < n; i++)
+            {
+            body[i] = sorted[i]->body;
+            if (body[i] != int32_t(NO_BODY))
+                all_default = false;
+            }
+        writeChunkParallel(fh, "particles/body", GSD_TYPE_INT32, N, 1, begin, body, true, all_default, nframes);
+
+        data.resize(n*3);
+        all_default = true;
+        for (unsigned int i = 0; i < n; i++)
+            {
+            for (unsigned int k = 0; k < 3; k++)
+                {
+                data[i*3+k] = sorted[i]->inertia[k];
+                if (data[i*3+k] != float(0.0))
+                    all_default = false;
+                }
+            }
+        writeChunkParallel(fh, "particles/moment_inertia", GSD_TYPE_FLOAT, N, 3, begin, data, true, all_default, nframes);
+        }
+
+    if (frame.write_property)
+        {
+        std::vector<float> data(n*3);
+        for (unsigned int i = 0; i < n; i++)
+            for (unsigned int k = 0; k < 3; k++)
+                data[i*3+k] = sorted[i]->pos[k];
+        if (m_position_bits > 0)
+            {
+            // the encoded slices have different sizes, and the root rank's slice starts with the header
+            std::vector<uint8_t> stream;
+            encodePositions(frame.box, data.data(), n, begin, N, nframes, true, stream);
+
+            uint64_t size = stream.size();
+            uint64_t offset = 0;
+            uint64_t total = 0;
+            MPI_Exscan(&size, &offset, 1, MPI_UINT64_T, MPI_SUM, mpi_comm);
+            MPI_Allreduce(&size, &total, 1, MPI_UINT64_T, MPI_SUM, mpi_comm);
+            if (rank == 0)
+                offset = 0;
+
+            writeChunkParallel(fh, "particles/position_quantized", GSD_TYPE_UINT8, total, 1, offset, stream, false, false, nframes);
+            }
+        else
+            {
+            writeChunkParallel(fh, "particles/position", GSD_TYPE_FLOAT, N, 3, begin, data, false, false, nframes);
+            }
+
+        data.resize(n*4);
+        bool all_default = true;
+        for (unsigned int i = 0; i < n; i++)
+            {
+            for (unsigned int k = 0; k < 4; k++)
+                {
+                data[i*4+k] = sorted[i]->orientation[k];
+                if (data[i*4+k] != (k == 0 ? float(1.0) : float(0.0)))
+                    all_default = false;
+                }
+            }
+        writeChunkParallel(fh, "particles/orientation", GSD_TYPE_FLOAT, N, 4, begin, data, true, all_default, nframes);
+        }
+
+    if (frame.write_momentum)
+        {
+        std::vector<float> data(n*3);
+        bool all_default = true;
+        for (unsigned int i = 0; i < n; i++)
+            {
+            for (unsigned int k = 0; k < 3; k++)
+                {
+                data[i*3+k] = sorted[i]->vel[k];
+                if (data[i*3+k] != float(0.0))
+                    all_default = false;
+                }
+            }
+        writeChunkParallel(fh, "particles/velocity", GSD_TYPE_FLOAT, N, 3, begin, data, true, all_default, nframes);
+
+        data.resize(n*4);
+        all_default = true;
+        for (unsigned int i = 0; i < n; i++)
+            {
+            for (unsigned int k = 0; k < 4; k++)
+                {
+                data[i*4+k] = sorted[i]->angmom[k];
+                if (data[i*4+k] != float(0.0))
+                    all_default = false;
+                }
+            }
+        writeChunkParallel(fh, "particles/angmom", GSD_TYPE_FLOAT, N, 4, begin, data, true, all_default, nframes);
+
+        std::vector<int32_t> image(n*3);
+        all_default = true;
+        for (unsigned int i = 0; i < n; i++)
+            {
+            for (unsigned int k = 0; k < 3; k++)
+                {
+                image[i*3+k] = sorted[i]->image[k];
+                if (image[i*3+k] != 0)
+                    all_default = false;
+                }
+            }
+        writeChunkParallel(fh, "particles/image", GSD_TYPE_INT32, N, 3, begin, image, true, all_default, nframes);
         }
+
+    // the data must be in the file before the root rank ends the frame
+    MPI_File_close(&fh);
+    MPI_Barrier(mpi_comm);
     }
 
+/*! \param fh MPI-IO handle of the file
+    \param name Name of the chunk
+    \param type Type of the chunk
+    \param N Number of rows in the chunk
+    \param M Number of columns in the chunk
+    \param first First row written by this rank
+    \param data Rows written by this rank
+    \param check_default True if the chunk is omitted when all values are default
+    \param all_default True if all local values are default
+    \param nframes Number of frames in the file, before this frame
+
+    The root rank writes the chunk through gsd_write_chunk(), with its own rows in place and zeros for the rows of
+    the other ranks. gsd appends the chunk data at the end of the file, so its location is the size of the file
+    before the write. The root rank broadcasts the location, then the other ranks write their rows into the chunk.
+    This is a collective call.
+*/
+template<class T>
+void GSDDumpWriter::writeChunkParallel(MPI_File fh,
+                                       const std::string& name,
+                                       gsd_type type,
+                                       uint64_t N,
+                                       uint32_t M,
+                                       uint64_t first,
+                                       const std::vector<T>& data,
+                                       bool check_default,
+                                       bool all_default,
+                                       uint64_t nframes)
+    {
+    const MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+    bool root = m_exec_conf->isRoot();
+    assert(sizeof(T) == gsd_sizeof_type(type));
+
+    if (check_default)
+        {
+        // skip chunks that are default on all ranks, unless they are present in frame 0
+        int write = !all_default;
+        MPI_Allreduce(MPI_IN_PLACE, &write, 1, MPI_INT, MPI_LOR, mpi_comm);
+        if (root)
+            write = write || (nframes > 0 && m_nondefault[name]);
+        MPI_Bcast(&write, 1, MPI_INT, 0, mpi_comm);
+        if (! write)
+            return;
+        }
+
+    int64_t location = 0;
+    int retval = 0;
+    if (root)
+        {
+        m_writer.notice(10) << "dump.gsd: writing " << name << endl;
+
+        std::vector<T> chunk(N*M);
+        std::copy(data.begin(), data.end(), chunk.begin() + first*M);
+
+        location = m_handle.file_size;
+        retval = gsd_write_chunk(&m_handle, name.c_str(), type, N, M, 0, (void *)chunk.data());
+        if (retval != 0)
+            location = -1;
+        else if (check_default && nframes == 0)
+            m_nondefault[name] = true;
+        }
+    MPI_Bcast(&location, 1, MPI_INT64_T, 0, mpi_comm);
+
+    if (location < 0)
+        {
+        if (root)
+            checkError(retval);
+        throw runtime_error("dump.gsd: Error writing " + name + " to " + m_fname);
+        }
+
+    // count elements instead of bytes, so that slices larger than 2 GiB do not overflow the int count
+    int valid = data.size() <= size_t(std::numeric_limits<int>::max());
+    MPI_Allreduce(MPI_IN_PLACE, &valid, 1, MPI_INT, MPI_LAND, mpi_comm);
+    if (! valid)
+        throw runtime_error("dump.gsd: Too many rows of " + name + " on one rank to write to " + m_fname);
+
+    MPI_Datatype mpi_element;
+    MPI_Type_contiguous(sizeof(T), MPI_BYTE, &mpi_element);
+    MPI_Type_commit(&mpi_element);
+
+    // the rows of the root rank are already in the file
+    MPI_Offset offset = location + MPI_Offset(first) * M * sizeof(T);
+    MPI_Status status;
+    retval = MPI_File_write_at_all(fh, offset, (void *)data.data(), root ? 0 : int(data.size()), mpi_element, &status);
+    MPI_Type_free(&mpi_element);
+    if (retval != MPI_SUCCESS)
+        {
+        throw runtime_error("dump.gsd: MPI-IO error writing " + name + " to " + m_fname);
+        }
+    }
+#endif
+
 /*! Populate the m_nondefault map.
     Set entries to true when they exist in frame 0 of the file, otherwise, set them to false.
 */
@@ -924,5 +1654,9 @@ void export_GSDDumpWriter(py::module& m)
         .def("setWriteProperty", &GSDDumpWriter::setWriteProperty)
         .def("setWriteMomentum", &GSDDumpWriter::setWriteMomentum)
         .def("setWriteTopology", &GSDDumpWriter::setWriteTopology)
+        .def("setBufferFrames", &GSDDumpWriter::setBufferFrames)
+        .def("flush", &GSDDumpWriter::flush)
+        .def("setParallelWrite", &GSDDumpWriter::setParallelWrite)
+        .def("setPositionQuantization", &GSDDumpWriter::setPositionQuantization)
     ;
     }
@@ -11,6 +11,7 @@
 
 #include <string>
 #include <memory>
+#include "BackgroundWriter.h"
 #include "hoomd/extern/gsd.h"
 
 /*! \file GSDDumpWriter.h
@@ -31,6 +32,25 @@
     On the first call to analyze() \a fname is created with a dcd header. If it already
     exists, append to the file (unless the user specifies overwrite=True).
 
+    When frames are buffered (setBufferFrames()), analyze() only gathers the snapshots into a Frame and a writer thread
+    on the root rank writes them to the file in the background. The frames queued for the writer are limited, and
+    analyze() waits for the writer when the queue is full. Frames are written synchronously once a slot has been
+    connected to the write signal, as the slots write to the file handle directly.
+
+    In parallel mode (setParallelWrite()), the particle data is not gathered on the root rank. Every rank writes a
+    contiguous range of the group members with MPI-IO: the particles are first sent to the rank that owns their range
+    of group indices, the root rank reserves each particle data chunk in the file and all ranks write their slice of
+    it. The root rank still writes the frame header, the topology and the chunk index. Parallel writes are synchronous.
+
+    With position quantization (setPositionQuantization()), particles/position is replaced by the lossy
+    particles/position_quantized chunk (see GSDPositionCodec), with a keyframe every few frames and deltas to the
+    keyframe in between. GSDReader decodes the chunk transparently.
+
+    Topology is gathered only when the modification count of a bonded group type (see
+    BondedGroupData::getModificationCount()) changed since the last gather, the root rank keeps the last snapshot of
+    every type and reuses it otherwise. A type is written to a frame only if it changed since frame 0 of the file,
+    readers take the unchanged types from frame 0.
+
     \ingroup analyzers
 */
 class PYBIND11_EXPORT GSDDumpWriter : public Analyzer
@@ -73,9 +93,68 @@ class PYBIND11_EXPORT GSDDumpWriter : public Analyzer
         //! Write out the data for the current timestep
         void analyze(unsigned int timestep);
 
-        hoomd::detail::SharedSignal<int (gsd_handle&)>& getWriteSignal() { return m_write_signal; }
+        //! Set the number of frames that are written in the background
+        void setBufferFrames(unsigned int buffer_frames);
+
+        //! Wait until all buffered frames are written
+        virtual void flush();
+
+        //! Write the particle data from all ranks in parallel
+        void setParallelWrite(bool parallel)
+            {
+            m_parallel = parallel;
+            }
+
+        //! Write quantized positions
+        void setPositionQuantization(unsigned int bits, unsigned int keyframe_period);
+
+        hoomd::detail::SharedSignal<int (gsd_handle&)>& getWriteSignal()
+            {
+            // slots write to the handle, so frames can no longer be written in the background
+            m_write_signal_requested = true;
+            return m_write_signal;
+            }
 
     private:
+        //! Data of one frame, captured by analyze()
+        struct Frame
+            {
+            unsigned int timestep;                  //!< Time step of the frame
+            BoxDim box;                             //!< Global simulation box
+            unsigned int N;                         //!< Number of particles in the frame
+            unsigned int dimensions;                //!< Number of dimensions
+            std::vector<unsigned int> group_tags;   //!< Tags of the group members
+            SnapshotParticleData<float> snapshot;   //!< Particle data
+            std::vector<unsigned int> snap_idx;     //!< Snapshot index of every particle tag
+            bool write_attribute;                   //!< True if attributes are written in this frame
+            bool write_property;                    //!< True if properties are written in this frame
+            bool write_momentum;                    //!< True if momenta are written in this frame
+            bool write_topology;                    //!< True if topology is written in this frame
+            std::shared_ptr<const BondData::Snapshot> bond;             //!< Bonds (NULL if not written)
+            std::shared_ptr<const AngleData::Snapshot> angle;           //!< Angles (NULL if not written)
+            std::shared_ptr<const DihedralData::Snapshot> dihedral;     //!< Dihedrals (NULL if not written)
+            std::shared_ptr<const ImproperData::Snapshot> improper;     //!< Impropers (NULL if not written)
+            std::shared_ptr<const ConstraintData::Snapshot> constraint; //!< Constraints (NULL if not written)
+            std::shared_ptr<const PairData::Snapshot> pair;             //!< Special pairs (NULL if not written)
+            };
+
+        //! Last gathered snapshot of one bonded group type
+        template<class Snapshot>
+        struct TopologyCache
+            {
+            //! Constructor
+            TopologyCache()
+                : count(0), valid(false), frame0_count(0), frame0_valid(false)
+                {
+                }
+
+            std::shared_ptr<const Snapshot> snapshot; //!< Last gathered snapshot (only filled on the root rank)
+            uint64_t count;                           //!< Modification count of the snapshot
+            bool valid;                               //!< True if the snapshot has been gathered
+            uint64_t frame0_count;                    //!< Modification count of the data written to frame 0
+            bool frame0_valid;                        //!< True if frame 0 was written by this writer
+            };
+
         std::string m_fname;                //!< The file name we are writing to
         bool m_overwrite;                   //!< True if file should be overwritten
         bool m_truncate;                    //!< True if we should truncate the file on every analyze()
@@ -91,31 +170,88 @@ class PYBIND11_EXPORT GSDDumpWriter : public Analyzer
 
         hoomd::detail::SharedSignal<int (gsd_handle&)> m_write_signal;
 
+        uint64_t m_nframes;                         //!< Number of frames in the file, including queued frames
+        unsigned int m_buffer_frames;               //!< Maximum number of queued frames (0 to write synchronously)
+        bool m_write_signal_requested;              //!< True if slots may be connected to the write signal
+        BackgroundWriter m_writer;                  //!< Writes the buffered frames on the root rank
+        bool m_parallel;                            //!< True if all ranks write the particle data with MPI-IO
+
+        unsigned int m_position_bits;               //!< Bits per quantized coordinate (0 to write plain positions)
+        unsigned int m_keyframe_period;             //!< Number of frames between position keyframes
+        std::vector<uint32_t> m_keyframe_q;         //!< Quantized coordinates of the last keyframe (local slice)
+        uint64_t m_keyframe_frame;                  //!< Frame of the last keyframe
+        unsigned int m_keyframe_first;              //!< First particle of the local slice of the last keyframe
+
+        TopologyCache<BondData::Snapshot> m_bond_cache;             //!< Last bond snapshot
+        TopologyCache<AngleData::Snapshot> m_angle_cache;           //!< Last angle snapshot
+        TopologyCache<DihedralData::Snapshot> m_dihedral_cache;     //!< Last dihedral snapshot
+        TopologyCache<ImproperData::Snapshot> m_improper_cache;     //!< Last improper snapshot
+        TopologyCache<ConstraintData::Snapshot> m_constraint_cache; //!< Last constraint snapshot
+        TopologyCache<PairData::Snapshot> m_pair_cache;             //!< Last special pair snapshot
+
         //! Write a type mapping out to the file
         void writeTypeMapping(std::string chunk, std::vector< std::string > type_mapping);
 
         //! Initializes the output file for writing
         void initFileIO();
 
+        //! Truncate the file
+        void truncateFile();
+
+        //! Write all data chunks of a frame
+        void writeFrame(const Frame& frame);
+
         //! Write frame header
-        void writeFrameHeader(unsigned int timestep);
+        void writeFrameHeader(const Frame& frame);
 
         //! Write particle attributes
-        void writeAttributes(const SnapshotParticleData<float>& snapshot, const std::map<unsigned int, unsigned int> &map);
+        void writeAttributes(const Frame& frame);
 
         //! Write particle properties
-        void writeProperties(const SnapshotParticleData<float>& snapshot, const std::map<unsigned int, unsigned int> &map);
+        void writeProperties(const Frame& frame);
 
         //! Write particle momenta
-        void writeMomenta(const SnapshotParticleData<float>& snapshot, const std::map<unsigned int, unsigned int> &map);
+        void writeMomenta(const Frame& frame);
+
+        //! Quantize and encode positions, deciding whether this frame is a keyframe
+        void encodePositions(const BoxDim& box,
+                             const float *pos,
+                             unsigned int n,
+                             unsigned int first,
+                             uint32_t N,
+                             uint64_t nframes,
+                             bool parallel,
+                             std::vector<uint8_t>& stream);
+
+        //! Gather a bonded group type if it changed and select it for the frame
+        template<class Data>
+        std::shared_ptr<const typename Data::Snapshot> updateTopology(const Data& data,
+                                                                      TopologyCache<typename Data::Snapshot>& cache,
+                                                                      uint64_t nframes);
 
         //! Write bond topology
-        void writeTopology(BondData::Snapshot& bond,
-                           AngleData::Snapshot& angle,
-                           DihedralData::Snapshot& dihedral,
-                           ImproperData::Snapshot& improper,
-                           ConstraintData::Snapshot& constraint,
-                           PairData::Snapshot& pair);
+        void writeTopology(const Frame& frame);
+
+        //! Queue a frame for the writer thread
+        void queueFrame(std::shared_ptr<Frame> frame);
+
+        #ifdef ENABLE_MPI
+        //! Write the particle data chunks from all ranks
+        void writeParticlesParallel(const Frame& frame, uint64_t nframes);
+
+        //! Write one rank's slice of a particle data chunk
+        template<class T>
+        void writeChunkParallel(MPI_File fh,
+                                const std::string& name,
+                                gsd_type type,
+                                uint64_t N,
+                                uint32_t M,
+                                uint64_t first,
+                                const std::vector<T>& data,
+                                bool check_default,
+                                bool all_default,
+                                uint64_t nframes);
+        #endif
 
         //! Check and raise an exception if an error occurs
         void checkError(int retval);
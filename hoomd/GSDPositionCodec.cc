@@ -0,0 +1,278 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file GSDPositionCodec.cc
+    \brief Defines the GSDPositionCodec class
+*/
+
+#include "GSDPositionCodec.h"
+
+#ifdef ENABLE_TBB
+#include <tbb/tbb.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+//! Map a signed difference to an unsigned value, small magnitudes to small values
+inline uint32_t zigzag_encode(int32_t d)
+    {
+    return (uint32_t(d) << 1) ^ uint32_t(d >> 31);
+    }
+
+//! Inverse of zigzag_encode()
+inline int32_t zigzag_decode(uint32_t u)
+    {
+    return int32_t(u >> 1) ^ -int32_t(u & 1);
+    }
+
+//! Number of bits needed to store a value
+inline unsigned int bit_width(uint32_t v)
+    {
+    unsigned int w = 0;
+    while (v)
+        {
+        v >>= 1;
+        w++;
+        }
+    return w;
+    }
+
+/*! \param box Box the positions are in
+    \param pos Positions (3*N floats), wrapped into the box
+    \param N Number of particles
+    \param bits Bits per coordinate
+    \param q Output quantized coordinates (3*N values)
+*/
+void GSDPositionCodec::quantize(const BoxDim& box, const float *pos, unsigned int N, unsigned int bits, uint32_t *q)
+    {
+    const Scalar scale = Scalar(uint32_t(1) << bits);
+    const uint32_t q_max = (uint32_t(1) << bits) - 1;
+
+    #ifdef ENABLE_TBB
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, N),
+        [&](const tbb::blocked_range<unsigned int>& r)
+        {
+        for (unsigned int i = r.begin(); i != r.end(); ++i)
+    #else
+    for (unsigned int i = 0; i < N; i++)
+    #endif
+            {
+            Scalar3 f = box.makeFraction(make_scalar3(pos[3*i], pos[3*i+1], pos[3*i+2]));
+
+            // positions on the upper boundary (and round off) are clamped into the box
+            Scalar fq[3] = {f.x * scale, f.y * scale, f.z * scale};
+            for (unsigned int k = 0; k < 3; k++)
+                {
+                Scalar v = std::max(Scalar(0.0), fq[k]);
+                q[3*i+k] = std::min(uint32_t(v), q_max);
+                }
+            }
+    #ifdef ENABLE_TBB
+        });
+    #endif
+    }
+
+/*! \param box Box the positions are in
+    \param q Quantized coordinates (3*N values)
+    \param N Number of particles
+    \param bits Bits per coordinate
+    \param pos Output positions (3*N floats), at the centers of the quantization cells
+*/
+void GSDPositionCodec::dequantize(const BoxDim& box, const uint32_t *q, unsigned int N, unsigned int bits, float *pos)
+    {
+    const Scalar inv_scale = Scalar(1.0) / Scalar(uint32_t(1) << bits);
+
+    #ifdef ENABLE_TBB
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, N),
+        [&](const tbb::blocked_range<unsigned int>& r)
+        {
+        for (unsigned int i = r.begin(); i != r.end(); ++i)
+    #else
+    for (unsigned int i = 0; i < N; i++)
+    #endif
+            {
+            Scalar3 f = make_scalar3((Scalar(q[3*i]) + Scalar(0.5)) * inv_scale,
+                                     (Scalar(q[3*i+1]) + Scalar(0.5)) * inv_scale,
+                                     (Scalar(q[3*i+2]) + Scalar(0.5)) * inv_scale);
+            Scalar3 p = box.makeCoordinates(f);
+            pos[3*i] = float(p.x);
+            pos[3*i+1] = float(p.y);
+            pos[3*i+2] = float(p.z);
+            }
+    #ifdef ENABLE_TBB
+        });
+    #endif
+    }
+
+/*! \param q Quantized coordinates
+    \param q_key Quantized coordinates of the keyframe, or NULL to encode a keyframe
+    \param n_values Number of values in \a q (and \a q_key)
+    \param bits Bits per coordinate
+    \param out Stream to append the blocks to
+
+    The bit width of every block is chosen independently. The widths are determined and the blocks are packed in
+    parallel, only the block offsets are accumulated serially.
+*/
+void GSDPositionCodec::encode(const uint32_t *q,
+                              const uint32_t *q_key,
+                              size_t n_values,
+                              unsigned int bits,
+                              std::vector<uint8_t>& out)
+    {
+    const uint32_t mask = (uint32_t(1) << bits) - 1;
+    const unsigned int shift = 32 - bits;
+    size_t n_blocks = (n_values + block_size - 1) / block_size;
+
+    // value to store for element i
+    auto value = [&](size_t i) -> uint32_t
+        {
+        if (q_key == NULL)
+            return q[i];
+
+        // sign extend the difference modulo 2^bits
+        int32_t d = int32_t(((q[i] - q_key[i]) & mask) << shift) >> shift;
+        return zigzag_encode(d);
+        };
+
+    // determine the bit width of every block
+    std::vector<uint8_t> width(n_blocks);
+    #ifdef ENABLE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, n_blocks),
+        [&](const tbb::blocked_range<size_t>& r)
+        {
+        for (size_t b = r.begin(); b != r.end(); ++b)
+    #else
+    for (size_t b = 0; b < n_blocks; b++)
+    #endif
+            {
+            size_t end = std::min(n_values, (b+1)*block_size);
+            uint32_t all = 0;
+            for (size_t i = b*block_size; i < end; i++)
+                all |= value(i);
+            width[b] = bit_width(all);
+            }
+    #ifdef ENABLE_TBB
+        });
+    #endif
+
+    // offset of every block in the stream
+    std::vector<size_t> offset(n_blocks+1);
+    offset[0] = out.size();
+    for (size_t b = 0; b < n_blocks; b++)
+        {
+        size_t count = std::min(n_values - b*block_size, size_t(block_size));
+        offset[b+1] = offset[b] + 2 + (count * width[b] + 7) / 8;
+        }
+    out.resize(offset[n_blocks], 0);
+
+    // pack the blocks
+    #ifdef ENABLE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, n_blocks),
+        [&](const tbb::blocked_range<size_t>& r)
+        {
+        for (size_t b = r.begin(); b != r.end(); ++b)
+    #else
+    for (size_t b = 0; b < n_blocks; b++)
+    #endif
+            {
+            size_t begin = b*block_size;
+            size_t count = std::min(n_values - begin, size_t(block_size));
+            unsigned int w = width[b];
+
+            uint8_t *dst = &out[offset[b]];
+            *dst++ = uint8_t(w);
+            *dst++ = uint8_t(count);
+
+            // pack the values least significant bit first
+            uint64_t acc = 0;
+            unsigned int n_acc = 0;
+            for (size_t i = begin; i < begin + count; i++)
+                {
+                acc |= uint64_t(value(i)) << n_acc;
+                n_acc += w;
+                while (n_acc >= 8)
+                    {
+                    *dst++ = uint8_t(acc);
+                    acc >>= 8;
+                    n_acc -= 8;
+                    }
+                }
+            if (n_acc > 0)
+                *dst = uint8_t(acc);
+            }
+    #ifdef ENABLE_TBB
+        });
+    #endif
+    }
+
+/*! \param data Stream of blocks
+    \param size Size of \a data in bytes
+    \param q_key Quantized coordinates of the keyframe for the decoded values, or NULL for a keyframe
+    \param first Index of the first value to decode
+    \param n_values Number of values to decode
+    \param bits Bits per coordinate
+    \param q Output quantized coordinates (\a n_values values)
+    \returns false if the stream is truncated or invalid
+
+    The blocks before \a first are skipped by their headers, without unpacking them.
+*/
+bool GSDPositionCodec::decode(const uint8_t *data,
+                              size_t size,
+                              const uint32_t *q_key,
+                              size_t first,
+                              size_t n_values,
+                              unsigned int bits,
+                              uint32_t *q)
+    {
+    const uint32_t mask = (uint32_t(1) << bits) - 1;
+    size_t pos = 0;
+    size_t value_idx = 0;
+    size_t end = first + n_values;
+
+    while (value_idx < end)
+        {
+        if (pos + 2 > size)
+            return false;
+
+        unsigned int w = data[pos];
+        size_t count = data[pos+1];
+        size_t n_bytes = (count * w + 7) / 8;
+        if (w > bits || count == 0 || pos + 2 + n_bytes > size)
+            return false;
+
+        if (value_idx + count > first)
+            {
+            // unpack the block
+            const uint8_t *src = data + pos + 2;
+            const uint32_t value_mask = w == 32 ? 0xffffffff : (uint32_t(1) << w) - 1;
+            uint64_t acc = 0;
+            unsigned int n_acc = 0;
+            for (size_t i = value_idx; i < value_idx + count; i++)
+                {
+                while (n_acc < w)
+                    {
+                    acc |= uint64_t(*src++) << n_acc;
+                    n_acc += 8;
+                    }
+                uint32_t v = uint32_t(acc) & value_mask;
+                acc >>= w;
+                n_acc -= w;
+
+                if (i >= first && i < end)
+                    {
+                    if (q_key == NULL)
+                        q[i - first] = v;
+                    else
+                        q[i - first] = (q_key[i - first] + uint32_t(zigzag_decode(v))) & mask;
+                    }
+                }
+            }
+
+        value_idx += count;
+        pos += 2 + n_bytes;
+        }
+
+    return true;
+    }
@@ -0,0 +1,83 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+/*! \file GSDPositionCodec.h
+    \brief Declares the GSDPositionCodec class
+*/
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+#ifndef __GSD_POSITION_CODEC_H__
+#define __GSD_POSITION_CODEC_H__
+
+#include "BoxDim.h"
+
+#include <hoomd/extern/pybind/include/pybind11/pybind11.h>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+//! Lossy compression of particle positions in GSD files
+/*! Positions are quantized to fractional coordinates of the box with a fixed number of bits per coordinate,
+    so that the error is at most L/2^(bits+1) along every box vector. A keyframe stores the quantized coordinates
+    directly, the following frames store the difference to the last keyframe. Differences are taken modulo 2^bits,
+    so particles that cross a periodic boundary stay small.
+
+    The chunk particles/position_quantized (UINT8) starts with a Header, followed by blocks of up to block_size
+    values. The values are the quantized x,y,z coordinates of the particles in order, zig-zag encoded differences in
+    delta frames. Every block starts with two bytes, the bit width w and the number of values c, followed by
+    ceil(c*w/8) bytes holding the values packed with w bits each, least significant bit first. Blocks are self
+    describing, so streams encoded independently for consecutive ranges of particles can be concatenated.
+
+    \ingroup utils
+*/
+class PYBIND11_EXPORT GSDPositionCodec
+    {
+    public:
+        //! Header of an encoded position chunk
+        struct Header
+            {
+            uint8_t version;            //!< Format version
+            uint8_t bits;               //!< Bits per quantized coordinate
+            uint8_t keyframe;           //!< 1 for a keyframe, 0 for a delta to a keyframe
+            uint8_t reserved;           //!< Unused, always 0
+            uint32_t N;                 //!< Number of particles
+            uint64_t keyframe_frame;    //!< Frame of the keyframe that the chunk refers to
+            };
+
+        //! Maximum number of values in a block
+        static const unsigned int block_size = 64;
+
+        //! Smallest supported number of bits per coordinate
+        static const unsigned int min_bits = 4;
+
+        //! Largest supported number of bits per coordinate (the precision of a float)
+        static const unsigned int max_bits = 24;
+
+        //! Quantize positions to fractional coordinates of the box
+        static void quantize(const BoxDim& box, const float *pos, unsigned int N, unsigned int bits, uint32_t *q);
+
+        //! Convert quantized coordinates back to positions
+        static void dequantize(const BoxDim& box, const uint32_t *q, unsigned int N, unsigned int bits, float *pos);
+
+        //! Append encoded blocks of quantized coordinates to a stream
+        static void encode(const uint32_t *q,
+                           const uint32_t *q_key,
+                           size_t n_values,
+                           unsigned int bits,
+                           std::vector<uint8_t>& out);
+
+        //! Decode a range of values from a stream of blocks
+        static bool decode(const uint8_t *data,
+                           size_t size,
+                           const uint32_t *q_key,
+                           size_t first,
+                           size_t n_values,
+                           unsigned int bits,
+                           uint32_t *q);
+    };
+
+#endif
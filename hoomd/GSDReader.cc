@@ -9,10 +9,13 @@
 */
 
 #include "GSDReader.h"
+#include "GSDPositionCodec.h"
 #include "SnapshotSystemData.h"
+#include "SystemDefinition.h"
 #include "ExecutionConfiguration.h"
 #include "hoomd/extern/gsd.h"
 #include <string.h>
+#include <sys/mman.h>
 
 #include <stdexcept>
 using namespace std;
@@ -23,21 +26,28 @@ namespace py = pybind11;
     \param name File name to read
     \param frame Frame index to read from the file
     \param from_end Count frames back from the end of the file
+    \param distributed Read the particles on all ranks with initializeDistributed()
 
     The GSDReader constructor opens the GSD file, initializes an empty snapshot, and reads the file into
-    memory (on the root rank).
+    memory (on the root rank). In distributed mode, all ranks open the file and map it into memory, and the
+    particles are read later by initializeDistributed(). Distributed mode only applies to MPI runs with more than
+    one rank.
 */
 GSDReader::GSDReader(std::shared_ptr<const ExecutionConfiguration> exec_conf,
                      const std::string &name,
                      const uint64_t frame,
-                     bool from_end)
-    : m_exec_conf(exec_conf), m_timestep(0), m_name(name), m_frame(frame)
+                     bool from_end,
+                     bool distributed)
+    : m_exec_conf(exec_conf), m_timestep(0), m_name(name), m_frame(frame), m_distributed(false), m_N(0),
+      m_mapped(NULL), m_mapped_size(0)
     {
     m_snapshot = std::shared_ptr< SnapshotSystemData<float> >(new SnapshotSystemData<float>);
 
     #ifdef ENABLE_MPI
+    m_distributed = distributed && m_exec_conf->getNRanks() > 1;
+
     // if we are not the root processor, do not perform file I/O
-    if (!m_exec_conf->isRoot())
+    if (!m_exec_conf->isRoot() && !m_distributed)
         {
         return;
         }
@@ -102,15 +112,42 @@ GSDReader::GSDReader(std::shared_ptr<const ExecutionConfiguration> exec_conf,
         }
 
     readHeader();
-    readParticles();
-    readTopology();
+
+    if (m_distributed)
+        {
+        m_snapshot->particle_data.type_mapping = readTypes(m_frame, "particles/types");
+
+        // map the file, the particles are read from the mapping by initializeDistributed()
+        m_mapped_size = m_handle.file_size;
+        void *mapped = mmap(NULL, m_mapped_size, PROT_READ, MAP_SHARED, m_handle.fd, 0);
+        if (mapped == MAP_FAILED)
+            {
+            m_exec_conf->msg->error() << "data.gsd_snapshot: " << strerror(errno) << " - " << name << endl;
+            throw runtime_error("Error opening GSD file");
+            }
+        m_mapped = (const char *)mapped;
+
+        // the topology can only be added after the particles
+        if (m_exec_conf->isRoot())
+            {
+            m_topology = std::shared_ptr< SnapshotSystemData<float> >(new SnapshotSystemData<float>);
+            readTopology(*m_topology);
+            }
+        }
+    else
+        {
+        readParticles();
+        readTopology(*m_snapshot);
+        }
     }
 
 GSDReader::~GSDReader()
     {
+    unmapFile();
+
     #ifdef ENABLE_MPI
     // if we are not the root processor, do not perform file I/O
-    if (!m_exec_conf->isRoot())
+    if (!m_exec_conf->isRoot() && !m_distributed)
         {
         return;
         }
@@ -119,6 +156,17 @@ GSDReader::~GSDReader()
     gsd_close(&m_handle);
     }
 
+//! Release the memory mapping of the file
+void GSDReader::unmapFile()
+    {
+    if (m_mapped != NULL)
+        {
+        munmap((void *)m_mapped, m_mapped_size);
+        m_mapped = NULL;
+        m_mapped_size = 0;
+        }
+    }
+
 /*! \param data Pointer to data to read into
     \param frame Frame index to read from
     \param name Name of the data chunk
@@ -264,7 +312,11 @@ void GSDReader::readHeader()
         m_exec_conf->msg->error() << "data.gsd_snapshot: " << "cannot read a file with 0 particles" << endl;
         throw runtime_error("Error reading GSD file");
         }
-    m_snapshot->particle_data.resize(N);
+    m_N = N;
+
+    // in distributed mode, the particles are read into the slices of the ranks
+    if (! m_distributed)
+        m_snapshot->particle_data.resize(N);
     }
 
 /*! Read the same data chunks for particles
@@ -282,68 +334,288 @@ void GSDReader::readParticles()
     readChunk(&m_snapshot->particle_data.diameter[0], m_frame, "particles/diameter", N*4, N);
     readChunk(&m_snapshot->particle_data.body[0], m_frame, "particles/body", N*4, N);
     readChunk(&m_snapshot->particle_data.inertia[0], m_frame, "particles/moment_inertia", N*12, N);
-    readChunk(&m_snapshot->particle_data.pos[0], m_frame, "particles/position", N*12, N);
+    if (hasQuantizedPositions() || ! readChunk(&m_snapshot->particle_data.pos[0], m_frame, "particles/position", N*12, N))
+        readQuantizedPositions((float *)&m_snapshot->particle_data.pos[0], 0, N);
     readChunk(&m_snapshot->particle_data.orientation[0], m_frame, "particles/orientation", N*16, N);
     readChunk(&m_snapshot->particle_data.vel[0], m_frame, "particles/velocity", N*12, N);
     readChunk(&m_snapshot->particle_data.angmom[0], m_frame, "particles/angmom", N*16, N);
     readChunk(&m_snapshot->particle_data.image[0], m_frame, "particles/image", N*12, N);
     }
 
-/*! Read the same data chunks for topology
+/*! \param data Pointer to data to read into
+    \param name Name of the particle data chunk
+    \param row_size Size of one row (particle) of the chunk in bytes
+    \param first First row to read
+    \param n Number of rows to read
+
+    Like readChunk(), but copies only the rows [first, first+n) out of the memory mapped file of the current frame
+    (or frame 0). Return true if data is actually read from the file.
+*/
+bool GSDReader::readChunkSlice(void *data, const char *name, size_t row_size, unsigned int first, unsigned int n)
+    {
+    const struct gsd_index_entry* entry = gsd_find_chunk(&m_handle, m_frame, name);
+    if (entry == NULL && m_frame != 0)
+        entry = gsd_find_chunk(&m_handle, 0, name);
+
+    if (entry == NULL || entry->N != m_N)
+        {
+        m_exec_conf->msg->notice(10) << "data.gsd_snapshot: chunk not found " << name << endl;
+        return false;
+        }
+
+    m_exec_conf->msg->notice(7) << "data.gsd_snapshot: reading rows " << first << " to " << first+n
+                                << " of chunk " << name << endl;
+    size_t actual_size = entry->N * entry->M * gsd_sizeof_type((enum gsd_type)entry->type);
+    if (actual_size != m_N * row_size)
+        {
+        m_exec_conf->msg->error() << "data.gsd_snapshot: " << "Expecting " << m_N * row_size << " bytes in " << name << " but found " << actual_size << endl;
+        throw runtime_error("Error reading GSD file");
+        }
+    if (entry->location < 0 || size_t(entry->location) + actual_size > m_mapped_size)
+        {
+        m_exec_conf->msg->error() << "data.gsd_snapshot: " << "Invalid GSD file " << m_name << endl;
+        throw runtime_error("Error reading GSD file");
+        }
+
+    memcpy(data, m_mapped + entry->location + size_t(first) * row_size, size_t(n) * row_size);
+    return true;
+    }
+
+/*! \param entry Index entry of the chunk
+    \param buffer Buffer to read the chunk into when the file is not mapped
+    \returns Pointer to the chunk data
+*/
+const uint8_t *GSDReader::getChunkData(const struct gsd_index_entry *entry, std::vector<uint8_t>& buffer)
+    {
+    size_t size = entry->N * entry->M * gsd_sizeof_type((enum gsd_type)entry->type);
+
+    if (m_mapped != NULL)
+        {
+        if (entry->location < 0 || size_t(entry->location) + size > m_mapped_size)
+            {
+            m_exec_conf->msg->error() << "data.gsd_snapshot: " << "Invalid GSD file " << m_name << endl;
+            throw runtime_error("Error reading GSD file");
+            }
+        return (const uint8_t *)m_mapped + entry->location;
+        }
+
+    buffer.resize(size);
+    int retval = gsd_read_chunk(&m_handle, buffer.data(), entry);
+    if (retval == -1)
+        {
+        m_exec_conf->msg->error() << "data.gsd_snapshot: " << strerror(errno) << " - " << m_name << endl;
+        throw runtime_error("Error reading GSD file");
+        }
+    else if (retval != 0)
+        {
+        m_exec_conf->msg->error() << "data.gsd_snapshot: " << "Invalid GSD file " << m_name << endl;
+        throw runtime_error("Error reading GSD file");
+        }
+    return buffer.data();
+    }
+
+/*! \param pos Positions to read into (3*n floats)
+    \param first First particle to read
+    \param n Number of particles to read
+
+    Decodes the particles/position_quantized chunk written by GSDDumpWriter (see GSDPositionCodec). Delta frames are
+    applied to the keyframe they refer to. Return true if data is actually read from the file.
+*/
+bool GSDReader::readQuantizedPositions(float *pos, unsigned int first, unsigned int n)
+    {
+    const char *name = "particles/position_quantized";
+    const struct gsd_index_entry* entry = gsd_find_chunk(&m_handle, m_frame, name);
+    if (entry == NULL && m_frame != 0)
+        entry = gsd_find_chunk(&m_handle, 0, name);
+
+    if (entry == NULL)
+        {
+        m_exec_conf->msg->notice(10) << "data.gsd_snapshot: chunk not found " << name << endl;
+        return false;
+        }
+
+    m_exec_conf->msg->notice(7) << "data.gsd_snapshot: reading chunk " << name << endl;
+
+    // read and validate the header of a chunk
+    GSDPositionCodec::Header header;
+    auto read_header = [&](const struct gsd_index_entry *e, const uint8_t *data) -> bool
+        {
+        if (e->type != GSD_TYPE_UINT8 || e->M != 1 || e->N < sizeof(header))
+            return false;
+        memcpy(&header, data, sizeof(header));
+        return header.version == 1 && header.bits >= GSDPositionCodec::min_bits
+               && header.bits <= GSDPositionCodec::max_bits && header.N == m_N;
+        };
+
+    std::vector<uint8_t> buffer;
+    const uint8_t *data = getChunkData(entry, buffer);
+    if (! read_header(entry, data))
+        {
+        m_exec_conf->msg->error() << "data.gsd_snapshot: " << "Invalid " << name << " in " << m_name << endl;
+        throw runtime_error("Error reading GSD file");
+        }
+
+    std::vector<uint32_t> q(3*n);
+    bool valid = true;
+    if (header.keyframe)
+        {
+        valid = GSDPositionCodec::decode(data + sizeof(header), entry->N - sizeof(header), NULL,
+                                         3*size_t(first), 3*size_t(n), header.bits, q.data());
+        }
+    else
+        {
+        // decode the keyframe first
+        unsigned int bits = header.bits;
+        const struct gsd_index_entry* key_entry = gsd_find_chunk(&m_handle, header.keyframe_frame, name);
+        std::vector<uint8_t> key_buffer;
+        const uint8_t *key_data = key_entry ? getChunkData(key_entry, key_buffer) : NULL;
+        if (key_data == NULL || ! read_header(key_entry, key_data) || ! header.keyframe || header.bits != bits)
+            {
+            m_exec_conf->msg->error() << "data.gsd_snapshot: " << "Missing keyframe of " << name << " in " << m_name << endl;
+            throw runtime_error("Error reading GSD file");
+            }
+
+        std::vector<uint32_t> q_key(3*n);
+        valid = GSDPositionCodec::decode(key_data + sizeof(header), key_entry->N - sizeof(header), NULL,
+                                         3*size_t(first), 3*size_t(n), bits, q_key.data())
+                && GSDPositionCodec::decode(data + sizeof(header), entry->N - sizeof(header), q_key.data(),
+                                            3*size_t(first), 3*size_t(n), bits, q.data());
+        header.bits = bits;
+        }
+
+    if (! valid)
+        {
+        m_exec_conf->msg->error() << "data.gsd_snapshot: " << "Corrupt " << name << " in " << m_name << endl;
+        throw runtime_error("Error reading GSD file");
+        }
+
+    GSDPositionCodec::dequantize(m_snapshot->global_box, q.data(), n, header.bits, pos);
+    return true;
+    }
+
+/*! The quantized positions of the current frame take precedence over the full positions of frame 0, which
+    readChunk() and readChunkSlice() fall back to.
+*/
+bool GSDReader::hasQuantizedPositions()
+    {
+    return gsd_find_chunk(&m_handle, m_frame, "particles/position") == NULL
+           && gsd_find_chunk(&m_handle, m_frame, "particles/position_quantized") != NULL;
+    }
+
+/*! \param sysdef System definition constructed from getSnapshot()
+
+    Every rank reads the particles [N*r/P, N*(r+1)/P) from the mapped file and ParticleData sends them to the ranks
+    that own them. Then the topology is initialized from the root rank. This is a collective call.
+*/
+void GSDReader::initializeDistributed(std::shared_ptr<SystemDefinition> sysdef)
+    {
+    if (! m_distributed)
+        {
+        m_exec_conf->msg->error() << "data.gsd_snapshot: " << m_name << " was not opened for distributed reading" << endl;
+        throw runtime_error("Error reading GSD file");
+        }
+
+    #ifdef ENABLE_MPI
+    unsigned int nranks = m_exec_conf->getNRanks();
+    unsigned int rank = m_exec_conf->getRank();
+    unsigned int first = (unsigned int)((uint64_t)m_N * rank / nranks);
+    unsigned int n = (unsigned int)((uint64_t)m_N * (rank+1) / nranks) - first;
+
+    SnapshotParticleData<float> slice(n);
+    slice.type_mapping = m_snapshot->particle_data.type_mapping;
+
+    // the slice already has default values, if a chunk is not found, the value
+    // is already at the default, and the failed read is not a problem
+    readChunkSlice(slice.type.data(), "particles/typeid", 4, first, n);
+    readChunkSlice(slice.mass.data(), "particles/mass", 4, first, n);
+    readChunkSlice(slice.charge.data(), "particles/charge", 4, first, n);
+    readChunkSlice(slice.diameter.data(), "particles/diameter", 4, first, n);
+    readChunkSlice(slice.body.data(), "particles/body", 4, first, n);
+    readChunkSlice(slice.inertia.data(), "particles/moment_inertia", 12, first, n);
+    if (hasQuantizedPositions() || ! readChunkSlice(slice.pos.data(), "particles/position", 12, first, n))
+        readQuantizedPositions((float *)slice.pos.data(), first, n);
+    readChunkSlice(slice.orientation.data(), "particles/orientation", 16, first, n);
+    readChunkSlice(slice.vel.data(), "particles/velocity", 12, first, n);
+    readChunkSlice(slice.angmom.data(), "particles/angmom", 16, first, n);
+    readChunkSlice(slice.image.data(), "particles/image", 12, first, n);
+
+    // the particles are no longer needed
+    unmapFile();
+
+    sysdef->getParticleData()->initializeFromDistributedSnapshot(slice, first, m_N);
+
+    // the bonded groups are added on the ranks that hold their particles, the root rank holds the topology
+    SnapshotSystemData<float> empty;
+    const SnapshotSystemData<float>& topology = m_topology ? *m_topology : empty;
+
+    sysdef->getBondData()->initializeFromSnapshot(topology.bond_data);
+    sysdef->getAngleData()->initializeFromSnapshot(topology.angle_data);
+    sysdef->getDihedralData()->initializeFromSnapshot(topology.dihedral_data);
+    sysdef->getImproperData()->initializeFromSnapshot(topology.improper_data);
+    sysdef->getConstraintData()->initializeFromSnapshot(topology.constraint_data);
+    sysdef->getPairData()->initializeFromSnapshot(topology.pair_data);
+
+    m_topology.reset();
+    #endif
+    }
+
+/*! \param snapshot Snapshot to read the topology into
+
+    Read the same data chunks for topology
 */
-void GSDReader::readTopology()
+void GSDReader::readTopology(SnapshotSystemData<float>& snapshot)
     {
     unsigned int N = 0;
     readChunk(&N, m_frame, "bonds/N", 4);
     if (N > 0)
         {
-        m_snapshot->bond_data.resize(N);
-        m_snapshot->bond_data.type_mapping = readTypes(m_frame, "bonds/types");
-        readChunk(&m_snapshot->bond_data.type_id[0], m_frame, "bonds/typeid", N*4, N);
-        readChunk(&m_snapshot->bond_data.groups[0], m_frame, "bonds/group", N*8, N);
+        snapshot.bond_data.resize(N);
+        snapshot.bond_data.type_mapping = readTypes(m_frame, "bonds/types");
+        readChunk(&snapshot.bond_data.type_id[0], m_frame, "bonds/typeid", N*4, N);
+        readChunk(&snapshot.bond_data.groups[0], m_frame, "bonds/group", N*8, N);
         }
 
     N = 0;
     readChunk(&N, m_frame, "angles/N", 4);
     if (N > 0)
         {
-        m_snapshot->angle_data.resize(N);
-        m_snapshot->angle_data.type_mapping = readTypes(m_frame, "angles/types");
-        readChunk(&m_snapshot->angle_data.type_id[0], m_frame, "angles/typeid", N*4, N);
-        readChunk(&m_snapshot->angle_data.groups[0], m_frame, "angles/group", N*12, N);
+        snapshot.angle_data.resize(N);
+        snapshot.angle_data.type_mapping = readTypes(m_frame, "angles/types");
+        readChunk(&snapshot.angle_data.type_id[0], m_frame, "angles/typeid", N*4, N);
+        readChunk(&snapshot.angle_data.groups[0], m_frame, "angles/group", N*12, N);
         }
 
     N = 0;
     readChunk(&N, m_frame, "dihedrals/N", 4);
     if (N > 0)
         {
-        m_snapshot->dihedral_data.resize(N);
-        m_snapshot->dihedral_data.type_mapping = readTypes(m_frame, "dihedrals/types");
-        readChunk(&m_snapshot->dihedral_data.type_id[0], m_frame, "dihedrals/typeid", N*4, N);
-        readChunk(&m_snapshot->dihedral_data.groups[0], m_frame, "dihedrals/group", N*16, N);
+        snapshot.dihedral_data.resize(N);
+        snapshot.dihedral_data.type_mapping = readTypes(m_frame, "dihedrals/types");
+        readChunk(&snapshot.dihedral_data.type_id[0], m_frame, "dihedrals/typeid", N*4, N);
+        readChunk(&snapshot.dihedral_data.groups[0], m_frame, "dihedrals/group", N*16, N);
         }
 
     N = 0;
     readChunk(&N, m_frame, "impropers/N", 4);
     if (N > 0)
         {
-        m_snapshot->improper_data.resize(N);
-        m_snapshot->improper_data.type_mapping = readTypes(m_frame, "impropers/types");
-        readChunk(&m_snapshot->improper_data.type_id[0], m_frame, "impropers/typeid", N*4, N);
-        readChunk(&m_snapshot->improper_data.groups[0], m_frame, "impropers/group", N*16, N);
+        snapshot.improper_data.resize(N);
+        snapshot.improper_data.type_mapping = readTypes(m_frame, "impropers/types");
+        readChunk(&snapshot.improper_data.type_id[0], m_frame, "impropers/typeid", N*4, N);
+        readChunk(&snapshot.improper_data.groups[0], m_frame, "impropers/group", N*16, N);
         }
 
     N = 0;
     readChunk(&N, m_frame, "constraints/N", 4);
     if (N > 0)
         {
-        m_snapshot->constraint_data.resize(N);
+        snapshot.constraint_data.resize(N);
         std::vector<float> data(N);
         readChunk(&data[0], m_frame, "constraints/value", N*4, N);
         for (unsigned int i=0; i < N; i++)
-            m_snapshot->constraint_data.val[i] = Scalar(data[i]);
+            snapshot.constraint_data.val[i] = Scalar(data[i]);
 
-        readChunk(&m_snapshot->constraint_data.groups[0], m_frame, "constraints/group", N*8, N);
+        readChunk(&snapshot.constraint_data.groups[0], m_frame, "constraints/group", N*8, N);
         }
 
     if (m_handle.header.schema_version >= gsd_make_version(1,1))
@@ -352,10 +624,10 @@ void GSDReader::readTopology()
         readChunk(&N, m_frame, "pairs/N", 4);
         if (N > 0)
             {
-            m_snapshot->pair_data.resize(N);
-            m_snapshot->pair_data.type_mapping = readTypes(m_frame, "pairs/types");
-            readChunk(&m_snapshot->pair_data.type_id[0], m_frame, "pairs/typeid", N*4, N);
-            readChunk(&m_snapshot->pair_data.groups[0], m_frame, "pairs/group", N*8, N);
+            snapshot.pair_data.resize(N);
+            snapshot.pair_data.type_mapping = readTypes(m_frame, "pairs/types");
+            readChunk(&snapshot.pair_data.type_id[0], m_frame, "pairs/typeid", N*4, N);
+            readChunk(&snapshot.pair_data.groups[0], m_frame, "pairs/group", N*8, N);
             }
         }
     }
@@ -364,8 +636,10 @@ void export_GSDReader(py::module& m)
     {
     py::class_< GSDReader, std::shared_ptr<GSDReader> >(m,"GSDReader")
     .def(py::init<std::shared_ptr<const ExecutionConfiguration>, const string&, const uint64_t, bool>())
+    .def(py::init<std::shared_ptr<const ExecutionConfiguration>, const string&, const uint64_t, bool, bool>())
     .def("getTimeStep", &GSDReader::getTimeStep)
     .def("getSnapshot", &GSDReader::getSnapshot)
     .def("clearSnapshot", &GSDReader::clearSnapshot)
+    .def("initializeDistributed", &GSDReader::initializeDistributed)
     ;
     }
@@ -25,11 +25,18 @@
 
 //! Forward declarations
 template <class Real> struct SnapshotSystemData;
+class SystemDefinition;
 
 //! Reads a GSD input file
 /*! Read an input GSD file and generate a system snapshot. GSDReader can read any frame from a GSD
     file into the snapshot. For information on the GSD specification, see http://gsd.readthedocs.io/
 
+    In distributed mode, all ranks open the file and map it into memory. The snapshot only holds the header and the
+    particle types, and the topology is kept aside on the root rank. After the SystemDefinition has been constructed
+    from the snapshot, initializeDistributed() reads a contiguous slice of the particles on every rank directly from
+    the mapped file and hands the slices to ParticleData::initializeFromDistributedSnapshot(), which sends every
+    particle to the rank that owns it. The topology is added once the particles are in place.
+
     \ingroup data_structs
 */
 class PYBIND11_EXPORT GSDReader
@@ -39,7 +46,8 @@ class PYBIND11_EXPORT GSDReader
         GSDReader(std::shared_ptr<const ExecutionConfiguration> exec_conf,
                   const std::string &name,
                   const uint64_t frame,
-                  bool from_end);
+                  bool from_end,
+                  bool distributed=false);
 
         //! Destructor
         ~GSDReader();
@@ -85,6 +93,9 @@ class PYBIND11_EXPORT GSDReader
             return m_handle;
             }
 
+        //! Read the particles on all ranks and initialize the system (distributed mode)
+        void initializeDistributed(std::shared_ptr<SystemDefinition> sysdef);
+
     private:
         std::shared_ptr<const ExecutionConfiguration> m_exec_conf; //!< The execution configuration
         uint64_t m_timestep;                                         //!< Timestep at the selected frame
@@ -92,6 +103,26 @@ class PYBIND11_EXPORT GSDReader
         uint64_t m_frame;                                            //!< Cached frame
         std::shared_ptr< SnapshotSystemData<float> > m_snapshot;   //!< The snapshot to read
         gsd_handle m_handle;                                         //!< Handle to the file
+        bool m_distributed;                                          //!< True if all ranks read the particles
+        unsigned int m_N;                                            //!< Number of particles in the frame
+        std::shared_ptr< SnapshotSystemData<float> > m_topology;   //!< Topology, in distributed mode
+        const char *m_mapped;                                        //!< Memory mapped file (distributed mode)
+        size_t m_mapped_size;                                        //!< Size of the mapping
+
+        //! Helper function to read rows of a particle data chunk from the mapped file
+        bool readChunkSlice(void *data, const char *name, size_t row_size, unsigned int first, unsigned int n);
+
+        //! Helper function to read and decode rows of quantized positions
+        bool readQuantizedPositions(float *pos, unsigned int first, unsigned int n);
+
+        //! Helper function to check if the positions of the current frame are stored only in quantized form
+        bool hasQuantizedPositions();
+
+        //! Helper function to access the data of a chunk, in the mapped file or read into a buffer
+        const uint8_t *getChunkData(const struct gsd_index_entry *entry, std::vector<uint8_t>& buffer);
+
+        //! Release the memory mapping
+        void unmapFile();
 
         //! Helper function to read a type list from the file
         std::vector<std::string> readTypes(uint64_t frame, const char *name);
@@ -99,7 +130,7 @@ class PYBIND11_EXPORT GSDReader
         // helper functions to read sections of the file
         void readHeader();
         void readParticles();
-        void readTopology();
+        void readTopology(SnapshotSystemData<float>& snapshot);
     };
 
 //! Exports GSDReader to python
@@ -362,6 +362,58 @@ void gather_v(const T& in_value, std::vector<T> & out_values, unsigned int root,
         }
     }
 
+//! Wrapper around MPI_Gatherv that concatenates flat arrays of trivially copyable objects on the root processor
+/*! \param in_values Local array
+    \param out_values Arrays of all ranks in rank order (output, only on the root processor)
+
+    Unlike gather_v(), the elements are sent as raw bytes without serialization.
+ */
+template<typename T>
+void gather_v_flat(const std::vector<T>& in_values, std::vector<T>& out_values, unsigned int root, const MPI_Comm mpi_comm)
+    {
+    int rank;
+    int size;
+    MPI_Comm_rank(mpi_comm, &rank);
+    MPI_Comm_size(mpi_comm, &size);
+
+    // count in units of T, so that large arrays do not overflow the int byte counts
+    MPI_Datatype mpi_type;
+    MPI_Type_contiguous(sizeof(T), MPI_BYTE, &mpi_type);
+    MPI_Type_commit(&mpi_type);
+
+    int send_count = in_values.size();
+
+    std::vector<int> recv_counts;
+    std::vector<int> displs;
+    if (rank == (int) root)
+        {
+        recv_counts.resize(size);
+        displs.resize(size);
+        }
+
+    // gather lengths of arrays
+    MPI_Gather(&send_count, 1, MPI_INT, rank == (int) root ? &recv_counts.front() : NULL, 1, MPI_INT, root, mpi_comm);
+
+    if (rank == (int) root)
+        {
+        unsigned int len = 0;
+        for (unsigned int i = 0; i < (unsigned int) size; i++)
+            {
+            displs[i] = len;
+            len += recv_counts[i];
+            }
+        out_values.resize(len);
+        }
+
+    MPI_Gatherv(send_count ? (void *) &in_values.front() : NULL, send_count, mpi_type,
+        (rank == (int) root && out_values.size()) ? (void *) &out_values.front() : NULL,
+        rank == (int) root ? &recv_counts.front() : NULL,
+        rank == (int) root ? &displs.front() : NULL,
+        mpi_type, root, mpi_comm);
+
+    MPI_Type_free(&mpi_type);
+    }
+
 //! Wrapper around MPI_Allgatherv
 template<typename T>
 void all_gather_v(const T& in_value, std::vector<T> & out_values, const MPI_Comm mpi_comm)
@@ -38,7 +38,10 @@ Integrator::~Integrator()
     if (m_request_flags_connected && m_comm)
         m_comm->getCommFlagsRequestSignal().disconnect<Integrator, &Integrator::determineFlags>(this);
     if (m_signals_connected && m_comm)
+        {
         m_comm->getComputeCallbackSignal().disconnect<Integrator, &Integrator::computeCallback>(this);
+        m_comm->getInteriorComputeCallbackSignal().disconnect<Integrator, &Integrator::interiorComputeCallback>(this);
+        }
     #endif
     }
 
@@ -98,6 +101,12 @@ void Integrator::setDeltaT(Scalar deltaT)
         m_constraint_forces[i]->setDeltaT(deltaT);
 
      m_deltaT = deltaT;
+
+    #ifdef ENABLE_MPI
+    // the communicator extrapolates ghost positions with the time step
+    if (m_comm)
+        m_comm->setDeltaT(deltaT);
+    #endif
     }
 
 /*! \return the timestep deltaT
@@ -309,10 +318,21 @@ Scalar Integrator::computeTotalMomentum(unsigned int timestep)
 */
 void Integrator::computeNetForce(unsigned int timestep)
     {
+    #ifdef ENABLE_MPI
+    // the time spent in the force computes is the cost used for load balancing, without the time they communicate
+    int64_t start_time = m_clk.getTime();
+    int64_t start_wait = m_comm ? m_comm->getWaitTime() : 0;
+    #endif
+
     std::vector< std::shared_ptr<ForceCompute> >::iterator force_compute;
     for (force_compute = m_forces.begin(); force_compute != m_forces.end(); ++force_compute)
         (*force_compute)->compute(timestep);
 
+    #ifdef ENABLE_MPI
+    if (m_comm)
+        m_comm->addComputeTime(m_clk.getTime() - start_time - (m_comm->getWaitTime() - start_wait));
+    #endif
+
     if (m_prof)
         {
         m_prof->push("Integrate");
@@ -904,18 +924,43 @@ void Integrator::setCommunicator(std::shared_ptr<Communicator> comm)
     m_request_flags_connected = true;
 
     if (! m_signals_connected && m_comm)
+        {
         comm->getComputeCallbackSignal().connect<Integrator, &Integrator::computeCallback>(this);
+        comm->getInteriorComputeCallbackSignal().connect<Integrator, &Integrator::interiorComputeCallback>(this);
+        }
 
     m_signals_connected = true;
+
+    if (m_comm)
+        m_comm->setDeltaT(m_deltaT);
     }
 
 void Integrator::computeCallback(unsigned int timestep)
     {
+    int64_t start_time = m_clk.getTime();
+    int64_t start_wait = m_comm->getWaitTime();
+
     // pre-compute all active forces
     std::vector< std::shared_ptr<ForceCompute> >::iterator force_compute;
 
     for (force_compute = m_forces.begin(); force_compute != m_forces.end(); ++force_compute)
         (*force_compute)->preCompute(timestep);
+
+    m_comm->addComputeTime(m_clk.getTime() - start_time - (m_comm->getWaitTime() - start_wait));
+    }
+
+void Integrator::interiorComputeCallback(unsigned int timestep)
+    {
+    int64_t start_time = m_clk.getTime();
+    int64_t start_wait = m_comm->getWaitTime();
+
+    // pre-compute the interior forces while the ghost update is in flight
+    std::vector< std::shared_ptr<ForceCompute> >::iterator force_compute;
+
+    for (force_compute = m_forces.begin(); force_compute != m_forces.end(); ++force_compute)
+        (*force_compute)->preComputeInterior(timestep);
+
+    m_comm->addComputeTime(m_clk.getTime() - start_time - (m_comm->getWaitTime() - start_wait));
     }
 #endif
 
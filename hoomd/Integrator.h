@@ -20,6 +20,7 @@
 #include "ForceConstraint.h"
 #include "HalfStepHook.h"
 #include "ParticleGroup.h"
+#include "ClockSource.h"
 #include <string>
 #include <vector>
 #include <hoomd/extern/pybind/include/pybind11/pybind11.h>
@@ -137,6 +138,9 @@ class PYBIND11_EXPORT Integrator : public Updater
 
         //! Callback for pre-computing the forces
         void computeCallback(unsigned int timestep);
+
+        //! Callback for pre-computing the forces on interior particles during the ghost update
+        void interiorComputeCallback(unsigned int timestep);
         #endif
 
     protected:
@@ -171,6 +175,7 @@ class PYBIND11_EXPORT Integrator : public Updater
         #ifdef ENABLE_MPI
         bool m_request_flags_connected = false;     //!< Connection to Communicator to request communication flags
         bool m_signals_connected = false;                           //!< Track if we have already connected signals
+        ClockSource m_clk;                                          //!< Clock to measure the force compute time
         #endif
     };
 
@@ -32,8 +32,9 @@ LoadBalancer::LoadBalancer(std::shared_ptr<SystemDefinition> sysdef,
                            std::shared_ptr<DomainDecomposition> decomposition)
         : Updater(sysdef), m_decomposition(decomposition), m_mpi_comm(m_exec_conf->getMPICommunicator()),
           m_max_imbalance(Scalar(1.0)), m_recompute_max_imbalance(true), m_needs_migrate(false),
-          m_needs_recount(false), m_tolerance(Scalar(1.05)), m_maxiter(1), m_max_scale(Scalar(0.05)),
-          m_N_own(m_pdata->getN()), m_max_max_imbalance(1.0), m_total_max_imbalance(0.0), m_n_calls(0),
+          m_needs_recount(false), m_time_weights(false), m_weight(Scalar(1.0)), m_last_compute_time(0),
+          m_tolerance(Scalar(1.05)), m_maxiter(1), m_max_scale(Scalar(0.05)),
+          m_N_own(m_pdata->getN()), m_load_own(Scalar(m_pdata->getN())), m_max_max_imbalance(1.0), m_total_max_imbalance(0.0), m_n_calls(0),
           m_n_iterations(0), m_n_rebalances(0)
     {
     m_exec_conf->msg->notice(5) << "Constructing LoadBalancer" << endl;
@@ -64,7 +65,8 @@ void LoadBalancer::update(unsigned int timestep)
     if (m_prof) m_prof->push(m_exec_conf, "balance");
 
     // no adjustment has been made yet, so set m_N_own to the number of particles on the rank
-    resetNOwn(m_pdata->getN());
+    computeParticleWeight();
+    resetNOwn(m_pdata->getN(), m_weight*Scalar(m_pdata->getN()));
 
     // figure out which rank is the reduction root for broadcasting
     const Index3D& di = m_decomposition->getDomainIndexer();
@@ -112,17 +114,37 @@ void LoadBalancer::update(unsigned int timestep)
                 min_frac_i = min_domain_frac.z;
                 }
 
-            vector<unsigned int> N_i;
+            vector<Scalar> N_i;
             bool adjusted = false;
 
-            // reduce the number of particles in the slice along dim
+            // reduce the load in the slice along dim
             bool active = reduce(N_i, dim, reduce_root);
 
+            if (m_decomposition->isStaggered() && dim > 0)
+                {
+                // balance the slabs (y) or columns (z) independently
+                vector<Scalar> stag_frac = m_decomposition->getStaggeredFractions(dim);
+                if (active)
+                    {
+                    adjusted = adjustStaggered(stag_frac, N_i, dim, L_i, min_frac_i);
+                    }
+
+                bcast(adjusted, reduce_root, m_mpi_comm);
+
+                if (adjusted)
+                    {
+                    m_decomposition->setStaggeredFractions(dim, stag_frac, reduce_root);
+                    m_pdata->setGlobalBox(box);
+                    signalResize();
+                    }
+                continue;
+                }
+
             // attempt an adjustment
             vector<Scalar> cum_frac = m_decomposition->getCumulativeFractions(dim);
             if (active)
                 {
-                adjusted = adjust(cum_frac, N_i, L_i, min_frac_i);
+                adjusted = adjust(cum_frac, N_i, L_i, min_frac_i, vector<Scalar>(), vector<Scalar>());
                 }
 
             // broadcast if an adjustment has been made on the root
@@ -140,9 +162,14 @@ void LoadBalancer::update(unsigned int timestep)
         // force a particle migration if one is needed
         if (m_needs_migrate)
             {
+            // the particles keep the weights of the ranks they came from
+            const Scalar load = getLoadOwn();
+
             m_comm->forceMigrate();
             m_comm->communicate(timestep);
-            resetNOwn(m_pdata->getN());
+
+            m_weight = (m_pdata->getN() > 0) ? load / Scalar(m_pdata->getN()) : Scalar(1.0);
+            resetNOwn(m_pdata->getN(), load);
             m_needs_migrate = false;
 
             // increment the number of rebalances actually performed
@@ -154,13 +181,38 @@ void LoadBalancer::update(unsigned int timestep)
     }
 
 /*!
- * Computes the imbalance factor I = N / <N> for each rank, and computes the maximum among all ranks.
+ * With time weights, the force compute time of the rank since the last call is distributed evenly over its particles.
+ * The weights are normalized so that the total load equals the number of particles. If no time has been measured on
+ * any rank, all particles have unit weight.
+ *
+ * \note All ranks must call this method, because the total compute time is reduced over all ranks.
+ */
+void LoadBalancer::computeParticleWeight()
+    {
+    m_weight = Scalar(1.0);
+    if (!m_time_weights)
+        return;
+
+    const int64_t compute_time = m_comm->getComputeTime();
+    Scalar work = Scalar(compute_time - m_last_compute_time);
+    m_last_compute_time = compute_time;
+
+    Scalar total_work(0.0);
+    MPI_Allreduce(&work, &total_work, 1, MPI_HOOMD_SCALAR, MPI_SUM, m_mpi_comm);
+
+    if (total_work > Scalar(0.0) && m_pdata->getN() > 0)
+        m_weight = work / total_work * Scalar(m_pdata->getNGlobal()) / Scalar(m_pdata->getN());
+    }
+
+/*!
+ * Computes the imbalance factor I = N / <N> for each rank, and computes the maximum among all ranks. With time
+ * weights, N is the load of the rank.
  */
 Scalar LoadBalancer::getMaxImbalance()
     {
     if (m_recompute_max_imbalance)
         {
-        Scalar cur_imb = Scalar(getNOwn()) / (Scalar(m_pdata->getNGlobal()) / Scalar(m_exec_conf->getNRanks()));
+        Scalar cur_imb = getLoadOwn() / (Scalar(m_pdata->getNGlobal()) / Scalar(m_exec_conf->getNRanks()));
         Scalar max_imb(0.0);
         MPI_Allreduce(&cur_imb, &max_imb, 1, MPI_HOOMD_SCALAR, MPI_MAX, m_mpi_comm);
 
@@ -175,13 +227,16 @@ Scalar LoadBalancer::getMaxImbalance()
     }
 
 /*!
- * \param N_i Vector holding the total number of particles in each slice (will be allocated on call)
+ * \param N_i Vector holding the total load (number of particles, or their weight) in each slice (will be allocated on call)
  * \param dim The dimension of the slices (x=0, y=1, z=2)
  * \param reduce_root The rank to perform the reduction on
  * \returns true if the current rank holds the active \a N_i
  *
  * \post \a N_i holds the number of particles in each slice along \a dim
  *
+ * In a staggered decomposition, the y loads are reduced per slab (ordered by slab, then y) and the z loads are not
+ * reduced at all (ordered by column, then z), since every slab or column is balanced on its own.
+ *
  * \note reduce() relies on collective MPI calls, and so all ranks must call it. However, for efficiency the data will
  *       be active only on Cartesian rank \a reduce_root, as indicated by the return value. As a result, only \a reduce_root
  *       actually needs to allocate memory for \a N_i.
@@ -191,18 +246,18 @@ Scalar LoadBalancer::getMaxImbalance()
  * down dimensions. Generally, load balancing should not be performed too frequently, and so we do not pursue this
  * optimization right now.
  */
-bool LoadBalancer::reduce(std::vector<unsigned int>& N_i, unsigned int dim, unsigned int reduce_root)
+bool LoadBalancer::reduce(std::vector<Scalar>& N_i, unsigned int dim, unsigned int reduce_root)
     {
     // do nothing if there is only one rank
     if (N_i.size() == 1) return false;
 
     const Index3D& di = m_decomposition->getDomainIndexer();
-    std::vector<unsigned int> N_per_rank(di.getNumElements());
+    std::vector<Scalar> N_per_rank(di.getNumElements());
 
-    // get the number of particles the current rank owns (the quantity to be reduced)
-    unsigned int N_own = getNOwn();
+    // get the load the current rank owns (the quantity to be reduced)
+    Scalar N_own = getLoadOwn();
 
-    MPI_Gather(&N_own, 1, MPI_UNSIGNED, &N_per_rank[0], 1, MPI_UNSIGNED, reduce_root, m_mpi_comm);
+    MPI_Gather(&N_own, 1, MPI_HOOMD_SCALAR, &N_per_rank[0], 1, MPI_HOOMD_SCALAR, reduce_root, m_mpi_comm);
 
     // only the root rank performs the reduction
     if (m_exec_conf->getRank() != reduce_root)
@@ -210,7 +265,7 @@ bool LoadBalancer::reduce(std::vector<unsigned int>& N_i, unsigned int dim, unsi
 
     // rearrange the data from ranks to cartesian order in case it is jumbled around
     ArrayHandle<unsigned int> h_cart_ranks_inv(m_decomposition->getInverseCartRanks(), access_location::host, access_mode::read);
-    std::vector<unsigned int> N_per_cart_rank(di.getNumElements());
+    std::vector<Scalar> N_per_cart_rank(di.getNumElements());
     for (unsigned int cur_rank=0; cur_rank < di.getNumElements(); ++cur_rank)
         {
         N_per_cart_rank[h_cart_ranks_inv.data[cur_rank]] = N_per_rank[cur_rank];
@@ -222,7 +277,7 @@ bool LoadBalancer::reduce(std::vector<unsigned int>& N_i, unsigned int dim, unsi
         N_i.clear(); N_i.resize(di.getW());
         for (unsigned int i=0; i < di.getW(); ++i)
             {
-            N_i[i] = 0;
+            N_i[i] = Scalar(0.0);
             for (unsigned int k=0; k < di.getD(); ++k)
                 {
                 for (unsigned int j=0; j < di.getH(); ++j)
@@ -232,12 +287,42 @@ bool LoadBalancer::reduce(std::vector<unsigned int>& N_i, unsigned int dim, unsi
                 }
             }
         }
+    else if (dim == 1 && m_decomposition->isStaggered()) // to y in every slab
+        {
+        N_i.clear(); N_i.resize(di.getW()*di.getH());
+        for (unsigned int i=0; i < di.getW(); ++i)
+            {
+            for (unsigned int j=0; j < di.getH(); ++j)
+                {
+                Scalar& N_ij = N_i[i*di.getH() + j];
+                N_ij = Scalar(0.0);
+                for (unsigned int k=0; k < di.getD(); ++k)
+                    {
+                    N_ij += N_per_cart_rank[di(i,j,k)];
+                    }
+                }
+            }
+        }
+    else if (dim == 2 && m_decomposition->isStaggered()) // to z in every column
+        {
+        N_i.clear(); N_i.resize(di.getNumElements());
+        for (unsigned int i=0; i < di.getW(); ++i)
+            {
+            for (unsigned int j=0; j < di.getH(); ++j)
+                {
+                for (unsigned int k=0; k < di.getD(); ++k)
+                    {
+                    N_i[(i*di.getH() + j)*di.getD() + k] = N_per_cart_rank[di(i,j,k)];
+                    }
+                }
+            }
+        }
     else if (dim == 1) // to y
         {
         N_i.clear(); N_i.resize(di.getH());
         for (unsigned int j=0; j < di.getH(); ++j)
             {
-            N_i[j] = 0;
+            N_i[j] = Scalar(0.0);
             for (unsigned int k=0; k < di.getD(); ++k)
                 {
                 for (unsigned int i=0; i < di.getW(); ++i)
@@ -252,7 +337,7 @@ bool LoadBalancer::reduce(std::vector<unsigned int>& N_i, unsigned int dim, unsi
         N_i.clear(); N_i.resize(di.getD());
         for (unsigned int k=0; k < di.getD(); ++k)
             {
-            N_i[k] = 0;
+            N_i[k] = Scalar(0.0);
             for (unsigned int j=0; j < di.getH(); ++j)
                 {
                 for (unsigned int i=0; i < di.getW(); ++i)
@@ -273,9 +358,11 @@ bool LoadBalancer::reduce(std::vector<unsigned int>& N_i, unsigned int dim, unsi
 
 /*!
  * \param cum_frac_i The cumulative fraction array to write output into
- * \param N_i The reduced number of particles along the dimension
+ * \param N_i The reduced load along the dimension
  * \param L_i The global box length along the dimension
  * \param min_frac_i The minimum fractional width of a domain
+ * \param lo_i Lower bounds on the fractions of the inner cuts (may be empty)
+ * \param hi_i Upper bounds on the fractions of the inner cuts (may be empty)
  *
  * \returns true if an adjustment occurred
  *
@@ -291,15 +378,18 @@ bool LoadBalancer::reduce(std::vector<unsigned int>& N_i, unsigned int dim, unsi
  *     successful, apply the adjustment to \a cum_frac_i.
  */
 bool LoadBalancer::adjust(vector<Scalar>& cum_frac_i,
-                          const vector<unsigned int>& N_i,
+                          const vector<Scalar>& N_i,
                           Scalar L_i,
-                          Scalar min_frac_i)
+                          Scalar min_frac_i,
+                          const vector<Scalar>& lo_i,
+                          const vector<Scalar>& hi_i)
     {
     if (N_i.size() == 1)
         return false;
 
-    // target particles per rank is uniform distribution
-    const Scalar target = Scalar(m_pdata->getNGlobal()) / Scalar(N_i.size());
+    // target particles per rank is uniform distribution of the load along the slices, which is the number of particles
+    // divided by the number of slices unless a single slab or column is balanced
+    const Scalar target = std::accumulate(N_i.begin(), N_i.end(), Scalar(0.0)) / Scalar(N_i.size());
 
     // make the minimum domain slightly bigger so that the optimization won't fail at equality
     const Scalar min_domain_size = Scalar(1.00001) * min_frac_i * L_i;
@@ -313,8 +403,7 @@ bool LoadBalancer::adjust(vector<Scalar>& cum_frac_i,
     vector<Scalar> new_widths(N_i.size());
     for (unsigned int i=0; i < N_i.size(); ++i)
         {
-        const Scalar imb_factor = Scalar(N_i[i]) / target;
-        Scalar scale_factor = (N_i[i] > 0) ? Scalar(1.0) / imb_factor : (Scalar(1.0) + m_max_scale); // as in gromacs, use half the imbalance factor to scale
+        Scalar scale_factor = (N_i[i] > 0) ? target / N_i[i] : (Scalar(1.0) + m_max_scale); // as in gromacs, use half the imbalance factor to scale
 
         // limit rescaling to 5% either direction
         // we should use absolute distance here, it is necessary to control balancing in corrugated systems
@@ -368,6 +457,17 @@ bool LoadBalancer::adjust(vector<Scalar>& cum_frac_i,
         {
         l(j) = Scalar(0.5) * (cum_frac_i[j] + cum_frac_i[j+1]) * L_i;
         u(j) = Scalar(0.5) * (cum_frac_i[j+1] + cum_frac_i[j+2]) * L_i;
+
+        // additional bounds from the caller, if the cut cannot move within them it stays in place
+        if (!lo_i.empty() && !hi_i.empty())
+            {
+            l(j) = std::max(Scalar(l(j)), lo_i[j] * L_i);
+            u(j) = std::min(Scalar(u(j)), hi_i[j] * L_i);
+            if (l(j) > u(j))
+                {
+                l(j) = u(j) = cum_frac_i[j+1] * L_i;
+                }
+            }
         }
 
     try
@@ -416,6 +516,75 @@ bool LoadBalancer::adjust(vector<Scalar>& cum_frac_i,
     return false;
     }
 
+/*!
+ * \param stag_frac Concatenated cumulative fractions of all slabs (y) or columns (z), updated in place
+ * \param N_i The load per domain, ordered as \a stag_frac
+ * \param dim The dimension of the cuts (y=1, z=2)
+ * \param L_i The global box length along the dimension
+ * \param min_frac_i The minimum fractional width of a domain
+ *
+ * \returns true if an adjustment occurred in any slab or column
+ *
+ * Every slab or column is adjusted with adjust(). The staged communication routes particles and ghosts along the grid,
+ * one neighbor per dimension, so every cut is additionally bounded to stay more than a ghost layer width inside the
+ * neighboring domains of the adjacent slabs or columns (including the diagonal columns). The slabs and columns are
+ * adjusted one after another against the current cuts of their neighbors, so the cuts remain interleaved.
+ */
+bool LoadBalancer::adjustStaggered(std::vector<Scalar>& stag_frac,
+                                   const std::vector<Scalar>& N_i,
+                                   unsigned int dim,
+                                   Scalar L_i,
+                                   Scalar min_frac_i)
+    {
+    const Index3D& di = m_decomposition->getDomainIndexer();
+    const unsigned int n = (dim == 1) ? di.getH() : di.getD();
+    const unsigned int n_x = di.getW();
+    const unsigned int n_y = (dim == 1) ? 1 : di.getH();
+
+    // the ghost layer width is half the minimum domain size
+    const Scalar margin = Scalar(0.5) * min_frac_i;
+
+    bool adjusted = false;
+    for (unsigned int i = 0; i < n_x; ++i)
+        {
+        for (unsigned int j = 0; j < n_y; ++j)
+            {
+            const unsigned int cur = i*n_y + j;
+
+            // bound the inner cuts by the cuts of the adjacent slabs or columns
+            std::vector<Scalar> lo(n-1, Scalar(0.0)), hi(n-1, Scalar(1.0));
+            for (int ix = -1; ix <= 1; ++ix)
+                {
+                if (ix && n_x == 1) continue;
+                const unsigned int i_neigh = (i + n_x + ix) % n_x;
+                for (int iy = -1; iy <= 1; ++iy)
+                    {
+                    if (iy && n_y == 1) continue;
+                    const unsigned int j_neigh = (j + n_y + iy) % n_y;
+                    const unsigned int neigh = i_neigh*n_y + j_neigh;
+                    if (neigh == cur) continue;
+
+                    for (unsigned int c = 1; c < n; ++c)
+                        {
+                        lo[c-1] = std::max(lo[c-1], stag_frac[neigh*(n+1) + c - 1] + margin);
+                        hi[c-1] = std::min(hi[c-1], stag_frac[neigh*(n+1) + c + 1] - margin);
+                        }
+                    }
+                }
+
+            std::vector<Scalar> cum_frac(stag_frac.begin() + cur*(n+1), stag_frac.begin() + (cur+1)*(n+1));
+            std::vector<Scalar> N_cur(N_i.begin() + cur*n, N_i.begin() + (cur+1)*n);
+            if (adjust(cum_frac, N_cur, L_i, min_frac_i, lo, hi))
+                {
+                std::copy(cum_frac.begin(), cum_frac.end(), stag_frac.begin() + cur*(n+1));
+                adjusted = true;
+                }
+            }
+        }
+
+    return adjusted;
+    }
+
 /*!
  * \param cnts Map holding result of number of particles on each rank that neighbors the local rank
  */
@@ -487,7 +656,10 @@ void LoadBalancer::countParticlesOffRank(std::map<unsigned int, unsigned int>& c
             else if (grid_pos.z < 0)
                 grid_pos.z += di.getD();
 
-            unsigned int cur_rank = h_cart_ranks.data[di(grid_pos.x,grid_pos.y,grid_pos.z)];
+            // in a staggered decomposition, the particle may land in a different domain of the neighboring slab or column
+            unsigned int cur_rank = m_decomposition->isStaggered() ?
+                m_decomposition->placeParticle(m_pdata->getGlobalBox(), cur_pos, h_cart_ranks.data) :
+                h_cart_ranks.data[di(grid_pos.x,grid_pos.y,grid_pos.z)];
             cnts[cur_rank]++;
             }
         }
@@ -496,7 +668,8 @@ void LoadBalancer::countParticlesOffRank(std::map<unsigned int, unsigned int>& c
 /*!
  * Each rank calls countParticlesOffRank() to count the number of particles to send to other ranks. Neighboring ranks
  * then perform send/receive calls, and count the new number of particles they own as the number they owned locally
- * plus the number received minus the number sent.
+ * plus the number received minus the number sent. The load changes accordingly, where every particle carries the
+ * weight of the rank it is sent from.
  *
  * \note All ranks must participate in this call since it involves send/receive operations between neighboring domains.
  */
@@ -532,16 +705,38 @@ void LoadBalancer::computeOwnedParticles()
         }
     MPI_Waitall(nreq, req, stat);
 
+    // exchange the particle weights with the neighbors
+    Scalar recv_weight[m_comm->getNUniqueNeighbors()];
+    if (m_time_weights)
+        {
+        nreq = 0;
+        for (unsigned int cur_neigh=0; cur_neigh < m_comm->getNUniqueNeighbors(); ++cur_neigh)
+            {
+            unsigned int neigh_rank = h_unique_neigh.data[cur_neigh];
+            MPI_Isend(&m_weight, 1, MPI_HOOMD_SCALAR, neigh_rank, 1, m_mpi_comm, & req[nreq++]);
+            MPI_Irecv(&recv_weight[cur_neigh], 1, MPI_HOOMD_SCALAR, neigh_rank, 1, m_mpi_comm, & req[nreq++]);
+            }
+        MPI_Waitall(nreq, req, stat);
+        }
+    else
+        {
+        for (unsigned int cur_neigh=0; cur_neigh < m_comm->getNUniqueNeighbors(); ++cur_neigh)
+            recv_weight[cur_neigh] = Scalar(1.0);
+        }
+
     // reduce the particles sent to me
     int N_own = m_pdata->getN();
+    Scalar load_own = m_weight * Scalar(m_pdata->getN());
     for (unsigned int cur_neigh = 0; cur_neigh < m_comm->getNUniqueNeighbors(); ++cur_neigh)
         {
         N_own += n_recv_ptls[cur_neigh];
         N_own -= n_send_ptls[cur_neigh];
+        load_own += Scalar(n_recv_ptls[cur_neigh]) * recv_weight[cur_neigh];
+        load_own -= Scalar(n_send_ptls[cur_neigh]) * m_weight;
         }
 
     // set the count
-    resetNOwn(N_own);
+    resetNOwn(N_own, load_own);
     }
 
 /*!
@@ -578,6 +773,8 @@ void export_LoadBalancer(py::module& m)
     .def("setTolerance", &LoadBalancer::setTolerance)
     .def("getMaxIterations", &LoadBalancer::getMaxIterations)
     .def("setMaxIterations", &LoadBalancer::setMaxIterations)
+    .def("setTimeWeights", &LoadBalancer::setTimeWeights)
+    .def("getTimeWeights", &LoadBalancer::getTimeWeights)
     ;
     }
 #endif // ENABLE_MPI
@@ -31,6 +31,11 @@
  * is defined as the number of particles owned by a rank divided by the average number of particles per rank if the
  * particles had a uniform distribution.
  *
+ * With time weights, every particle instead carries the measured force compute time of its rank since the last
+ * balancing step, divided by the number of particles on the rank, and normalized so that the average weight is one.
+ * The load of a rank is the sum of the weights of the particles it owns. Particles keep the weight of the rank they
+ * came from when the boundaries are adjusted.
+ *
  * At each load balancing step, we attempt to rescale the domain size by the inverse of the load balance, subject to the
  * following constraints that are imposed to both maintain a stable balancing and to keep communication isolated to the
  * 26 nearest neighbors of a cell:
@@ -41,6 +46,9 @@
  * Constraints are satisfied by solving a least-squares problem with box constraints, where the cost function is the
  * deviation of the domain sizes from the proposed rescaled width.
  *
+ * In a staggered decomposition, the y cuts of every slab and the z cuts of every column are balanced independently,
+ * subject to the additional constraint that they stay interleaved with the cuts of the adjacent slabs and columns.
+ *
  * \ingroup updaters
  */
 class PYBIND11_EXPORT LoadBalancer : public Updater
@@ -83,6 +91,21 @@ class PYBIND11_EXPORT LoadBalancer : public Updater
             m_maxiter = maxiter;
             }
 
+        //! Set whether particles are weighted by the measured compute time of their rank
+        /*!
+         * \param enable True to balance the measured force compute time, false to balance the number of particles
+         */
+        void setTimeWeights(bool enable)
+            {
+            m_time_weights = enable;
+            }
+
+        //! Returns true if particles are weighted by the measured compute time of their rank
+        bool getTimeWeights() const
+            {
+            return m_time_weights;
+            }
+
         //! Enable / disable load balancing along a dimension
         /*!
          * \param dim Dimension along which to balance
@@ -119,8 +142,8 @@ class PYBIND11_EXPORT LoadBalancer : public Updater
         Scalar m_max_imbalance;             //!< Maximum imbalance
         bool m_recompute_max_imbalance;     //!< Flag if maximum imbalance needs to be computed
 
-        //! Reduce the particle numbers per rank down to one dimension
-        bool reduce(std::vector<unsigned int>& N_i, unsigned int dim, unsigned int reduce_root);
+        //! Reduce the loads per rank down to one dimension
+        bool reduce(std::vector<Scalar>& N_i, unsigned int dim, unsigned int reduce_root);
 
         //! Set flags within the class that a resize has been performed
         void signalResize()
@@ -132,9 +155,18 @@ class PYBIND11_EXPORT LoadBalancer : public Updater
 
         //! Adjust the partitioning along a single dimension
         bool adjust(std::vector<Scalar>& cum_frac_i,
-                    const std::vector<unsigned int>& N_i,
+                    const std::vector<Scalar>& N_i,
                     Scalar L_i,
-                    Scalar min_domain_frac);
+                    Scalar min_domain_frac,
+                    const std::vector<Scalar>& lo_i,
+                    const std::vector<Scalar>& hi_i);
+
+        //! Adjust the partitioning of every slab or column of a staggered decomposition along a single dimension
+        bool adjustStaggered(std::vector<Scalar>& stag_frac,
+                             const std::vector<Scalar>& N_i,
+                             unsigned int dim,
+                             Scalar L_i,
+                             Scalar min_domain_frac);
         bool m_needs_migrate;   //!< Flag to signal that migration is necessary
 
         //! Compute the number of particles on each rank after an adjustment
@@ -150,18 +182,33 @@ class PYBIND11_EXPORT LoadBalancer : public Updater
             return m_N_own;
             }
 
+        //! Gets the load of the owned particles, updating if necessary
+        Scalar getLoadOwn()
+            {
+            computeOwnedParticles();
+            return m_load_own;
+            }
+
         //! Force a reset of the number of owned particles without counting
         /*!
          * \param N number of particles owned by the rank
+         * \param load total weight of the particles owned by the rank
          */
-        void resetNOwn(unsigned int N)
+        void resetNOwn(unsigned int N, Scalar load)
             {
             m_N_own = N;
+            m_load_own = load;
             m_recompute_max_imbalance = true;
             m_needs_recount = false;
             }
         bool m_needs_recount;   //!< Flag if a particle change needs to be computed
 
+        //! Determine the weight of the particles on this rank from the measured compute time
+        void computeParticleWeight();
+        bool m_time_weights;            //!< True if particles are weighted by the compute time of their rank
+        Scalar m_weight;                //!< Weight of a particle on this rank
+        int64_t m_last_compute_time;    //!< Compute time of the rank at the last balancing step
+
         Scalar m_tolerance;     //!< Load imbalance to tolerate
         unsigned int m_maxiter; //!< Maximum number of iterations to attempt
         bool m_enable_x;        //!< Flag to enable balancing in x
@@ -172,6 +219,7 @@ class PYBIND11_EXPORT LoadBalancer : public Updater
 
     private:
         unsigned int m_N_own;               //!< Number of particles owned by this rank
+        Scalar m_load_own;                  //!< Total weight of the particles owned by this rank
 
         Scalar m_max_max_imbalance;     //!< The maximum imbalance of any check
         double m_total_max_imbalance;   //!< The average imbalance over checks
@@ -0,0 +1,253 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+/*! \file LogBinary.cc
+    \brief Defines the LogBinary class
+*/
+
+#include "LogBinary.h"
+#include "Filesystem.h"
+
+#ifdef ENABLE_MPI
+#include "Communicator.h"
+#endif
+
+namespace py = pybind11;
+
+#include <stdexcept>
+#include <cstring>
+using namespace std;
+
+/*! \param sysdef Specified for Logger, but not used directly by Logger
+    \param fname File name to write the log to
+    \param overwrite Will overwrite an exiting file if true (default is to append)
+    \param block_rows Number of rows buffered in memory before they are written
+*/
+LogBinary::LogBinary(std::shared_ptr<SystemDefinition> sysdef,
+                     const std::string& fname,
+                     bool overwrite,
+                     unsigned int block_rows)
+    : Logger(sysdef), m_filename(fname), m_appending(!overwrite), m_is_initialized(false), m_block_rows(1),
+      m_writer(m_exec_conf, 2)
+    {
+    m_exec_conf->msg->notice(5) << "Constructing LogBinary: " << fname << " " << overwrite << " " << block_rows << endl;
+
+    setBlockRows(block_rows);
+    }
+
+LogBinary::~LogBinary()
+    {
+    m_exec_conf->msg->notice(5) << "Destroying LogBinary" << endl;
+
+    try
+        {
+        if (m_block && m_block->timesteps.size() > 0)
+            queueBlock();
+        }
+    catch (...)
+        {
+        }
+
+    m_writer.stop();
+    }
+
+void LogBinary::openOutputFile()
+    {
+    // validate the header of the file we append to
+    if (filesystem::exists(m_filename) && m_appending)
+        {
+        m_exec_conf->msg->notice(3) << "analyze.log_binary: Appending log to existing file \"" << m_filename << "\"" << endl;
+
+        ifstream in(m_filename.c_str(), ios_base::in | ios_base::binary);
+        char magic[sizeof(LOG_BINARY_MAGIC)];
+        uint32_t version = 0;
+        in.read(magic, sizeof(magic));
+        in.read((char *)&version, sizeof(version));
+        if (!in.good() || memcmp(magic, LOG_BINARY_MAGIC, sizeof(magic)) != 0 || version != LOG_BINARY_VERSION)
+            {
+            m_exec_conf->msg->error() << "analyze.log_binary: " << m_filename << " is not a binary log file of this version" << endl;
+            throw runtime_error("Error initializing LogBinary");
+            }
+
+        m_file.open(m_filename.c_str(), ios_base::out | ios_base::binary | ios_base::app);
+        }
+    else
+        {
+        m_exec_conf->msg->notice(3) << "analyze.log_binary: Creating new log in file \"" << m_filename << "\"" << endl;
+        m_file.open(m_filename.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+        m_file.write(LOG_BINARY_MAGIC, sizeof(LOG_BINARY_MAGIC));
+        m_file.write((const char *)&LOG_BINARY_VERSION, sizeof(LOG_BINARY_VERSION));
+        m_appending = false;
+        }
+
+    if (!m_file.good())
+        {
+        m_exec_conf->msg->error() << "analyze.log_binary: Error opening log file " << m_filename << endl;
+        throw runtime_error("Error initializing LogBinary");
+        }
+    }
+
+/*! \param block_rows Number of rows buffered in memory before they are written
+
+    The rows buffered so far are queued for writing.
+*/
+void LogBinary::setBlockRows(unsigned int block_rows)
+    {
+    if (block_rows == 0)
+        {
+        m_exec_conf->msg->error() << "analyze.log_binary: block_rows must be positive" << endl;
+        throw runtime_error("Error setting LogBinary parameters");
+        }
+
+    if (m_block && m_block->timesteps.size() > 0)
+        queueBlock();
+
+    m_block_rows = block_rows;
+    }
+
+/*! \param timestep Time step to write out data for
+
+    Appends a row with the time step and the values of all logged quantities to the current block.
+*/
+void LogBinary::analyze(unsigned int timestep)
+    {
+    //Call the base class to cache all values.
+    Logger::analyze(timestep);
+
+    // only output to file on root processor
+    if (! m_exec_conf->isRoot())
+        return;
+
+    if (m_prof) m_prof->push("LogBinary");
+
+    if (! m_block)
+        {
+        m_block = std::shared_ptr<Record>(new Record());
+        m_block->n_columns = (unsigned int)m_cached_quantities.size();
+        m_block->timesteps.reserve(m_block_rows);
+        m_block->values.reserve(size_t(m_block_rows) * m_block->n_columns);
+        }
+
+    m_block->timesteps.push_back(timestep);
+    m_block->values.insert(m_block->values.end(), m_cached_quantities.begin(), m_cached_quantities.end());
+
+    if (m_block->timesteps.size() >= m_block_rows)
+        queueBlock();
+
+    if (m_prof) m_prof->pop();
+    }
+
+/*! \param quantities A list of quantities to log
+
+    The rows buffered so far are queued for writing, followed by a record with the new column names.
+*/
+void LogBinary::setLoggedQuantities(const std::vector< std::string >& quantities)
+    {
+    Logger::setLoggedQuantities(quantities);
+
+    // only output to file on root processor
+    if (! m_exec_conf->isRoot())
+        return;
+
+    // open output files for writing
+    if (! m_is_initialized)
+        openOutputFile();
+
+    m_is_initialized = true;
+
+    if (quantities.size() == 0)
+        m_exec_conf->msg->warning() << "analyze.log_binary: No quantities specified for logging" << endl;
+
+    // the buffered rows have the previous columns
+    if (m_block && m_block->timesteps.size() > 0)
+        queueBlock();
+    m_block.reset();
+
+    std::shared_ptr<Record> record(new Record());
+    record->columns = quantities;
+    record->n_columns = (unsigned int)quantities.size();
+    queueRecord(record);
+    }
+
+/*! Queues the rows buffered so far, then waits until the writer thread has written all queued records and raises any
+    error that occurred while writing.
+*/
+void LogBinary::flush()
+    {
+    if (m_block && m_block->timesteps.size() > 0)
+        queueBlock();
+
+    m_writer.flush();
+
+    if (m_file.is_open())
+        m_file.flush();
+    }
+
+//! Hand the block being filled to the writer thread and start a new one
+void LogBinary::queueBlock()
+    {
+    std::shared_ptr<Record> block = m_block;
+    m_block.reset();
+    queueRecord(block);
+    }
+
+/*! \param record Record to write out
+
+    Blocks while two records are still waiting to be written, so that the memory held by the queue stays bounded.
+*/
+void LogBinary::queueRecord(std::shared_ptr<Record> record)
+    {
+    m_writer.queue([this, record]{ writeRecord(*record); });
+    }
+
+/*! \param record Record to write
+
+    Blocks are transposed from rows into columns before they are written.
+*/
+void LogBinary::writeRecord(const Record& record)
+    {
+    if (record.timesteps.size() == 0)
+        {
+        uint32_t type = LOG_BINARY_COLUMNS;
+        uint32_t n_columns = (uint32_t)record.columns.size();
+        m_file.write((const char *)&type, sizeof(type));
+        m_file.write((const char *)&n_columns, sizeof(n_columns));
+        for (unsigned int i = 0; i < record.columns.size(); i++)
+            {
+            uint32_t len = (uint32_t)record.columns[i].size();
+            m_file.write((const char *)&len, sizeof(len));
+            m_file.write(record.columns[i].c_str(), len);
+            }
+        }
+    else
+        {
+        uint32_t type = LOG_BINARY_BLOCK;
+        uint32_t n_rows = (uint32_t)record.timesteps.size();
+        uint32_t n_columns = record.n_columns;
+        m_file.write((const char *)&type, sizeof(type));
+        m_file.write((const char *)&n_rows, sizeof(n_rows));
+        m_file.write((const char *)&n_columns, sizeof(n_columns));
+        m_file.write((const char *)&record.timesteps[0], sizeof(uint64_t) * n_rows);
+
+        std::vector<double> column(n_rows);
+        for (unsigned int j = 0; j < n_columns; j++)
+            {
+            for (unsigned int i = 0; i < n_rows; i++)
+                column[i] = record.values[size_t(i) * n_columns + j];
+            m_file.write((const char *)&column[0], sizeof(double) * n_rows);
+            }
+        }
+
+    // runs on the writer thread, the message is printed by the caller (see BackgroundWriter)
+    if (!m_file.good())
+        throw runtime_error("analyze.log_binary: I/O error while writing log file " + m_filename);
+    }
+
+void export_LogBinary(py::module& m)
+    {
+    py::class_<LogBinary, std::shared_ptr<LogBinary> >(m,"LogBinary", py::base<Logger>())
+    .def(py::init< std::shared_ptr<SystemDefinition>, const std::string&, bool, unsigned int >())
+    .def("setBlockRows", &LogBinary::setBlockRows)
+    .def("flush", &LogBinary::flush)
+    ;
+    }
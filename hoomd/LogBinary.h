@@ -0,0 +1,109 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+/*! \file LogBinary.h
+    \brief Declares the LogBinary class
+*/
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+#include "Logger.h"
+#include "BackgroundWriter.h"
+
+#ifndef __LOGBINARY_H__
+#define __LOGBINARY_H__
+
+//! Magic bytes at the start of a binary log file
+const char LOG_BINARY_MAGIC[8] = {'H', 'O', 'O', 'M', 'D', 'L', 'G', 'B'};
+//! Version of the binary log format
+const uint32_t LOG_BINARY_VERSION = 1;
+//! Record type of the column names
+const uint32_t LOG_BINARY_COLUMNS = 1;
+//! Record type of a block of rows
+const uint32_t LOG_BINARY_BLOCK = 2;
+
+//! Logs registered quantities to a binary file in blocks of columns
+/*! LogBinary evaluates the logged quantities like LogPlainTXT, but stores every row as raw values in an in-memory
+    block instead of formatting it. When a block holds getBlockRows() rows, it is handed to a writer thread on the root
+    rank, which transposes it into columns and appends it to the file while the simulation continues. The partial
+    block is written in flush(), at the end of every run().
+
+    The file starts with the 8 byte magic "HOOMDLGB" and a uint32 version, followed by records in native byte order.
+    Every record starts with a uint32 record type:
+     - LOG_BINARY_COLUMNS: uint32 number of columns, then every column name as uint32 length and characters. Written
+       every time setLoggedQuantities() is called, it applies to all following blocks.
+     - LOG_BINARY_BLOCK: uint32 number of rows n and uint32 number of columns m, followed by n uint64 time steps and
+       then m columns of n doubles each.
+
+    hoomd.analyze.log_binary_to_text() converts the file to the delimited text format of LogPlainTXT.
+
+    \ingroup analyzers
+*/
+class LogBinary : public Logger
+    {
+    public:
+        //! Constructs a logger
+        LogBinary(std::shared_ptr<SystemDefinition> sysdef,
+                  const std::string& fname,
+                  bool overwrite=false,
+                  unsigned int block_rows=1000);
+
+        //! Destructor
+        ~LogBinary();
+
+        //! Selects which quantities to log
+        virtual void setLoggedQuantities(const std::vector< std::string >& quantities);
+
+        //! Set the number of rows per block
+        void setBlockRows(unsigned int block_rows);
+
+        //! Get the number of rows per block
+        unsigned int getBlockRows() const
+            {
+            return m_block_rows;
+            }
+
+        //! Store the data for the current timestep
+        void analyze(unsigned int timestep);
+
+        //! Write out all buffered rows
+        virtual void flush();
+
+    private:
+        //! A record waiting to be written
+        struct Record
+            {
+            std::vector<std::string> columns;   //!< Column names (a column record has no rows)
+            unsigned int n_columns;             //!< Number of columns of the block
+            std::vector<uint64_t> timesteps;    //!< Time step of every row
+            std::vector<double> values;         //!< Values of the block, row by row
+            };
+
+        std::string m_filename;                 //!< The output file name
+        bool m_appending;                       //!< True if an existing file is appended to
+        std::ofstream m_file;                   //!< The file we write out to
+        bool m_is_initialized;                  //!< True if the file is open
+        unsigned int m_block_rows;              //!< Number of rows per block
+        std::shared_ptr<Record> m_block;        //!< The block being filled
+
+        BackgroundWriter m_writer;              //!< Writes the queued records on the root rank
+
+        //! Helper function to open the output file
+        void openOutputFile();
+
+        //! Hand the block being filled to the writer thread
+        void queueBlock();
+
+        //! Queue a record for the writer thread
+        void queueRecord(std::shared_ptr<Record> record);
+
+        //! Write a record to the file
+        void writeRecord(const Record& record);
+    };
+
+//! exports the LogBinary class to python
+void export_LogBinary(pybind11::module& m);
+
+#endif
@@ -24,7 +24,7 @@ using namespace std;
 /*! \param sysdef Specified for Analyzer, but not used directly by Logger
 */
 Logger::Logger(std::shared_ptr<SystemDefinition> sysdef)
-    : Analyzer(sysdef)
+    : Analyzer(sysdef), m_cached_timestep(-1), m_sources_valid(false)
     {
     m_exec_conf->msg->notice(5) << "Constructing Logger: " << endl;
     }
@@ -60,6 +60,7 @@ void Logger::registerCompute(std::shared_ptr<Compute> compute)
             m_exec_conf->msg->warning() << "analyze.log: The log quantity " << provided_quantities[i] <<
                  " has been registered more than once. Only the most recent registration takes effect" << endl;
         m_compute_quantities[provided_quantities[i]] = compute;
+        m_sources_valid = false;
         m_exec_conf->msg->notice(6) << "analyze.log: Registering log quantity " << provided_quantities[i] << endl;
         }
     }
@@ -84,6 +85,7 @@ void Logger::registerUpdater(std::shared_ptr<Updater> updater)
             m_exec_conf->msg->warning() << "analyze.log: The log quantity " << provided_quantities[i] <<
                  " has been registered more than once. Only the most recent registration takes effect" << endl;
         m_updater_quantities[provided_quantities[i]] = updater;
+        m_sources_valid = false;
         m_exec_conf->msg->notice(6) << "analyze.log: Registering log quantity " << provided_quantities[i] << endl;
         }
     }
@@ -106,6 +108,7 @@ void Logger::registerCallback(std::string name, pybind11::handle callback)
 
     pybind11::handle(callback).inc_ref(); // increase the reference count on this handle while we hold it
     m_callback_quantities[name] = callback.ptr();
+    m_sources_valid = false;
     }
 
 /*! After calling removeAll(), no quantities are registered for logging
@@ -114,6 +117,7 @@ void Logger::removeAll()
     {
     m_compute_quantities.clear();
     m_updater_quantities.clear();
+    m_sources_valid = false;
     //The callbacks are intentionally not cleared, because before each
     //run all compute and updaters should be cleared, but the python
     //callbacks should not be cleared for this.
@@ -131,6 +135,56 @@ void Logger::setLoggedQuantities(const std::vector< std::string >& quantities)
     // prepare or adjust storage for caching the logger properties.
     m_cached_timestep = -1;
     m_cached_quantities.resize(quantities.size());
+    m_sources_valid = false;
+    }
+
+/*! Every logged quantity is looked up in the same order of precedence as before: the built-in time, then computes,
+    updaters and callbacks.
+*/
+void Logger::resolveQuantitySources()
+    {
+    m_quantity_sources.assign(m_logged_quantities.size(), quantity_source());
+
+    for (unsigned int i = 0; i < m_logged_quantities.size(); i++)
+        {
+        const std::string& quantity = m_logged_quantities[i];
+        quantity_source& source = m_quantity_sources[i];
+
+        if (quantity == "time")
+            {
+            source.kind = quantity_source::time;
+            }
+        else if (m_compute_quantities.count(quantity))
+            {
+            source.kind = quantity_source::compute;
+            source.compute_source = m_compute_quantities[quantity];
+            }
+        else if (m_updater_quantities.count(quantity))
+            {
+            source.kind = quantity_source::updater;
+            source.updater_source = m_updater_quantities[quantity];
+            }
+        else if (m_callback_quantities.count(quantity))
+            {
+            source.kind = quantity_source::callback;
+            source.py_callback = m_callback_quantities[quantity];
+            }
+        }
+
+    m_sources_valid = true;
+    }
+
+/*! \param timestep Time step to compute the values for
+*/
+void Logger::updateCachedQuantities(unsigned int timestep)
+    {
+    if (! m_sources_valid)
+        resolveQuantitySources();
+
+    for (unsigned int i = 0; i < m_logged_quantities.size(); i++)
+        m_cached_quantities[i] = getValue(i, timestep);
+
+    m_cached_timestep = timestep;
     }
 
 /*! \param timestep Time step to write out data for
@@ -143,10 +197,7 @@ void Logger::analyze(unsigned int timestep)
     if (m_prof) m_prof->push("Log");
 
     // update info in cache for later use and for immediate output.
-    for (unsigned int i = 0; i < m_logged_quantities.size(); i++)
-        m_cached_quantities[i] = getValue(m_logged_quantities[i], timestep);
-
-    m_cached_timestep = timestep;
+    updateCachedQuantities(timestep);
 
     if (m_prof) m_prof->pop();
     }
@@ -157,11 +208,7 @@ Scalar Logger::getQuantity(const std::string &quantity, unsigned int timestep, b
     {
     // update info in cache for later use
     if (!use_cache && timestep != m_cached_timestep)
-        {
-        for (unsigned int i = 0; i < m_logged_quantities.size(); i++)
-            m_cached_quantities[i] = getValue(m_logged_quantities[i], timestep);
-        m_cached_timestep = timestep;
-        }
+        updateCachedQuantities(timestep);
 
     // first see if it is the timestep number
     if (quantity == "timestep")
@@ -178,49 +225,46 @@ Scalar Logger::getQuantity(const std::string &quantity, unsigned int timestep, b
     return Scalar(0.0);
     }
 
-/*! \param quantity Quantity to get
+/*! \param i Index of the quantity in the logged quantities
     \param timestep Time step to compute value for (needed for Compute classes)
 */
-Scalar Logger::getValue(const std::string &quantity, int timestep)
+Scalar Logger::getValue(unsigned int i, unsigned int timestep)
     {
-    // first see if it is the built-in time quantity
-    if (quantity == "time")
-        {
-        return Scalar(double(m_clk.getTime())/1e9);
-        }
-    // check to see if the quantity exists in the compute list
-    else if (m_compute_quantities.count(quantity))
-        {
-        // update the compute
-        m_compute_quantities[quantity]->compute(timestep);
-        // get the log value
-        return m_compute_quantities[quantity]->getLogValue(quantity, timestep);
-        }
-    // check to see if the quantity exists in the updaters list
-    else if (m_updater_quantities.count(quantity))
-        {
-        // get the log value
-        return m_updater_quantities[quantity]->getLogValue(quantity, timestep);
-        }
-    else if (m_callback_quantities.count(quantity))
-        {
-        // get a quantity from a callback
-        try
-            {
-            py::object rv = pybind11::reinterpret_borrow<py::object>(m_callback_quantities[quantity])(timestep);
-            Scalar extracted_rv = rv.cast<Scalar>();
-            return extracted_rv;
-            }
-        catch (const py::cast_error&)
-            {
-                m_exec_conf->msg->warning() << "analyze.log: Log callback " << quantity << " returned invalid value, logging 0." << endl;
-                return Scalar(0.0);
-            }
-        }
-    else
+    const quantity_source& source = m_quantity_sources[i];
+    const std::string& quantity = m_logged_quantities[i];
+
+    switch (source.kind)
         {
-        m_exec_conf->msg->warning() << "analyze.log: Log quantity " << quantity << " is not registered, logging a value of 0" << endl;
-        return Scalar(0.0);
+        case quantity_source::time:
+            return Scalar(double(m_clk.getTime())/1e9);
+
+        case quantity_source::compute:
+            // update the compute
+            source.compute_source->compute(timestep);
+            // get the log value
+            return source.compute_source->getLogValue(quantity, timestep);
+
+        case quantity_source::updater:
+            // get the log value
+            return source.updater_source->getLogValue(quantity, timestep);
+
+        case quantity_source::callback:
+            // get a quantity from a callback
+            try
+                {
+                py::object rv = pybind11::reinterpret_borrow<py::object>(source.py_callback)(timestep);
+                Scalar extracted_rv = rv.cast<Scalar>();
+                return extracted_rv;
+                }
+            catch (const py::cast_error&)
+                {
+                    m_exec_conf->msg->warning() << "analyze.log: Log callback " << quantity << " returned invalid value, logging 0." << endl;
+                    return Scalar(0.0);
+                }
+
+        default:
+            m_exec_conf->msg->warning() << "analyze.log: Log quantity " << quantity << " is not registered, logging a value of 0" << endl;
+            return Scalar(0.0);
         }
     }
 
@@ -43,6 +43,9 @@
     The removeAll method can be used to clear all registered computes and updaters. hoomd will
     removeAll() and re-register all active computes and updaters before every run()
 
+    The source of every logged quantity is looked up once, on the first analyze() after the logged quantities or the
+    registrations change, so that logging a quantity does not search the maps on every call.
+
     \ingroup analyzers
 */
 class __attribute__((visibility("default"))) Logger : public Analyzer
@@ -107,9 +110,40 @@ class __attribute__((visibility("default"))) Logger : public Analyzer
         //! The values of the logged quantities at the last logger update.
         std::vector< Scalar > m_cached_quantities;
 
+        //! Evaluate all logged quantities into m_cached_quantities
+        void updateCachedQuantities(unsigned int timestep);
+
     private:
-        //! Helper function to get a value for a given quantity
-        Scalar getValue(const std::string &quantity, int timestep);
+        //! Source of a logged quantity
+        struct quantity_source
+            {
+            //! Kinds of sources
+            enum kind_type
+                {
+                none,       //!< The quantity is not registered
+                time,       //!< The built-in wall clock time
+                compute,    //!< A registered compute
+                updater,    //!< A registered updater
+                callback    //!< A registered python callback
+                };
+
+            //! Default constructor
+            quantity_source() : kind(none), py_callback(NULL) {}
+
+            kind_type kind;                              //!< Kind of the source
+            std::shared_ptr<Compute> compute_source;     //!< Compute that provides the quantity
+            std::shared_ptr<Updater> updater_source;     //!< Updater that provides the quantity
+            PyObject *py_callback;                       //!< Callback that provides the quantity
+            };
+
+        std::vector<quantity_source> m_quantity_sources; //!< Source of every logged quantity
+        bool m_sources_valid;                            //!< False if the sources need to be looked up again
+
+        //! Look up the sources of the logged quantities
+        void resolveQuantitySources();
+
+        //! Helper function to get the value of a logged quantity
+        Scalar getValue(unsigned int i, unsigned int timestep);
     };
 
 //! exports the Logger class to python
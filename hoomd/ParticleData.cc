@@ -9,6 +9,7 @@
  */
 #include "ParticleData.h"
 #include "Profiler.h"
+#include "CheckpointIO.h"
 
 #ifdef ENABLE_MPI
 #include "HOOMDMPI.h"
@@ -19,6 +20,10 @@
 #include "GPUPartition.cuh"
 #endif
 
+#ifdef ENABLE_TBB
+#include <tbb/tbb.h>
+#endif
+
 #include "hoomd/extern/pybind/include/pybind11/numpy.h"
 
 #include <iostream>
@@ -27,6 +32,7 @@
 #include <stdexcept>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 using namespace std;
 
@@ -61,6 +67,9 @@ ParticleData::ParticleData(unsigned int N, const BoxDim &global_box, unsigned in
           m_max_nparticles(0),
           m_nglobal(0),
           m_accel_set(false),
+          m_soa_positions(false),
+          m_soa_valid(false),
+          m_soa_ghosts_valid(false),
           m_resize_factor(9./8.),
           m_arrays_allocated(false)
     {
@@ -150,6 +159,9 @@ ParticleData::ParticleData(const SnapshotParticleData<Real>& snapshot,
       m_max_nparticles(0),
       m_nglobal(0),
       m_accel_set(false),
+      m_soa_positions(false),
+      m_soa_valid(false),
+      m_soa_ghosts_valid(false),
       m_resize_factor(9./8.),
       m_arrays_allocated(false)
     {
@@ -260,6 +272,17 @@ const BoxDim & ParticleData::getGlobalBox() const
 */
 void ParticleData::notifyParticleSort()
     {
+    // the permutation is not known, subscribers to the permutation signal have to rebuild
+    emitSortSignals(NULL, NULL);
+    }
+
+/*! \param order Permutation that was applied (new index -> old index), or NULL if unknown
+    \param inverse Inverse permutation (old index -> new index), or NULL if unknown
+*/
+void ParticleData::emitSortSignals(const unsigned int *order, const unsigned int *inverse)
+    {
+    invalidatePositionsSoA();
+
     #ifdef ENABLE_CUDA
     if (m_exec_conf->isCUDAEnabled())
         {
@@ -272,6 +295,125 @@ void ParticleData::notifyParticleSort()
     #endif
 
     m_sort_signal.emit();
+    m_permutation_signal.emit(order, inverse);
+    }
+
+/*! \param order Permutation of the local particles, the particle at old index order[i] moves to index i
+
+    All per-particle arrays are gathered into the alternate arrays in a single (threaded, if TBB is enabled) pass,
+    and swapped in afterwards, so no temporary storage is allocated. The reverse-lookup tags are updated in the
+    same pass. Subscribers are notified with the permutation, so they can update their own index tables
+    incrementally instead of rebuilding them.
+
+    \pre There are no ghost particles
+    \post The sort signals have been emitted, there is no need to call notifyParticleSort()
+*/
+void ParticleData::applyPermutation(const unsigned int *order)
+    {
+    assert(order);
+    assert(m_nghosts == 0);
+
+    if (m_prof) m_prof->push("permute");
+
+    const unsigned int N = m_nparticles;
+
+    if (m_inverse_order.size() < N)
+        m_inverse_order.resize(m_max_nparticles);
+
+        {
+        ArrayHandle<Scalar4> h_pos(m_pos, access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_vel(m_vel, access_location::host, access_mode::read);
+        ArrayHandle<Scalar3> h_accel(m_accel, access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_charge(m_charge, access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_diameter(m_diameter, access_location::host, access_mode::read);
+        ArrayHandle<int3> h_image(m_image, access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_tag(m_tag, access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_body(m_body, access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_orientation(m_orientation, access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_angmom(m_angmom, access_location::host, access_mode::read);
+        ArrayHandle<Scalar3> h_inertia(m_inertia, access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_net_force(m_net_force, access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_net_virial(m_net_virial, access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_net_torque(m_net_torque, access_location::host, access_mode::read);
+
+        ArrayHandle<Scalar4> h_pos_alt(m_pos_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<Scalar4> h_vel_alt(m_vel_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<Scalar3> h_accel_alt(m_accel_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<Scalar> h_charge_alt(m_charge_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<Scalar> h_diameter_alt(m_diameter_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<int3> h_image_alt(m_image_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<unsigned int> h_tag_alt(m_tag_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<unsigned int> h_body_alt(m_body_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<Scalar4> h_orientation_alt(m_orientation_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<Scalar4> h_angmom_alt(m_angmom_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<Scalar3> h_inertia_alt(m_inertia_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<Scalar4> h_net_force_alt(m_net_force_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<Scalar> h_net_virial_alt(m_net_virial_alt, access_location::host, access_mode::overwrite);
+        ArrayHandle<Scalar4> h_net_torque_alt(m_net_torque_alt, access_location::host, access_mode::overwrite);
+
+        ArrayHandle<unsigned int> h_rtag(m_rtag, access_location::host, access_mode::readwrite);
+
+        const unsigned int virial_pitch = m_net_virial.getPitch();
+        const unsigned int virial_pitch_alt = m_net_virial_alt.getPitch();
+        unsigned int *inverse = m_inverse_order.data();
+
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, N),
+            [&](const tbb::blocked_range<unsigned int>& r)
+            {
+            for (unsigned int i = r.begin(); i != r.end(); ++i)
+        #else
+        for (unsigned int i = 0; i < N; ++i)
+        #endif
+                {
+                const unsigned int j = order[i];
+                assert(j < N);
+
+                h_pos_alt.data[i] = h_pos.data[j];
+                h_vel_alt.data[i] = h_vel.data[j];
+                h_accel_alt.data[i] = h_accel.data[j];
+                h_charge_alt.data[i] = h_charge.data[j];
+                h_diameter_alt.data[i] = h_diameter.data[j];
+                h_image_alt.data[i] = h_image.data[j];
+                h_body_alt.data[i] = h_body.data[j];
+                h_orientation_alt.data[i] = h_orientation.data[j];
+                h_angmom_alt.data[i] = h_angmom.data[j];
+                h_inertia_alt.data[i] = h_inertia.data[j];
+                h_net_force_alt.data[i] = h_net_force.data[j];
+                h_net_torque_alt.data[i] = h_net_torque.data[j];
+                for (unsigned int k = 0; k < 6; ++k)
+                    h_net_virial_alt.data[k*virial_pitch_alt+i] = h_net_virial.data[k*virial_pitch+j];
+
+                // tags are unique, so the scattered writes into rtag and the inverse do not conflict
+                const unsigned int tag = h_tag.data[j];
+                h_tag_alt.data[i] = tag;
+                h_rtag.data[tag] = i;
+                inverse[j] = i;
+                }
+        #ifdef ENABLE_TBB
+            });
+        #endif
+        }
+
+    // swap in the reordered data
+    swapPositions();
+    swapVelocities();
+    swapAccelerations();
+    swapCharges();
+    swapDiameters();
+    swapImages();
+    swapTags();
+    swapBodies();
+    swapOrientations();
+    swapAngularMomenta();
+    swapMomentsOfInertia();
+    swapNetForce();
+    swapNetVirial();
+    swapNetTorque();
+
+    if (m_prof) m_prof->pop();
+
+    emitSortSignals(order, m_inverse_order.data());
     }
 
 /*! This function is called any time the ghost particles are removed
@@ -450,6 +592,10 @@ void ParticleData::allocate(unsigned int N)
     // allocate alternate particle data arrays (for swapping in-out)
     allocateAlternateArrays(N);
 
+    // allocate the structure-of-arrays mirror if requested
+    if (m_soa_positions)
+        allocateSoAArrays(N);
+
     // notify observers
     m_max_particle_num_signal.emit();
 
@@ -594,10 +740,100 @@ void ParticleData::setNGlobal(unsigned int nglobal)
     #endif
     }
 
+/*! \param N Number of particles to allocate memory for
+    \post The structure-of-arrays position mirror is allocated
+*/
+void ParticleData::allocateSoAArrays(unsigned int N)
+    {
+    GlobalArray< Scalar > pos_x(N, m_exec_conf);
+    m_pos_x.swap(pos_x);
+    TAG_ALLOCATION(m_pos_x);
+
+    GlobalArray< Scalar > pos_y(N, m_exec_conf);
+    m_pos_y.swap(pos_y);
+    TAG_ALLOCATION(m_pos_y);
+
+    GlobalArray< Scalar > pos_z(N, m_exec_conf);
+    m_pos_z.swap(pos_z);
+    TAG_ALLOCATION(m_pos_z);
+
+    GlobalArray< unsigned int > type_soa(N, m_exec_conf);
+    m_type_soa.swap(type_soa);
+    TAG_ALLOCATION(m_type_soa);
+    }
+
+/*! \param enable True to maintain the structure-of-arrays position mirror
+
+    Disabling the mirror releases its memory. Enabling it allocates the arrays with the current maximum
+    particle number, they are subsequently resized together with the other per-particle arrays.
+*/
+void ParticleData::setPositionsSoA(bool enable)
+    {
+    if (enable == m_soa_positions)
+        return;
+
+    m_soa_positions = enable;
+    invalidatePositionsSoA();
+
+    if (enable)
+        {
+        m_exec_conf->msg->notice(4) << "Enabling structure-of-arrays particle positions" << std::endl;
+        if (m_arrays_allocated)
+            allocateSoAArrays(m_max_nparticles);
+        }
+    else
+        {
+        m_exec_conf->msg->notice(4) << "Disabling structure-of-arrays particle positions" << std::endl;
+        GlobalArray<Scalar>().swap(m_pos_x);
+        GlobalArray<Scalar>().swap(m_pos_y);
+        GlobalArray<Scalar>().swap(m_pos_z);
+        GlobalArray<unsigned int>().swap(m_type_soa);
+        }
+    }
+
+/*! Copies the positions and types of the local and ghost particles from the packed Scalar4 array into the
+    structure-of-arrays mirror, if they have changed since the last update. The producers of positions invalidate
+    the mirror (see invalidatePositionsSoA()), so that the mirror is copied at most once per change, no matter how
+    many consumers read it.
+
+    \pre The mirror has been enabled with setPositionsSoA()
+*/
+void ParticleData::updatePositionsSoA()
+    {
+    assert(m_soa_positions);
+
+    if (m_soa_valid && m_soa_ghosts_valid)
+        return;
+
+    // only the ghosts change with a ghost update
+    unsigned int first = m_soa_valid ? m_nparticles : 0;
+    unsigned int last = m_nparticles + m_nghosts;
+
+    ArrayHandle<Scalar4> h_pos(m_pos, access_location::host, access_mode::read);
+    ArrayHandle<Scalar> h_x(m_pos_x, access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar> h_y(m_pos_y, access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar> h_z(m_pos_z, access_location::host, access_mode::readwrite);
+    ArrayHandle<unsigned int> h_type(m_type_soa, access_location::host, access_mode::readwrite);
+
+    for (unsigned int i = first; i < last; ++i)
+        {
+        const Scalar4 postype = h_pos.data[i];
+        h_x.data[i] = postype.x;
+        h_y.data[i] = postype.y;
+        h_z.data[i] = postype.z;
+        h_type.data[i] = __scalar_as_int(postype.w);
+        }
+
+    m_soa_valid = true;
+    m_soa_ghosts_valid = true;
+    }
+
 /*! \param new_nparticles New particle number
  */
 void ParticleData::resize(unsigned int new_nparticles)
     {
+    invalidatePositionsSoA();
+
     // update the partition information, so it is available to subscribers of various signals early
     #ifdef ENABLE_CUDA
     if (m_exec_conf->isCUDAEnabled())
@@ -680,6 +916,14 @@ void ParticleData::reallocate(unsigned int max_n)
 
     m_comm_flags.resize(max_n);
 
+    if (m_soa_positions)
+        {
+        m_pos_x.resize(max_n);
+        m_pos_y.resize(max_n);
+        m_pos_z.resize(max_n);
+        m_type_soa.resize(max_n);
+        }
+
     #ifdef ENABLE_CUDA
     if (m_exec_conf->isCUDAEnabled() && m_exec_conf->allConcurrentManagedAccess())
         {
@@ -828,6 +1072,8 @@ bool ParticleData::inBox(const SnapshotParticleData<Real> &snap)
 template <class Real>
 void ParticleData::initializeFromSnapshot(const SnapshotParticleData<Real>& snapshot, bool ignore_bodies)
     {
+    invalidatePositionsSoA();
+
     m_exec_conf->msg->notice(4) << "ParticleData: initializing from snapshot" << std::endl;
 
     // remove all ghost particles
@@ -905,11 +1151,8 @@ void ParticleData::initializeFromSnapshot(const SnapshotParticleData<Real>& snap
                 throw std::runtime_error("Error initializing ParticleData");
                 }
 
-            const Index3D& di = m_decomposition->getDomainIndexer();
             unsigned int n_ranks = m_exec_conf->getNRanks();
 
-            BoxDim global_box = m_global_box;
-
             // loop over particles in snapshot, place them into domains
             for (typename std::vector< vec3<Real> >::const_iterator it=snapshot.pos.begin(); it != snapshot.pos.end(); it++)
                 {
@@ -923,45 +1166,12 @@ void ParticleData::initializeFromSnapshot(const SnapshotParticleData<Real>& snap
 
                 // determine domain the particle is placed into
                 Scalar3 pos = vec_to_scalar3(*it);
-                Scalar3 f = m_global_box.makeFraction(pos);
-                int i= f.x * ((Scalar)di.getW());
-                int j= f.y * ((Scalar)di.getH());
-                int k= f.z * ((Scalar)di.getD());
-
-                // wrap particles that are exactly on a boundary
-                // we only need to wrap in the negative direction, since
-                // processor ids are rounded toward zero
-                char3 flags = make_char3(0,0,0);
-                if (i == (int) di.getW())
-                    {
-                    i = 0;
-                    flags.x = 1;
-                    }
-
-                if (j == (int) di.getH())
-                    {
-                    j = 0;
-                    flags.y = 1;
-                    }
-
-                if (k == (int) di.getD())
-                    {
-                    k = 0;
-                    flags.z = 1;
-                    }
-
                 int3 img = snapshot.image[snap_idx];
-
-                // only wrap if the particles is on one of the boundaries
-                uchar3 periodic = make_uchar3(flags.x,flags.y,flags.z);
-                global_box.setPeriodic(periodic);
-                global_box.wrap(pos, img, flags);
-
-                // place particle using actual domain fractions, not global box fraction
-                unsigned int rank = m_decomposition->placeParticle(m_global_box, pos, h_cart_ranks.data);
+                unsigned int rank = placeInitialParticle(pos, img, h_cart_ranks.data);
 
                 if (rank >= n_ranks)
                     {
+                    Scalar3 f = m_global_box.makeFraction(pos);
                     m_exec_conf->msg->error() << "init.*: Particle " << snap_idx << " out of bounds." << std::endl;
                     m_exec_conf->msg->error() << "Cartesian coordinates: " << std::endl;
                     m_exec_conf->msg->error() << "x: " << pos.x << " y: " << pos.y << " z: " << pos.z << std::endl;
@@ -1193,6 +1403,450 @@ void ParticleData::initializeFromSnapshot(const SnapshotParticleData<Real>& snap
     m_num_types_signal.emit();
     }
 
+#ifdef ENABLE_MPI
+/*! \param pos Position of the particle, wrapped on output if it is exactly on a boundary of the global box
+    \param img Image of the particle, updated with \a pos
+    \param cart_ranks Map from cartesian domain index to rank
+    \returns The rank the particle is placed on, or a value >= the number of ranks if it is out of bounds
+*/
+unsigned int ParticleData::placeInitialParticle(Scalar3& pos, int3& img, const unsigned int *cart_ranks)
+    {
+    const Index3D& di = m_decomposition->getDomainIndexer();
+
+    Scalar3 f = m_global_box.makeFraction(pos);
+    int i= f.x * ((Scalar)di.getW());
+    int j= f.y * ((Scalar)di.getH());
+    int k= f.z * ((Scalar)di.getD());
+
+    // wrap particles that are exactly on a boundary
+    // we only need to wrap in the negative direction, since
+    // processor ids are rounded toward zero
+    char3 flags = make_char3(0,0,0);
+    if (i == (int) di.getW())
+        flags.x = 1;
+
+    if (j == (int) di.getH())
+        flags.y = 1;
+
+    if (k == (int) di.getD())
+        flags.z = 1;
+
+    // only wrap if the particles is on one of the boundaries
+    BoxDim global_box = m_global_box;
+    uchar3 periodic = make_uchar3(flags.x,flags.y,flags.z);
+    global_box.setPeriodic(periodic);
+    global_box.wrap(pos, img, flags);
+
+    // place particle using actual domain fractions, not global box fraction
+    return m_decomposition->placeParticle(m_global_box, pos, cart_ranks);
+    }
+
+namespace
+    {
+    //! Data of one particle, sent to the rank that owns it during initialization
+    struct InitialParticle
+        {
+        Scalar3 pos;            //!< Position
+        Scalar3 vel;            //!< Velocity
+        Scalar3 accel;          //!< Acceleration
+        Scalar4 orientation;    //!< Orientation
+        Scalar4 angmom;         //!< Angular momentum
+        Scalar3 inertia;        //!< Principal moments of inertia
+        int3 image;             //!< Image
+        Scalar mass;            //!< Mass
+        Scalar charge;          //!< Charge
+        Scalar diameter;        //!< Diameter
+        unsigned int type;      //!< Type id
+        unsigned int body;      //!< Body id
+        unsigned int tag;       //!< Global tag
+        };
+    }
+
+//! Initialize from snapshot slices held by all ranks
+/*! \param snapshot The particles read by this rank
+    \param first_tag Tag of the first particle in \a snapshot, the particles have consecutive tags
+    \param nglobal Global number of particles, the sum of the snapshot sizes of all ranks
+
+    Unlike initializeFromSnapshot(), the particles are not scattered by the root rank. Every rank places the
+    particles of its own slice into the domains and sends them to their owners in a single all-to-all exchange, so
+    that the full system is never held by a single rank. The type mapping must be set on all ranks.
+
+    \pre The local box must be set before a call to initializeFromDistributedSnapshot().
+*/
+template <class Real>
+void ParticleData::initializeFromDistributedSnapshot(const SnapshotParticleData<Real>& snapshot,
+                                                     unsigned int first_tag,
+                                                     unsigned int nglobal)
+    {
+    m_exec_conf->msg->notice(4) << "ParticleData: initializing from distributed snapshot" << std::endl;
+
+    assert(m_decomposition);
+    const MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+    unsigned int n_ranks = m_exec_conf->getNRanks();
+
+    // remove all ghost particles
+    removeAllGhostParticles();
+
+    // check the input for errors on all ranks
+    int valid = snapshot.validate() && snapshot.type_mapping.size() > 0;
+    unsigned int n_total = snapshot.size;
+    MPI_Allreduce(MPI_IN_PLACE, &valid, 1, MPI_INT, MPI_LAND, mpi_comm);
+    MPI_Allreduce(MPI_IN_PLACE, &n_total, 1, MPI_UNSIGNED, MPI_SUM, mpi_comm);
+    if (! valid || n_total != nglobal)
+        {
+        m_exec_conf->msg->error() << "init.*: invalid distributed particle data snapshot."
+                                << std::endl << std::endl;
+        throw std::runtime_error("Error initializing particle data.");
+        }
+
+    // clear set of active tags
+    m_tag_set.clear();
+
+    // clear reservoir of recycled tags
+    while (! m_recycled_tags.empty())
+        m_recycled_tags.pop();
+
+    // place the particles of this rank into domains
+    std::vector<InitialParticle> particles(snapshot.size);
+    std::vector<unsigned int> dest(snapshot.size);
+    int in_bounds = 1;
+        {
+        ArrayHandle<unsigned int> h_cart_ranks(m_decomposition->getCartRanks(), access_location::host, access_mode::read);
+
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, snapshot.size),
+            [&](const tbb::blocked_range<unsigned int>& r)
+            {
+            for (unsigned int snap_idx = r.begin(); snap_idx != r.end(); ++snap_idx)
+        #else
+        for (unsigned int snap_idx = 0; snap_idx < snapshot.size; snap_idx++)
+        #endif
+                {
+                InitialParticle& p = particles[snap_idx];
+                p.pos = vec_to_scalar3(snapshot.pos[snap_idx]);
+                p.image = snapshot.image[snap_idx];
+                dest[snap_idx] = placeInitialParticle(p.pos, p.image, h_cart_ranks.data);
+
+                p.vel = vec_to_scalar3(snapshot.vel[snap_idx]);
+                p.accel = vec_to_scalar3(snapshot.accel[snap_idx]);
+                p.orientation = quat_to_scalar4(snapshot.orientation[snap_idx]);
+                p.angmom = quat_to_scalar4(snapshot.angmom[snap_idx]);
+                p.inertia = vec_to_scalar3(snapshot.inertia[snap_idx]);
+                p.mass = snapshot.mass[snap_idx];
+                p.charge = snapshot.charge[snap_idx];
+                p.diameter = snapshot.diameter[snap_idx];
+                p.type = snapshot.type[snap_idx];
+                p.body = snapshot.body[snap_idx];
+                p.tag = first_tag + snap_idx;
+                }
+        #ifdef ENABLE_TBB
+            });
+        #endif
+        }
+
+    for (unsigned int snap_idx = 0; snap_idx < snapshot.size; snap_idx++)
+        {
+        if (dest[snap_idx] >= n_ranks)
+            {
+            Scalar3 pos = particles[snap_idx].pos;
+            m_exec_conf->msg->error() << "init.*: Particle " << first_tag + snap_idx << " out of bounds." << std::endl;
+            m_exec_conf->msg->error() << "Cartesian coordinates: " << std::endl;
+            m_exec_conf->msg->error() << "x: " << pos.x << " y: " << pos.y << " z: " << pos.z << std::endl;
+            in_bounds = 0;
+            break;
+            }
+        }
+
+    MPI_Allreduce(MPI_IN_PLACE, &in_bounds, 1, MPI_INT, MPI_LAND, mpi_comm);
+    if (! in_bounds)
+        throw std::runtime_error("Error initializing from snapshot.");
+
+    // sort the particles by destination rank
+    std::vector<int> send_counts(n_ranks, 0);
+    for (unsigned int snap_idx = 0; snap_idx < snapshot.size; snap_idx++)
+        send_counts[dest[snap_idx]]++;
+
+    std::vector<int> send_displs(n_ranks, 0);
+    for (unsigned int r = 1; r < n_ranks; r++)
+        send_displs[r] = send_displs[r-1] + send_counts[r-1];
+
+    std::vector<InitialParticle> send_buf(snapshot.size);
+        {
+        std::vector<int> offset(send_displs);
+        for (unsigned int snap_idx = 0; snap_idx < snapshot.size; snap_idx++)
+            send_buf[offset[dest[snap_idx]]++] = particles[snap_idx];
+        }
+    std::vector<InitialParticle>().swap(particles);
+
+    // exchange the particles
+    std::vector<int> recv_counts(n_ranks);
+    MPI_Alltoall(&send_counts[0], 1, MPI_INT, &recv_counts[0], 1, MPI_INT, mpi_comm);
+
+    std::vector<int> recv_displs(n_ranks, 0);
+    for (unsigned int r = 1; r < n_ranks; r++)
+        recv_displs[r] = recv_displs[r-1] + recv_counts[r-1];
+
+    MPI_Datatype mpi_particle;
+    MPI_Type_contiguous(sizeof(InitialParticle), MPI_BYTE, &mpi_particle);
+    MPI_Type_commit(&mpi_particle);
+
+    std::vector<InitialParticle> recv_buf(recv_displs[n_ranks-1] + recv_counts[n_ranks-1]);
+    MPI_Alltoallv(send_buf.data(), &send_counts[0], &send_displs[0], mpi_particle,
+                  recv_buf.data(), &recv_counts[0], &recv_displs[0], mpi_particle, mpi_comm);
+    MPI_Type_free(&mpi_particle);
+
+    // all ranks hold the type mapping
+    m_type_mapping = snapshot.type_mapping;
+
+    // resize array for reverse-lookup tags
+    m_rtag.resize(nglobal);
+
+        {
+        // reset all reverse lookup tags to NOT_LOCAL flag
+        ArrayHandle<unsigned int> h_rtag(getRTags(), access_location::host, access_mode::overwrite);
+
+        // we have to reset all previous rtags, to remove 'leftover' ghosts
+        unsigned int max_tag = m_rtag.size();
+        for (unsigned int tag = 0; tag < max_tag; tag++)
+            h_rtag.data[tag] = NOT_LOCAL;
+        }
+
+    // update list of active tags
+    for (unsigned int tag = 0; tag < nglobal; tag++)
+        {
+        m_tag_set.insert(tag);
+        }
+
+    // Now that active tag list has changed, invalidate the cache
+    m_invalid_cached_tags = true;
+
+    // resize particle data
+    m_nparticles = recv_buf.size();
+    resize(m_nparticles);
+
+        {
+        // Load particle data
+        ArrayHandle< Scalar4 > h_pos(m_pos, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar4 > h_vel(m_vel, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar3 > h_accel(m_accel, access_location::host, access_mode::overwrite);
+        ArrayHandle< int3 > h_image(m_image, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar > h_charge(m_charge, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar > h_diameter(m_diameter, access_location::host, access_mode::overwrite);
+        ArrayHandle< unsigned int > h_body(m_body, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar4 > h_orientation(m_orientation, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar4 > h_angmom(m_angmom, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar3 > h_inertia(m_inertia, access_location::host, access_mode::overwrite);
+        ArrayHandle< unsigned int > h_tag(m_tag, access_location::host, access_mode::overwrite);
+        ArrayHandle< unsigned int > h_comm_flag(m_comm_flags, access_location::host, access_mode::overwrite);
+        ArrayHandle< unsigned int > h_rtag(m_rtag, access_location::host, access_mode::readwrite);
+
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_nparticles),
+            [&](const tbb::blocked_range<unsigned int>& r)
+            {
+            for (unsigned int idx = r.begin(); idx != r.end(); ++idx)
+        #else
+        for (unsigned int idx = 0; idx < m_nparticles; idx++)
+        #endif
+                {
+                const InitialParticle& p = recv_buf[idx];
+                h_pos.data[idx] = make_scalar4(p.pos.x, p.pos.y, p.pos.z, __int_as_scalar(p.type));
+                h_vel.data[idx] = make_scalar4(p.vel.x, p.vel.y, p.vel.z, p.mass);
+                h_accel.data[idx] = p.accel;
+                h_charge.data[idx] = p.charge;
+                h_diameter.data[idx] = p.diameter;
+                h_image.data[idx] = p.image;
+                h_tag.data[idx] = p.tag;
+                h_rtag.data[p.tag] = idx;
+                h_body.data[idx] = p.body;
+                h_orientation.data[idx] = p.orientation;
+                h_angmom.data[idx] = p.angmom;
+                h_inertia.data[idx] = p.inertia;
+
+                h_comm_flag.data[idx] = 0; // initialize with zero
+                }
+        #ifdef ENABLE_TBB
+            });
+        #endif
+        }
+
+    // the acceleration is set if it is set in any slice
+    int accel_set = snapshot.is_accel_set;
+    MPI_Allreduce(MPI_IN_PLACE, &accel_set, 1, MPI_INT, MPI_LOR, mpi_comm);
+    m_accel_set = accel_set;
+
+    // set global number of particles
+    setNGlobal(nglobal);
+
+    // notify listeners about resorting of local particles
+    notifyParticleSort();
+
+    // zero the origin
+    m_origin = make_scalar3(0,0,0);
+    m_o_image = make_int3(0,0,0);
+
+    // notify listeners that number of types has changed
+    m_num_types_signal.emit();
+    }
+#endif
+
+/*! \param out Stream to write to
+
+    Only the local particles are written, ghost particles are recreated by the communication at the next step. The
+    global tag state is identical on all ranks and written to every stream, it is stored as the global number of
+    particles and the stack of recycled tags, since the active tags are all tags below
+    getNGlobal() + (number of recycled tags) that have not been recycled. The type mapping is not part of the stream.
+
+    \sa readCheckpoint()
+*/
+void ParticleData::writeCheckpoint(std::ostream& out) const
+    {
+    // the stack of recycled tags, bottom first
+    std::vector<unsigned int> recycled_tags;
+    std::stack<unsigned int> recycled(m_recycled_tags);
+    while (! recycled.empty())
+        {
+        recycled_tags.push_back(recycled.top());
+        recycled.pop();
+        }
+    std::reverse(recycled_tags.begin(), recycled_tags.end());
+
+    unsigned int N = getN();
+    checkpoint_write(out, N);
+    checkpoint_write(out, m_nglobal);
+    checkpoint_write(out, recycled_tags);
+    checkpoint_write(out, (uint8_t)m_accel_set);
+    checkpoint_write(out, m_origin);
+    checkpoint_write(out, m_o_image);
+
+    ArrayHandle< Scalar4 > h_pos(m_pos, access_location::host, access_mode::read);
+    ArrayHandle< Scalar4 > h_vel(m_vel, access_location::host, access_mode::read);
+    ArrayHandle< Scalar3 > h_accel(m_accel, access_location::host, access_mode::read);
+    ArrayHandle< Scalar > h_charge(m_charge, access_location::host, access_mode::read);
+    ArrayHandle< Scalar > h_diameter(m_diameter, access_location::host, access_mode::read);
+    ArrayHandle< int3 > h_image(m_image, access_location::host, access_mode::read);
+    ArrayHandle< unsigned int > h_body(m_body, access_location::host, access_mode::read);
+    ArrayHandle< Scalar4 > h_orientation(m_orientation, access_location::host, access_mode::read);
+    ArrayHandle< Scalar4 > h_angmom(m_angmom, access_location::host, access_mode::read);
+    ArrayHandle< Scalar3 > h_inertia(m_inertia, access_location::host, access_mode::read);
+    ArrayHandle< unsigned int > h_tag(m_tag, access_location::host, access_mode::read);
+
+    checkpoint_write(out, h_pos.data, N);
+    checkpoint_write(out, h_vel.data, N);
+    checkpoint_write(out, h_accel.data, N);
+    checkpoint_write(out, h_charge.data, N);
+    checkpoint_write(out, h_diameter.data, N);
+    checkpoint_write(out, h_image.data, N);
+    checkpoint_write(out, h_body.data, N);
+    checkpoint_write(out, h_orientation.data, N);
+    checkpoint_write(out, h_angmom.data, N);
+    checkpoint_write(out, h_inertia.data, N);
+    checkpoint_write(out, h_tag.data, N);
+    }
+
+/*! \param in Stream to read from, written by writeCheckpoint()
+
+    The particles are restored in their local order, without checking that they are inside the local box. The caller
+    must ensure that the domain decomposition is the one the checkpoint was written with. The type mapping must have
+    been set before. If the stream is truncated, reading stops and the caller is expected to check the stream state.
+*/
+void ParticleData::readCheckpoint(std::istream& in)
+    {
+    m_exec_conf->msg->notice(4) << "ParticleData: restoring from checkpoint" << std::endl;
+
+    // remove all ghost particles
+    removeAllGhostParticles();
+
+    unsigned int N = 0;
+    unsigned int nglobal = 0;
+    std::vector<unsigned int> recycled_tags;
+    uint8_t accel_set = 0;
+    checkpoint_read(in, N);
+    checkpoint_read(in, nglobal);
+    checkpoint_read(in, recycled_tags);
+    checkpoint_read(in, accel_set);
+    checkpoint_read(in, m_origin);
+    checkpoint_read(in, m_o_image);
+    if (! in)
+        return;
+
+    // restore the active tags and the reservoir of recycled tags
+    m_tag_set.clear();
+    while (! m_recycled_tags.empty())
+        m_recycled_tags.pop();
+
+    for (unsigned int i = 0; i < recycled_tags.size(); i++)
+        m_recycled_tags.push(recycled_tags[i]);
+
+    unsigned int n_tags = nglobal + recycled_tags.size();
+    std::sort(recycled_tags.begin(), recycled_tags.end());
+    std::vector<unsigned int>::const_iterator next_recycled = recycled_tags.begin();
+    for (unsigned int tag = 0; tag < n_tags; tag++)
+        {
+        if (next_recycled != recycled_tags.end() && *next_recycled == tag)
+            {
+            ++next_recycled;
+            continue;
+            }
+        m_tag_set.insert(m_tag_set.end(), tag);
+        }
+
+    // Now that active tag list has changed, invalidate the cache
+    m_invalid_cached_tags = true;
+
+    m_rtag.resize(n_tags);
+    resize(N);
+
+        {
+        ArrayHandle< Scalar4 > h_pos(m_pos, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar4 > h_vel(m_vel, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar3 > h_accel(m_accel, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar > h_charge(m_charge, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar > h_diameter(m_diameter, access_location::host, access_mode::overwrite);
+        ArrayHandle< int3 > h_image(m_image, access_location::host, access_mode::overwrite);
+        ArrayHandle< unsigned int > h_body(m_body, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar4 > h_orientation(m_orientation, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar4 > h_angmom(m_angmom, access_location::host, access_mode::overwrite);
+        ArrayHandle< Scalar3 > h_inertia(m_inertia, access_location::host, access_mode::overwrite);
+        ArrayHandle< unsigned int > h_tag(m_tag, access_location::host, access_mode::overwrite);
+        ArrayHandle< unsigned int > h_comm_flag(m_comm_flags, access_location::host, access_mode::overwrite);
+        ArrayHandle< unsigned int > h_rtag(m_rtag, access_location::host, access_mode::overwrite);
+
+        checkpoint_read(in, h_pos.data, N);
+        checkpoint_read(in, h_vel.data, N);
+        checkpoint_read(in, h_accel.data, N);
+        checkpoint_read(in, h_charge.data, N);
+        checkpoint_read(in, h_diameter.data, N);
+        checkpoint_read(in, h_image.data, N);
+        checkpoint_read(in, h_body.data, N);
+        checkpoint_read(in, h_orientation.data, N);
+        checkpoint_read(in, h_angmom.data, N);
+        checkpoint_read(in, h_inertia.data, N);
+        checkpoint_read(in, h_tag.data, N);
+
+        for (unsigned int tag = 0; tag < n_tags; tag++)
+            h_rtag.data[tag] = NOT_LOCAL;
+
+        for (unsigned int idx = 0; idx < N; idx++)
+            {
+            if (in && h_tag.data[idx] < n_tags)
+                h_rtag.data[h_tag.data[idx]] = idx;
+            h_comm_flag.data[idx] = 0;
+            }
+        }
+
+    m_accel_set = accel_set;
+
+    // set global number of particles
+    setNGlobal(nglobal);
+
+    // notify listeners about resorting of local particles
+    notifyParticleSort();
+
+    // notify listeners that number of types has changed
+    m_num_types_signal.emit();
+    }
+
 //! take a particle data snapshot
 /* \param snapshot The snapshot to write to
    \returns a map to lookup the snapshot index from a particle tag
@@ -1202,9 +1856,29 @@ void ParticleData::initializeFromSnapshot(const SnapshotParticleData<Real>& snap
 template <class Real>
 std::map<unsigned int, unsigned int> ParticleData::takeSnapshot(SnapshotParticleData<Real> &snapshot)
     {
-    // a map to contain a particle tag-> snapshot idx lookup
+    std::vector<unsigned int> snap_idx;
+    takeSnapshot(snapshot, snap_idx);
+
+    // a map to contain a particle tag-> snapshot idx lookup, the tags are inserted in order
     std::map<unsigned int, unsigned int> index;
+    for (unsigned int tag = 0; tag < snap_idx.size(); ++tag)
+        if (snap_idx[tag] != NOT_LOCAL)
+            index.insert(index.end(), std::make_pair(tag, snap_idx[tag]));
+
+    return index;
+    }
+
+//! take a particle data snapshot
+/* \param snapshot The snapshot to write to
+   \param snap_idx Snapshot index of every particle tag, NOT_LOCAL for inactive tags (output)
 
+   The snapshot is in tag order. With domain decomposition, every rank sends flat arrays of its particle tags and
+   properties to the root, which scatters them into the snapshot in parallel. The snapshot and \a snap_idx are only
+   filled on the root processor.
+*/
+template <class Real>
+void ParticleData::takeSnapshot(SnapshotParticleData<Real> &snapshot, std::vector<unsigned int>& snap_idx)
+    {
     m_exec_conf->msg->notice(4) << "ParticleData: taking snapshot" << std::endl;
 
     ArrayHandle< Scalar4 > h_pos(m_pos, access_location::host, access_mode::read);
@@ -1220,6 +1894,8 @@ std::map<unsigned int, unsigned int> ParticleData::takeSnapshot(SnapshotParticle
     ArrayHandle< unsigned int > h_tag(m_tag, access_location::host, access_mode::read);
     ArrayHandle< unsigned int > h_rtag(m_rtag, access_location::host, access_mode::read);
 
+    const unsigned int nglobal = getNGlobal();
+
 #ifdef ENABLE_MPI
     if (m_decomposition)
         {
@@ -1237,198 +1913,205 @@ std::map<unsigned int, unsigned int> ParticleData::takeSnapshot(SnapshotParticle
         std::vector<Scalar4> angmom(m_nparticles);
         std::vector<Scalar3> inertia(m_nparticles);
         std::vector<unsigned int> tag(m_nparticles);
-        std::map<unsigned int, unsigned int> rtag_map;
-        for (unsigned int idx = 0; idx < m_nparticles; idx++)
-            {
-            pos[idx] = make_scalar3(h_pos.data[idx].x, h_pos.data[idx].y, h_pos.data[idx].z) - m_origin;
-            vel[idx] = make_scalar3(h_vel.data[idx].x, h_vel.data[idx].y, h_vel.data[idx].z);
-            accel[idx] = h_accel.data[idx];
-            type[idx] = __scalar_as_int(h_pos.data[idx].w);
-            mass[idx] = h_vel.data[idx].w;
-            charge[idx] = h_charge.data[idx];
-            diameter[idx] = h_diameter.data[idx];
-            image[idx] = h_image.data[idx];
-            image[idx].x -= m_o_image.x;
-            image[idx].y -= m_o_image.y;
-            image[idx].z -= m_o_image.z;
-            body[idx] = h_body.data[idx];
-            orientation[idx] = h_orientation.data[idx];
-            angmom[idx] = h_angmom.data[idx];
-            inertia[idx] = h_inertia.data[idx];
-
-            // insert reverse lookup global tag -> idx
-            rtag_map.insert(std::pair<unsigned int, unsigned int>(h_tag.data[idx], idx));
-            }
 
-        std::vector< std::vector<Scalar3> > pos_proc;              // Position array of every processor
-        std::vector< std::vector<Scalar3> > vel_proc;              // Velocities array of every processor
-        std::vector< std::vector<Scalar3> > accel_proc;            // Accelerations array of every processor
-        std::vector< std::vector<unsigned int> > type_proc;        // Particle types array of every processor
-        std::vector< std::vector<Scalar > > mass_proc;             // Particle masses array of every processor
-        std::vector< std::vector<Scalar > > charge_proc;           // Particle charges array of every processor
-        std::vector< std::vector<Scalar > > diameter_proc;         // Particle diameters array of every processor
-        std::vector< std::vector<int3 > > image_proc;              // Particle images array of every processor
-        std::vector< std::vector<unsigned int > > body_proc;       // Body ids of every processor
-        std::vector< std::vector<Scalar4 > > orientation_proc;     // Orientations of every processor
-        std::vector< std::vector<Scalar4 > > angmom_proc;          // Angular momenta of every processor
-        std::vector< std::vector<Scalar3 > > inertia_proc;         // Moments of inertia of every processor
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_nparticles),
+            [&](const tbb::blocked_range<unsigned int>& r)
+            {
+            for (unsigned int idx = r.begin(); idx != r.end(); ++idx)
+        #else
+        for (unsigned int idx = 0; idx < m_nparticles; idx++)
+        #endif
+                {
+                pos[idx] = make_scalar3(h_pos.data[idx].x, h_pos.data[idx].y, h_pos.data[idx].z) - m_origin;
+                vel[idx] = make_scalar3(h_vel.data[idx].x, h_vel.data[idx].y, h_vel.data[idx].z);
+                accel[idx] = h_accel.data[idx];
+                type[idx] = __scalar_as_int(h_pos.data[idx].w);
+                mass[idx] = h_vel.data[idx].w;
+                charge[idx] = h_charge.data[idx];
+                diameter[idx] = h_diameter.data[idx];
+                image[idx] = h_image.data[idx];
+                image[idx].x -= m_o_image.x;
+                image[idx].y -= m_o_image.y;
+                image[idx].z -= m_o_image.z;
+                body[idx] = h_body.data[idx];
+                orientation[idx] = h_orientation.data[idx];
+                angmom[idx] = h_angmom.data[idx];
+                inertia[idx] = h_inertia.data[idx];
+                tag[idx] = h_tag.data[idx];
+                }
+        #ifdef ENABLE_TBB
+            });
+        #endif
 
-        std::vector< std::map<unsigned int, unsigned int> > rtag_map_proc; // List of reverse-lookup maps
+        // Arrays of all processors, concatenated in rank order
+        std::vector<Scalar3> pos_all;
+        std::vector<Scalar3> vel_all;
+        std::vector<Scalar3> accel_all;
+        std::vector<unsigned int> type_all;
+        std::vector<Scalar> mass_all;
+        std::vector<Scalar> charge_all;
+        std::vector<Scalar> diameter_all;
+        std::vector<int3> image_all;
+        std::vector<unsigned int> body_all;
+        std::vector<Scalar4> orientation_all;
+        std::vector<Scalar4> angmom_all;
+        std::vector<Scalar3> inertia_all;
+        std::vector<unsigned int> tag_all;
 
         const MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
-        unsigned int size = m_exec_conf->getNRanks();
         unsigned int rank = m_exec_conf->getRank();
 
-        // resize to number of ranks in communicator
-        pos_proc.resize(size);
-        vel_proc.resize(size);
-        accel_proc.resize(size);
-        type_proc.resize(size);
-        mass_proc.resize(size);
-        charge_proc.resize(size);
-        diameter_proc.resize(size);
-        image_proc.resize(size);
-        body_proc.resize(size);
-        orientation_proc.resize(size);
-        angmom_proc.resize(size);
-        inertia_proc.resize(size);
-        rtag_map_proc.resize(size);
-
         unsigned int root = 0;
 
         // collect all particle data on the root processor
-        gather_v(pos, pos_proc, root,mpi_comm);
-        gather_v(vel, vel_proc, root, mpi_comm);
-        gather_v(accel, accel_proc, root, mpi_comm);
-        gather_v(type, type_proc, root, mpi_comm);
-        gather_v(mass, mass_proc, root, mpi_comm);
-        gather_v(charge, charge_proc, root, mpi_comm);
-        gather_v(diameter, diameter_proc, root, mpi_comm);
-        gather_v(image, image_proc, root, mpi_comm);
-        gather_v(body, body_proc, root, mpi_comm);
-        gather_v(orientation, orientation_proc, root, mpi_comm);
-        gather_v(angmom, angmom_proc, root, mpi_comm);
-        gather_v(inertia, inertia_proc, root, mpi_comm);
-
-        // gather the reverse-lookup maps
-        gather_v(rtag_map, rtag_map_proc, root, mpi_comm);
+        gather_v_flat(pos, pos_all, root, mpi_comm);
+        gather_v_flat(vel, vel_all, root, mpi_comm);
+        gather_v_flat(accel, accel_all, root, mpi_comm);
+        gather_v_flat(type, type_all, root, mpi_comm);
+        gather_v_flat(mass, mass_all, root, mpi_comm);
+        gather_v_flat(charge, charge_all, root, mpi_comm);
+        gather_v_flat(diameter, diameter_all, root, mpi_comm);
+        gather_v_flat(image, image_all, root, mpi_comm);
+        gather_v_flat(body, body_all, root, mpi_comm);
+        gather_v_flat(orientation, orientation_all, root, mpi_comm);
+        gather_v_flat(angmom, angmom_all, root, mpi_comm);
+        gather_v_flat(inertia, inertia_all, root, mpi_comm);
+        gather_v_flat(tag, tag_all, root, mpi_comm);
 
         if (rank == root)
             {
             // allocate memory in snapshot
-            snapshot.resize(getNGlobal());
-
-            unsigned int n_ranks = m_exec_conf->getNRanks();
-            assert(rtag_map_proc.size() == n_ranks);
-
-            // create single map of all particle ranks and indices
-            std::map<unsigned int, std::pair<unsigned int, unsigned int> > rank_rtag_map;
-            std::map<unsigned int, unsigned int>::iterator it;
-            for (unsigned int irank = 0; irank < n_ranks; ++irank)
-                for (it = rtag_map_proc[irank].begin(); it != rtag_map_proc[irank].end(); ++it)
-                    rank_rtag_map.insert(std::pair<unsigned int, std::pair<unsigned int, unsigned int> >(
-                        it->first, std::pair<unsigned int, unsigned int>(irank, it->second)));
-
-            // add particles to snapshot
-            assert(m_tag_set.size() == getNGlobal());
-            std::set<unsigned int>::const_iterator tag_set_it = m_tag_set.begin();
-
-            std::map<unsigned int, std::pair<unsigned int, unsigned int> >::iterator rank_rtag_it;
-            for (unsigned int snap_id = 0; snap_id < getNGlobal(); snap_id++)
+            snapshot.resize(nglobal);
+
+            // the snapshot is in tag order
+            assert(m_tag_set.size() == nglobal);
+            snap_idx.assign(m_tag_set.empty() ? 0 : *m_tag_set.rbegin() + 1, NOT_LOCAL);
+            unsigned int n = 0;
+            for (std::set<unsigned int>::const_iterator it = m_tag_set.begin(); it != m_tag_set.end(); ++it)
+                snap_idx[*it] = n++;
+
+            // position of every particle in the gathered arrays
+            std::vector<unsigned int> gathered_idx(nglobal, NOT_LOCAL);
+            for (unsigned int i = 0; i < tag_all.size(); ++i)
                 {
-                unsigned int tag = *tag_set_it;
-                assert(tag <= getMaximumTag());
-                rank_rtag_it = rank_rtag_map.find(tag);
-
-                if (rank_rtag_it == rank_rtag_map.end())
+                unsigned int t = tag_all[i];
+                if (t >= snap_idx.size() || snap_idx[t] == NOT_LOCAL)
                     {
                     m_exec_conf->msg->error()
-                        << endl << "Could not find particle " << tag << " on any processor. "
+                        << endl << "Found inactive particle " << t << " during snapshot. "
                         << endl << endl;
                     throw std::runtime_error("Error gathering ParticleData");
                     }
+                gathered_idx[snap_idx[t]] = i;
+                }
 
-                // rank contains the processor rank on which the particle was found
-                std::pair<unsigned int, unsigned int> rank_idx = rank_rtag_it->second;
-                unsigned int rank = rank_idx.first;
-                unsigned int idx = rank_idx.second;
-
-                // store tag in index map
-                index.insert(std::make_pair(tag, snap_id));
-
-                snapshot.pos[snap_id] = vec3<Real>(pos_proc[rank][idx]);
-                snapshot.vel[snap_id] = vec3<Real>(vel_proc[rank][idx]);
-                snapshot.accel[snap_id] = vec3<Real>(accel_proc[rank][idx]);
-                snapshot.type[snap_id] = type_proc[rank][idx];
-                snapshot.mass[snap_id] = mass_proc[rank][idx];
-                snapshot.charge[snap_id] = charge_proc[rank][idx];
-                snapshot.diameter[snap_id] = diameter_proc[rank][idx];
-                snapshot.image[snap_id] = image_proc[rank][idx];
-                snapshot.body[snap_id] = body_proc[rank][idx];
-                snapshot.orientation[snap_id] = quat<Real>(orientation_proc[rank][idx]);
-                snapshot.angmom[snap_id] = quat<Real>(angmom_proc[rank][idx]);
-                snapshot.inertia[snap_id] = vec3<Real>(inertia_proc[rank][idx]);
-
-                // make sure the position stored in the snapshot is within the boundaries
-                Scalar3 tmp = vec_to_scalar3(snapshot.pos[snap_id]);
-                m_global_box.wrap(tmp, snapshot.image[snap_id]);
-                snapshot.pos[snap_id] = vec3<Real>(tmp);
-
-                std::advance(tag_set_it, 1);
+            for (unsigned int snap_id = 0; snap_id < nglobal; ++snap_id)
+                {
+                if (gathered_idx[snap_id] == NOT_LOCAL)
+                    {
+                    unsigned int t = *std::next(m_tag_set.begin(), snap_id);
+                    m_exec_conf->msg->error()
+                        << endl << "Could not find particle " << t << " on any processor. "
+                        << endl << endl;
+                    throw std::runtime_error("Error gathering ParticleData");
+                    }
                 }
+
+            // add particles to snapshot
+            #ifdef ENABLE_TBB
+            tbb::parallel_for(tbb::blocked_range<unsigned int>(0, nglobal),
+                [&](const tbb::blocked_range<unsigned int>& r)
+                {
+                for (unsigned int snap_id = r.begin(); snap_id != r.end(); ++snap_id)
+            #else
+            for (unsigned int snap_id = 0; snap_id < nglobal; ++snap_id)
+            #endif
+                    {
+                    unsigned int i = gathered_idx[snap_id];
+
+                    snapshot.pos[snap_id] = vec3<Real>(pos_all[i]);
+                    snapshot.vel[snap_id] = vec3<Real>(vel_all[i]);
+                    snapshot.accel[snap_id] = vec3<Real>(accel_all[i]);
+                    snapshot.type[snap_id] = type_all[i];
+                    snapshot.mass[snap_id] = mass_all[i];
+                    snapshot.charge[snap_id] = charge_all[i];
+                    snapshot.diameter[snap_id] = diameter_all[i];
+                    snapshot.image[snap_id] = image_all[i];
+                    snapshot.body[snap_id] = body_all[i];
+                    snapshot.orientation[snap_id] = quat<Real>(orientation_all[i]);
+                    snapshot.angmom[snap_id] = quat<Real>(angmom_all[i]);
+                    snapshot.inertia[snap_id] = vec3<Real>(inertia_all[i]);
+
+                    // make sure the position stored in the snapshot is within the boundaries
+                    Scalar3 tmp = vec_to_scalar3(snapshot.pos[snap_id]);
+                    m_global_box.wrap(tmp, snapshot.image[snap_id]);
+                    snapshot.pos[snap_id] = vec3<Real>(tmp);
+                    }
+            #ifdef ENABLE_TBB
+                });
+            #endif
             }
         }
     else
 #endif
         {
         // allocate memory in snapshot
-        snapshot.resize(getNGlobal());
+        snapshot.resize(nglobal);
 
+        // the snapshot is in tag order
         assert(m_tag_set.size() == m_nparticles);
-        std::set<unsigned int>::const_iterator it = m_tag_set.begin();
+        std::vector<unsigned int> tags(m_tag_set.begin(), m_tag_set.end());
+        snap_idx.assign(tags.empty() ? 0 : tags.back() + 1, NOT_LOCAL);
 
         // iterate through active tags
-        for (unsigned int snap_id = 0; snap_id < m_nparticles; snap_id++)
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_nparticles),
+            [&](const tbb::blocked_range<unsigned int>& r)
             {
-            unsigned int tag = *it;
-            assert(tag <= getMaximumTag());
-            unsigned int idx = h_rtag.data[tag];
-            assert(idx < m_nparticles);
-
-            // store tag in index map
-            index.insert(std::make_pair(tag, snap_id));
-
-            snapshot.pos[snap_id] = vec3<Real>(make_scalar3(h_pos.data[idx].x, h_pos.data[idx].y, h_pos.data[idx].z) - m_origin);
-            snapshot.vel[snap_id] = vec3<Real>(make_scalar3(h_vel.data[idx].x, h_vel.data[idx].y, h_vel.data[idx].z));
-            snapshot.accel[snap_id] = vec3<Real>(h_accel.data[idx]);
-            snapshot.type[snap_id] = __scalar_as_int(h_pos.data[idx].w);
-            snapshot.mass[snap_id] = h_vel.data[idx].w;
-            snapshot.charge[snap_id] = h_charge.data[idx];
-            snapshot.diameter[snap_id] = h_diameter.data[idx];
-            snapshot.image[snap_id] = h_image.data[idx];
-            snapshot.image[snap_id].x -= m_o_image.x;
-            snapshot.image[snap_id].y -= m_o_image.y;
-            snapshot.image[snap_id].z -= m_o_image.z;
-            snapshot.body[snap_id] = h_body.data[idx];
-            snapshot.orientation[snap_id] = quat<Real>(h_orientation.data[idx]);
-            snapshot.angmom[snap_id] = quat<Real>(h_angmom.data[idx]);
-            snapshot.inertia[snap_id] = vec3<Real>(h_inertia.data[idx]);
-
-            // make sure the position stored in the snapshot is within the boundaries
-            Scalar3 tmp = vec_to_scalar3(snapshot.pos[snap_id]);
-            m_global_box.wrap(tmp, snapshot.image[snap_id]);
-            snapshot.pos[snap_id] = vec3<Real>(tmp);
-
-            std::advance(it, 1);
-            }
+            for (unsigned int snap_id = r.begin(); snap_id != r.end(); ++snap_id)
+        #else
+        for (unsigned int snap_id = 0; snap_id < m_nparticles; snap_id++)
+        #endif
+                {
+                unsigned int tag = tags[snap_id];
+                assert(tag <= getMaximumTag());
+                unsigned int idx = h_rtag.data[tag];
+                assert(idx < m_nparticles);
+
+                // store snapshot index of the tag
+                snap_idx[tag] = snap_id;
+
+                snapshot.pos[snap_id] = vec3<Real>(make_scalar3(h_pos.data[idx].x, h_pos.data[idx].y, h_pos.data[idx].z) - m_origin);
+                snapshot.vel[snap_id] = vec3<Real>(make_scalar3(h_vel.data[idx].x, h_vel.data[idx].y, h_vel.data[idx].z));
+                snapshot.accel[snap_id] = vec3<Real>(h_accel.data[idx]);
+                snapshot.type[snap_id] = __scalar_as_int(h_pos.data[idx].w);
+                snapshot.mass[snap_id] = h_vel.data[idx].w;
+                snapshot.charge[snap_id] = h_charge.data[idx];
+                snapshot.diameter[snap_id] = h_diameter.data[idx];
+                snapshot.image[snap_id] = h_image.data[idx];
+                snapshot.image[snap_id].x -= m_o_image.x;
+                snapshot.image[snap_id].y -= m_o_image.y;
+                snapshot.image[snap_id].z -= m_o_image.z;
+                snapshot.body[snap_id] = h_body.data[idx];
+                snapshot.orientation[snap_id] = quat<Real>(h_orientation.data[idx]);
+                snapshot.angmom[snap_id] = quat<Real>(h_angmom.data[idx]);
+                snapshot.inertia[snap_id] = vec3<Real>(h_inertia.data[idx]);
+
+                // make sure the position stored in the snapshot is within the boundaries
+                Scalar3 tmp = vec_to_scalar3(snapshot.pos[snap_id]);
+                m_global_box.wrap(tmp, snapshot.image[snap_id]);
+                snapshot.pos[snap_id] = vec3<Real>(tmp);
+                }
+        #ifdef ENABLE_TBB
+            });
+        #endif
         }
 
     snapshot.type_mapping = m_type_mapping;
 
     // copy over acceleration set flag (this is a copy in case users take a snapshot before running)
     snapshot.is_accel_set = m_accel_set;
-
-    return index;
     }
 
 //! Add ghost particles at the end of the local particle data
@@ -1442,6 +2125,8 @@ std::map<unsigned int, unsigned int> ParticleData::takeSnapshot(SnapshotParticle
 */
 void ParticleData::addGhostParticles(const unsigned int nghosts)
     {
+    invalidateGhostPositionsSoA();
+
     assert(nghosts >= 0);
 
     unsigned int max_nparticles = m_max_nparticles;
@@ -1878,6 +2563,8 @@ Scalar ParticleData::getPNetVirial(unsigned int tag, unsigned int component) con
  */
 void ParticleData::setPosition(unsigned int tag, const Scalar3& pos, bool move)
     {
+    invalidatePositionsSoA();
+
     //shift using gridtshift origin
     Scalar3 tmp_pos = pos + m_origin;
 
@@ -2478,6 +3165,12 @@ template ParticleData::ParticleData(const SnapshotParticleData<double>& snapshot
                                           );
 template void ParticleData::initializeFromSnapshot<double>(const SnapshotParticleData<double> & snapshot, bool ignore_bodies);
 template std::map<unsigned int, unsigned int> ParticleData::takeSnapshot<double>(SnapshotParticleData<double> &snapshot);
+template void ParticleData::takeSnapshot<double>(SnapshotParticleData<double> &snapshot, std::vector<unsigned int>& snap_idx);
+#ifdef ENABLE_MPI
+template void ParticleData::initializeFromDistributedSnapshot<double>(const SnapshotParticleData<double> & snapshot,
+                                                                     unsigned int first_tag,
+                                                                     unsigned int nglobal);
+#endif
 
 
 template ParticleData::ParticleData(const SnapshotParticleData<float>& snapshot,
@@ -2487,6 +3180,12 @@ template ParticleData::ParticleData(const SnapshotParticleData<float>& snapshot,
                                           );
 template void ParticleData::initializeFromSnapshot<float>(const SnapshotParticleData<float> & snapshot, bool ignore_bodies);
 template std::map<unsigned int, unsigned int> ParticleData::takeSnapshot<float>(SnapshotParticleData<float> &snapshot);
+template void ParticleData::takeSnapshot<float>(SnapshotParticleData<float> &snapshot, std::vector<unsigned int>& snap_idx);
+#ifdef ENABLE_MPI
+template void ParticleData::initializeFromDistributedSnapshot<float>(const SnapshotParticleData<float> & snapshot,
+                                                                     unsigned int first_tag,
+                                                                     unsigned int nglobal);
+#endif
 
 
 void export_ParticleData(py::module& m)
@@ -2538,6 +3237,8 @@ void export_ParticleData(py::module& m)
     .def("addParticle", &ParticleData::addParticle)
     .def("removeParticle", &ParticleData::removeParticle)
     .def("getNthTag", &ParticleData::getNthTag)
+    .def("setPositionsSoA", &ParticleData::setPositionsSoA)
+    .def("hasPositionsSoA", &ParticleData::hasPositionsSoA)
 #ifdef ENABLE_MPI
     .def("setDomainDecomposition", &ParticleData::setDomainDecomposition)
     .def("getDomainDecomposition", &ParticleData::getDomainDecomposition)
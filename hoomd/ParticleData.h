@@ -49,6 +49,7 @@
 #include <string>
 #include <bitset>
 #include <stack>
+#include <iosfwd>
 
 /*! \ingroup hoomd_lib
     @{
@@ -609,6 +610,62 @@ class PYBIND11_EXPORT ParticleData
         //! Return body ids
         const GlobalArray< unsigned int >& getBodies() const { return m_body; }
 
+        /*!
+         * Optional structure-of-arrays (SoA) mirror of the positions and types
+         *
+         * When enabled, ParticleData maintains separate x, y, z and type arrays alongside the packed Scalar4
+         * positions. The packed positions remain the authoritative copy. Code that writes positions or types
+         * through an ArrayHandle invalidates the mirror with invalidatePositionsSoA(), or
+         * invalidateGhostPositionsSoA() if only the ghosts changed. ParticleData, the Communicator, the System
+         * (after updaters) and IntegratorTwoStep do so already. Integration methods may instead write the mirror
+         * together with the positions, see IntegrationMethodTwoStep::updatesPositionsSoA().
+         *
+         * CPU kernels that want unit-stride access call updatePositionsSoA() once before their main loop, which
+         * only copies the positions that were invalidated, and then read the arrays with ArrayHandle as usual.
+         *
+         * USAGE EXAMPLE:
+         * \code
+         * if (m_pdata->hasPositionsSoA())
+         *     m_pdata->updatePositionsSoA();
+         * ArrayHandle<Scalar> h_x(m_pdata->getPositionsX(), access_location::host, access_mode::read);
+         * ArrayHandle<unsigned int> h_type(m_pdata->getTypesSoA(), access_location::host, access_mode::read);
+         * \endcode
+         */
+
+        //! Enable or disable the structure-of-arrays mirror of positions and types
+        void setPositionsSoA(bool enable);
+
+        //! Returns true if the structure-of-arrays mirror of positions and types is maintained
+        bool hasPositionsSoA() const { return m_soa_positions; }
+
+        //! Refresh the out of date parts of the structure-of-arrays mirror from the packed positions
+        void updatePositionsSoA();
+
+        //! Mark the structure-of-arrays mirror of the local and ghost particles as out of date
+        void invalidatePositionsSoA()
+            {
+            m_soa_valid = false;
+            m_soa_ghosts_valid = false;
+            }
+
+        //! Mark the structure-of-arrays mirror of the ghost particles as out of date
+        void invalidateGhostPositionsSoA()
+            {
+            m_soa_ghosts_valid = false;
+            }
+
+        //! Return x coordinates (structure-of-arrays mirror, null if disabled)
+        const GlobalArray< Scalar >& getPositionsX() const { return m_pos_x; }
+
+        //! Return y coordinates (structure-of-arrays mirror, null if disabled)
+        const GlobalArray< Scalar >& getPositionsY() const { return m_pos_y; }
+
+        //! Return z coordinates (structure-of-arrays mirror, null if disabled)
+        const GlobalArray< Scalar >& getPositionsZ() const { return m_pos_z; }
+
+        //! Return types (structure-of-arrays mirror, null if disabled)
+        const GlobalArray< unsigned int >& getTypesSoA() const { return m_type_soa; }
+
         /*!
          * Access methods to stand-by arrays for fast swapping in of reordered particle data
          *
@@ -634,7 +691,11 @@ class PYBIND11_EXPORT ParticleData
         const GlobalArray< Scalar4 >& getAltPositions() const { return m_pos_alt; }
 
         //! Swap in positions
-        inline void swapPositions() { m_pos.swap(m_pos_alt); }
+        inline void swapPositions()
+            {
+            m_pos.swap(m_pos_alt);
+            invalidatePositionsSoA();
+            }
 
         //! Return velocities and masses (alternate array)
         const GlobalArray< Scalar4 >& getAltVelocities() const { return m_vel_alt; }
@@ -731,6 +792,20 @@ class PYBIND11_EXPORT ParticleData
         //! Notify listeners that the particles have been rearranged in memory
         void notifyParticleSort();
 
+        //! Connects a function to be called every time the particles are rearranged in memory
+        /*! The slot receives the permutation (new index -> old index) and its inverse (old index -> new index)
+            of the local particles, so it can update per-particle index tables incrementally. When the particles
+            were reordered through notifyParticleSort() without a known permutation, both pointers are NULL and
+            the subscriber has to rebuild.
+         */
+        Nano::Signal<void (const unsigned int *, const unsigned int *)>& getParticlePermutationSignal()
+            {
+            return m_permutation_signal;
+            }
+
+        //! Reorder the local particles according to the given permutation
+        void applyPermutation(const unsigned int *order);
+
         //! Connects a function to be called every time the box size is changed
         Nano::Signal<void ()>& getBoxChangeSignal()
             {
@@ -977,10 +1052,28 @@ class PYBIND11_EXPORT ParticleData
         template <class Real>
         void initializeFromSnapshot(const SnapshotParticleData<Real> & snapshot, bool ignore_bodies=false);
 
+        #ifdef ENABLE_MPI
+        //! Initialize from snapshot slices held by all ranks
+        template <class Real>
+        void initializeFromDistributedSnapshot(const SnapshotParticleData<Real> & snapshot,
+                                               unsigned int first_tag,
+                                               unsigned int nglobal);
+        #endif
+
         //! Take a snapshot
         template <class Real>
         std::map<unsigned int, unsigned int> takeSnapshot(SnapshotParticleData<Real> &snapshot);
 
+        //! Take a snapshot and return the snapshot index of every particle tag in a flat array
+        template <class Real>
+        void takeSnapshot(SnapshotParticleData<Real> &snapshot, std::vector<unsigned int>& snap_idx);
+
+        //! Write the local particles and the global tag state to a checkpoint stream
+        void writeCheckpoint(std::ostream& out) const;
+
+        //! Restore the local particles and the global tag state from a checkpoint stream
+        void readCheckpoint(std::istream& in);
+
         //! Add ghost particles at the end of the local particle data
         void addGhostParticles(const unsigned int nghosts);
 
@@ -989,6 +1082,7 @@ class PYBIND11_EXPORT ParticleData
             {
             // reset ghost particle number
             m_nghosts = 0;
+            invalidateGhostPositionsSoA();
 
             notifyGhostParticlesRemoved();
             }
@@ -1115,6 +1209,7 @@ class PYBIND11_EXPORT ParticleData
         std::vector<std::string> m_type_mapping;    //!< Mapping between particle type indices and names
 
         Nano::Signal<void ()> m_sort_signal;       //!< Signal that is triggered when particles are sorted in memory
+        Nano::Signal<void (const unsigned int *, const unsigned int *)> m_permutation_signal; //!< Signal that passes the sort permutation to subscribers
         Nano::Signal<void ()> m_boxchange_signal;  //!< Signal that is triggered when the box size changes
         Nano::Signal<void ()> m_max_particle_num_signal; //!< Signal that is triggered when the maximum particle number changes
         Nano::Signal<void ()> m_ghost_particles_removed_signal; //!< Signal that is triggered when ghost particles are removed
@@ -1147,6 +1242,16 @@ class PYBIND11_EXPORT ParticleData
         GlobalArray< Scalar3 > m_inertia;              //!< Principal moments of inertia for each particle
         GlobalArray<unsigned int> m_comm_flags;        //!< Array of communication flags
 
+        bool m_soa_positions;                          //!< True if the structure-of-arrays position mirror is enabled
+        bool m_soa_valid;                              //!< True if the mirror of the local particles is up to date
+        bool m_soa_ghosts_valid;                       //!< True if the mirror of the ghost particles is up to date
+        GlobalArray<Scalar> m_pos_x;                   //!< particle x coordinates (SoA mirror)
+        GlobalArray<Scalar> m_pos_y;                   //!< particle y coordinates (SoA mirror)
+        GlobalArray<Scalar> m_pos_z;                   //!< particle z coordinates (SoA mirror)
+        GlobalArray<unsigned int> m_type_soa;          //!< particle types (SoA mirror)
+
+        std::vector<unsigned int> m_inverse_order;   //!< Inverse of the last permutation applied with applyPermutation()
+
         std::stack<unsigned int> m_recycled_tags;    //!< Global tags of removed particles
         std::set<unsigned int> m_tag_set;            //!< Lookup table for tags by active index
         std::vector<unsigned int> m_cached_tag_set;   //!< Cached constant-time lookup table for tags by active index
@@ -1205,6 +1310,9 @@ class PYBIND11_EXPORT ParticleData
         //! Helper function to allocate alternate particle data
         void allocateAlternateArrays(unsigned int N);
 
+        //! Helper function to allocate the structure-of-arrays position mirror
+        void allocateSoAArrays(unsigned int N);
+
         //! Helper function for amortized array resizing
         void resize(unsigned int new_nparticles);
 
@@ -1214,6 +1322,9 @@ class PYBIND11_EXPORT ParticleData
         //! Helper function to rebuild the active tag cache if necessary
         void maybe_rebuild_tag_cache();
 
+        //! Helper function to emit the particle sort signals
+        void emitSortSignals(const unsigned int *order, const unsigned int *inverse);
+
         //! Helper function to check that particles of a snapshot are in the box
         /*! \return true If and only if all particles are in the simulation box
          * \param Snapshot to check
@@ -1221,6 +1332,11 @@ class PYBIND11_EXPORT ParticleData
         template <class Real>
         bool inBox(const SnapshotParticleData<Real>& snap);
 
+        #ifdef ENABLE_MPI
+        //! Helper function to find the rank that a particle is initialized on
+        unsigned int placeInitialParticle(Scalar3& pos, int3& img, const unsigned int *cart_ranks);
+        #endif
+
         //! Update the CUDA memory hints
         void setGPUAdvice();
     };
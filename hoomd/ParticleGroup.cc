@@ -12,6 +12,10 @@
 #include <cuda_runtime.h>
 #endif
 
+#ifdef ENABLE_TBB
+#include <tbb/tbb.h>
+#endif
+
 #include <algorithm>
 #include <iostream>
 using namespace std;
@@ -389,7 +393,7 @@ ParticleGroup::ParticleGroup(std::shared_ptr<SystemDefinition> sysdef,
     updateMemberTags(true);
 
     // connect to the particle sort signal
-    m_pdata->getParticleSortSignal().connect<ParticleGroup, &ParticleGroup::slotParticleSort>(this);
+    m_pdata->getParticlePermutationSignal().connect<ParticleGroup, &ParticleGroup::slotParticleSort>(this);
 
     // connect reallocate() method to maximum particle number change signal
     m_pdata->getMaxParticleNumberChangeSignal().connect<ParticleGroup, &ParticleGroup::slotReallocate>(this);
@@ -482,7 +486,7 @@ ParticleGroup::ParticleGroup(std::shared_ptr<SystemDefinition> sysdef, const std
     rebuildIndexList();
 
     // connect to the particle sort signal
-    m_pdata->getParticleSortSignal().connect<ParticleGroup, &ParticleGroup::slotParticleSort>(this);
+    m_pdata->getParticlePermutationSignal().connect<ParticleGroup, &ParticleGroup::slotParticleSort>(this);
 
     // connect reallocate() method to maximum particle number change signal
     m_pdata->getMaxParticleNumberChangeSignal().connect<ParticleGroup, &ParticleGroup::slotReallocate>(this);
@@ -499,7 +503,7 @@ ParticleGroup::~ParticleGroup()
     // disconnect the sort connection, but only if there was a particle data to connect it to in the first place
     if (m_pdata)
         {
-        m_pdata->getParticleSortSignal().disconnect<ParticleGroup, &ParticleGroup::slotParticleSort>(this);
+        m_pdata->getParticlePermutationSignal().disconnect<ParticleGroup, &ParticleGroup::slotParticleSort>(this);
         m_pdata->getMaxParticleNumberChangeSignal().disconnect<ParticleGroup, &ParticleGroup::slotReallocate>(this);
         m_pdata->getGlobalParticleNumberChangeSignal().disconnect<ParticleGroup, &ParticleGroup::slotGlobalParticleNumChange>(this);
         }
@@ -861,6 +865,37 @@ void ParticleGroup::rebuildIndexList() const
     #endif
     }
 
+/*! \param inverse Inverse of the permutation applied to the particles (old index -> new index)
+
+    Maps the current member indices to their new positions and restores the ascending order of the index list,
+    instead of looking up the membership of every particle by tag.
+*/
+void ParticleGroup::permuteIndexList(const unsigned int *inverse) const
+    {
+    ArrayHandle<unsigned int> h_is_member(m_is_member, access_location::host, access_mode::readwrite);
+    ArrayHandle<unsigned int> h_member_idx(m_member_idx, access_location::host, access_mode::readwrite);
+
+    unsigned int *member_begin = h_member_idx.data;
+    unsigned int *member_end = h_member_idx.data + m_num_local_members;
+
+    // relabel and reset the membership flags of the old indices
+    for (unsigned int *it = member_begin; it != member_end; ++it)
+        {
+        h_is_member.data[*it] = 0;
+        *it = inverse[*it];
+        }
+
+    // keep the member list in index order, as rebuildIndexList() does
+    #ifdef ENABLE_TBB
+    tbb::parallel_sort(member_begin, member_end);
+    #else
+    std::sort(member_begin, member_end);
+    #endif
+
+    for (unsigned int *it = member_begin; it != member_end; ++it)
+        h_is_member.data[*it] = 1;
+    }
+
 void ParticleGroup::updateGPUAdvice() const
     {
     #ifdef ENABLE_CUDA
@@ -320,6 +320,17 @@ class PYBIND11_EXPORT ParticleGroup
             return m_member_idx;
             }
 
+        //! Direct access to the sorted list of member tags
+        /*! \returns A GlobalArray with the tags of all members in the group, in ascending order
+            \note The caller \b must \b not write to or change the array.
+        */
+        const GlobalArray<unsigned int>& getMemberTagArray() const
+            {
+            checkRebuild();
+
+            return m_member_tags;
+            }
+
         #ifdef ENABLE_CUDA
         //! Return the load balancing GPU partition
         const GPUPartition& getGPUPartition() const
@@ -420,11 +431,27 @@ class PYBIND11_EXPORT ParticleGroup
             }
 
         //! Helper function to be called when the particles are resorted
-        void slotParticleSort()
+        /*! \param order Permutation applied to the particles (new index -> old index), NULL if unknown
+            \param inverse Inverse permutation (old index -> new index), NULL if unknown
+         */
+        void slotParticleSort(const unsigned int *order, const unsigned int *inverse)
             {
-            m_particles_sorted = true;
+            // update the index list in place if it is current and the permutation is known,
+            // otherwise defer a full rebuild to the next access
+            bool incremental = inverse && !m_particles_sorted && !m_reallocated && !m_global_ptl_num_change;
+            #ifdef ENABLE_CUDA
+            incremental = incremental && !m_exec_conf->isCUDAEnabled();
+            #endif
+
+            if (incremental)
+                permuteIndexList(inverse);
+            else
+                m_particles_sorted = true;
             }
 
+        //! Helper function to apply a particle permutation to the index lists
+        void permuteIndexList(const unsigned int *inverse) const;
+
         //! Update the GPU memory advice
         void updateGPUAdvice() const;
 
@@ -236,6 +236,9 @@ void SFCPackUpdaterGPU::applySortOrder()
     m_pdata->swapNetVirial();
     m_pdata->swapNetForce();
     m_pdata->swapNetTorque();
+
+    // trigger sort signal (this also forces particle migration)
+    m_pdata->notifyParticleSort();
     }
 
 void export_SFCPackUpdaterGPU(py::module& m)
@@ -40,6 +40,7 @@ System::System(std::shared_ptr<SystemDefinition> sysdef, unsigned int initial_ts
     // sanity check
     assert(m_sysdef);
     m_exec_conf = m_sysdef->getParticleData()->getExecConf();
+    m_analyzer_pipeline = std::shared_ptr<AnalyzerPipeline>(new AnalyzerPipeline(m_exec_conf));
 
     // initialize tps array
     m_tps_list.resize(0);
@@ -122,6 +123,8 @@ std::vector<System::analyzer_item>::iterator System::findAnalyzerItem(const std:
 void System::removeAnalyzer(const std::string& name)
     {
     vector<analyzer_item>::iterator i = findAnalyzerItem(name);
+    if (i->m_off_path)
+        m_analyzer_pipeline->flush();
     m_analyzers.erase(i);
     }
 
@@ -173,6 +176,35 @@ unsigned int System::getAnalyzerPeriod(const std::string& name)
     return i->m_period;
     }
 
+/*! \param name Name of the Analyzer to modify
+    \param off_path True if the Analyzer should run off the critical path
+
+    Off-path analyzers are not executed by the simulation loop directly. Instead, the AnalyzerPipeline executes them
+    on a snapshot of the system, while the simulation continues.
+*/
+void System::setAnalyzerOffPath(const std::string& name, bool off_path)
+    {
+    vector<System::analyzer_item>::iterator i = findAnalyzerItem(name);
+    if (off_path && !i->m_analyzer->isOffPathCapable())
+        {
+        m_exec_conf->msg->error() << "Analyzer " << name << " cannot run off the critical path" << endl;
+        throw runtime_error("System: cannot set Analyzer off path");
+        }
+
+    if (i->m_off_path && !off_path)
+        m_analyzer_pipeline->flush();
+    i->m_off_path = off_path;
+    }
+
+/*! \param max_lag Maximum number of time steps the off-path analyzers may lag behind the simulation
+    \param num_threads Number of threads that execute off-path analyzers
+*/
+void System::setAnalyzerPipelineParams(unsigned int max_lag, unsigned int num_threads)
+    {
+    m_analyzer_pipeline->setMaxLag(max_lag);
+    m_analyzer_pipeline->setNumThreads(num_threads);
+    }
+
 
 // -------------- Updater get/set methods
 /*! \param name Name of the Updater to find in m_updaters
@@ -483,6 +515,26 @@ void System::run(unsigned int nsteps, unsigned int cb_frequency,
         m_integrator->prepRun(m_cur_tstep);
         }
 
+    // write out the output captured before an error ends the run, errors of the output are superseded by that error
+    struct FlushOnError
+        {
+        System *system;
+        bool done;
+
+        ~FlushOnError()
+            {
+            if (done)
+                return;
+            try
+                {
+                system->flushAnalyzers();
+                }
+            catch (...)
+                {
+                }
+            }
+        } flush_on_error = {this, false};
+
     // handle time steps
     for ( ; m_cur_tstep < m_end_tstep; m_cur_tstep++)
         {
@@ -582,19 +634,19 @@ void System::run(unsigned int nsteps, unsigned int cb_frequency,
             }
 
         // execute analyzers
-        vector<analyzer_item>::iterator analyzer;
-        for (analyzer =  m_analyzers.begin(); analyzer != m_analyzers.end(); ++analyzer)
-            {
-            if (analyzer->shouldExecute(m_cur_tstep))
-                analyzer->m_analyzer->analyze(m_cur_tstep);
-            }
+        executeAnalyzers();
 
         // execute updaters
         vector<updater_item>::iterator updater;
         for (updater =  m_updaters.begin(); updater != m_updaters.end(); ++updater)
             {
             if (updater->shouldExecute(m_cur_tstep))
+                {
                 updater->m_updater->update(m_cur_tstep);
+
+                // updaters may move particles or change their types
+                m_sysdef->getParticleData()->invalidatePositionsSoA();
+                }
             }
 
         // look ahead to the next time step and see which analyzers and updaters will be executed
@@ -609,10 +661,15 @@ void System::run(unsigned int nsteps, unsigned int cb_frequency,
         if (g_sigint_recvd)
             {
             g_sigint_recvd = 0;
+            flushAnalyzers();
             return;
             }
         }
 
+    // finish writing any output that is still in progress, also when the run ended on a time limit
+    flush_on_error.done = true;
+    flushAnalyzers();
+
     // generate a final status line
     generateStatusLine();
     m_last_status_tstep = m_cur_tstep;
@@ -806,6 +863,56 @@ void System::resetStats()
         compute->second->resetStats();
     }
 
+void System::flushAnalyzers()
+    {
+    // complete the off-path analysis first, analyzers may finish its output in flush()
+    m_analyzer_pipeline->flush();
+
+    vector<analyzer_item>::iterator analyzer;
+    for (analyzer = m_analyzers.begin(); analyzer != m_analyzers.end(); ++analyzer)
+        analyzer->m_analyzer->flush();
+    }
+
+/*! Calls analyze() on all analyzers that execute on the current time step. Off-path analyzers are instead queued in
+    the AnalyzerPipeline. They share a snapshot of the system that is only taken when at least one of them executes.
+*/
+void System::executeAnalyzers()
+    {
+    // bound the lag of the off-path analysis
+    m_analyzer_pipeline->waitForLag(m_cur_tstep);
+
+    std::shared_ptr< SnapshotSystemData<Scalar> > snapshot;
+
+    vector<analyzer_item>::iterator analyzer;
+    for (analyzer =  m_analyzers.begin(); analyzer != m_analyzers.end(); ++analyzer)
+        {
+        if (! analyzer->shouldExecute(m_cur_tstep))
+            continue;
+
+        if (! analyzer->m_off_path)
+            {
+            analyzer->m_analyzer->analyze(m_cur_tstep);
+            continue;
+            }
+
+        if (! snapshot)
+            {
+            if (m_profiler) m_profiler->push("Analyzer snapshot");
+
+            std::shared_ptr<ParticleData> pdata = m_sysdef->getParticleData();
+            snapshot = std::shared_ptr< SnapshotSystemData<Scalar> >(new SnapshotSystemData<Scalar>());
+            snapshot->dimensions = m_sysdef->getNDimensions();
+            snapshot->global_box = pdata->getGlobalBox();
+            pdata->takeSnapshot(snapshot->particle_data);
+
+            if (m_profiler) m_profiler->pop();
+            }
+
+        analyzer->m_analyzer->prepareSnapshot(m_cur_tstep);
+        m_analyzer_pipeline->submit(analyzer->m_analyzer, m_cur_tstep, snapshot);
+        }
+    }
+
 void System::generateStatusLine()
     {
     // a status line consists of
@@ -908,6 +1015,8 @@ void export_System(py::module& m)
     .def("setAnalyzerPeriod", &System::setAnalyzerPeriod)
     .def("setAnalyzerPeriodVariable", &System::setAnalyzerPeriodVariable)
     .def("getAnalyzerPeriod", &System::getAnalyzerPeriod)
+    .def("setAnalyzerOffPath", &System::setAnalyzerOffPath)
+    .def("setAnalyzerPipelineParams", &System::setAnalyzerPipelineParams)
 
     .def("addUpdater", &System::addUpdater)
     .def("removeUpdater", &System::removeUpdater)
@@ -6,6 +6,7 @@
 
 #include "Updater.h"
 #include "Analyzer.h"
+#include "AnalyzerPipeline.h"
 #include "Compute.h"
 #include "Integrator.h"
 #include "Logger.h"
@@ -85,6 +86,12 @@ class PYBIND11_EXPORT System
         //! Get the period of an Analyzer
         unsigned int getAnalyzerPeriod(const std::string& name);
 
+        //! Run an Analyzer off the critical path
+        void setAnalyzerOffPath(const std::string& name, bool off_path);
+
+        //! Set the parameters of the pipeline that runs off-path analyzers
+        void setAnalyzerPipelineParams(unsigned int max_lag, unsigned int num_threads);
+
         // -------------- Updater get/set methods
 
         //! Adds an Updater
@@ -198,7 +205,7 @@ class PYBIND11_EXPORT System
             */
             analyzer_item(std::shared_ptr<Analyzer> analyzer, const std::string& name, unsigned int period,
                           unsigned int created_tstep, unsigned int next_execute_tstep)
-                    : m_analyzer(analyzer), m_name(name), m_period(period), m_created_tstep(created_tstep), m_next_execute_tstep(next_execute_tstep), m_is_variable_period(false), m_n(1)
+                    : m_analyzer(analyzer), m_name(name), m_period(period), m_created_tstep(created_tstep), m_next_execute_tstep(next_execute_tstep), m_is_variable_period(false), m_off_path(false), m_n(1)
                 {
                 }
 
@@ -286,12 +293,14 @@ class PYBIND11_EXPORT System
             unsigned int m_created_tstep;           //!< The timestep when the analyzer was added
             unsigned int m_next_execute_tstep;      //!< The next time step we will execute on
             bool m_is_variable_period;              //!< True if the variable period should be used
+            bool m_off_path;                        //!< True if the analyzer runs in the analyzer pipeline
 
             unsigned int m_n;                       //!< Current value of n for the variable period func
             pybind11::object m_update_func;    //!< Python lambda function to evaluate time steps to update at
             };
 
         std::vector<analyzer_item> m_analyzers; //!< List of analyzers belonging to this System
+        std::shared_ptr<AnalyzerPipeline> m_analyzer_pipeline; //!< Runs the off-path analyzers
 
         //! Holds an item in the list of updaters
         struct updater_item
@@ -433,6 +442,12 @@ class PYBIND11_EXPORT System
         //! Resets stats for all contained classes
         void resetStats();
 
+        //! Completes the output of all analyzers
+        void flushAnalyzers();
+
+        //! Executes the analyzers of the current time step
+        void executeAnalyzers();
+
         //! Prints out a formatted status line
         void generateStatusLine();
 
@@ -14,6 +14,7 @@ from hoomd import _hoomd;
 import hoomd;
 import sys;
 import numpy
+import struct
 
 ## \internal
 # \brief Base class for analyzers
@@ -43,6 +44,7 @@ class _analyzer(hoomd.meta._metadata):
 
         self.analyzer_name = "analyzer%d" % (id);
         self.enabled = True;
+        self.off_path = False;
 
         # Store a reference in global simulation variables
         hoomd.context.current.analyzers.append(self)
@@ -142,6 +144,7 @@ class _analyzer(hoomd.meta._metadata):
             return;
 
         hoomd.context.current.system.addAnalyzer(self.cpp_analyzer, self.analyzer_name, self.prev_period, self.phase);
+        hoomd.context.current.system.setAnalyzerOffPath(self.analyzer_name, self.off_path);
         hoomd.context.current.analyzers.append(self)
         self.enabled = True;
 
@@ -174,6 +177,33 @@ class _analyzer(hoomd.meta._metadata):
         else:
             hoomd.context.msg.warning("I don't know what to do with a period of type " + str(type(period)) + " expecting an int or a function");
 
+    def set_off_path(self, off_path=True):
+        R""" Run the analyzer off the critical path
+
+        Args:
+            off_path (bool): When True, run the analyzer in the background while the simulation continues.
+
+        Examples::
+
+            msd = deprecated.analyze.msd(filename='msd.log', groups=[group.all()], period=10)
+            msd.set_off_path()
+
+        Off-path analyzers do not stall the simulation. On every step an off-path analyzer executes, hoomd takes a
+        snapshot of the particles, shared by all off-path analyzers executing on that step, and continues the
+        simulation while a background thread analyzes the snapshot. The output is identical to that of the analyzer
+        on the critical path, it is complete at the end of every :py:func:`hoomd.run()`. Use
+        :py:func:`set_pipeline_params()` to set how far the analysis may lag behind the simulation.
+
+        Only some analyzers support running off the critical path, it is an error to set others off path.
+        Python callbacks always run on the critical path.
+        """
+        hoomd.util.print_status_line();
+        self.check_initialization();
+
+        if self.enabled:
+            hoomd.context.current.system.setAnalyzerOffPath(self.analyzer_name, off_path);
+        self.off_path = off_path;
+
     ## \internal
     # \brief Get metadata
     def get_metadata(self):
@@ -208,6 +238,37 @@ class _analyzer(hoomd.meta._metadata):
 # set default counter
 _analyzer.cur_id = 0;
 
+def set_pipeline_params(max_lag=100, threads=1):
+    R""" Set the parameters of the off-path analysis
+
+    Args:
+        max_lag (int): Maximum number of time steps the analysis may lag behind the simulation.
+        threads (int): Number of background threads that run off-path analyzers.
+
+    Analyzers set off the critical path with ``set_off_path()`` run in *threads* background threads. When the
+    analysis of a snapshot taken more than *max_lag* time steps ago is still in progress, the simulation waits for it.
+    The snapshots of all steps within *max_lag* may be held in memory at the same time. Different analyzers run
+    concurrently, every analyzer processes its snapshots in order.
+
+    Examples::
+
+        analyze.set_pipeline_params(max_lag=1000, threads=2)
+
+    """
+    hoomd.util.print_status_line();
+
+    if not hoomd.init.is_initialized():
+        hoomd.context.msg.error("Cannot set the analyzer pipeline parameters before initialization\n");
+        raise RuntimeError('Error setting analyzer pipeline parameters');
+
+    if max_lag < 0:
+        raise ValueError("max_lag must be non-negative");
+
+    if threads < 1:
+        raise ValueError("threads must be positive");
+
+    hoomd.context.current.system.setAnalyzerPipelineParams(int(max_lag), int(threads));
+
 class imd(_analyzer):
     R""" Send simulation snapshots to VMD in real-time.
 
@@ -573,6 +634,186 @@ class log(_analyzer):
 
         hoomd.context.current.loggers.append(self)
 
+class log_binary(log):
+    R""" Log a number of calculated quantities to a binary file.
+
+    Args:
+        filename (str): File to write the log to.
+        quantities (list): List of quantities to log.
+        period (int): Quantities are logged every *period* time steps.
+        overwrite (bool): When False (the default) an existing log will be appended to. When True, an existing log file will be overwritten instead.
+        phase (int): When -1, start on the current time step. When >= 0, execute on steps where *(step + phase) % period == 0*.
+        block_rows (int): Number of rows to buffer in memory before they are written to the file.
+
+    :py:class:`log_binary` logs the same quantities as :py:class:`log`, but stores the values without formatting
+    them. Rows are collected in memory and every *block_rows* rows, a background thread writes them to the file as a
+    block of columns, while the simulation continues. The rows still in memory are written at the end of every
+    :py:func:`hoomd.run()`. This makes logging at high frequency cheap.
+
+    Use :py:func:`log_binary_to_text()` to convert the file into the delimited text format written by
+    :py:class:`log`, or :py:func:`read_log_binary()` to read the columns into numpy arrays.
+
+    Examples::
+
+        analyze.log_binary(filename='mylog.bin', quantities=['potential_energy', 'temperature'], period=10)
+        analyze.log_binary_to_text('mylog.bin', 'mylog.log')
+
+    """
+
+    def __init__(self, filename, quantities, period, overwrite=False, phase=0, block_rows=1000):
+        hoomd.util.print_status_line();
+
+        # initialize base class
+        _analyzer.__init__(self);
+
+        if filename is None or filename == "":
+            hoomd.context.msg.error("analyze.log_binary needs a file name\n");
+            raise RuntimeError('Error creating analyzer');
+
+        if block_rows < 1:
+            raise ValueError("block_rows must be positive");
+
+        # create the c++ mirror class
+        self.cpp_analyzer = _hoomd.LogBinary(hoomd.context.current.system_definition, filename, overwrite, int(block_rows));
+        self.setupAnalyzer(period, phase);
+
+        # set the logged quantities
+        quantity_list = _hoomd.std_vector_string();
+        for item in quantities:
+            quantity_list.append(str(item));
+        self.cpp_analyzer.setLoggedQuantities(quantity_list);
+
+        # add the logger to the list of loggers
+        hoomd.context.current.loggers.append(self);
+
+        # store metadata
+        self.metadata_fields = ['filename','period','block_rows']
+        self.filename = filename
+        self.period = period
+        self.block_rows = block_rows
+
+    def set_params(self, quantities=None, block_rows=None):
+        R""" Change the parameters of the log.
+
+        Args:
+            quantities (list): New list of quantities to log (if specified)
+            block_rows (int): New number of rows to buffer in memory (if specified)
+
+        Examples::
+
+            logger.set_params(quantities=['bond_harmonic_energy'])
+            logger.set_params(block_rows=100);
+        """
+
+        hoomd.util.print_status_line();
+
+        if quantities is not None:
+            # set the logged quantities
+            quantity_list = _hoomd.std_vector_string();
+            for item in quantities:
+                quantity_list.append(str(item));
+            self.cpp_analyzer.setLoggedQuantities(quantity_list);
+
+        if block_rows is not None:
+            if block_rows < 1:
+                raise ValueError("block_rows must be positive");
+            self.cpp_analyzer.setBlockRows(int(block_rows));
+            self.block_rows = block_rows;
+
+def read_log_binary(filename):
+    R""" Read a log written by :py:class:`log_binary`.
+
+    Args:
+        filename (str): File to read.
+
+    Returns:
+        A list of segments, one for every set of logged quantities in the file. Every segment is a tuple of the list
+        of column names, a numpy array of the time steps and a dictionary of numpy arrays with the values of every
+        column.
+
+    :py:func:`read_log_binary()` does not need an initialized simulation.
+
+    Examples::
+
+        for columns, timesteps, values in analyze.read_log_binary('mylog.bin'):
+            print(timesteps, values['potential_energy'])
+
+    """
+    with open(filename, 'rb') as f:
+        data = f.read();
+
+    if data[0:8] != b'HOOMDLGB':
+        raise RuntimeError("{} is not a binary log file".format(filename));
+
+    version, = struct.unpack_from('=I', data, 8);
+    if version != 1:
+        raise RuntimeError("Unsupported binary log version {}".format(version));
+
+    segments = [];
+    offset = 12;
+    while offset < len(data):
+        record_type, = struct.unpack_from('=I', data, offset);
+        offset += 4;
+
+        if record_type == 1:
+            n_columns, = struct.unpack_from('=I', data, offset);
+            offset += 4;
+            columns = [];
+            for i in range(n_columns):
+                length, = struct.unpack_from('=I', data, offset);
+                offset += 4;
+                columns.append(data[offset:offset+length].decode());
+                offset += length;
+            segments.append((columns, [], [[] for c in columns]));
+        elif record_type == 2:
+            n_rows, n_columns = struct.unpack_from('=II', data, offset);
+            offset += 8;
+            if len(segments) == 0 or len(segments[-1][0]) != n_columns:
+                raise RuntimeError("Corrupt binary log file {}".format(filename));
+
+            segments[-1][1].append(numpy.frombuffer(data, dtype=numpy.uint64, count=n_rows, offset=offset));
+            offset += 8*n_rows;
+            for j in range(n_columns):
+                segments[-1][2][j].append(numpy.frombuffer(data, dtype=numpy.float64, count=n_rows, offset=offset));
+                offset += 8*n_rows;
+        else:
+            raise RuntimeError("Corrupt binary log file {}".format(filename));
+
+    result = [];
+    for columns, timesteps, values in segments:
+        timesteps = numpy.concatenate(timesteps) if len(timesteps) > 0 else numpy.zeros(0, dtype=numpy.uint64);
+        value_dict = {};
+        for name, blocks in zip(columns, values):
+            value_dict[name] = numpy.concatenate(blocks) if len(blocks) > 0 else numpy.zeros(0);
+        result.append((columns, timesteps, value_dict));
+
+    return result;
+
+def log_binary_to_text(filename, output, delimiter='\t', header_prefix=''):
+    R""" Convert a log written by :py:class:`log_binary` to a delimited text file.
+
+    Args:
+        filename (str): Binary log to read.
+        output (str): Text file to write.
+        delimiter (str): Delimiter between columns.
+        header_prefix (str): String to print before every header line.
+
+    The text file has the same format as a file written by :py:class:`log`: a header line with the column names,
+    followed by one line per logged time step. When the logged quantities change in the binary log, a new header
+    line is written. :py:func:`log_binary_to_text()` does not need an initialized simulation.
+
+    Examples::
+
+        analyze.log_binary_to_text('mylog.bin', 'mylog.log')
+
+    """
+    with open(output, 'w') as f:
+        for columns, timesteps, values in read_log_binary(filename):
+            f.write(header_prefix + delimiter.join(['timestep'] + columns) + '\n');
+            for i in range(len(timesteps)):
+                row = ['{:d}'.format(int(timesteps[i]))] + ['{:.10g}'.format(values[name][i]) for name in columns];
+                f.write(delimiter.join(row) + '\n');
+
 class callback(_analyzer):
     R""" Callback analyzer.
 
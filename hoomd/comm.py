@@ -82,6 +82,149 @@ def barrier():
     if _hoomd.is_MPI_available():
         hoomd.context.mpi_conf.barrier()
 
+def set_direct_ghost_update(enable=True, persistent=False, shared_memory=False, position_bits=None):
+    """ Exchange ghost particle updates directly with all neighboring ranks.
+
+    Args:
+        enable (bool): True to exchange ghost updates directly, False to use the staged exchange
+        persistent (bool): True to set up the messages once per neighbor list build with persistent MPI requests
+        shared_memory (bool): True to let ranks on the same node read the ghost data from shared memory
+        position_bits (int): Send ghost positions as 16 or 32 bit fixed point displacements (None: full precision)
+
+    By default, ghost particle positions are updated in six sequential stages, one per face of the domain,
+    with ghosts destined for edge and corner neighbors forwarded through the face neighbors. In direct mode,
+    every rank sends the ghost data to all (up to 26) neighbors at once, so that a ghost update completes in a
+    single round of messages. This can reduce the time per step when it is dominated by communication latency,
+    such as with many ranks and small domains. The ghost exchange at neighbor list builds is still staged.
+
+    In direct mode, the ghost update proceeds in the background while the CPU pair potentials compute the
+    forces on particles whose neighbors are all local. The forces on particles near the domain boundary are
+    added once the ghost positions have arrived.
+
+    With *persistent* set, the messages to all neighbors are set up once after every neighbor list build, and each
+    ghost update only starts and completes them. This reduces the per-step overhead of the MPI library.
+
+    With *shared_memory* set, ranks on the same node place the ghost data in an MPI-3 shared memory window,
+    and the neighbors read it in place instead of receiving a copy. Only a zero-byte notification is exchanged
+    with neighbors on the same node; neighbors on other nodes still receive messages.
+
+    With *position_bits* set, every ghost position component is sent as a fixed point displacement since the last
+    neighbor list build, in units of the ghost layer width :math:`r_\mathrm{ghost}` divided by :math:`2^{15}-1` (16 bits)
+    or :math:`2^{31}-1` (32 bits). The position error is at most half of that unit, far below the neighbor list buffer,
+    and the message size shrinks by up to a factor of 5 (16 bits, double precision). Particle types are not updated
+    between neighbor list builds in this mode.
+
+    Example::
+
+        comm.set_direct_ghost_update()
+        comm.set_direct_ghost_update(persistent=True)
+        comm.set_direct_ghost_update(shared_memory=True)
+        comm.set_direct_ghost_update(position_bits=16)
+
+    Note:
+        Direct ghost updates are only available on the CPU. Does nothing in non-mpi builds.
+
+    Warning:
+        This command must be invoked *after* the system is initialized.
+    """
+    hoomd.util.print_status_line();
+    hoomd.context._verify_init();
+
+    if not _hoomd.is_MPI_available():
+        return
+
+    if not hoomd.init.is_initialized():
+        hoomd.context.msg.error("Cannot set direct ghost updates before initialization\n");
+        raise RuntimeError('Error setting ghost update mode');
+
+    cpp_comm = hoomd.context.current.system.getCommunicator()
+    if cpp_comm is None:
+        return
+
+    if hoomd.context.exec_conf.isCUDAEnabled():
+        hoomd.context.msg.warning("comm.set_direct_ghost_update() is not supported on the GPU, ignoring.\n")
+        return
+
+    cpp_comm.setDirectGhostUpdate(enable)
+    cpp_comm.setPersistentGhostUpdate(persistent)
+    cpp_comm.setSharedGhostUpdate(shared_memory)
+
+    if position_bits is None:
+        position_bits = 0
+    if position_bits not in (0, 16, 32):
+        hoomd.context.msg.error("comm.set_direct_ghost_update: position_bits must be 16 or 32\n");
+        raise RuntimeError('Error setting ghost update mode');
+    cpp_comm.setGhostPositionBits(position_bits)
+
+def set_ghost_update_period(period, max_drift=0.1, approximate=False):
+    """ Extrapolate ghost particle positions between ghost updates (approximate).
+
+    Args:
+        period (int): Maximum number of time steps between ghost updates (1: update every step)
+        max_drift (float): Maximum deviation of a ghost particle from its particle between updates (in distance units)
+        approximate (bool): Must be True to enable extrapolation, as an acknowledgement that the dynamics change
+
+    Normally, the positions of ghost particles are updated from their owning ranks every time step. With a
+    *period* larger than 1, each rank instead advances the positions of its ghost particles with their velocities
+    for up to *period* - 1 steps, and only synchronizes with its neighbors every *period* steps. This trades
+    accuracy for fewer messages, which can help when the time per step is dominated by the latency of the network.
+
+    The speed of the fastest particle is reduced over all ranks at every step. Ghosts are only extrapolated as long as
+    the distance the particles may have moved since the last update, plus the distance the ghosts have been
+    extrapolated, is at most *max_drift*. The ghost layer is widened by *max_drift*, which must fit into the domains,
+    and neighbor lists are rebuilt when the particles have moved by half of *r_buff* - *max_drift*, so *max_drift*
+    must be smaller than *r_buff*.
+
+    Warning:
+        The forces on ghost particles are not computed, so the extrapolation assumes constant velocity. The forces
+        near the domain boundaries are approximate, and the trajectories depend on the domain decomposition.
+        Ghosts are updated every step when their orientations are needed, or with rigid bodies.
+
+    Example::
+
+        comm.set_ghost_update_period(4, max_drift=0.05, approximate=True)
+
+    Note:
+        Ghost extrapolation is only available on the CPU. Does nothing in non-mpi builds.
+
+    Warning:
+        This command must be invoked *after* the system is initialized, and after the neighbor lists are created.
+    """
+    hoomd.util.print_status_line();
+    hoomd.context._verify_init();
+
+    if not _hoomd.is_MPI_available():
+        return
+
+    if not hoomd.init.is_initialized():
+        hoomd.context.msg.error("Cannot set the ghost update period before initialization\n");
+        raise RuntimeError('Error setting ghost update period');
+
+    if int(period) < 1 or max_drift < 0:
+        hoomd.context.msg.error("comm.set_ghost_update_period: period must be positive and max_drift non-negative\n");
+        raise RuntimeError('Error setting ghost update period');
+
+    if int(period) > 1 and not approximate:
+        hoomd.context.msg.error("comm.set_ghost_update_period: extrapolated ghosts change the dynamics, "
+                                "set approximate=True to enable them\n");
+        raise RuntimeError('Error setting ghost update period');
+
+    for nl in hoomd.context.current.neighbor_lists:
+        if int(period) > 1 and max_drift >= nl.r_buff:
+            hoomd.context.msg.error("comm.set_ghost_update_period: max_drift ({}) must be smaller than the neighbor "
+                                    "list buffer r_buff ({})\n".format(max_drift, nl.r_buff));
+            raise RuntimeError('Error setting ghost update period');
+
+    cpp_comm = hoomd.context.current.system.getCommunicator()
+    if cpp_comm is None:
+        return
+
+    if hoomd.context.exec_conf.isCUDAEnabled():
+        hoomd.context.msg.warning("comm.set_ghost_update_period() is not supported on the GPU, ignoring.\n")
+        return
+
+    cpp_comm.setGhostUpdatePeriod(int(period), float(max_drift))
+
 class decomposition(object):
     """ Set the domain decomposition.
 
@@ -92,6 +235,8 @@ class decomposition(object):
         nx (int): Number of processors to uniformly space in x dimension (if *x* is None)
         ny (int): Number of processors to uniformly space in y dimension (if *y* is None)
         nz (int): Number of processors to uniformly space in z dimension (if *z* is None)
+        staggered (bool): If True, the y and z cut planes can be set independently in every slab and column
+        twolevel (bool): If True, map the ranks of every node onto a compact block also for the grid given here
 
     A single domain decomposition is defined for the simulation.
     A standard domain decomposition divides the simulation box into equal volumes along the Cartesian axes while minimizing
@@ -118,13 +263,26 @@ class decomposition(object):
     The decomposition can be adjusted dynamically if the best static decomposition is not known, or the system
     composition is changing dynamically. For this associated command, see update.balance().
 
+    With *staggered* = True, the decomposition becomes a tree of cuts: the x cuts divide the box into slabs, every
+    slab has its own y cuts that divide it into columns, and every column has its own z cuts. All slabs and columns
+    start out with the cuts given here, and update.balance() then adjusts each of them independently, so that the
+    load can be balanced when it varies in more than one dimension at once (for example, a droplet on a surface).
+    Staggered decompositions are only supported by the CPU communicator, and not with MPCD or reverse ghost
+    communication (``pair.tersoff``).
+
+    When the grid is chosen automatically, the ranks of every node are mapped onto a compact block of the grid, so
+    that most neighbor domains are on the same node (disable with the ``--onelevel`` command line option). A grid
+    or fractions given here or on the command line keep the sequential order of the ranks, unless *twolevel* = True.
+
     Priority is always given to specified arguments over the command line arguments. If one of these is not set but
     a command line option is, then the command line option is used. Otherwise, a default decomposition is chosen.
 
     Examples::
 
         comm.decomposition(x=0.4, ny=2, nz=2)
+        comm.decomposition(nx=4, ny=4, nz=4, staggered=True)
         comm.decomposition(nx=2, y=0.8, z=[0.2,0.3])
+        comm.decomposition(nx=4, ny=4, nz=8, twolevel=True)
 
     Warning:
         The decomposition command will override specified command line options.
@@ -142,7 +300,7 @@ class decomposition(object):
         raised if both are set.
     """
 
-    def __init__(self, x=None, y=None, z=None, nx=None, ny=None, nz=None):
+    def __init__(self, x=None, y=None, z=None, nx=None, ny=None, nz=None, staggered=False, twolevel=False):
         hoomd.util.print_status_line()
 
         # check that the context has been initialized though
@@ -168,6 +326,8 @@ class decomposition(object):
             self.uniform_x = True
             self.uniform_y = True
             self.uniform_z = True
+            self.staggered = staggered
+            self.twolevel = twolevel
 
             hoomd.util.quiet_status()
             self.set_params(x,y,z,nx,ny,nz)
@@ -256,7 +416,8 @@ class decomposition(object):
     def _make_cpp_decomposition(self, box):
         # if the box is uniform in all directions, just use these values
         if self.uniform_x and self.uniform_y and self.uniform_z:
-            self.cpp_dd = _hoomd.DomainDecomposition(hoomd.context.exec_conf, box.getL(), self.nx, self.ny, self.nz, not hoomd.context.options.onelevel)
+            self.cpp_dd = _hoomd.DomainDecomposition(hoomd.context.exec_conf, box.getL(), self.nx, self.ny, self.nz, not hoomd.context.options.onelevel, self.twolevel)
+            self.cpp_dd.setStaggered(self.staggered)
             return self.cpp_dd
 
         # otherwise, make the fractional decomposition
@@ -305,7 +466,8 @@ class decomposition(object):
                 hoomd.context.msg.error("comm.decomposition: fraction must be between 0.0 and 1.0\n")
                 raise RuntimeError("Sum of decomposition in z must lie between 0.0 and 1.0")
 
-            self.cpp_dd = _hoomd.DomainDecomposition(hoomd.context.exec_conf, box.getL(), fxs, fys, fzs)
+            self.cpp_dd = _hoomd.DomainDecomposition(hoomd.context.exec_conf, box.getL(), fxs, fys, fzs, not hoomd.context.options.onelevel, self.twolevel)
+            self.cpp_dd.setStaggered(self.staggered)
             return self.cpp_dd
 
         except TypeError as te:
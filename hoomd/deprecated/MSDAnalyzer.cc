@@ -140,13 +140,81 @@ void MSDAnalyzer::analyze(unsigned int timestep)
         }
 #endif
 
-    // error check
+    checkColumns();
+
+    try
+        {
+        analyzeParticles(timestep, m_pdata->getGlobalBox(), snapshot);
+        }
+    catch (const std::exception& e)
+        {
+        m_exec_conf->msg->error() << e.what() << endl;
+        throw;
+        }
+
+    if (m_prof)
+        m_prof->pop();
+    }
+
+/*! \param timestep Time step of the snapshot
+    \param snapshot Snapshot of the system
+
+    Writes the same row as analyze(), computed from the snapshot on a worker thread of the AnalyzerPipeline. The
+    warnings are printed by prepareSnapshot() on the main thread.
+*/
+void MSDAnalyzer::analyzeSnapshot(unsigned int timestep, std::shared_ptr<const SnapshotSystemData<Scalar> > snapshot)
+    {
+#ifdef ENABLE_MPI
+    // if we are not the root processor, do not perform file I/O
+    if (m_comm && !m_exec_conf->isRoot())
+        return;
+#endif
+
+    analyzeParticles(timestep, snapshot->global_box, snapshot->particle_data);
+    }
+
+/*! \param timestep Time step of the snapshot
+*/
+void MSDAnalyzer::prepareSnapshot(unsigned int timestep)
+    {
+#ifdef ENABLE_MPI
+    // only the root processor writes the file
+    if (m_comm && !m_exec_conf->isRoot())
+        return;
+#endif
+
+    checkColumns();
+    }
+
+/*! Prints the warnings for analyze() and prepareSnapshot(), the output is computed without access to the Messenger.
+*/
+void MSDAnalyzer::checkColumns()
+    {
     if (m_columns.size() == 0)
         {
         m_exec_conf->msg->warning() << "analyze.msd: No columns specified in the MSD analysis" << endl;
         return;
         }
 
+    for (unsigned int i = 0; i < m_columns.size(); i++)
+        {
+        if (m_columns[i].m_member_tags.size() == 0)
+            m_exec_conf->msg->warning() << "analyze.msd: Group has 0 members, reporting a calculated msd of 0.0" << endl;
+        }
+    }
+
+/*! \param timestep Time step of the snapshot
+    \param box Global box at \a timestep
+    \param snapshot Particle data snapshot at \a timestep
+
+    Writes out the header if the columns have changed, then a row of MSD values.
+*/
+void MSDAnalyzer::analyzeParticles(unsigned int timestep, const BoxDim& box, const SnapshotParticleData<Scalar>& snapshot)
+    {
+    // nothing to write, checkColumns() warns about this
+    if (m_columns.size() == 0)
+        return;
+
     // ignore writing the header on the first call when appending the file
     if (m_columns_changed && m_appending)
         {
@@ -162,10 +230,7 @@ void MSDAnalyzer::analyze(unsigned int timestep)
         }
 
     // write out the row every time
-    writeRow(timestep, snapshot);
-
-    if (m_prof)
-        m_prof->pop();
+    writeRow(timestep, box, snapshot);
     }
 
 /*! \param delimiter New delimiter to set
@@ -185,7 +250,14 @@ void MSDAnalyzer::setDelimiter(const std::string& delimiter)
 */
 void MSDAnalyzer::addColumn(std::shared_ptr<ParticleGroup> group, const std::string& name)
     {
-    m_columns.push_back(column(group, name));
+    column new_column(group, name);
+
+    // store the members, so that the analysis does not need to access the group
+    new_column.m_member_tags.resize(group->getNumMembersGlobal());
+    for (unsigned int group_idx = 0; group_idx < group->getNumMembersGlobal(); group_idx++)
+        new_column.m_member_tags[group_idx] = group->getMemberTag(group_idx);
+
+    m_columns.push_back(new_column);
 
     // store initial number of particles
     m_initial_group_N.push_back(group->getNumMembersGlobal());
@@ -265,10 +337,7 @@ void MSDAnalyzer::writeHeader()
     m_file << "timestep";
 
     if (m_columns.size() == 0)
-        {
-        m_exec_conf->msg->warning() << "analyze.msd: No columns specified in the MSD analysis" << endl;
         return;
-        }
 
     // only print the delimiter after the timestep if there are more columns
     m_file << m_delimiter;
@@ -281,29 +350,26 @@ void MSDAnalyzer::writeHeader()
     m_file.flush();
     }
 
-/*! \param group Particle group to calculate the MSD of
+/*! \param col Column with the particle group to calculate the MSD of
+    \param box Global box of the snapshot
+    \param snapshot Particle data snapshot
     Loop through all particles in the given group and calculate the MSD over them.
     \returns The calculated MSD
 */
-Scalar MSDAnalyzer::calcMSD(std::shared_ptr<ParticleGroup const> group, const SnapshotParticleData<Scalar>& snapshot)
+Scalar MSDAnalyzer::calcMSD(const column& col, const BoxDim& box, const SnapshotParticleData<Scalar>& snapshot)
     {
-    BoxDim box = m_pdata->getGlobalBox();
-
     // initial sum for the average
     Scalar msd = Scalar(0.0);
 
-    // handle the case where there are 0 members gracefully
-    if (group->getNumMembersGlobal() == 0)
-        {
-        m_exec_conf->msg->warning() << "analyze.msd: Group has 0 members, reporting a calculated msd of 0.0" << endl;
+    // handle the case where there are 0 members gracefully, checkColumns() warns about this
+    if (col.m_member_tags.size() == 0)
         return Scalar(0.0);
-        }
 
     // for each particle in the group
-    for (unsigned int group_idx = 0; group_idx < group->getNumMembersGlobal(); group_idx++)
+    for (unsigned int group_idx = 0; group_idx < col.m_member_tags.size(); group_idx++)
         {
         // get the tag for the current group member from the group
-        unsigned int tag = group->getMemberTag(group_idx);
+        unsigned int tag = col.m_member_tags[group_idx];
         assert(tag < snapshot.size);
         vec3<Scalar> pos = snapshot.pos[tag];
         int3 image = snapshot.image[tag];
@@ -316,19 +382,19 @@ Scalar MSDAnalyzer::calcMSD(std::shared_ptr<ParticleGroup const> group, const Sn
         }
 
     // divide to complete the average
-    msd /= Scalar(group->getNumMembersGlobal());
+    msd /= Scalar(col.m_member_tags.size());
     return msd;
     }
 
 /*! \param timestep current time step of the simulation
+    \param box Global box at \a timestep
+    \param snapshot Particle data snapshot at \a timestep
 
     Performs all the steps needed in order to calculate the MSDs for all the groups in the columns and writes out an
     entire row to the file.
 */
-void MSDAnalyzer::writeRow(unsigned int timestep, const SnapshotParticleData<Scalar>& snapshot)
+void MSDAnalyzer::writeRow(unsigned int timestep, const BoxDim& box, const SnapshotParticleData<Scalar>& snapshot)
     {
-    if (m_prof) m_prof->push("MSD");
-
     // The timestep is always output
     m_file << setprecision(10) << timestep;
 
@@ -343,18 +409,14 @@ void MSDAnalyzer::writeRow(unsigned int timestep, const SnapshotParticleData<Sca
 
     // write all but the last of the columns separated by the delimiter
     for (unsigned int i = 0; i < m_columns.size()-1; i++)
-        m_file << setprecision(10) << calcMSD(m_columns[i].m_group, snapshot) << m_delimiter;
+        m_file << setprecision(10) << calcMSD(m_columns[i], box, snapshot) << m_delimiter;
     // write the last one with no delimiter after it
-    m_file << setprecision(10) << calcMSD(m_columns[m_columns.size()-1].m_group, snapshot) << endl;
+    m_file << setprecision(10) << calcMSD(m_columns[m_columns.size()-1], box, snapshot) << endl;
     m_file.flush();
 
+    // the caller prints the message, this may run on a worker thread of the AnalyzerPipeline
     if (!m_file.good())
-        {
-        m_exec_conf->msg->error() << "analyze.msd: I/O error while writing file" << endl;
-        throw runtime_error("Error writing msd file");
-        }
-
-    if (m_prof) m_prof->pop();
+        throw runtime_error("analyze.msd: I/O error while writing file");
     }
 
 void export_MSDAnalyzer(py::module& m)
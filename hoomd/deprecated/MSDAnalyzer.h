@@ -17,6 +17,7 @@
 
 #include "hoomd/Analyzer.h"
 #include "hoomd/ParticleGroup.h"
+#include "hoomd/SnapshotSystemData.h"
 
 #include <hoomd/extern/pybind/include/pybind11/pybind11.h>
 #include <string>
@@ -56,6 +57,18 @@ class MSDAnalyzer : public Analyzer
         //! Write out the data for the current timestep
         void analyze(unsigned int timestep);
 
+        //! The MSD can be computed off the critical path
+        bool isOffPathCapable()
+            {
+            return true;
+            }
+
+        //! Write out the data for a snapshot
+        void analyzeSnapshot(unsigned int timestep, std::shared_ptr<const SnapshotSystemData<Scalar> > snapshot);
+
+        //! Check the columns before a snapshot is analyzed
+        void prepareSnapshot(unsigned int timestep);
+
         //! Sets the delimiter to use between fields
         void setDelimiter(const std::string& delimiter);
 
@@ -93,16 +106,21 @@ class MSDAnalyzer : public Analyzer
 
             std::shared_ptr<ParticleGroup const> m_group; //!< A shared pointer to the group definition
             std::string m_name;                             //!< The name to print across the file header
+            std::vector<unsigned int> m_member_tags;        //!< Tags of the group members when the column was added
             };
 
         std::vector<column> m_columns;  //!< List of groups to output
 
+        //! Helper function to warn about columns that produce no output
+        void checkColumns();
         //! Helper function to write out the header
         void writeHeader();
+        //! Helper function to write the header and a row of output for a snapshot
+        void analyzeParticles(unsigned int timestep, const BoxDim& box, const SnapshotParticleData<Scalar>& snapshot);
         //! Helper function to calculate the MSD of a single group
-        Scalar calcMSD(std::shared_ptr<ParticleGroup const> group, const SnapshotParticleData<Scalar>& snapshot);
+        Scalar calcMSD(const column& col, const BoxDim& box, const SnapshotParticleData<Scalar>& snapshot);
         //! Helper function to write one row of output
-        void writeRow(unsigned int timestep, const SnapshotParticleData<Scalar>& snapshot);
+        void writeRow(unsigned int timestep, const BoxDim& box, const SnapshotParticleData<Scalar>& snapshot);
 
         //! Method to be called when particles are added/removed/sorted
         void slotParticleSort();
@@ -68,6 +68,9 @@ class msd(_analyzer):
     If *r0_file* is left at the default of None, then the current state of the system at the execution of the
     analyze.msd command is used to initialize :math:`\vec{r}_0`.
 
+    :py:class:`msd` can run off the critical path, see ``set_off_path()`` and
+    :py:func:`hoomd.analyze.set_pipeline_params()`. The groups are evaluated when :py:class:`msd` is created.
+
     """
 
     def __init__(self, filename, groups, period, header_prefix='', r0_file=None, overwrite=False, phase=0):
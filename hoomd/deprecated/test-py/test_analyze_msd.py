@@ -4,6 +4,7 @@
 import hoomd;
 hoomd.context.initialize()
 from hoomd import deprecated
+from hoomd import md
 import unittest
 import os
 import tempfile
@@ -38,6 +39,28 @@ class analyze_msd_tests (unittest.TestCase):
         deprecated.analyze.msd(period = lambda n: n*10, filename=self.tmp_file, groups=[hoomd.group.all()]);
         hoomd.run(100);
 
+    # test that the off-path analysis writes the same file
+    def test_off_path(self):
+        md.integrate.mode_standard(dt=0.005);
+        md.integrate.nve(group=hoomd.group.all());
+        deprecated.analyze.msd(period = 10, filename=self.tmp_file, groups=[hoomd.group.all()], overwrite=True);
+        ana = deprecated.analyze.msd(period = 10, filename=self.tmp_file+'_off', groups=[hoomd.group.all()], overwrite=True);
+        ana.set_off_path();
+        hoomd.analyze.set_pipeline_params(max_lag=20, threads=2);
+        hoomd.run(100);
+
+        if hoomd.comm.get_rank() == 0:
+            with open(self.tmp_file) as f:
+                expected = f.read();
+            with open(self.tmp_file+'_off') as f:
+                self.assertEqual(f.read(), expected);
+            os.remove(self.tmp_file+'_off');
+
+    # test error for analyzers that cannot run off the critical path
+    def test_off_path_unsupported(self):
+        ana = hoomd.analyze.callback(callback = lambda timestep: None, period = 10);
+        self.assertRaises(RuntimeError, ana.set_off_path);
+
     # test error if no groups defined
     def test_no_gropus(self):
         self.assertRaises(RuntimeError, deprecated.analyze.msd, period=10, filename=self.tmp_file, groups=[]);
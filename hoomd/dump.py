@@ -16,6 +16,69 @@ import os;
 import sys;
 import types;
 
+class checkpoint(hoomd.analyze._analyzer):
+    R""" Writes per-rank checkpoint files for fast restarts.
+
+    Args:
+        prefix (str): Prefix of the checkpoint file names.
+        period (int): Number of time steps between checkpoints.
+        phase (int): When -1, start on the current time step. When >= 0, execute on steps where *(step + phase) % period == 0*.
+
+    Every *period* time steps, every MPI rank writes the raw contents of its local particle data and bonded groups
+    to its own file ``prefix.<step>.<rank>.bin``, and the root rank writes the small manifest ``prefix.manifest`` with the
+    time step, the box, the type names, the integrator variables (e.g. thermostat and barostat degrees of freedom)
+    and the domain decomposition. No particle data is sent between ranks, so writing a checkpoint costs about as much
+    as writing the local memory of every rank to the file system in parallel.
+
+    Each checkpoint replaces the previous one. The manifest is replaced once all ranks have written their files, and
+    the files of the previous checkpoint are removed only after that, so that an interrupted write always leaves a
+    complete checkpoint.
+
+    Use :py:func:`hoomd.init.read_checkpoint` to restart from the checkpoint. A restart is exact: with the same script
+    on the same number of ranks, the simulation continues the trajectory it would have followed without interruption.
+    The checkpoint files can only be read by a build of HOOMD-blue with the same floating point precision. They are
+    not a trajectory format, use :py:class:`hoomd.dump.gsd` to save configurations for analysis.
+
+    .. versionadded:: 2.7
+
+    Examples::
+
+        if os.path.exists('restart.manifest'):
+            init.read_checkpoint('restart')
+        else:
+            init.read_gsd('init.gsd')
+
+        # ... set up the simulation ...
+
+        ckpt = dump.checkpoint(prefix='restart', period=100000)
+        run(1e7, limit_hours=23.5)
+        ckpt.write_restart()
+    """
+    def __init__(self, prefix, period, phase=0):
+        hoomd.util.print_status_line();
+
+        # initialize base class
+        hoomd.analyze._analyzer.__init__(self);
+
+        # all ranks use the same prefix
+        prefix = _hoomd.mpi_bcast_str(prefix, hoomd.context.exec_conf);
+
+        self.cpp_analyzer = _hoomd.CheckpointWriter(hoomd.context.current.system_definition, prefix);
+        self.setupAnalyzer(period, phase);
+
+        # store metadata
+        self.prefix = prefix
+        self.period = period
+        self.metadata_fields = ['prefix','period']
+
+    def write_restart(self):
+        """ Write a checkpoint at the current time step.
+
+        Call :py:meth:`write_restart` at the end of a job to ensure that the final state of the simulation is saved.
+        """
+        time_step = hoomd.context.current.system.getCurrentTimeStep()
+        self.cpp_analyzer.analyze(time_step);
+
 class dcd(hoomd.analyze._analyzer):
     R""" Writes simulation snapshots in the DCD format
 
@@ -33,11 +96,19 @@ class dcd(hoomd.analyze._analyzer):
                some particles may be written just outside it. *unwrap_rigid* is ignored when *unwrap_full* is True.
         angle_z (bool): When True, the particle orientation angle is written to the z component (only useful for 2D simulations)
         phase (int): When -1, start on the current time step. When >= 0, execute on steps where *(step + phase) % period == 0*.
+        parallel (bool): When True, all MPI ranks pack the coordinates of their particles and the root rank writes the
+                         frames in a background thread. (added in version 2.7)
 
     Every *period* time steps a new simulation snapshot is written to the
     specified file in the DCD file format. DCD only stores particle positions, in distance
     units - see :ref:`page-units`.
 
+    With *parallel* set to True, no snapshot of the system is taken: every rank converts the coordinates of its members
+    of *group* to single precision and unwraps them with their local image flags, and the root rank places them
+    directly into a reusable frame buffer. The frame is written to the file while the simulation continues. The file
+    contents are identical to those written with *parallel* set to False. *unwrap_rigid* without *unwrap_full* is not
+    supported in parallel and falls back to the serial output.
+
     Due to constraints of the DCD file format, once you stop writing to
     a file via :py:meth:`disable()`, you cannot continue writing to the same file,
     nor can you change the period of the dump at any time. Either of these tasks
@@ -55,7 +126,7 @@ class dcd(hoomd.analyze._analyzer):
         * dump.dcd will not write out data at time steps that already are present in the dcd file to maintain a
           consistent timeline
     """
-    def __init__(self, filename, period, group=None, overwrite=False, unwrap_full=False, unwrap_rigid=False, angle_z=False, phase=0):
+    def __init__(self, filename, period, group=None, overwrite=False, unwrap_full=False, unwrap_rigid=False, angle_z=False, phase=0, parallel=False):
         hoomd.util.print_status_line();
 
         # initialize base class
@@ -77,6 +148,7 @@ class dcd(hoomd.analyze._analyzer):
         self.cpp_analyzer.setUnwrapFull(unwrap_full);
         self.cpp_analyzer.setUnwrapRigid(unwrap_rigid);
         self.cpp_analyzer.setAngleZ(angle_z);
+        self.cpp_analyzer.setParallel(parallel);
         self.setupAnalyzer(period, phase);
 
         # store metadata
@@ -504,6 +576,11 @@ class gsd(hoomd.analyze._analyzer):
         time_step (int): Time step to write to the file (only used when period is None)
         dynamic (list): A list of quantity categories to save every frame. (added in version 2.2)
         static (list): A list of quantity categories save only in frame 0 (may not be set in conjunction with *dynamic*, deprecated in version 2.2).
+        buffer_frames (int): Number of frames that are written to the file in the background (0 to write
+                             synchronously). (added in version 2.7)
+        parallel (bool): When True, all MPI ranks write their particles to the file with MPI-IO. (added in version 2.7)
+        position_bits (int): When set, store positions quantized to this many bits per coordinate (4 to 24). (added in version 2.7)
+        keyframe_period (int): Number of frames between quantized position keyframes. (added in version 2.7)
 
     Write a simulation snapshot to the specified GSD file at regular intervals.
     GSD is capable of storing all particle and bond data fields in hoomd,
@@ -552,6 +629,10 @@ class gsd(hoomd.analyze._analyzer):
         * constraints/
         * pairs/
 
+    With ``topology`` in *dynamic*, each of the bonded group types is gathered only on the steps where groups were
+    added or removed, and written only to frames where it differs from frame 0. Readers take the unchanged types from
+    frame 0.
+
     See https://github.com/glotzerlab/gsd and http://gsd.readthedocs.io/ for more information on GSD files.
 
     If you only need to store a subset of the system, you can save file size and time spent analyzing data by
@@ -561,6 +642,26 @@ class gsd(hoomd.analyze._analyzer):
     To write restart files with gsd, set `truncate=True`. This will cause :py:class:`gsd` to write a new frame 0
     to the file every period steps.
 
+    With *buffer_frames* > 0, :py:class:`gsd` gathers the frame and then continues the simulation while a thread on
+    the root rank writes the frame to the file. When *buffer_frames* frames are still being written, the simulation
+    waits for the writer. All frames are written to the file at the end of every :py:func:`hoomd.run()`.
+    Frames are written synchronously once :py:meth:`dump_state` has been called.
+
+    With *parallel=True* in MPI simulations, the particle data is not gathered on the root rank. Instead, every rank
+    writes a contiguous range of the group members directly to the file with MPI-IO, which requires a file system
+    that all ranks can write to. The root rank still writes the box, the topology and the file index. The resulting
+    file is identical to one written with *parallel=False*. Parallel writes are always synchronous, *buffer_frames*
+    is ignored. In single-process simulations, *parallel* has no effect.
+
+    With *position_bits* set, :py:class:`gsd` stores lossy compressed positions in the chunk
+    ``particles/position_quantized`` instead of ``particles/position``. The fractional coordinates of every particle
+    in the box are rounded to *position_bits* bits, so the error along each box vector is at most
+    :math:`L/2^{\mathrm{position\_bits}+1}`. Every *keyframe_period* frames, a keyframe stores the rounded
+    coordinates, and the frames in between only store the differences to the last keyframe, packed with as few bits as
+    needed. Depending on how far the particles move between frames, this reduces the size of the positions 3 to 6
+    times. :py:func:`hoomd.init.read_gsd` and :py:func:`hoomd.data.gsd_snapshot` decode the positions transparently,
+    other GSD readers do not know the chunk and see all positions at 0.
+
     .. rubric:: State data
 
     :py:class:`gsd` can save internal state data for the following hoomd objects:
@@ -577,6 +678,9 @@ class gsd(hoomd.analyze._analyzer):
         dump.gsd(filename="configuration.gsd", overwrite=True, period=None, group=group.all(), time_step=0)
         dump.gsd(filename="momentum_too.gsd", period=1000, group=group.all(), phase=0, dynamic=['momentum'])
         dump.gsd(filename="saveall.gsd", overwrite=True, period=1000, group=group.all(), dynamic=['attribute', 'momentum', 'topology'])
+        dump.gsd(filename="trajectory.gsd", period=1000, group=group.all(), buffer_frames=2)
+        dump.gsd(filename="trajectory.gsd", period=1000, group=group.all(), parallel=True)
+        dump.gsd(filename="trajectory.gsd", period=1000, group=group.all(), position_bits=16, keyframe_period=20)
 
     """
     def __init__(self,
@@ -588,12 +692,25 @@ class gsd(hoomd.analyze._analyzer):
                  phase=0,
                  time_step=None,
                  static=None,
-                 dynamic=None):
+                 dynamic=None,
+                 buffer_frames=0,
+                 parallel=False,
+                 position_bits=None,
+                 keyframe_period=10):
         hoomd.util.print_status_line();
 
         if static is not None and dynamic is not None:
             raise ValueError("Cannot specify both static and dynamic arguments");
 
+        if buffer_frames < 0:
+            raise ValueError("buffer_frames must be non-negative");
+
+        if position_bits is not None and (position_bits < 4 or position_bits > 24):
+            raise ValueError("position_bits must be between 4 and 24");
+
+        if keyframe_period < 1:
+            raise ValueError("keyframe_period must be positive");
+
         categories = ['attribute', 'property', 'momentum', 'topology'];
         dynamic_quantities = ['property']
 
@@ -628,6 +745,10 @@ class gsd(hoomd.analyze._analyzer):
         self.cpp_analyzer.setWriteProperty('property' in dynamic_quantities);
         self.cpp_analyzer.setWriteMomentum('momentum' in dynamic_quantities);
         self.cpp_analyzer.setWriteTopology('topology' in dynamic_quantities);
+        self.cpp_analyzer.setBufferFrames(int(buffer_frames));
+        self.cpp_analyzer.setParallelWrite(bool(parallel));
+        if position_bits is not None:
+            self.cpp_analyzer.setPositionQuantization(int(position_bits), int(keyframe_period));
 
         if period is not None:
             self.setupAnalyzer(period, phase);
@@ -635,13 +756,18 @@ class gsd(hoomd.analyze._analyzer):
             if time_step is None:
                 time_step = hoomd.context.current.system.getCurrentTimeStep()
             self.cpp_analyzer.analyze(time_step);
+            self.cpp_analyzer.flush();
 
         # store metadata
         self.filename = filename
         self.period = period
         self.group = group
         self.phase = phase
-        self.metadata_fields = ['filename','period','group', 'phase']
+        self.buffer_frames = buffer_frames
+        self.parallel = parallel
+        self.position_bits = position_bits
+        self.keyframe_period = keyframe_period
+        self.metadata_fields = ['filename','period','group', 'phase', 'buffer_frames', 'parallel', 'position_bits', 'keyframe_period']
 
     def write_restart(self):
         """ Write a restart file at the current time step.
@@ -653,6 +779,7 @@ class gsd(hoomd.analyze._analyzer):
 
         time_step = hoomd.context.current.system.getCurrentTimeStep()
         self.cpp_analyzer.analyze(time_step);
+        self.cpp_analyzer.flush();
 
     def dump_state(self, obj):
         """Write state information for a hoomd object.
@@ -250,7 +250,7 @@ def read_snapshot(snapshot):
     _perform_common_init_tasks();
     return hoomd.data.system_data(hoomd.context.current.system_definition);
 
-def read_gsd(filename, restart = None, frame = 0, time_step = None):
+def read_gsd(filename, restart = None, frame = 0, time_step = None, distributed = False):
     R""" Read initial system state from an GSD file.
 
     Args:
@@ -258,6 +258,7 @@ def read_gsd(filename, restart = None, frame = 0, time_step = None):
         restart (str): If it exists, read the file *restart* instead of *filename*.
         frame (int): Index of the frame to read from the GSD file. Negative values index from the end of the file.
         time_step (int): (if specified) Time step number to initialize instead of the one stored in the GSD file.
+        distributed (bool): When True, all MPI ranks read the particles from the file (added in version 2.7).
 
     All particles, bonds, angles, dihedrals, impropers, constraints, and box information
     are read from the given GSD file at the given frame index. To read and write GSD files
@@ -273,6 +274,12 @@ def read_gsd(filename, restart = None, frame = 0, time_step = None):
     The result of :py:func:`hoomd.init.read_gsd` can be saved in a variable and later used to read and/or
     change particle properties later in the script. See :py:mod:`hoomd.data` for more information.
 
+    By default, the root rank reads the whole frame and scatters the particles to the other ranks. With
+    *distributed=True*, every rank maps the file into memory, reads an equal share of the particles and sends
+    them to the ranks that own them, so the system never has to fit into the memory of a single rank. The file must
+    be readable by all ranks. The topology is still read by the root rank. *distributed* has no effect in
+    single-process simulations.
+
     See Also:
         :py:class:`hoomd.dump.gsd`
     """
@@ -287,11 +294,13 @@ def read_gsd(filename, restart = None, frame = 0, time_step = None):
     filename = _hoomd.mpi_bcast_str(filename, hoomd.context.exec_conf);
     restart = _hoomd.mpi_bcast_str(restart, hoomd.context.exec_conf);
 
+    distributed = distributed and hoomd.comm.get_num_ranks() > 1;
+
     if restart is not None and os.path.exists(restart):
-        reader = _hoomd.GSDReader(hoomd.context.exec_conf, restart, abs(frame), frame < 0);
+        reader = _hoomd.GSDReader(hoomd.context.exec_conf, restart, abs(frame), frame < 0, distributed);
         time_step = reader.getTimeStep();
     else:
-        reader = _hoomd.GSDReader(hoomd.context.exec_conf, filename, abs(frame), frame < 0);
+        reader = _hoomd.GSDReader(hoomd.context.exec_conf, filename, abs(frame), frame < 0, distributed);
         if time_step is None:
             time_step = reader.getTimeStep();
 
@@ -303,6 +312,10 @@ def read_gsd(filename, restart = None, frame = 0, time_step = None):
 
     if my_domain_decomposition is not None:
         hoomd.context.current.system_definition = _hoomd.SystemDefinition(snapshot, hoomd.context.exec_conf, my_domain_decomposition);
+
+        # the snapshot only holds the header, the ranks read the particles themselves
+        if distributed:
+            reader.initializeDistributed(hoomd.context.current.system_definition);
     else:
         hoomd.context.current.system_definition = _hoomd.SystemDefinition(snapshot, hoomd.context.exec_conf);
 
@@ -314,6 +327,62 @@ def read_gsd(filename, restart = None, frame = 0, time_step = None):
     hoomd.context.current.state_reader.clearSnapshot();
     return hoomd.data.system_data(hoomd.context.current.system_definition);
 
+def read_checkpoint(prefix):
+    R""" Restore the system state from a checkpoint.
+
+    Args:
+        prefix (str): Prefix of the checkpoint file names, as given to :py:class:`hoomd.dump.checkpoint`.
+
+    Every MPI rank reads its local particles and bonded groups directly from the file written by the rank that held
+    the same domain, so restoring a checkpoint needs no communication of particle data. The time step, the box, the
+    integrator variables and the domain decomposition, including cut planes moved by :py:class:`hoomd.update.balance`,
+    are restored from the manifest ``prefix.manifest``.
+
+    The checkpoint must be restored on the same number of ranks it was written with. If a decomposition is set with
+    :py:class:`hoomd.comm.decomposition` before, it must have the same grid, otherwise the grid of the checkpoint is
+    used. Integrators restore their state when they are created with the same parameters and in the same order as in
+    the script that wrote the checkpoint.
+
+    .. versionadded:: 2.7
+
+    See Also:
+        :py:class:`hoomd.dump.checkpoint`
+    """
+    hoomd.context._verify_init();
+    hoomd.util.print_status_line();
+
+    # check if initialization has already occurred
+    if is_initialized():
+        hoomd.context.msg.error("Cannot initialize more than once\n");
+        raise RuntimeError("Error initializing");
+
+    prefix = _hoomd.mpi_bcast_str(prefix, hoomd.context.exec_conf);
+    reader = _hoomd.CheckpointReader(hoomd.context.exec_conf, prefix);
+    snapshot = reader.getSnapshot();
+
+    # use the grid of the checkpoint unless a decomposition has been set
+    grid = reader.getGridSize();
+    if grid.x > 0 and hoomd.context.current.decomposition is None:
+        hoomd.util.quiet_status();
+        hoomd.comm.decomposition(nx=grid.x, ny=grid.y, nz=grid.z, staggered=reader.isStaggered());
+        hoomd.util.unquiet_status();
+
+    my_domain_decomposition = _create_domain_decomposition(snapshot._global_box);
+
+    if my_domain_decomposition is not None:
+        reader.setDomainDecomposition(my_domain_decomposition);
+        hoomd.context.current.system_definition = _hoomd.SystemDefinition(snapshot, hoomd.context.exec_conf, my_domain_decomposition);
+    else:
+        hoomd.context.current.system_definition = _hoomd.SystemDefinition(snapshot, hoomd.context.exec_conf);
+
+    reader.initialize(hoomd.context.current.system_definition);
+
+    # initialize the system
+    hoomd.context.current.system = _hoomd.System(hoomd.context.current.system_definition, reader.getTimeStep());
+
+    _perform_common_init_tasks();
+    return hoomd.data.system_data(hoomd.context.current.system_definition);
+
 def restore_getar(filename, modes={'any': 'any'}):
     """Restore a subset of the current system's parameters from a
     trajectory archive (.tar, .zip, .sqlite) file. For a detailed
@@ -9,6 +9,12 @@
 
 #include <map>
 #include <string.h>
+#include <atomic>
+#include <climits>
+
+#ifdef ENABLE_TBB
+#include <tbb/tbb.h>
+#endif
 namespace py = pybind11;
 
 /*! \file ForceComposite.cc
@@ -802,8 +808,22 @@ void ForceComposite::computeForces(unsigned int timestep)
         compute_virial = true;
         }
 
+    const unsigned int N = m_pdata->getN();
+
+    // tag of an incomplete body with a local central particle, detected inside the (possibly threaded) loop
+    std::atomic<unsigned int> incomplete_tag(UINT_MAX);
+
     // loop over all molecules, also incomplete ones
+    // every molecule owns its central particle and its constituents, so the iterations write to disjoint
+    // elements and each body's sum is accumulated in molecule list order, independent of the thread count
+    #ifdef ENABLE_TBB
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, nmol),
+        [&](const tbb::blocked_range<unsigned int>& r)
+        {
+        for (unsigned int ibody = r.begin(); ibody != r.end(); ++ibody)
+    #else
     for (unsigned int ibody = 0; ibody < nmol; ibody++)
+    #endif
         {
         unsigned int len = h_molecule_length.data[ibody];
 
@@ -829,6 +849,20 @@ void ForceComposite::computeForces(unsigned int timestep)
         // body type
         unsigned int type = __scalar_as_int(postype.w);
 
+        // if the central particle is local, the molecule should be complete
+        bool local_body = central_idx < N;
+        if (local_body && len > 1 && len != h_body_len.data[type] + 1)
+            {
+            incomplete_tag = central_tag;
+            continue;
+            }
+
+        // accumulate the body force, torque and virial in registers
+        vec3<Scalar> force_sum(0.0,0.0,0.0);
+        Scalar energy_sum(0.0);
+        vec3<Scalar> torque_sum(0.0,0.0,0.0);
+        Scalar virial_sum[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
         // sum up forces and torques from constituent particles
         for (unsigned int jptl = 0; jptl < len; ++jptl)
             {
@@ -849,23 +883,13 @@ void ForceComposite::computeForces(unsigned int timestep)
             h_net_torque.data[idxj] = make_scalar4(0.0,0.0,0.0,0.0);
 
             // only add forces for local central particles
-            if (central_idx < m_pdata->getN())
+            if (local_body)
                 {
-                // if the central particle is local, the molecule should be complete
-                if (len != h_body_len.data[type] + 1)
-                    {
-                    m_exec_conf->msg->error() << "constrain.rigid(): Composite particle with body tag " << central_tag << " incomplete"
-                        << std::endl << std::endl;
-                    throw std::runtime_error("Error computing composite particle forces.\n");
-                    }
-
                 // sum up center of mass force
-                h_force.data[central_idx].x += f.x;
-                h_force.data[central_idx].y += f.y;
-                h_force.data[central_idx].z += f.z;
+                force_sum += f;
 
                 // sum up energy
-                h_force.data[central_idx].w += net_force.w;
+                energy_sum += net_force.w;
 
                 // fetch relative position from rigid body definition
                 vec3<Scalar> dr(h_body_pos.data[m_body_idx(type, jptl - 1)]);
@@ -874,17 +898,12 @@ void ForceComposite::computeForces(unsigned int timestep)
                 vec3<Scalar> dr_space = rotate(orientation, dr);
 
                 // torque = r x f
-                vec3<Scalar> delta_torque(cross(dr_space,f));
-                h_torque.data[central_idx].x += delta_torque.x;
-                h_torque.data[central_idx].y += delta_torque.y;
-                h_torque.data[central_idx].z += delta_torque.z;
+                torque_sum += cross(dr_space,f);
 
                 /* from previous rigid body implementation: Access Torque elements from a single particle. Right now I will am assuming that the particle
                     and rigid body reference frames are the same. Probably have to rotate first.
                  */
-                h_torque.data[central_idx].x += net_torque.x;
-                h_torque.data[central_idx].y += net_torque.y;
-                h_torque.data[central_idx].z += net_torque.z;
+                torque_sum += vec3<Scalar>(net_torque);
 
                 if (compute_virial)
                     {
@@ -897,12 +916,12 @@ void ForceComposite::computeForces(unsigned int timestep)
                     Scalar virialzz = h_net_virial.data[5*net_virial_pitch+idxj];
 
                     // subtract intra-body virial prt
-                    h_virial.data[0*m_virial_pitch+central_idx] += virialxx - f.x*dr_space.x;
-                    h_virial.data[1*m_virial_pitch+central_idx] += virialxy - f.x*dr_space.y;
-                    h_virial.data[2*m_virial_pitch+central_idx] += virialxz - f.x*dr_space.z;
-                    h_virial.data[3*m_virial_pitch+central_idx] += virialyy - f.y*dr_space.y;
-                    h_virial.data[4*m_virial_pitch+central_idx] += virialyz - f.y*dr_space.z;
-                    h_virial.data[5*m_virial_pitch+central_idx] += virialzz - f.z*dr_space.z;
+                    virial_sum[0] += virialxx - f.x*dr_space.x;
+                    virial_sum[1] += virialxy - f.x*dr_space.y;
+                    virial_sum[2] += virialxz - f.x*dr_space.z;
+                    virial_sum[3] += virialyy - f.y*dr_space.y;
+                    virial_sum[4] += virialyz - f.y*dr_space.z;
+                    virial_sum[5] += virialzz - f.z*dr_space.z;
                     }
                 }
 
@@ -914,6 +933,29 @@ void ForceComposite::computeForces(unsigned int timestep)
             h_net_virial.data[4*net_virial_pitch+idxj] = 0.0;
             h_net_virial.data[5*net_virial_pitch+idxj] = 0.0;
             }
+
+        if (local_body)
+            {
+            // central_idx belongs to this molecule only, so no other iteration writes to it
+            h_force.data[central_idx] = make_scalar4(force_sum.x, force_sum.y, force_sum.z, energy_sum);
+            h_torque.data[central_idx] = make_scalar4(torque_sum.x, torque_sum.y, torque_sum.z, 0.0);
+
+            if (compute_virial)
+                {
+                for (unsigned int k = 0; k < 6; ++k)
+                    h_virial.data[k*m_virial_pitch+central_idx] = virial_sum[k];
+                }
+            }
+        }
+    #ifdef ENABLE_TBB
+        });
+    #endif
+
+    if (incomplete_tag != UINT_MAX)
+        {
+        m_exec_conf->msg->error() << "constrain.rigid(): Composite particle with body tag " << incomplete_tag << " incomplete"
+            << std::endl << std::endl;
+        throw std::runtime_error("Error computing composite particle forces.\n");
         }
     }
 
@@ -952,8 +994,22 @@ void ForceComposite::updateCompositeParticles(unsigned int timestep)
 
     // we need to update both local and ghost particles
     unsigned int nptl = m_pdata->getN() + m_pdata->getNGhosts();
+    const unsigned int N = m_pdata->getN();
+
+    // errors detected inside the (possibly threaded) loop, reported afterwards
+    std::atomic<unsigned int> missing_tag(UINT_MAX);
+    std::atomic<unsigned int> incomplete_tag(UINT_MAX);
 
+    // every iteration only writes to its own constituent particle and reads the central particle,
+    // which is never written to, so the loop can be executed in parallel
+    #ifdef ENABLE_TBB
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, nptl),
+        [&](const tbb::blocked_range<unsigned int>& r)
+        {
+        for (unsigned int iptl = r.begin(); iptl != r.end(); ++iptl)
+    #else
     for (unsigned int iptl = 0; iptl < nptl; iptl++)
+    #endif
         {
         unsigned int central_tag = h_body.data[iptl];
 
@@ -964,14 +1020,13 @@ void ForceComposite::updateCompositeParticles(unsigned int timestep)
         assert(central_tag <= m_pdata->getMaximumTag());
         unsigned int central_idx = h_rtag.data[central_tag];
 
-        if (central_idx == NOT_LOCAL && iptl >= m_pdata->getN())
+        if (central_idx == NOT_LOCAL && iptl >= N)
             continue;
 
         if (central_idx == NOT_LOCAL)
             {
-            m_exec_conf->msg->error() << "constrain.rigid(): Missing central particle tag " << central_tag << "!"
-                << std::endl << std::endl;
-            throw std::runtime_error("Error updating composite particles.\n");
+            missing_tag = central_tag;
+            continue;
             }
 
         // central ptl position and orientation
@@ -991,12 +1046,10 @@ void ForceComposite::updateCompositeParticles(unsigned int timestep)
         unsigned int mol_idx = h_molecule_idx.data[iptl];
         if (body_len != h_molecule_len.data[mol_idx] - 1)
             {
-            if (iptl < m_pdata->getN())
+            if (iptl < N)
                 {
                 // if the molecule is incomplete and has local members, this is an error
-                m_exec_conf->msg->error() << "constrain.rigid(): Composite particle with body tag " << central_tag << " incomplete"
-                    << std::endl << std::endl;
-                throw std::runtime_error("Error while updating constituent particles.\n");
+                incomplete_tag = central_tag;
                 }
 
             // otherwise we must ignore it
@@ -1029,6 +1082,23 @@ void ForceComposite::updateCompositeParticles(unsigned int timestep)
         h_orientation.data[iptl] = quat_to_scalar4(updated_orientation);
         h_image.data[iptl] = img+imgi;
         }
+    #ifdef ENABLE_TBB
+        });
+    #endif
+
+    if (missing_tag != UINT_MAX)
+        {
+        m_exec_conf->msg->error() << "constrain.rigid(): Missing central particle tag " << missing_tag << "!"
+            << std::endl << std::endl;
+        throw std::runtime_error("Error updating composite particles.\n");
+        }
+
+    if (incomplete_tag != UINT_MAX)
+        {
+        m_exec_conf->msg->error() << "constrain.rigid(): Composite particle with body tag " << incomplete_tag << " incomplete"
+            << std::endl << std::endl;
+        throw std::runtime_error("Error while updating constituent particles.\n");
+        }
     }
 
 void export_ForceComposite(py::module& m)
@@ -182,6 +182,15 @@ class PYBIND11_EXPORT IntegrationMethodTwoStep
             return PDataFlags(0);
             }
 
+        //! Returns true if integrateStepOne() writes the new positions to the structure-of-arrays mirror as well
+        /*! The mirror is invalidated after the first step unless all methods keep it up to date.
+            \sa ParticleData::updatePositionsSoA()
+        */
+        virtual bool updatesPositionsSoA() const
+            {
+            return false;
+            }
+
         //! Validate that all members in the particle group are valid (throw an exception if they are not)
         virtual void validateGroup();
 
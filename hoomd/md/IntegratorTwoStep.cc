@@ -109,9 +109,17 @@ void IntegratorTwoStep::update(unsigned int timestep)
         m_prof->push("Integrate");
 
     // perform the first step of the integration on all groups
+    bool soa_valid = true;
     std::vector< std::shared_ptr<IntegrationMethodTwoStep> >::iterator method;
     for (method = m_methods.begin(); method != m_methods.end(); ++method)
+        {
         (*method)->integrateStepOne(timestep);
+        soa_valid = soa_valid && (*method)->updatesPositionsSoA();
+        }
+
+    // the methods that do not write the structure-of-arrays mirror make it out of date
+    if (! soa_valid)
+        m_pdata->invalidatePositionsSoA();
 
     if (m_prof)
         m_prof->pop();
@@ -341,6 +349,9 @@ void IntegratorTwoStep::setAnisotropicMode(AnisotropicMode mode)
 */
 void IntegratorTwoStep::prepRun(unsigned int timestep)
     {
+    // positions may have been changed in any way since the last run
+    m_pdata->invalidatePositionsSoA();
+
     bool aniso = false;
 
     // set (an-)isotropic integration mode
@@ -445,6 +456,9 @@ void IntegratorTwoStep::updateRigidBodies(unsigned int timestep)
     // slave any constituents of local composite particles
     for (auto force_composite = m_composite_forces.begin(); force_composite != m_composite_forces.end(); ++force_composite)
         (*force_composite)->updateCompositeParticles(timestep);
+
+    if (! m_composite_forces.empty())
+        m_pdata->invalidatePositionsSoA();
     }
 
 /*! \param enable Enable/disable autotuning
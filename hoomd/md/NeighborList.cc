@@ -54,6 +54,12 @@ NeighborList::NeighborList(std::shared_ptr<SystemDefinition> sysdef, Scalar _r_c
 
     m_need_reallocate_exlist = false;
 
+    #ifdef ENABLE_MPI
+    m_interior_requested = false;
+    m_interior_valid = false;
+    m_interior_n = 0;
+    #endif
+
     // initialize box length at last update
     m_last_L = m_pdata->getGlobalBox().getNearestPlaneDistance();
     m_last_L_local = m_pdata->getBox().getNearestPlaneDistance();
@@ -363,6 +369,11 @@ void NeighborList::compute(unsigned int timestep)
         if (m_exclusions_set)
             filterNlist();
 
+        #ifdef ENABLE_MPI
+        if (m_interior_requested)
+            buildInteriorList();
+        #endif
+
         setLastUpdatedPos();
         m_has_been_updated_once = true;
         }
@@ -1105,6 +1116,14 @@ bool NeighborList::distanceCheck(unsigned int timestep)
     ArrayHandle<Scalar4> h_last_pos(m_last_pos, access_location::host, access_mode::read);
     ArrayHandle<Scalar> h_rcut_max(m_rcut_max, access_location::host, access_mode::read);
 
+    // extrapolated ghosts deviate from the positions of their particles by up to the maximum drift,
+    // which uses up that part of the buffer
+    Scalar ghost_drift(0.0);
+    #ifdef ENABLE_MPI
+    if (m_comm && m_comm->getGhostUpdatePeriod() > 1)
+        ghost_drift = m_comm->getGhostMaxDrift();
+    #endif
+
     for (unsigned int i = 0; i < m_pdata->getN(); i++)
         {
         const unsigned int type_i = __scalar_as_int(h_pos.data[i].w);
@@ -1113,7 +1132,7 @@ bool NeighborList::distanceCheck(unsigned int timestep)
         Scalar old_rmin = h_rcut_max.data[type_i];
 
         // maximum value we have checked for neighbors, defined by the buffer layer
-        Scalar rmax = old_rmin + m_r_buff;
+        Scalar rmax = old_rmin + m_r_buff - ghost_drift;
 
         // max displacement for each particle (after subtraction of homogeneous dilations)
         const Scalar delta_max = (rmax*lambda_min - old_rmin)/Scalar(2.0);
@@ -1136,6 +1155,9 @@ bool NeighborList::distanceCheck(unsigned int timestep)
     if (m_pdata->getDomainDecomposition())
         {
         if (m_prof) m_prof->push("MPI allreduce");
+        // the reduction mostly waits for the other ranks, it is not part of the force compute cost
+        ClockSource clk;
+
         // check if migrate criterion is fulfilled on any rank
         int local_result = result ? 1 : 0;
         int global_result = 0;
@@ -1146,6 +1168,9 @@ bool NeighborList::distanceCheck(unsigned int timestep)
             MPI_MAX,
             m_exec_conf->getMPICommunicator());
         result = (global_result > 0);
+
+        if (m_comm)
+            m_comm->addWaitTime(clk.getTime());
         if (m_prof) m_prof->pop();
         }
     #endif
@@ -1574,6 +1599,51 @@ bool NeighborList::peekUpdate(unsigned int timestep)
 
     return result;
     }
+
+/*! A local particle is interior if none of its neighbors is a ghost particle, so its forces can be evaluated
+    before the ghost positions of the current time step have arrived. The classification is only maintained for
+    lists built on the host.
+ */
+void NeighborList::buildInteriorList()
+    {
+    m_interior_list.clear();
+    m_boundary_list.clear();
+    m_interior_valid = false;
+
+    #ifdef ENABLE_CUDA
+    if (m_exec_conf->isCUDAEnabled())
+        return;
+    #endif
+
+    ArrayHandle<unsigned int> h_n_neigh(m_n_neigh, access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_nlist(m_nlist, access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_head_list(m_head_list, access_location::host, access_mode::read);
+
+    const unsigned int N = m_pdata->getN();
+    for (unsigned int i = 0; i < N; ++i)
+        {
+        const unsigned int head = h_head_list.data[i];
+        const unsigned int n_neigh = h_n_neigh.data[i];
+
+        bool interior = true;
+        for (unsigned int k = 0; k < n_neigh; ++k)
+            {
+            if (h_nlist.data[head + k] >= N)
+                {
+                interior = false;
+                break;
+                }
+            }
+
+        if (interior)
+            m_interior_list.push_back(i);
+        else
+            m_boundary_list.push_back(i);
+        }
+
+    m_interior_n = N;
+    m_interior_valid = true;
+    }
 #endif
 
 #ifdef ENABLE_CUDA
@@ -436,6 +436,40 @@ class PYBIND11_EXPORT NeighborList : public Compute
         /*! \param timestep The current timestep
          */
         bool peekUpdate(unsigned int timestep);
+
+        //! Request the classification of particles into interior and boundary particles
+        /*! After the next build on the CPU, every local particle is classified as interior if all of its
+         *  neighbors are local particles, and as boundary otherwise. The classification is maintained at
+         *  every subsequent build.
+         */
+        void requestInteriorList()
+            {
+            m_interior_requested = true;
+            }
+
+        //! Returns true if the interior classification is current and the list will not be rebuilt this step
+        /*! \param timestep Current time step
+         *
+         *  This is supposed to be called after the particle migration check of this time step.
+         */
+        bool hasValidInteriorList(unsigned int timestep)
+            {
+            return m_interior_valid && m_has_been_updated_once && !m_force_update && !m_rcut_changed
+                && m_last_checked_tstep == timestep && !m_last_check_result
+                && m_interior_n == m_pdata->getN();
+            }
+
+        //! Get the indices of the local particles without ghost neighbors
+        const std::vector<unsigned int>& getInteriorList() const
+            {
+            return m_interior_list;
+            }
+
+        //! Get the indices of the local particles with at least one ghost neighbor
+        const std::vector<unsigned int>& getBoundaryList() const
+            {
+            return m_boundary_list;
+            }
 #endif
 
         //! Return true if the neighbor list has been updated this time step
@@ -557,6 +591,17 @@ class PYBIND11_EXPORT NeighborList : public Compute
         unsigned int m_every; //!< No update checks will be performed until m_every steps after the last one
         std::vector<unsigned int> m_update_periods;    //!< Steps between updates
 
+        #ifdef ENABLE_MPI
+        bool m_interior_requested;                     //!< True if the interior classification is maintained
+        bool m_interior_valid;                         //!< True if the interior classification matches the list
+        unsigned int m_interior_n;                     //!< Number of local particles at the time of classification
+        std::vector<unsigned int> m_interior_list;     //!< Local particles without ghost neighbors
+        std::vector<unsigned int> m_boundary_list;     //!< Local particles with ghost neighbors
+
+        //! Classify the local particles into interior and boundary particles
+        void buildInteriorList();
+        #endif
+
         //! Test if the list needs updating
         bool needsUpdating(unsigned int timestep);
 
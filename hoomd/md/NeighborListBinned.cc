@@ -87,8 +87,14 @@ void NeighborListBinned::buildNlist(unsigned int timestep)
     if (m_prof)
         m_prof->push(m_exec_conf, "compute");
 
+    // neighbor types are looked up in the structure-of-arrays mirror, if enabled
+    if (m_pdata->hasPositionsSoA())
+        m_pdata->updatePositionsSoA();
+
     // acquire the particle data and box dimension
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_type(m_pdata->getTypesSoA(), access_location::host, access_mode::read);
+    const bool use_soa = m_pdata->hasPositionsSoA();
     ArrayHandle<unsigned int> h_body(m_pdata->getBodies(), access_location::host, access_mode::read);
     ArrayHandle<Scalar> h_diameter(m_pdata->getDiameters(), access_location::host, access_mode::read);
 
@@ -184,7 +190,7 @@ void NeighborListBinned::buildNlist(unsigned int timestep)
                 unsigned int cur_neigh = __scalar_as_int(cur_xyzf.w);
 
                 // get the current neighbor type from the position data (will use tdb on the GPU)
-                unsigned int cur_neigh_type = __scalar_as_int(h_pos.data[cur_neigh].w);
+                unsigned int cur_neigh_type = use_soa ? h_type.data[cur_neigh] : __scalar_as_int(h_pos.data[cur_neigh].w);
                 Scalar r_cut = h_r_cut.data[m_typpair_idx(type_i,cur_neigh_type)];
 
                 // automatically exclude particles without a distance check when:
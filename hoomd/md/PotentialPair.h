@@ -126,6 +126,9 @@ class PotentialPair : public ForceCompute
         #ifdef ENABLE_MPI
         //! Get ghost particle fields requested by this pair potential
         virtual CommFlags getRequestedCommFlags(unsigned int timestep);
+
+        //! Compute the forces on interior particles during the ghost update
+        virtual void preComputeInterior(unsigned int timestep);
         #endif
 
         //! Calculates the energy between two lists of particles.
@@ -147,9 +150,18 @@ class PotentialPair : public ForceCompute
         std::string m_prof_name;                    //!< Cached profiler name
         std::string m_log_name;                     //!< Cached log name
 
+        #ifdef ENABLE_MPI
+        bool m_interior_pending;                    //!< True if the interior forces have been computed ahead of time
+        unsigned int m_interior_tstep;              //!< Time step of the interior forces
+        unsigned int m_interior_nlist_updates;      //!< Number of neighbor list builds at the time of the interior forces
+        #endif
+
         //! Actually compute the forces
         virtual void computeForces(unsigned int timestep);
 
+        //! Evaluate the pair forces for a set of neighbor list rows
+        void computeParticleForces(const unsigned int *rows, unsigned int n_rows, bool zero_forces);
+
         //! Method to be called when number of types changes
         virtual void slotNumTypesChange()
             {
@@ -205,6 +217,12 @@ PotentialPair< evaluator >::PotentialPair(std::shared_ptr<SystemDefinition> sysd
     {
     m_exec_conf->msg->notice(5) << "Constructing PotentialPair<" << evaluator::getName() << ">" << std::endl;
 
+    #ifdef ENABLE_MPI
+    m_interior_pending = false;
+    m_interior_tstep = 0;
+    m_interior_nlist_updates = 0;
+    #endif
+
     assert(m_pdata);
     assert(m_nlist);
 
@@ -359,6 +377,36 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
     // start the profile for this compute
     if (m_prof) m_prof->push(m_prof_name);
 
+    #ifdef ENABLE_MPI
+    // if the interior particles were computed during the ghost update, only the boundary particles remain
+    if (m_interior_pending && m_interior_tstep == timestep && m_interior_nlist_updates == m_nlist->getNumUpdates())
+        {
+        const std::vector<unsigned int>& boundary = m_nlist->getBoundaryList();
+        computeParticleForces(boundary.size() ? &boundary.front() : NULL, boundary.size(), false);
+        }
+    else
+    #endif
+        {
+        computeParticleForces(NULL, m_pdata->getN(), true);
+        }
+
+    #ifdef ENABLE_MPI
+    m_interior_pending = false;
+    #endif
+
+    if (m_prof) m_prof->pop();
+    }
+
+/*! \param rows Indices of the particles whose neighbor list rows are evaluated, or NULL for particles 0 to n_rows-1
+    \param n_rows Number of rows to evaluate
+    \param zero_forces True if the force and virial arrays are zeroed before the evaluation
+
+    With the half neighbor list, the third law contributions are added to the local neighbors as well, so the complete
+    forces are only available after all rows have been evaluated.
+*/
+template< class evaluator >
+void PotentialPair< evaluator >::computeParticleForces(const unsigned int *rows, unsigned int n_rows, bool zero_forces)
+    {
     // depending on the neighborlist settings, we can take advantage of newton's third law
     // to reduce computations at the cost of memory access complexity: set that flag now
     bool third_law = m_nlist->getStorageMode() == NeighborList::half;
@@ -369,14 +417,24 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
 //     Index2D nli = m_nlist->getNListIndexer();
     ArrayHandle<unsigned int> h_head_list(m_nlist->getHeadList(), access_location::host, access_mode::read);
 
+    // with the structure-of-arrays layout, neighbor coordinates and types are read with unit stride
+    // instead of gathering whole Scalar4 elements
+    const bool use_soa = m_pdata->hasPositionsSoA();
+    if (use_soa)
+        m_pdata->updatePositionsSoA();
+
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar> h_x(m_pdata->getPositionsX(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar> h_y(m_pdata->getPositionsY(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar> h_z(m_pdata->getPositionsZ(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_type(m_pdata->getTypesSoA(), access_location::host, access_mode::read);
     ArrayHandle<Scalar> h_diameter(m_pdata->getDiameters(), access_location::host, access_mode::read);
     ArrayHandle<Scalar> h_charge(m_pdata->getCharges(), access_location::host, access_mode::read);
 
 
     //force arrays
-    ArrayHandle<Scalar4> h_force(m_force,access_location::host, access_mode::overwrite);
-    ArrayHandle<Scalar>  h_virial(m_virial,access_location::host, access_mode::overwrite);
+    ArrayHandle<Scalar4> h_force(m_force,access_location::host, zero_forces ? access_mode::overwrite : access_mode::readwrite);
+    ArrayHandle<Scalar>  h_virial(m_virial,access_location::host, zero_forces ? access_mode::overwrite : access_mode::readwrite);
 
 
     const BoxDim& box = m_pdata->getGlobalBox();
@@ -388,15 +446,30 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
     bool compute_virial = flags[pdata_flag::pressure_tensor] || flags[pdata_flag::isotropic_virial];
 
     // need to start from a zero force, energy and virial
-    memset((void*)h_force.data,0,sizeof(Scalar4)*m_force.getNumElements());
-    memset((void*)h_virial.data,0,sizeof(Scalar)*m_virial.getNumElements());
+    if (zero_forces)
+        {
+        memset((void*)h_force.data,0,sizeof(Scalar4)*m_force.getNumElements());
+        memset((void*)h_virial.data,0,sizeof(Scalar)*m_virial.getNumElements());
+        }
 
     // for each particle
-    for (int i = 0; i < (int)m_pdata->getN(); i++)
+    for (unsigned int row = 0; row < n_rows; row++)
         {
+        const unsigned int i = rows ? rows[row] : row;
+
         // access the particle's position and type (MEM TRANSFER: 4 scalars)
-        Scalar3 pi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
-        unsigned int typei = __scalar_as_int(h_pos.data[i].w);
+        Scalar3 pi;
+        unsigned int typei;
+        if (use_soa)
+            {
+            pi = make_scalar3(h_x.data[i], h_y.data[i], h_z.data[i]);
+            typei = h_type.data[i];
+            }
+        else
+            {
+            pi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
+            typei = __scalar_as_int(h_pos.data[i].w);
+            }
 
         // sanity check
         assert(typei < m_pdata->getNTypes());
@@ -428,12 +501,20 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
             unsigned int j = h_nlist.data[myHead + k];
             assert(j < m_pdata->getN() + m_pdata->getNGhosts());
 
-            // calculate dr_ji (MEM TRANSFER: 3 scalars / FLOPS: 3)
-            Scalar3 pj = make_scalar3(h_pos.data[j].x, h_pos.data[j].y, h_pos.data[j].z);
+            // calculate dr_ji and access the type of the neighbor particle (MEM TRANSFER: 4 scalars / FLOPS: 3)
+            Scalar3 pj;
+            unsigned int typej;
+            if (use_soa)
+                {
+                pj = make_scalar3(h_x.data[j], h_y.data[j], h_z.data[j]);
+                typej = h_type.data[j];
+                }
+            else
+                {
+                pj = make_scalar3(h_pos.data[j].x, h_pos.data[j].y, h_pos.data[j].z);
+                typej = __scalar_as_int(h_pos.data[j].w);
+                }
             Scalar3 dx = pi - pj;
-
-            // access the type of the neighbor particle (MEM TRANSFER: 1 scalar)
-            unsigned int typej = __scalar_as_int(h_pos.data[j].w);
             assert(typej < m_pdata->getNTypes());
 
             // access diameter and charge (if needed)
@@ -563,8 +644,40 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
             }
         }
 
+    }
+
+#ifdef ENABLE_MPI
+/*! \param timestep Current time step
+
+    Evaluates the neighbor list rows of the interior particles, which have no ghost neighbors, while the ghost positions
+    are being updated. The boundary rows are added in the following call to computeForces().
+*/
+template< class evaluator >
+void PotentialPair< evaluator >::preComputeInterior(unsigned int timestep)
+    {
+    m_interior_pending = false;
+
+    // the interior classification is only maintained for neighbor lists built on the host
+    if (m_exec_conf->isCUDAEnabled())
+        return;
+
+    // the classification becomes available with the next neighbor list build
+    m_nlist->requestInteriorList();
+    if (! m_nlist->hasValidInteriorList(timestep))
+        return;
+
+    if (m_prof) m_prof->push(m_prof_name);
+
+    const std::vector<unsigned int>& interior = m_nlist->getInteriorList();
+    computeParticleForces(interior.size() ? &interior.front() : NULL, interior.size(), true);
+
     if (m_prof) m_prof->pop();
+
+    m_interior_pending = true;
+    m_interior_tstep = timestep;
+    m_interior_nlist_updates = m_nlist->getNumUpdates();
     }
+#endif
 
 #ifdef ENABLE_MPI
 /*! \param timestep Current time step
@@ -63,6 +63,9 @@ class PotentialPairDPDThermo : public PotentialPair<evaluator>
         #ifdef ENABLE_MPI
         //! Get ghost particle fields requested by this pair potential
         virtual CommFlags getRequestedCommFlags(unsigned int timestep);
+
+        //! The thermostat forces are evaluated in a single pass in computeForces()
+        virtual void preComputeInterior(unsigned int timestep) { }
         #endif
 
     protected:
@@ -9,6 +9,7 @@
 #include <stdexcept>
 #include <memory>
 #include <fstream>
+#include <vector>
 
 #include "hoomd/HOOMDMath.h"
 #include "hoomd/Index1D.h"
@@ -29,6 +30,10 @@
 
 #include <hoomd/extern/pybind/include/pybind11/pybind11.h>
 
+#ifdef ENABLE_TBB
+#include <tbb/tbb.h>
+#endif
+
 //! Template class for computing three-body potentials
 /*! <b>Overview:</b>
     PotentialTersoff computes standard three-body potentials and forces between all particles in the
@@ -62,6 +67,12 @@
     potential evaluator class passed in. See the appropriate documentation for the evaluator for the definition of each
     element of the parameters.
 
+    On the CPU, the neighbors of each particle are first copied into a small cache grouped by type, together with
+    their minimum image separation. The inner loops over k then visit whole type groups and skip the types that do
+    not interact with particle i, without re-reading the neighbor list or re-applying periodic boundaries. With TBB,
+    particles are processed in parallel and the forces on j and k are scattered into per-thread buffers that are
+    summed at the end.
+
     For profiling and logging, PotentialTersoff needs to know the name of the potential. For now, that will be queried from
     the evaluator. Perhaps in the future we could allow users to change that so multiple pair potentials could be logged
     independently.
@@ -108,9 +119,42 @@ class PotentialTersoff : public ForceCompute
         std::string m_prof_name;                    //!< Cached profiler name
         std::string m_log_name;                     //!< Cached log name
 
+        //! Neighbors of a single particle, grouped by type
+        struct neighbor_cache
+            {
+            std::vector<unsigned int> type_head; //!< Offset of the first neighbor of each type (ntypes+1 entries)
+            std::vector<unsigned int> idx;       //!< Particle index of the neighbor
+            std::vector<Scalar3> dx;             //!< Minimum image separation r_i - r_neighbor
+            std::vector<Scalar> rsq;             //!< Squared separation
+            std::vector<Scalar> phi_ab;          //!< Per-type sum for per-particle energies
+            };
+
+        #ifdef ENABLE_TBB
+        //! Per-thread force and virial contributions, all zero outside of computeForces()
+        tbb::enumerable_thread_specific< std::vector<Scalar4> > m_force_bufs;
+        tbb::enumerable_thread_specific< std::vector<Scalar> > m_virial_bufs; //!< Per-thread virial, 6 x N+Nghost
+        tbb::enumerable_thread_specific< neighbor_cache > m_caches;          //!< Per-thread neighbor caches
+        #endif
+
         //! Actually compute the forces
         virtual void computeForces(unsigned int timestep);
 
+        //! Compute the contributions of all triplets centered on particle i
+        void computeParticle(unsigned int i,
+                             neighbor_cache& cache,
+                             Scalar4 *force,
+                             Scalar *virial,
+                             unsigned int virial_pitch,
+                             bool compute_virial,
+                             const Scalar4 *h_pos,
+                             const unsigned int *h_n_neigh,
+                             const unsigned int *h_nlist,
+                             const unsigned int *h_head_list,
+                             const Scalar *h_rcutsq,
+                             const param_type *h_params,
+                             const std::vector<char>& interactive,
+                             const BoxDim& box);
+
         //! Method to be called when number of types changes
         virtual void slotNumTypesChange()
             {
@@ -311,113 +355,239 @@ void PotentialTersoff< evaluator >::computeForces(unsigned int timestep)
     memset(h_virial.data, 0, sizeof(Scalar)*6*m_virial_pitch);
 
     unsigned int ntypes = m_pdata->getNTypes();
+    const unsigned int N = m_pdata->getN();
 
-    // for each particle
-    for (int i = 0; i < (int)m_pdata->getN(); i++)
-        {
-        // access the particle's position and type (MEM TRANSFER: 4 scalars)
-        Scalar3 posi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
-        unsigned int typei = __scalar_as_int(h_pos.data[i].w);
-        const unsigned int head_i = h_head_list.data[i];
-        // sanity check
-        assert(typei < m_pdata->getNTypes());
-
-        // initialize current force and potential energy of particle i to 0
-        Scalar3 fi = make_scalar3(0.0, 0.0, 0.0);
-        Scalar pei = 0.0;
-
-        Scalar viriali_xx(0.0);
-        Scalar viriali_xy(0.0);
-        Scalar viriali_xz(0.0);
-        Scalar viriali_yy(0.0);
-        Scalar viriali_yz(0.0);
-        Scalar viriali_zz(0.0);
-
-        Scalar phi_ab[ntypes];
-
-        // reset phi
+    // whether a type pair interacts depends on the parameters only, so evaluate it once per type pair
+    std::vector<char> interactive(m_typpair_idx.getNumElements());
+    for (unsigned int typ_a = 0; typ_a < ntypes; ++typ_a)
         for (unsigned int typ_b = 0; typ_b < ntypes; ++typ_b)
             {
-            phi_ab[typ_b] = Scalar(0.0);
+            unsigned int typpair_idx = m_typpair_idx(typ_a, typ_b);
+            evaluator eval(Scalar(0.0), h_rcutsq.data[typpair_idx], h_params.data[typpair_idx]);
+            interactive[typpair_idx] = eval.areInteractive();
             }
 
-        // all neighbors of this particle
-        const unsigned int size = (unsigned int)h_n_neigh.data[i];
-        if (evaluator::hasPerParticleEnergy())
+    #ifdef ENABLE_TBB
+    const unsigned int nptl = N + m_pdata->getNGhosts();
+
+    // forces on j and k are scattered to arbitrary particles, accumulate them per thread. The buffers are kept
+    // between calls, they only grow and are cleared while they are summed up
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, N),
+        [&](const tbb::blocked_range<unsigned int>& r)
+        {
+        std::vector<Scalar4>& force_buf = m_force_bufs.local();
+        std::vector<Scalar>& virial_buf = m_virial_bufs.local();
+        neighbor_cache& cache = m_caches.local();
+
+        if (force_buf.size() < nptl)
+            force_buf.resize(nptl, make_scalar4(0.0, 0.0, 0.0, 0.0));
+        if (compute_virial && virial_buf.size() < 6*nptl)
+            virial_buf.resize(6*nptl, Scalar(0.0));
+
+        for (unsigned int i = r.begin(); i != r.end(); ++i)
+            computeParticle(i, cache, force_buf.data(), virial_buf.data(), nptl, compute_virial,
+                h_pos.data, h_n_neigh.data, h_nlist.data, h_head_list.data, h_rcutsq.data, h_params.data,
+                interactive, box);
+        });
+
+    // sum up the per-thread buffers
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, nptl),
+        [&](const tbb::blocked_range<unsigned int>& r)
+        {
+        for (auto buf = m_force_bufs.begin(); buf != m_force_bufs.end(); ++buf)
             {
-            for (unsigned int j = 0; j < size; j++)
+            // threads that were not used in this call may have smaller buffers, which are zero
+            if (buf->size() < nptl)
+                continue;
+
+            for (unsigned int i = r.begin(); i != r.end(); ++i)
                 {
-                // access the index of neighbor j (MEM TRANSFER: 1 scalar)
-                unsigned int jj = h_nlist.data[head_i + j];
-                assert(jj < m_pdata->getN() + m_pdata->getNGhosts());
+                Scalar4& f = (*buf)[i];
+                h_force.data[i].x += f.x;
+                h_force.data[i].y += f.y;
+                h_force.data[i].z += f.z;
+                h_force.data[i].w += f.w;
+                f = make_scalar4(0.0, 0.0, 0.0, 0.0);
+                }
+            }
 
-                // access the position and type of particle j
-                Scalar3 posj = make_scalar3(h_pos.data[jj].x, h_pos.data[jj].y, h_pos.data[jj].z);
-                unsigned int typej = __scalar_as_int(h_pos.data[jj].w);
-                assert(typej < m_pdata->getNTypes());
+        if (compute_virial)
+            {
+            for (auto buf = m_virial_bufs.begin(); buf != m_virial_bufs.end(); ++buf)
+                {
+                if (buf->size() < 6*nptl)
+                    continue;
 
-                // calculate dr_ij (MEM TRANSFER: 3 scalars / FLOPS: 3)
-                Scalar3 dxij = posi - posj;
+                for (unsigned int l = 0; l < 6; ++l)
+                    for (unsigned int i = r.begin(); i != r.end(); ++i)
+                        {
+                        h_virial.data[l*m_virial_pitch+i] += (*buf)[l*nptl+i];
+                        (*buf)[l*nptl+i] = Scalar(0.0);
+                        }
+                }
+            }
+        });
+    #else
+    neighbor_cache cache;
 
-                // apply periodic boundary conditions
-                dxij = box.minImage(dxij);
+    // for each particle
+    for (unsigned int i = 0; i < N; i++)
+        computeParticle(i, cache, h_force.data, h_virial.data, m_virial_pitch, compute_virial,
+            h_pos.data, h_n_neigh.data, h_nlist.data, h_head_list.data, h_rcutsq.data, h_params.data,
+            interactive, box);
+    #endif
 
-                // compute rij_sq (FLOPS: 5)
-                Scalar rij_sq = dot(dxij, dxij);
+    if (m_prof) m_prof->pop();
+    }
 
-                // get parameters for this type pair
-                unsigned int typpair_idx = m_typpair_idx(typei, typej);
-                param_type param = h_params.data[typpair_idx];
-                Scalar rcutsq = h_rcutsq.data[typpair_idx];
+/*! \param i Index of the central particle
+    \param cache Scratch space for the neighbors of i
+    \param force Force array to accumulate into, with N+Nghosts elements
+    \param virial Virial array to accumulate into
+    \param virial_pitch Pitch of \a virial
+    \param compute_virial True if the virial is needed
+    \param h_pos Particle positions and types
+    \param h_n_neigh Number of neighbors per particle
+    \param h_nlist Full neighbor list
+    \param h_head_list Offsets into the neighbor list
+    \param h_rcutsq Cutoff radius squared per type pair
+    \param h_params Parameters per type pair
+    \param interactive Whether a type pair interacts
+    \param box Local simulation box
+
+    Forces on i are accumulated locally and added once; forces on the neighbors j and k are added directly to
+    \a force and \a virial, which therefore must not be shared between threads.
+*/
+template< class evaluator >
+void PotentialTersoff< evaluator >::computeParticle(unsigned int i,
+                                                    neighbor_cache& cache,
+                                                    Scalar4 *force,
+                                                    Scalar *virial,
+                                                    unsigned int virial_pitch,
+                                                    bool compute_virial,
+                                                    const Scalar4 *h_pos,
+                                                    const unsigned int *h_n_neigh,
+                                                    const unsigned int *h_nlist,
+                                                    const unsigned int *h_head_list,
+                                                    const Scalar *h_rcutsq,
+                                                    const param_type *h_params,
+                                                    const std::vector<char>& interactive,
+                                                    const BoxDim& box)
+    {
+    unsigned int ntypes = m_typpair_idx.getW();
 
-                // evaluate the scalar per-neighbor contribution
-                evaluator eval(rij_sq, rcutsq, param);
-                eval.evalPhi(phi_ab[typej]);
-                }
+    // access the particle's position and type (MEM TRANSFER: 4 scalars)
+    Scalar3 posi = make_scalar3(h_pos[i].x, h_pos[i].y, h_pos[i].z);
+    unsigned int typei = __scalar_as_int(h_pos[i].w);
+    const unsigned int head_i = h_head_list[i];
+    // sanity check
+    assert(typei < ntypes);
+
+    // all neighbors of this particle
+    const unsigned int size = (unsigned int)h_n_neigh[i];
+
+    // group the neighbors by type with a counting sort, keeping their order within a type
+    cache.type_head.assign(ntypes+1, 0);
+    for (unsigned int j = 0; j < size; j++)
+        {
+        unsigned int jj = h_nlist[head_i + j];
+        assert(jj < m_pdata->getN() + m_pdata->getNGhosts());
+        cache.type_head[__scalar_as_int(h_pos[jj].w)+1]++;
+        }
+    for (unsigned int typ_b = 0; typ_b < ntypes; ++typ_b)
+        cache.type_head[typ_b+1] += cache.type_head[typ_b];
+
+    cache.idx.resize(size);
+    cache.dx.resize(size);
+    cache.rsq.resize(size);
+    cache.phi_ab.assign(ntypes, Scalar(0.0));
+
+    // use the head of each type range as insertion point, then shift the heads back
+    for (unsigned int j = 0; j < size; j++)
+        {
+        // access the index of neighbor j (MEM TRANSFER: 1 scalar)
+        unsigned int jj = h_nlist[head_i + j];
+
+        // access the position and type of particle j
+        Scalar3 posj = make_scalar3(h_pos[jj].x, h_pos[jj].y, h_pos[jj].z);
+        unsigned int typej = __scalar_as_int(h_pos[jj].w);
+        assert(typej < ntypes);
+
+        // calculate dr_ij (MEM TRANSFER: 3 scalars / FLOPS: 3)
+        Scalar3 dxij = posi - posj;
 
-            // self-energy
-            for (unsigned int typ_b = 0; typ_b < ntypes; ++typ_b)
+        // apply periodic boundary conditions
+        dxij = box.minImage(dxij);
+
+        unsigned int pos = cache.type_head[typej]++;
+        cache.idx[pos] = jj;
+        cache.dx[pos] = dxij;
+        // compute rij_sq (FLOPS: 5)
+        cache.rsq[pos] = dot(dxij, dxij);
+        }
+    for (unsigned int typ_b = ntypes; typ_b > 0; --typ_b)
+        cache.type_head[typ_b] = cache.type_head[typ_b-1];
+    cache.type_head[0] = 0;
+
+    // initialize current force and potential energy of particle i to 0
+    Scalar3 fi = make_scalar3(0.0, 0.0, 0.0);
+    Scalar pei = 0.0;
+
+    Scalar viriali_xx(0.0);
+    Scalar viriali_xy(0.0);
+    Scalar viriali_xz(0.0);
+    Scalar viriali_yy(0.0);
+    Scalar viriali_yz(0.0);
+    Scalar viriali_zz(0.0);
+
+    if (evaluator::hasPerParticleEnergy())
+        {
+        for (unsigned int typej = 0; typej < ntypes; ++typej)
+            {
+            // get parameters for this type pair
+            unsigned int typpair_idx = m_typpair_idx(typei, typej);
+            param_type param = h_params[typpair_idx];
+            Scalar rcutsq = h_rcutsq[typpair_idx];
+
+            for (unsigned int j = cache.type_head[typej]; j < cache.type_head[typej+1]; j++)
                 {
-                unsigned int typpair_idx = m_typpair_idx(typei,typ_b);
-                param_type param = h_params.data[typpair_idx];
-                Scalar rcutsq = h_rcutsq.data[typpair_idx];
-                evaluator eval(Scalar(0.0), rcutsq, param);
-                Scalar energy(0.0);
-                eval.evalSelfEnergy(energy, phi_ab[typ_b]);
-                pei += energy;
+                // evaluate the scalar per-neighbor contribution
+                evaluator eval(cache.rsq[j], rcutsq, param);
+                eval.evalPhi(cache.phi_ab[typej]);
                 }
             }
 
-        // loop over all of the neighbors of this particle
-        for (unsigned int j = 0; j < size; j++)
+        // self-energy
+        for (unsigned int typ_b = 0; typ_b < ntypes; ++typ_b)
             {
-            // access the index of neighbor j (MEM TRANSFER: 1 scalar)
-            unsigned int jj = h_nlist.data[head_i + j];
-            assert(jj < m_pdata->getN() + m_pdata->getNGhosts());
+            unsigned int typpair_idx = m_typpair_idx(typei,typ_b);
+            param_type param = h_params[typpair_idx];
+            Scalar rcutsq = h_rcutsq[typpair_idx];
+            evaluator eval(Scalar(0.0), rcutsq, param);
+            Scalar energy(0.0);
+            eval.evalSelfEnergy(energy, cache.phi_ab[typ_b]);
+            pei += energy;
+            }
+        }
 
-            // access the position and type of particle j
-            Scalar3 posj = make_scalar3(h_pos.data[jj].x, h_pos.data[jj].y, h_pos.data[jj].z);
-            unsigned int typej = __scalar_as_int(h_pos.data[jj].w);
-            assert(typej < m_pdata->getNTypes());
+    // loop over all of the neighbors of this particle, one type at a time
+    for (unsigned int typej = 0; typej < ntypes; ++typej)
+        {
+        // get parameters for this type pair
+        unsigned int typpair_idx = m_typpair_idx(typei, typej);
+        param_type param = h_params[typpair_idx];
+        Scalar rcutsq = h_rcutsq[typpair_idx];
+
+        for (unsigned int j = cache.type_head[typej]; j < cache.type_head[typej+1]; j++)
+            {
+            unsigned int jj = cache.idx[j];
+            Scalar3 dxij = cache.dx[j];
+            Scalar rij_sq = cache.rsq[j];
 
             // initialize the current force and potential energy of particle j to 0
             Scalar3 fj = make_scalar3(0.0, 0.0, 0.0);
             Scalar pej = 0.0;
 
-            // calculate dr_ij (MEM TRANSFER: 3 scalars / FLOPS: 3)
-            Scalar3 dxij = posi - posj;
-
-            // apply periodic boundary conditions
-            dxij = box.minImage(dxij);
-
-            // compute rij_sq (FLOPS: 5)
-            Scalar rij_sq = dot(dxij, dxij);
-
-            // get parameters for this type pair
-            unsigned int typpair_idx = m_typpair_idx(typei, typej);
-            param_type param = h_params.data[typpair_idx];
-            Scalar rcutsq = h_rcutsq.data[typpair_idx];
-
             // evaluate the base repulsive and attractive terms
             Scalar fR = 0.0;
             Scalar fA = 0.0;
@@ -437,34 +607,19 @@ void PotentialTersoff< evaluator >::computeForces(unsigned int timestep)
                 Scalar chi = 0.0;
                 if (evaluator::needsChi())
                     {
-                    for (unsigned int k = 0; k < size; k++)
+                    for (unsigned int typek = 0; typek < ntypes; ++typek)
                         {
-                        // access the index of neighbor k
-                        unsigned int kk = h_nlist.data[head_i + k];
-                        assert(kk < m_pdata->getN());
-
-                        // access the position and type of neighbor k
-                        Scalar3 posk = make_scalar3(h_pos.data[kk].x, h_pos.data[kk].y, h_pos.data[kk].z);
-                        unsigned int typek = __scalar_as_int(h_pos.data[kk].w);
-                        assert(typek < m_pdata->getNTypes());
-
-                        // access the type pair parameters for i and k
-                        typpair_idx = m_typpair_idx(typei, typek);
-                        param_type temp_param = h_params.data[typpair_idx];
+                        // skip all neighbors of a type that does not interact with i
+                        if (! interactive[m_typpair_idx(typei, typek)])
+                            continue;
 
-                        evaluator temp_eval(rij_sq, rcutsq, temp_param);
-                        bool temp_evaluated = temp_eval.areInteractive();
-
-                        if (kk != jj && temp_evaluated)
+                        for (unsigned int k = cache.type_head[typek]; k < cache.type_head[typek+1]; k++)
                             {
-                            // compute drik
-                            Scalar3 dxik = posi - posk;
-
-                            // apply periodic boundary conditions
-                            dxik = box.minImage(dxik);
+                            if (k == j)
+                                continue;
 
-                            // compute rik_sq
-                            Scalar rik_sq = dot(dxik, dxik);
+                            Scalar3 dxik = cache.dx[k];
+                            Scalar rik_sq = cache.rsq[k];
 
                             // compute the bond angle (if needed)
                             Scalar cos_th = Scalar(0.0);
@@ -485,7 +640,7 @@ void PotentialTersoff< evaluator >::computeForces(unsigned int timestep)
                 Scalar force_divr = Scalar(0.0);
                 Scalar potential_eng = Scalar(0.0);
                 Scalar bij = Scalar(0.0);
-                eval.evalForceij(fR, fA, chi, phi_ab[typej], bij, force_divr, potential_eng);
+                eval.evalForceij(fR, fA, chi, cache.phi_ab[typej], bij, force_divr, potential_eng);
 
                 // add this force to particle i
                 fi += force_divr * dxij;
@@ -522,38 +677,24 @@ void PotentialTersoff< evaluator >::computeForces(unsigned int timestep)
                 if (evaluator::hasIkForce())
                     {
                     // evaluate the force from the ik interactions
-                    for (unsigned int k = 0; k < size; k++)
+                    for (unsigned int typek = 0; typek < ntypes; ++typek)
                         {
-                        // access the index of neighbor k
-                        unsigned int kk = h_nlist.data[head_i + k];
-                        assert(kk < m_pdata->getN());
+                        // skip all neighbors of a type that does not interact with i
+                        if (! interactive[m_typpair_idx(typei, typek)])
+                            continue;
 
-                        // access the position and type of neighbor k
-                        Scalar3 posk = make_scalar3(h_pos.data[kk].x, h_pos.data[kk].y, h_pos.data[kk].z);
-                        unsigned int typek = __scalar_as_int(h_pos.data[kk].w);
-                        assert(typek < m_pdata->getNTypes());
-
-                        // access the type pair parameters for i and k
-                        typpair_idx = m_typpair_idx(typei, typek);
-                        param_type temp_param = h_params.data[typpair_idx];
+                        for (unsigned int k = cache.type_head[typek]; k < cache.type_head[typek+1]; k++)
+                            {
+                            if (k == j)
+                                continue;
 
-                        evaluator temp_eval(rij_sq, rcutsq, temp_param);
-                        bool temp_evaluated = temp_eval.areInteractive();
+                            unsigned int kk = cache.idx[k];
+                            Scalar3 dxik = cache.dx[k];
+                            Scalar rik_sq = cache.rsq[k];
 
-                        if (kk != jj && temp_evaluated)
-                            {
                             // create variable for the force on k
                             Scalar3 fk = make_scalar3(0.0, 0.0, 0.0);
 
-                            // compute dr_ik
-                            Scalar3 dxik = posi - posk;
-
-                            // apply periodic boundary conditions
-                            dxik = box.minImage(dxik);
-
-                            // compute rik_sq
-                            Scalar rik_sq = dot(dxik, dxik);
-
                             // compute the bond angle (if needed)
                             Scalar cos_th = Scalar(0.0);
                             if (evaluator::needsAngle())
@@ -613,20 +754,20 @@ void PotentialTersoff< evaluator >::computeForces(unsigned int timestep)
 
                             // increment the force for particle k
                             unsigned int mem_idx = kk;
-                            h_force.data[mem_idx].x += fk.x;
-                            h_force.data[mem_idx].y += fk.y;
-                            h_force.data[mem_idx].z += fk.z;
+                            force[mem_idx].x += fk.x;
+                            force[mem_idx].y += fk.y;
+                            force[mem_idx].z += fk.z;
 
                             if (compute_virial)
                                 {
                                 Scalar force_div2r_ij = Scalar(0.5)*force_divr_ij.z;
                                 Scalar force_div2r_ik = Scalar(0.5)*force_divr_ik.z;
-                                h_virial.data[0*m_virial_pitch+mem_idx] += force_div2r_ij*dxij.x*dxij.x + force_div2r_ik*dxik.x*dxik.x;
-                                h_virial.data[1*m_virial_pitch+mem_idx] += force_div2r_ij*dxij.x*dxij.y + force_div2r_ik*dxik.x*dxik.y;
-                                h_virial.data[2*m_virial_pitch+mem_idx] += force_div2r_ij*dxij.x*dxij.z + force_div2r_ik*dxik.x*dxik.z;
-                                h_virial.data[3*m_virial_pitch+mem_idx] += force_div2r_ij*dxij.y*dxij.y + force_div2r_ik*dxik.y*dxik.y;
-                                h_virial.data[4*m_virial_pitch+mem_idx] += force_div2r_ij*dxij.y*dxij.z + force_div2r_ik*dxik.y*dxik.z;
-                                h_virial.data[5*m_virial_pitch+mem_idx] += force_div2r_ij*dxij.z*dxij.z + force_div2r_ik*dxik.z*dxik.z;
+                                virial[0*virial_pitch+mem_idx] += force_div2r_ij*dxij.x*dxij.x + force_div2r_ik*dxik.x*dxik.x;
+                                virial[1*virial_pitch+mem_idx] += force_div2r_ij*dxij.x*dxij.y + force_div2r_ik*dxik.x*dxik.y;
+                                virial[2*virial_pitch+mem_idx] += force_div2r_ij*dxij.x*dxij.z + force_div2r_ik*dxik.x*dxik.z;
+                                virial[3*virial_pitch+mem_idx] += force_div2r_ij*dxij.y*dxij.y + force_div2r_ik*dxik.y*dxik.y;
+                                virial[4*virial_pitch+mem_idx] += force_div2r_ij*dxij.y*dxij.z + force_div2r_ik*dxik.y*dxik.z;
+                                virial[5*virial_pitch+mem_idx] += force_div2r_ij*dxij.z*dxij.z + force_div2r_ik*dxik.z*dxik.z;
                                 }
                             }
                         }
@@ -634,40 +775,39 @@ void PotentialTersoff< evaluator >::computeForces(unsigned int timestep)
                 }
             // increment the force and potential energy for particle j
             unsigned int mem_idx = jj;
-            h_force.data[mem_idx].x += fj.x;
-            h_force.data[mem_idx].y += fj.y;
-            h_force.data[mem_idx].z += fj.z;
-            h_force.data[mem_idx].w += pej;
+            force[mem_idx].x += fj.x;
+            force[mem_idx].y += fj.y;
+            force[mem_idx].z += fj.z;
+            force[mem_idx].w += pej;
 
             if (compute_virial)
                 {
-                h_virial.data[0*m_virial_pitch+mem_idx] += virialj_xx;
-                h_virial.data[1*m_virial_pitch+mem_idx] += virialj_xy;
-                h_virial.data[2*m_virial_pitch+mem_idx] += virialj_xz;
-                h_virial.data[3*m_virial_pitch+mem_idx] += virialj_yy;
-                h_virial.data[4*m_virial_pitch+mem_idx] += virialj_yz;
-                h_virial.data[5*m_virial_pitch+mem_idx] += virialj_zz;
+                virial[0*virial_pitch+mem_idx] += virialj_xx;
+                virial[1*virial_pitch+mem_idx] += virialj_xy;
+                virial[2*virial_pitch+mem_idx] += virialj_xz;
+                virial[3*virial_pitch+mem_idx] += virialj_yy;
+                virial[4*virial_pitch+mem_idx] += virialj_yz;
+                virial[5*virial_pitch+mem_idx] += virialj_zz;
                 }
             }
-        // finally, increment the force and potential energy for particle i
-        unsigned int mem_idx = i;
-        h_force.data[mem_idx].x += fi.x;
-        h_force.data[mem_idx].y += fi.y;
-        h_force.data[mem_idx].z += fi.z;
-        h_force.data[mem_idx].w += pei;
-
-        if (compute_virial)
-            {
-            h_virial.data[0*m_virial_pitch+mem_idx] += viriali_xx;
-            h_virial.data[1*m_virial_pitch+mem_idx] += viriali_xy;
-            h_virial.data[2*m_virial_pitch+mem_idx] += viriali_xz;
-            h_virial.data[3*m_virial_pitch+mem_idx] += viriali_yy;
-            h_virial.data[4*m_virial_pitch+mem_idx] += viriali_yz;
-            h_virial.data[5*m_virial_pitch+mem_idx] += viriali_zz;
-            }
         }
 
-    if (m_prof) m_prof->pop();
+    // finally, increment the force and potential energy for particle i
+    unsigned int mem_idx = i;
+    force[mem_idx].x += fi.x;
+    force[mem_idx].y += fi.y;
+    force[mem_idx].z += fi.z;
+    force[mem_idx].w += pei;
+
+    if (compute_virial)
+        {
+        virial[0*virial_pitch+mem_idx] += viriali_xx;
+        virial[1*virial_pitch+mem_idx] += viriali_xy;
+        virial[2*virial_pitch+mem_idx] += viriali_xz;
+        virial[3*virial_pitch+mem_idx] += viriali_yy;
+        virial[4*virial_pitch+mem_idx] += viriali_yz;
+        virial[5*virial_pitch+mem_idx] += viriali_zz;
+        }
     }
 
 #ifdef ENABLE_MPI
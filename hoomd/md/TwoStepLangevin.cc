@@ -99,6 +99,12 @@ void TwoStepLangevin::integrateStepOne(unsigned int timestep)
 
     ArrayHandle<Scalar3> h_gamma_r(m_gamma_r, access_location::host, access_mode::read);
 
+    // keep the structure-of-arrays mirror up to date, see updatesPositionsSoA()
+    const bool use_soa = m_pdata->hasPositionsSoA();
+    ArrayHandle<Scalar> h_x(m_pdata->getPositionsX(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar> h_y(m_pdata->getPositionsY(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar> h_z(m_pdata->getPositionsZ(), access_location::host, access_mode::readwrite);
+
     const BoxDim& box = m_pdata->getBox();
 
     // perform the first half step of velocity verlet
@@ -118,6 +124,13 @@ void TwoStepLangevin::integrateStepOne(unsigned int timestep)
         // particles may have been moved slightly outside the box by the above steps, wrap them back into place
         box.wrap(h_pos.data[j], h_image.data[j]);
 
+        if (use_soa)
+            {
+            h_x.data[j] = h_pos.data[j].x;
+            h_y.data[j] = h_pos.data[j].y;
+            h_z.data[j] = h_pos.data[j].z;
+            }
+
         h_vel.data[j].x += Scalar(1.0/2.0)*h_accel.data[j].x*m_deltaT;
         h_vel.data[j].y += Scalar(1.0/2.0)*h_accel.data[j].y*m_deltaT;
         h_vel.data[j].z += Scalar(1.0/2.0)*h_accel.data[j].z*m_deltaT;
@@ -62,6 +62,12 @@ class PYBIND11_EXPORT TwoStepLangevin : public TwoStepLangevinBase
         //! Performs the second step of the integration
         virtual void integrateStepTwo(unsigned int timestep);
 
+        //! The first step writes the structure-of-arrays mirror of the positions
+        virtual bool updatesPositionsSoA() const
+            {
+            return true;
+            }
+
     protected:
         Scalar m_reservoir_energy;         //!< The energy of the reservoir the system is coupled to.
         Scalar m_extra_energy_overdeltaT;  //!< An energy packet that isn't added until the next time step
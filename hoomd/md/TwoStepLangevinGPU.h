@@ -46,6 +46,12 @@ class PYBIND11_EXPORT TwoStepLangevinGPU : public TwoStepLangevin
         //! Performs the second step of the integration
         virtual void integrateStepTwo(unsigned int timestep);
 
+        //! The GPU kernel only writes the packed positions
+        virtual bool updatesPositionsSoA() const
+            {
+            return false;
+            }
+
         //! Set autotuner parameters
         /*! \param enable Enable/disable autotuning
             \param period period (approximate) in time steps when returning occurs
@@ -124,10 +124,23 @@ void TwoStepNVE::integrateStepOne(unsigned int timestep)
 
     ArrayHandle<int3> h_image(m_pdata->getImages(), access_location::host, access_mode::readwrite);
 
+    // keep the structure-of-arrays mirror up to date, see updatesPositionsSoA()
+    const bool use_soa = m_pdata->hasPositionsSoA();
+    ArrayHandle<Scalar> h_x(m_pdata->getPositionsX(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar> h_y(m_pdata->getPositionsY(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar> h_z(m_pdata->getPositionsZ(), access_location::host, access_mode::readwrite);
+
     for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
         {
         unsigned int j = m_group->getMemberIndex(group_idx);
         box.wrap(h_pos.data[j], h_image.data[j]);
+
+        if (use_soa)
+            {
+            h_x.data[j] = h_pos.data[j].x;
+            h_y.data[j] = h_pos.data[j].y;
+            h_z.data[j] = h_pos.data[j].z;
+            }
         }
 
     // Integration of angular degrees of freedom using symplectic and
@@ -54,6 +54,12 @@ class PYBIND11_EXPORT TwoStepNVE : public IntegrationMethodTwoStep
         //! Performs the second step of the integration
         virtual void integrateStepTwo(unsigned int timestep);
 
+        //! The first step writes the structure-of-arrays mirror of the positions
+        virtual bool updatesPositionsSoA() const
+            {
+            return true;
+            }
+
     protected:
         bool m_limit;       //!< True if we should limit the distance a particle moves in one step
         Scalar m_limit_val; //!< The maximum distance a particle is to move in one step
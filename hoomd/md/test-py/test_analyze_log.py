@@ -131,6 +131,66 @@ class analyze_log_query_tests (unittest.TestCase):
         hoomd.context.initialize();
 
 
+# test analyze.log_binary
+class analyze_log_binary_tests (unittest.TestCase):
+    def setUp(self):
+        init.create_lattice(lattice.sc(a=1.5),n=[8,8,8]); # must be close enough to interact
+        nl = hoomd.md.nlist.cell()
+        self.pair = hoomd.md.pair.lj(r_cut=2.5, nlist = nl)
+        self.pair.pair_coeff.set('A', 'A', epsilon=1.0, sigma=1.0)
+        hoomd.md.integrate.mode_standard(dt=0.005);
+        hoomd.md.integrate.langevin(hoomd.group.all(), seed=1, kT=1.0);
+
+        if hoomd.comm.get_rank() == 0:
+            self.tmp_file = tempfile.mkstemp(suffix='.test.log')[1];
+            self.tmp_bin = tempfile.mkstemp(suffix='.test.bin')[1];
+        else:
+            self.tmp_file = "invalid";
+            self.tmp_bin = "invalid";
+
+    # tests that the converted binary log is identical to the text log
+    def test_convert(self):
+        quantities = ['potential_energy', 'kinetic_energy', 'pressure_xy'];
+        hoomd.analyze.log(quantities = quantities, period = 10, filename=self.tmp_file, overwrite=True);
+        log = hoomd.analyze.log_binary(quantities = quantities, period = 10, filename=self.tmp_bin, overwrite=True, block_rows=3);
+        hoomd.run(101);
+        self.assertNotEqual(log.query('potential_energy'), 0);
+
+        if hoomd.comm.get_rank() == 0:
+            columns, timesteps, values = hoomd.analyze.read_log_binary(self.tmp_bin)[0];
+            self.assertEqual(columns, quantities);
+            numpy.testing.assert_array_equal(timesteps, numpy.arange(0, 101, 10));
+
+            hoomd.analyze.log_binary_to_text(self.tmp_bin, self.tmp_bin + '.txt');
+            with open(self.tmp_file) as f:
+                expected = f.read();
+            with open(self.tmp_bin + '.txt') as f:
+                self.assertEqual(f.read(), expected);
+            os.remove(self.tmp_bin + '.txt');
+
+    # tests changing the logged quantities
+    def test_set_params(self):
+        log = hoomd.analyze.log_binary(quantities = ['potential_energy'], period = 10, filename=self.tmp_bin, overwrite=True);
+        hoomd.run(20);
+        log.set_params(quantities = ['kinetic_energy', 'temperature'], block_rows=1);
+        hoomd.run(20);
+
+        if hoomd.comm.get_rank() == 0:
+            segments = hoomd.analyze.read_log_binary(self.tmp_bin);
+            self.assertEqual(len(segments), 2);
+            self.assertEqual(segments[0][0], ['potential_energy']);
+            self.assertEqual(len(segments[0][1]), 2);
+            self.assertEqual(segments[1][0], ['kinetic_energy', 'temperature']);
+            self.assertEqual(len(segments[1][1]), 2);
+
+    def tearDown(self):
+        self.pair = None;
+        hoomd.context.initialize();
+        if (hoomd.comm.get_rank()==0):
+            os.remove(self.tmp_file);
+            os.remove(self.tmp_bin);
+
+
 try:
     import h5py
 except ImportError:
@@ -70,6 +70,29 @@ class nlist_cell_tests (unittest.TestCase):
         self.assertAlmostEqual(self.nl.r_cut.get_pair('A','A'), 5.0)
         self.assertAlmostEqual(nl2.r_cut.get_pair('A','A'), 4.0)
 
+    # test that the ghost extrapolation is opt-in and must fit into the buffer
+    def test_ghost_update_period(self):
+        if comm.get_num_ranks() == 1 or context.exec_conf.isCUDAEnabled():
+            return
+
+        self.nl.set_params(r_buff = 0.4)
+        lj = md.pair.lj(r_cut = 2.5, nlist = self.nl)
+        lj.pair_coeff.set('A','A', epsilon = 1.0, sigma = 1.0)
+        md.integrate.mode_standard(dt=0.005)
+        md.integrate.nve(group=group.all())
+
+        with self.assertRaises(RuntimeError):
+            comm.set_ghost_update_period(4, max_drift=0.05)
+
+        with self.assertRaises(RuntimeError):
+            comm.set_ghost_update_period(4, max_drift=0.4, approximate=True)
+
+        comm.set_ghost_update_period(4, max_drift=0.05, approximate=True)
+        run(10)
+
+        comm.set_ghost_update_period(1)
+        run(1)
+
     def tearDown(self):
         del self.nl
         context.initialize();
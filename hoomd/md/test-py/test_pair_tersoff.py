@@ -0,0 +1,55 @@
+# -*- coding: iso-8859-1 -*-
+
+from hoomd import *
+from hoomd import md;
+context.initialize()
+import unittest
+import numpy
+
+# md.pair.tersoff
+class pair_tersoff_tests (unittest.TestCase):
+    def setUp(self):
+        print
+        snapshot = lattice.sc(a=1.5).get_snapshot();
+        snapshot.replicate(6,6,6);
+        if comm.get_rank() == 0:
+            numpy.random.seed(12);
+            snapshot.particles.position[:] += numpy.random.uniform(-0.1, 0.1, size=(snapshot.particles.N, 3));
+        self.s = init.read_snapshot(snapshot);
+        self.nl = md.nlist.cell()
+
+    # basic test of creation
+    def test(self):
+        p = md.pair.tersoff(r_cut=2.2, nlist = self.nl);
+        p.pair_coeff.set('A', 'A', cutoff_thickness=0.3, dimer_r=1.8);
+        p.update_coeffs();
+
+    # tests that the threaded force computation gives the same result as a single thread
+    def test_threads(self):
+        p = md.pair.tersoff(r_cut=2.2, nlist = self.nl);
+        p.pair_coeff.set('A', 'A', cutoff_thickness=0.3, dimer_r=1.8, n=1.0, gamma=0.5, lambda3=0.5, c=1.0, d=1.0, m=1.0);
+
+        # request the virial, and keep the particles in place
+        analyze.log(filename=None, quantities=['pressure_xx', 'pressure_xy'], period=1);
+        md.integrate.mode_standard(dt=0.0);
+        md.integrate.nve(group=group.all());
+
+        option.set_num_threads(1);
+        run(1);
+        serial = [(p.forces[i].force, p.forces[i].energy, p.forces[i].virial) for i in range(len(self.s.particles))];
+
+        option.set_num_threads(4);
+        run(1);
+        for i in range(len(self.s.particles)):
+            force, energy, virial = serial[i];
+            numpy.testing.assert_allclose(p.forces[i].force, force, rtol=1e-5, atol=1e-5);
+            self.assertAlmostEqual(p.forces[i].energy, energy, places=5);
+            numpy.testing.assert_allclose(p.forces[i].virial, virial, rtol=1e-5, atol=1e-5);
+
+    def tearDown(self):
+        del self.nl
+        context.initialize();
+
+
+if __name__ == '__main__':
+    unittest.main(argv = ['test.py', '-v'])
@@ -3120,6 +3120,198 @@ void test_communicator_ghost_fields(communicator_creator comm_creator, std::shar
         }
     }
 
+//! Test extrapolation of ghost positions between ghost updates
+void test_communicator_ghost_extrapolation(communicator_creator comm_creator, std::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // this test needs to be run on eight processors
+    int size;
+    MPI_Comm_size(exec_conf->getHOOMDWorldMPICommunicator(), &size);
+    UP_ASSERT_EQUAL(size,8);
+
+    std::shared_ptr<SystemDefinition> sysdef(new SystemDefinition(9,          // number of particles
+                                                             BoxDim(2.0), // box dimensions
+                                                             1,           // number of particle types
+                                                             0,           // number of bond types
+                                                             0,           // number of angle types
+                                                             0,           // number of dihedral types
+                                                             0,           // number of dihedral types
+                                                             exec_conf));
+
+    std::shared_ptr<ParticleData> pdata(sysdef->getParticleData());
+
+    // place one particle in the middle of every box (outside the ghost layer)
+    pdata->setPosition(0, make_scalar3(-0.5,-0.5,-0.5),false);
+    pdata->setPosition(1, make_scalar3( 0.5,-0.5,-0.5),false);
+    pdata->setPosition(2, make_scalar3(-0.5, 0.5,-0.5),false);
+    pdata->setPosition(3, make_scalar3( 0.5, 0.5,-0.5),false);
+    pdata->setPosition(4, make_scalar3(-0.5,-0.5, 0.5),false);
+    pdata->setPosition(5, make_scalar3( 0.5,-0.5, 0.5),false);
+    pdata->setPosition(6, make_scalar3(-0.5, 0.5, 0.5),false);
+    pdata->setPosition(7, make_scalar3( 0.5, 0.5, 0.5),false);
+
+    // particle 8 in the ghost layer of its +x neighbor, moving away from the boundary
+    pdata->setPosition(8, make_scalar3( -0.05, -0.5, -0.5),false);
+    pdata->setVelocity(8, make_scalar3(-0.1,0.0,0.0));
+
+    // distribute particle data on processors
+    SnapshotParticleData<Scalar> snap(9);
+    pdata->takeSnapshot(snap);
+
+    std::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf,  pdata->getBox().getL()));
+    std::shared_ptr<Communicator> comm = comm_creator(sysdef, decomposition);
+
+    pdata->setDomainDecomposition(decomposition);
+
+    pdata->initializeFromSnapshot(snap);
+
+    ghost_layer_width g(0.1);
+    comm->getGhostLayerWidthRequestSignal().connect<ghost_layer_width, &ghost_layer_width::get>(g);
+    comm->getCommFlagsRequestSignal().connect<comm_flag_request>();
+
+    // up to two extrapolated steps, the fastest particle and the ghosts move 0.01 per step
+    comm->setDeltaT(0.1);
+    comm->setGhostUpdatePeriod(3, 0.2);
+
+    // the ghost layer widened by the maximum drift must fit into the domains
+    UP_ASSERT_EXCEPTION(std::runtime_error, [&]{ comm->setGhostUpdatePeriod(3, 0.5); });
+    UP_ASSERT_EQUAL(comm->getGhostUpdatePeriod(), (unsigned int)3);
+    MY_CHECK_CLOSE(comm->getGhostMaxDrift(), 0.2, tol);
+
+    // exchange ghosts
+    comm->communicate(0);
+
+    // moves particle 8 on its owner and returns the x coordinate of its ghost on rank 1
+    auto step = [&](unsigned int timestep, Scalar x)
+        {
+        pdata->setPosition(8, make_scalar3(x, -0.5, -0.5), false);
+        comm->communicate(timestep);
+
+        if (exec_conf->getRank() != 1)
+            return Scalar(0.0);
+
+        ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_rtag(pdata->getRTags(), access_location::host, access_mode::read);
+        unsigned int rtag = h_rtag.data[8];
+        UP_ASSERT(rtag >= pdata->getN() && rtag < pdata->getN()+pdata->getNGhosts());
+        return h_pos.data[rtag].x;
+        };
+
+    // the ghost is extrapolated with constant velocity
+    Scalar x1 = step(1, -0.06);
+    Scalar x2 = step(2, -0.07);
+
+    // the ghost is updated, so it picks up the deviation from the extrapolation
+    Scalar x3 = step(3, -0.075);
+
+    // and it is extrapolated from the updated position
+    Scalar x4 = step(4, -0.08);
+
+    if (exec_conf->getRank() == 1)
+        {
+        CHECK_CLOSE(x1, -0.06, tol);
+        CHECK_CLOSE(x2, -0.07, tol);
+        CHECK_CLOSE(x3, -0.075, tol);
+        CHECK_CLOSE(x4, -0.085, tol);
+        }
+
+    // the deviation grows by 0.02 per extrapolated step, so a maximum drift of 0.03 allows only one step
+    comm->setGhostUpdatePeriod(3, 0.03);
+    Scalar x5 = step(5, -0.08);
+    Scalar x6 = step(6, -0.082);
+    Scalar x7 = step(7, -0.083);
+
+    if (exec_conf->getRank() == 1)
+        {
+        CHECK_CLOSE(x5, -0.08, tol);
+        CHECK_CLOSE(x6, -0.09, tol);
+        CHECK_CLOSE(x7, -0.083, tol);
+        }
+    }
+
+//! Test particle migration and ghost exchange in a staggered decomposition
+void test_communicator_staggered(communicator_creator comm_creator, std::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // this test needs to be run on eight processors
+    int size;
+    MPI_Comm_size(exec_conf->getHOOMDWorldMPICommunicator(), &size);
+    UP_ASSERT_EQUAL(size,8);
+
+    std::shared_ptr<SystemDefinition> sysdef(new SystemDefinition(9,          // number of particles
+                                                             BoxDim(2.0), // box dimensions
+                                                             1,           // number of particle types
+                                                             0,           // number of bond types
+                                                             0,           // number of angle types
+                                                             0,           // number of dihedral types
+                                                             0,           // number of dihedral types
+                                                             exec_conf));
+
+    std::shared_ptr<ParticleData> pdata(sysdef->getParticleData());
+
+    // one particle in every domain
+    pdata->setPosition(0, make_scalar3(-0.5,-0.8,-0.5),false);
+    pdata->setPosition(1, make_scalar3( 0.5,-0.8,-0.5),false);
+    pdata->setPosition(2, make_scalar3(-0.5, 0.5,-0.5),false);
+    pdata->setPosition(3, make_scalar3( 0.5, 0.5,-0.5),false);
+    pdata->setPosition(4, make_scalar3(-0.5,-0.8, 0.5),false);
+    pdata->setPosition(5, make_scalar3( 0.5,-0.8, 0.5),false);
+    pdata->setPosition(6, make_scalar3(-0.5, 0.5, 0.5),false);
+    pdata->setPosition(7, make_scalar3( 0.5, 0.5, 0.5),false);
+
+    // particle 8 is in the upper y domain of the lower x slab, but within the lower y domain of the upper x slab
+    pdata->setPosition(8, make_scalar3(-0.05, 0.0,-0.5),false);
+
+    SnapshotParticleData<Scalar> snap(9);
+    pdata->takeSnapshot(snap);
+
+    // the y cut is at 0.3 in the lower x slab and at 0.6 in the upper one
+    std::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, pdata->getBox().getL(),2,2,2));
+    decomposition->setStaggered(true);
+    std::vector<Scalar> stag_frac_y(6);
+    stag_frac_y[0] = 0.0; stag_frac_y[1] = 0.3; stag_frac_y[2] = 1.0;
+    stag_frac_y[3] = 0.0; stag_frac_y[4] = 0.6; stag_frac_y[5] = 1.0;
+    decomposition->setStaggeredFractions(1, stag_frac_y, 0);
+
+    std::shared_ptr<Communicator> comm = comm_creator(sysdef, decomposition);
+    pdata->setDomainDecomposition(decomposition);
+    pdata->initializeFromSnapshot(snap);
+
+    const uint3 my_pos = decomposition->getGridPos();
+    MY_CHECK_CLOSE(decomposition->getCumulativeFractions(1)[1], my_pos.x == 0 ? 0.3 : 0.6, tol);
+
+    const Scalar3 L = pdata->getBox().getL();
+    if (my_pos.x == 0)
+        MY_CHECK_CLOSE(L.y, my_pos.y == 0 ? 0.6 : 1.4, tol);
+    else
+        MY_CHECK_CLOSE(L.y, my_pos.y == 0 ? 1.2 : 0.8, tol);
+
+    for (unsigned int tag = 0; tag < 8; ++tag)
+        UP_ASSERT_EQUAL(pdata->getOwnerRank(tag), tag);
+    UP_ASSERT_EQUAL(pdata->getOwnerRank(8), 2);
+
+    ghost_layer_width g(0.1);
+    comm->getGhostLayerWidthRequestSignal().connect<ghost_layer_width, &ghost_layer_width::get>(g);
+    comm->getCommFlagsRequestSignal().connect<comm_flag_request>();
+    comm->communicate(0);
+
+    // the ghost of particle 8 is sent along x to rank 3 and from there along y to rank 1
+    if (exec_conf->getRank() == 1)
+        {
+        ArrayHandle<unsigned int> h_rtag(pdata->getRTags(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::read);
+        unsigned int rtag = h_rtag.data[8];
+        UP_ASSERT(rtag >= pdata->getN() && rtag < pdata->getN()+pdata->getNGhosts());
+        MY_CHECK_CLOSE(h_pos.data[rtag].x, -0.05, tol);
+        MY_CHECK_SMALL(h_pos.data[rtag].y, tol_small);
+        }
+
+    // moving particle 8 across the x cut migrates it to the lower y domain of the upper slab
+    pdata->setPosition(8, make_scalar3(0.05, 0.0,-0.5),false);
+    comm->migrateParticles();
+    UP_ASSERT_EQUAL(pdata->getOwnerRank(8), 1);
+    if (exec_conf->getRank() == 1)
+        UP_ASSERT_EQUAL(pdata->getN(), 2);
+    }
+
 Scalar ghost_layer_width_request_1(unsigned int type)
     {
     return 0.0123;
@@ -3130,6 +3322,114 @@ Scalar ghost_layer_width_request_2(unsigned int type)
     return 0.0001;
     }
 
+//! Test gathering of particle and bond snapshots from all ranks
+void test_communicator_snapshot(communicator_creator comm_creator, std::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // this test needs to be run on eight processors
+    int size;
+    MPI_Comm_size(exec_conf->getHOOMDWorldMPICommunicator(), &size);
+    UP_ASSERT_EQUAL(size,8);
+
+    BoxDim box(2.0);
+    std::shared_ptr<SystemDefinition> sysdef(new SystemDefinition(8,           // number of particles
+                                                             box,         // box dimensions
+                                                             2,           // number of particle types
+                                                             1,           // number of bond types
+                                                             0,           // number of angle types
+                                                             0,           // number of dihedral types
+                                                             0,           // number of dihedral types
+                                                             exec_conf));
+
+    std::shared_ptr<ParticleData> pdata(sysdef->getParticleData());
+
+    // one particle in every domain
+    for (unsigned int i = 0; i < 8; ++i)
+        {
+        pdata->setPosition(i, make_scalar3((i & 1) ? 0.4 : -0.4, (i & 2) ? 0.4 : -0.4, (i & 4) ? 0.4 : -0.4),false);
+        pdata->setVelocity(i, make_scalar3(i, 0.0, -1.0*i));
+        pdata->setType(i, i % 2);
+        pdata->setCharge(i, 0.1*i);
+        }
+
+    // bonds between particles in different domains, which are present on both ranks
+    std::shared_ptr<BondData> bdata(sysdef->getBondData());
+    bdata->addBondedGroup(Bond(0,0,1));  // bond 0
+    bdata->addBondedGroup(Bond(0,2,3));  // bond 1
+    bdata->addBondedGroup(Bond(0,4,6));  // bond 2
+    bdata->addBondedGroup(Bond(0,5,7));  // bond 3
+
+    SnapshotParticleData<Scalar> snap(8);
+    pdata->takeSnapshot(snap);
+
+    BondData::Snapshot bdata_snap(4);
+    bdata->takeSnapshot(bdata_snap);
+
+    std::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, box.getL(), 2, 2, 2));
+    std::shared_ptr<Communicator> comm = comm_creator(sysdef, decomposition);
+    pdata->setDomainDecomposition(decomposition);
+
+    pdata->initializeFromSnapshot(snap);
+    bdata->initializeFromSnapshot(bdata_snap);
+
+    UP_ASSERT_EQUAL(pdata->getN(), 1);
+    UP_ASSERT_EQUAL(bdata->getN(), 1);
+
+    // leave a hole in the bond tags
+    bdata->removeBondedGroup(1);
+
+    // gather the snapshots again
+    SnapshotParticleData<Scalar> snap_gathered;
+    std::vector<unsigned int> snap_idx;
+    pdata->takeSnapshot(snap_gathered, snap_idx);
+
+    BondData::Snapshot bdata_snap_gathered;
+    std::vector<unsigned int> bond_snap_idx;
+    bdata->takeSnapshot(bdata_snap_gathered, bond_snap_idx);
+
+    if (exec_conf->getRank() == 0)
+        {
+        // the particle snapshot is in tag order
+        UP_ASSERT_EQUAL(snap_gathered.size, 8);
+        UP_ASSERT_EQUAL(snap_idx.size(), 8);
+        for (unsigned int tag = 0; tag < 8; ++tag)
+            {
+            UP_ASSERT_EQUAL(snap_idx[tag], tag);
+            MY_CHECK_CLOSE(snap_gathered.pos[tag].x, snap.pos[tag].x, tol);
+            MY_CHECK_CLOSE(snap_gathered.pos[tag].y, snap.pos[tag].y, tol);
+            MY_CHECK_CLOSE(snap_gathered.pos[tag].z, snap.pos[tag].z, tol);
+            MY_CHECK_SMALL(snap_gathered.vel[tag].x - snap.vel[tag].x, tol_small);
+            MY_CHECK_SMALL(snap_gathered.vel[tag].z - snap.vel[tag].z, tol_small);
+            MY_CHECK_SMALL(snap_gathered.charge[tag] - snap.charge[tag], tol_small);
+            UP_ASSERT_EQUAL(snap_gathered.type[tag], snap.type[tag]);
+            }
+
+        // every bond is present on two ranks, but only in the snapshot once
+        UP_ASSERT_EQUAL(bdata_snap_gathered.size, 3);
+        UP_ASSERT_EQUAL(bond_snap_idx.size(), 4);
+        UP_ASSERT_EQUAL(bond_snap_idx[0], 0);
+        UP_ASSERT_EQUAL(bond_snap_idx[1], GROUP_NOT_LOCAL);
+        UP_ASSERT_EQUAL(bond_snap_idx[2], 1);
+        UP_ASSERT_EQUAL(bond_snap_idx[3], 2);
+
+        UP_ASSERT_EQUAL(bdata_snap_gathered.groups[0].tag[0], 0);
+        UP_ASSERT_EQUAL(bdata_snap_gathered.groups[0].tag[1], 1);
+        UP_ASSERT_EQUAL(bdata_snap_gathered.groups[1].tag[0], 4);
+        UP_ASSERT_EQUAL(bdata_snap_gathered.groups[1].tag[1], 6);
+        UP_ASSERT_EQUAL(bdata_snap_gathered.groups[2].tag[0], 5);
+        UP_ASSERT_EQUAL(bdata_snap_gathered.groups[2].tag[1], 7);
+
+        // the map agrees with the flat index
+        std::map<unsigned int, unsigned int> map = bdata->takeSnapshot(bdata_snap_gathered);
+        UP_ASSERT_EQUAL(map.size(), 3);
+        UP_ASSERT_EQUAL(map[3], 2);
+        }
+    else
+        {
+        // participate in the collective call of the root
+        bdata->takeSnapshot(bdata_snap_gathered);
+        }
+    }
+
 Scalar ghost_layer_width_request_3(unsigned int type)
     {
     return 0.1;
@@ -3443,6 +3743,98 @@ void test_communicator_ghosts_per_type(communicator_creator comm_creator, std::s
         }
     }
 
+//! Test compressed ghost positions with a ghost layer of zero width
+/*! The ghosts are only those of bonded particles, and their positions are sent in full.
+ */
+void test_communicator_compressed_zero_width(communicator_creator comm_creator, std::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // this test needs to be run on eight processors
+    int size;
+    MPI_Comm_size(exec_conf->getHOOMDWorldMPICommunicator(), &size);
+    UP_ASSERT_EQUAL(size,8);
+
+    std::shared_ptr<SystemDefinition> sysdef(new SystemDefinition(8,           // number of particles
+                                                             BoxDim(2.0), // box dimensions
+                                                             1,           // number of particle types
+                                                             1,           // number of bond types
+                                                             0,           // number of angle types
+                                                             0,           // number of dihedral types
+                                                             0,           // number of dihedral types
+                                                             exec_conf));
+
+    std::shared_ptr<ParticleData> pdata(sysdef->getParticleData());
+
+    // one particle in every box, bonded into a cube
+    for (unsigned int i = 0; i < 8; ++i)
+        pdata->setPosition(i, make_scalar3((i & 1) ? 0.4 : -0.4, (i & 2) ? 0.4 : -0.4, (i & 4) ? 0.4 : -0.4), false);
+
+    std::shared_ptr<BondData> bdata(sysdef->getBondData());
+    bdata->addBondedGroup(Bond(0,0,1));
+    bdata->addBondedGroup(Bond(0,0,2));
+    bdata->addBondedGroup(Bond(0,0,4));
+    bdata->addBondedGroup(Bond(0,1,3));
+    bdata->addBondedGroup(Bond(0,1,5));
+    bdata->addBondedGroup(Bond(0,2,3));
+    bdata->addBondedGroup(Bond(0,2,6));
+    bdata->addBondedGroup(Bond(0,3,7));
+    bdata->addBondedGroup(Bond(0,4,5));
+    bdata->addBondedGroup(Bond(0,4,6));
+    bdata->addBondedGroup(Bond(0,5,7));
+    bdata->addBondedGroup(Bond(0,6,7));
+
+    SnapshotParticleData<Scalar> snap(8);
+    pdata->takeSnapshot(snap);
+
+    BondData::Snapshot snap_bdata(12);
+    bdata->takeSnapshot(snap_bdata);
+
+    std::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, pdata->getBox().getL()));
+    std::shared_ptr<Communicator> comm = comm_creator(sysdef, decomposition);
+
+    pdata->setDomainDecomposition(decomposition);
+    pdata->initializeFromSnapshot(snap);
+    bdata->initializeFromSnapshot(snap_bdata);
+
+    ghost_layer_width g(0.0);
+    comm->getGhostLayerWidthRequestSignal().connect<ghost_layer_width, &ghost_layer_width::get>(g);
+    comm->getCommFlagsRequestSignal().connect<comm_flag_request>();
+
+    UP_ASSERT_EQUAL(comm->getGhostPositionBits(), (unsigned int)32);
+
+    // exchange ghosts
+    comm->communicate(0);
+
+    // every rank has the bond partners of its particle as ghosts
+    UP_ASSERT_EQUAL(pdata->getNGhosts(), (unsigned int)3);
+
+    // move every particle towards the center of its box
+        {
+        ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::readwrite);
+        for (unsigned int i = 0; i < pdata->getN(); ++i)
+            {
+            h_pos.data[i].x *= Scalar(1.25);
+            h_pos.data[i].y *= Scalar(1.25);
+            h_pos.data[i].z *= Scalar(1.25);
+            }
+        }
+
+    // update ghosts
+    comm->communicate(1);
+
+        {
+        ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_tag(pdata->getTags(), access_location::host, access_mode::read);
+        for (unsigned int i = pdata->getN(); i < pdata->getN() + pdata->getNGhosts(); ++i)
+            {
+            unsigned int tag = h_tag.data[i];
+            UP_ASSERT(std::isfinite(h_pos.data[i].x) && std::isfinite(h_pos.data[i].y) && std::isfinite(h_pos.data[i].z));
+            CHECK_CLOSE(h_pos.data[i].x, (tag & 1) ? 0.5 : -0.5, tol);
+            CHECK_CLOSE(h_pos.data[i].y, (tag & 2) ? 0.5 : -0.5, tol);
+            CHECK_CLOSE(h_pos.data[i].z, (tag & 4) ? 0.5 : -0.5, tol);
+            }
+        }
+    }
+
 //! Communicator creator for unit tests
 std::shared_ptr<Communicator> base_class_communicator_creator(std::shared_ptr<SystemDefinition> sysdef,
                                                          std::shared_ptr<DomainDecomposition> decomposition)
@@ -3450,6 +3842,45 @@ std::shared_ptr<Communicator> base_class_communicator_creator(std::shared_ptr<Sy
     return std::shared_ptr<Communicator>(new Communicator(sysdef, decomposition) );
     }
 
+//! Communicator creator for unit tests, with single-round ghost updates
+std::shared_ptr<Communicator> direct_communicator_creator(std::shared_ptr<SystemDefinition> sysdef,
+                                                         std::shared_ptr<DomainDecomposition> decomposition)
+    {
+    std::shared_ptr<Communicator> comm(new Communicator(sysdef, decomposition));
+    comm->setDirectGhostUpdate(true);
+    return comm;
+    }
+
+//! Communicator creator for unit tests, with single-round ghost updates on persistent requests
+std::shared_ptr<Communicator> persistent_communicator_creator(std::shared_ptr<SystemDefinition> sysdef,
+                                                             std::shared_ptr<DomainDecomposition> decomposition)
+    {
+    std::shared_ptr<Communicator> comm(new Communicator(sysdef, decomposition));
+    comm->setDirectGhostUpdate(true);
+    comm->setPersistentGhostUpdate(true);
+    return comm;
+    }
+
+//! Communicator creator for unit tests, with single-round ghost updates through shared memory on the node
+std::shared_ptr<Communicator> shared_communicator_creator(std::shared_ptr<SystemDefinition> sysdef,
+                                                         std::shared_ptr<DomainDecomposition> decomposition)
+    {
+    std::shared_ptr<Communicator> comm(new Communicator(sysdef, decomposition));
+    comm->setDirectGhostUpdate(true);
+    comm->setSharedGhostUpdate(true);
+    return comm;
+    }
+
+//! Communicator creator for unit tests, with single-round ghost updates and 32 bit compressed positions
+std::shared_ptr<Communicator> compressed_communicator_creator(std::shared_ptr<SystemDefinition> sysdef,
+                                                             std::shared_ptr<DomainDecomposition> decomposition)
+    {
+    std::shared_ptr<Communicator> comm(new Communicator(sysdef, decomposition));
+    comm->setDirectGhostUpdate(true);
+    comm->setGhostPositionBits(32);
+    return comm;
+    }
+
 #ifdef ENABLE_CUDA
 std::shared_ptr<Communicator> gpu_communicator_creator(std::shared_ptr<SystemDefinition> sysdef,
                                                   std::shared_ptr<DomainDecomposition> decomposition)
@@ -3648,6 +4079,34 @@ UP_TEST( communicator_ghost_fields_test)
     test_communicator_ghost_fields(communicator_creator_base, exec_conf_cpu);
     }
 
+UP_TEST( communicator_ghost_extrapolation_test)
+    {
+    if (!exec_conf_cpu)
+        exec_conf_cpu = std::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+
+    communicator_creator communicator_creator_base = bind(base_class_communicator_creator, _1, _2);
+    test_communicator_ghost_extrapolation(communicator_creator_base, exec_conf_cpu);
+    }
+
+//! Tests a staggered decomposition on the CPU
+UP_TEST( communicator_staggered_test)
+    {
+    if (!exec_conf_cpu)
+        exec_conf_cpu = std::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+
+    communicator_creator communicator_creator_base = bind(base_class_communicator_creator, _1, _2);
+    test_communicator_staggered(communicator_creator_base, exec_conf_cpu);
+    }
+
+UP_TEST( communicator_snapshot_test)
+    {
+    if (!exec_conf_cpu)
+        exec_conf_cpu = std::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+
+    communicator_creator communicator_creator_base = bind(base_class_communicator_creator, _1, _2);
+    test_communicator_snapshot(communicator_creator_base, exec_conf_cpu);
+    }
+
 UP_TEST( communicator_ghost_layer_width_test)
     {
     if (!exec_conf_cpu)
@@ -3666,6 +4125,76 @@ UP_TEST( communicator_ghost_layer_per_type_test)
     test_communicator_ghosts_per_type(communicator_creator_base, exec_conf_cpu,BoxDim(2.0));
     }
 
+//! Compares staged and single-round ghost updates on the CPU
+UP_TEST( communicator_direct_ghost_update_test)
+    {
+    if (!exec_conf_cpu)
+        exec_conf_cpu = std::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+
+    communicator_creator communicator_creator_base = bind(base_class_communicator_creator, _1, _2);
+    communicator_creator communicator_creator_direct = bind(direct_communicator_creator, _1, _2);
+
+    BoxDim box(2.0);
+    std::shared_ptr<DomainDecomposition> decomposition_1(new DomainDecomposition(exec_conf_cpu,box.getL()));
+    std::shared_ptr<DomainDecomposition> decomposition_2(new DomainDecomposition(exec_conf_cpu,box.getL()));
+    test_communicator_compare(communicator_creator_base, communicator_creator_direct, exec_conf_cpu, exec_conf_cpu, box, decomposition_1, decomposition_2);
+    }
+
+//! Compares staged ghost updates and single-round ghost updates on persistent requests on the CPU
+UP_TEST( communicator_persistent_ghost_update_test)
+    {
+    if (!exec_conf_cpu)
+        exec_conf_cpu = std::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+
+    communicator_creator communicator_creator_base = bind(base_class_communicator_creator, _1, _2);
+    communicator_creator communicator_creator_persistent = bind(persistent_communicator_creator, _1, _2);
+
+    BoxDim box(2.0);
+    std::shared_ptr<DomainDecomposition> decomposition_1(new DomainDecomposition(exec_conf_cpu,box.getL()));
+    std::shared_ptr<DomainDecomposition> decomposition_2(new DomainDecomposition(exec_conf_cpu,box.getL()));
+    test_communicator_compare(communicator_creator_base, communicator_creator_persistent, exec_conf_cpu, exec_conf_cpu, box, decomposition_1, decomposition_2);
+    }
+
+//! Compares staged ghost updates and single-round ghost updates through shared memory on the CPU
+UP_TEST( communicator_shared_ghost_update_test)
+    {
+    if (!exec_conf_cpu)
+        exec_conf_cpu = std::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+
+    communicator_creator communicator_creator_base = bind(base_class_communicator_creator, _1, _2);
+    communicator_creator communicator_creator_shared = bind(shared_communicator_creator, _1, _2);
+
+    BoxDim box(2.0);
+    std::shared_ptr<DomainDecomposition> decomposition_1(new DomainDecomposition(exec_conf_cpu,box.getL()));
+    std::shared_ptr<DomainDecomposition> decomposition_2(new DomainDecomposition(exec_conf_cpu,box.getL()));
+    test_communicator_compare(communicator_creator_base, communicator_creator_shared, exec_conf_cpu, exec_conf_cpu, box, decomposition_1, decomposition_2);
+    }
+
+//! Compares staged ghost updates and single-round ghost updates with compressed positions on the CPU
+UP_TEST( communicator_compressed_ghost_update_test)
+    {
+    if (!exec_conf_cpu)
+        exec_conf_cpu = std::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+
+    communicator_creator communicator_creator_base = bind(base_class_communicator_creator, _1, _2);
+    communicator_creator communicator_creator_compressed = bind(compressed_communicator_creator, _1, _2);
+
+    BoxDim box(2.0);
+    std::shared_ptr<DomainDecomposition> decomposition_1(new DomainDecomposition(exec_conf_cpu,box.getL()));
+    std::shared_ptr<DomainDecomposition> decomposition_2(new DomainDecomposition(exec_conf_cpu,box.getL()));
+    test_communicator_compare(communicator_creator_base, communicator_creator_compressed, exec_conf_cpu, exec_conf_cpu, box, decomposition_1, decomposition_2);
+    }
+
+//! Tests compressed ghost positions with a ghost layer of zero width on the CPU
+UP_TEST( communicator_compressed_zero_width_test)
+    {
+    if (!exec_conf_cpu)
+        exec_conf_cpu = std::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+
+    communicator_creator communicator_creator_compressed = bind(compressed_communicator_creator, _1, _2);
+    test_communicator_compressed_zero_width(communicator_creator_compressed, exec_conf_cpu);
+    }
+
 UP_SUITE_END();
 
 #ifdef ENABLE_CUDA
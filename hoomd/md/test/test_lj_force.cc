@@ -14,6 +14,9 @@
 #include "hoomd/md/AllPairPotentials.h"
 
 #include "hoomd/md/NeighborListTree.h"
+#include "hoomd/md/NeighborListBinned.h"
+#include "hoomd/md/IntegratorTwoStep.h"
+#include "hoomd/md/TwoStepNVE.h"
 #include "hoomd/Initializers.h"
 
 #include <math.h>
@@ -531,6 +534,90 @@ void lj_force_shift_test(ljforce_creator lj_creator, std::shared_ptr<ExecutionCo
     }
     }
 
+//! Test that the neighbor list and the forces do not change with the structure-of-arrays positions
+void lj_force_soa_test(ljforce_creator lj_creator, std::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    const unsigned int N = 1000;
+
+    // two copies of a random particle system, one with the structure-of-arrays mirror
+    RandomInitializer rand_init(N, Scalar(0.2), Scalar(0.9), "A");
+    std::shared_ptr< SnapshotSystemData<Scalar> > snap = rand_init.getSnapshot();
+
+    std::shared_ptr<SystemDefinition> sysdef[2];
+    std::shared_ptr<NeighborListBinned> nlist[2];
+    std::shared_ptr<PotentialPairLJ> fc[2];
+    std::shared_ptr<IntegratorTwoStep> integrator[2];
+
+    Scalar lj1 = Scalar(4.0) * pow(Scalar(1.0),Scalar(12.0));
+    Scalar lj2 = Scalar(4.0) * pow(Scalar(1.0),Scalar(6.0));
+
+    for (unsigned int k = 0; k < 2; k++)
+        {
+        sysdef[k] = std::shared_ptr<SystemDefinition>(new SystemDefinition(snap, exec_conf));
+        std::shared_ptr<ParticleData> pdata = sysdef[k]->getParticleData();
+        pdata->setFlags(~PDataFlags(0));
+        pdata->setPositionsSoA(k == 1);
+
+        nlist[k] = std::shared_ptr<NeighborListBinned>(new NeighborListBinned(sysdef[k], Scalar(2.5), Scalar(0.4)));
+        fc[k] = lj_creator(sysdef[k], nlist[k]);
+        fc[k]->setRcut(0, 0, Scalar(2.5));
+        fc[k]->setParams(0,0,make_scalar2(lj1,lj2));
+
+        std::shared_ptr<ParticleSelector> selector_all(new ParticleSelectorTag(sysdef[k], 0, N-1));
+        std::shared_ptr<ParticleGroup> group_all(new ParticleGroup(sysdef[k], selector_all));
+        integrator[k] = std::shared_ptr<IntegratorTwoStep>(new IntegratorTwoStep(sysdef[k], Scalar(0.002)));
+        integrator[k]->addIntegrationMethod(std::shared_ptr<TwoStepNVE>(new TwoStepNVE(sysdef[k], group_all)));
+        integrator[k]->addForceCompute(fc[k]);
+        integrator[k]->prepRun(0);
+        }
+
+    for (unsigned int step = 0; step < 20; step++)
+        {
+        // move a particle between the steps, which has to invalidate the mirror
+        if (step == 10)
+            for (unsigned int k = 0; k < 2; k++)
+                {
+                std::shared_ptr<ParticleData> pdata = sysdef[k]->getParticleData();
+                pdata->setPosition(0, pdata->getPosition(0) + make_scalar3(0.01, 0.0, 0.0));
+                }
+
+        for (unsigned int k = 0; k < 2; k++)
+            integrator[k]->update(step);
+
+        // the neighbor lists are identical
+        ArrayHandle<unsigned int> h_n_neigh_0(nlist[0]->getNNeighArray(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_nlist_0(nlist[0]->getNListArray(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_head_list_0(nlist[0]->getHeadList(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_n_neigh_1(nlist[1]->getNNeighArray(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_nlist_1(nlist[1]->getNListArray(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_head_list_1(nlist[1]->getHeadList(), access_location::host, access_mode::read);
+
+        for (unsigned int i = 0; i < N; i++)
+            {
+            UP_ASSERT_EQUAL(h_n_neigh_1.data[i], h_n_neigh_0.data[i]);
+            for (unsigned int n = 0; n < h_n_neigh_0.data[i]; n++)
+                UP_ASSERT_EQUAL(h_nlist_1.data[h_head_list_1.data[i] + n], h_nlist_0.data[h_head_list_0.data[i] + n]);
+            }
+
+        // and so are the forces and the positions
+        ArrayHandle<Scalar4> h_force_0(fc[0]->getForceArray(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_force_1(fc[1]->getForceArray(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_pos_0(sysdef[0]->getParticleData()->getPositions(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_pos_1(sysdef[1]->getParticleData()->getPositions(), access_location::host, access_mode::read);
+
+        for (unsigned int i = 0; i < N; i++)
+            {
+            UP_ASSERT_EQUAL(h_force_1.data[i].x, h_force_0.data[i].x);
+            UP_ASSERT_EQUAL(h_force_1.data[i].y, h_force_0.data[i].y);
+            UP_ASSERT_EQUAL(h_force_1.data[i].z, h_force_0.data[i].z);
+            UP_ASSERT_EQUAL(h_force_1.data[i].w, h_force_0.data[i].w);
+            UP_ASSERT_EQUAL(h_pos_1.data[i].x, h_pos_0.data[i].x);
+            UP_ASSERT_EQUAL(h_pos_1.data[i].y, h_pos_0.data[i].y);
+            UP_ASSERT_EQUAL(h_pos_1.data[i].z, h_pos_0.data[i].z);
+            }
+        }
+    }
+
 //! LJForceCompute creator for unit tests
 std::shared_ptr<PotentialPairLJ> base_class_lj_creator(std::shared_ptr<SystemDefinition> sysdef,
                                                   std::shared_ptr<NeighborList> nlist)
@@ -570,6 +657,13 @@ UP_TEST( PotentialPairLJ_shift )
     lj_force_shift_test(lj_creator_base, std::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
 
+//! test case for the structure-of-arrays positions on CPU
+UP_TEST( PotentialPairLJ_soa )
+    {
+    ljforce_creator lj_creator_base = bind(base_class_lj_creator, _1, _2);
+    lj_force_soa_test(lj_creator_base, std::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
+
 # ifdef ENABLE_CUDA
 //! test case for particle test on GPU
 UP_TEST( LJForceGPU_particle )
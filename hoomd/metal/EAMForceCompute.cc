@@ -6,6 +6,14 @@
 
 #include "EAMForceCompute.h"
 
+#ifdef ENABLE_MPI
+#include "hoomd/Communicator.h"
+#endif
+
+#ifdef ENABLE_TBB
+#include <tbb/tbb.h>
+#endif
+
 #include <vector>
 
 using namespace std;
@@ -237,6 +245,8 @@ void EAMForceCompute::loadFile(char *filename, int type_of_file)
     interpolation(nr * m_ntypes * m_ntypes, nr, dr, &h_rho, &h_drho);
     interpolation((int) (0.5 * nr * (m_ntypes + 1) * m_ntypes), nr, dr, &h_rphi, &h_drphi);
 
+    // pack the coefficients used per neighbor in the force sweep
+    buildPairTable(&h_drho, &h_rphi, &h_drphi);
     }
 
 /*! compute cubic interpolation coefficients
@@ -306,9 +316,58 @@ Scalar EAMForceCompute::getLogValue(const std::string &quantity, unsigned int ti
         }
     }
 
+/*! \param drho Interpolated derivative of the electron density
+ \param rphi Interpolated pair potential r*phi(r)
+ \param drphi Interpolated derivative of r*phi(r)
+
+ Packs the coefficients needed by the force sweep for one ordered type pair (typei, typej) and one table
+ point into a single record of pair_table_width Scalars: the four coefficients of r*phi(r), the three of its
+ derivative and the three of drho/dr for (typei,typej) and (typej,typei). A neighbor then costs one contiguous
+ load instead of four scattered ones. The records are padded to pair_table_width Scalars, the table itself only has
+ the alignment of std::vector, so a record may straddle a cache line boundary.
+ */
+void EAMForceCompute::buildPairTable(ArrayHandle<Scalar4> *drho, ArrayHandle<Scalar4> *rphi,
+        ArrayHandle<Scalar4> *drphi)
+    {
+    m_pair_table.assign(m_ntypes * m_ntypes * nr * pair_table_width, Scalar(0.0));
+
+    for (unsigned int typei = 0; typei < m_ntypes; typei++)
+        for (unsigned int typej = 0; typej < m_ntypes; typej++)
+            {
+            // shift of the symmetric r*phi(r) table for type pair ij
+            int shift =
+                    (typei >= typej) ?
+                            (int) (0.5 * (2 * m_ntypes - typej - 1) * typej + typei) * nr :
+                            (int) (0.5 * (2 * m_ntypes - typei - 1) * typei + typej) * nr;
+
+            for (unsigned int m = 0; m < nr; m++)
+                {
+                Scalar *rec = &m_pair_table[((typei * m_ntypes + typej) * nr + m) * pair_table_width];
+
+                Scalar4 v = rphi->data[shift + m];
+                rec[0] = v.w; rec[1] = v.z; rec[2] = v.y; rec[3] = v.x;
+
+                Scalar4 dv = drphi->data[shift + m];
+                rec[4] = dv.z; rec[5] = dv.y; rec[6] = dv.x;
+
+                // drho / dr of i
+                dv = drho->data[m + typei * m_ntypes * nr + typej * nr];
+                rec[7] = dv.z; rec[8] = dv.y; rec[9] = dv.x;
+
+                // drho / dr of j
+                dv = drho->data[m + typej * m_ntypes * nr + typei * nr];
+                rec[10] = dv.z; rec[11] = dv.y; rec[12] = dv.x;
+                }
+            }
+    }
+
 /*! \post The EAM forces are computed for the given timestep. The neighborlist's
  compute method is called to ensure that it is up to date.
  \param timestep specifies the current time step of the simulation
+
+ Both sweeps loop over the full neighbor list of each local particle and only write to that particle, so they
+ run in parallel when TBB is enabled and give results independent of the number of threads. Between the sweeps,
+ dF/dP is copied to the ghost particles when running with domain decomposition.
  */
 void EAMForceCompute::computeForces(unsigned int timestep)
     {
@@ -319,12 +378,25 @@ void EAMForceCompute::computeForces(unsigned int timestep)
     if (m_prof)
         m_prof->push("EAM pair");
 
-    // depending on the neighborlist settings, we can take advantage of newton's third law
-    // to reduce computations at the cost of memory access complexity: set that flag now
-    bool third_law = m_nlist->getStorageMode() == NeighborList::half;
+    // the sweeps gather from neighbors only, which requires a full neighbor list
+    assert(m_nlist);
+    if (m_nlist->getStorageMode() != NeighborList::full)
+        {
+        m_exec_conf->msg->error() << "pair.eam: a full neighbor list is required" << endl;
+        throw runtime_error("Error computing EAM forces");
+        }
+
+    const unsigned int N = m_pdata->getN();
+    const unsigned int nptl = N + m_pdata->getNGhosts();
+
+    // dF/dP is needed for local and ghost particles
+    if (m_dFdP.getNumElements() < nptl)
+        {
+        GPUArray<Scalar> t_dFdP(nptl, m_exec_conf);
+        m_dFdP.swap(t_dFdP);
+        }
 
     // access the neighbor list
-    assert(m_nlist);
     ArrayHandle<unsigned int> h_n_neigh(m_nlist->getNNeighArray(), access_location::host, access_mode::read);
     ArrayHandle<unsigned int> h_nlist(m_nlist->getNListArray(), access_location::host, access_mode::read);
     ArrayHandle<unsigned int> h_head_list(m_nlist->getHeadList(), access_location::host, access_mode::read);
@@ -339,16 +411,7 @@ void EAMForceCompute::computeForces(unsigned int timestep)
     ArrayHandle<Scalar4> h_F(m_F, access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_dF(m_dF, access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_rho(m_rho, access_location::host, access_mode::read);
-    ArrayHandle<Scalar4> h_drho(m_drho, access_location::host, access_mode::read);
-    ArrayHandle<Scalar4> h_rphi(m_rphi, access_location::host, access_mode::read);
-    ArrayHandle<Scalar4> h_drphi(m_drphi, access_location::host, access_mode::read);
-
-    // index and remainder
-    Scalar position;  // look up position, scalar
-    unsigned int int_position;  // look up index for position, integer
-    unsigned int idxs; // look up index in F, rho, rphi array, considering shift, integer
-    Scalar remainder;  // look up remainder in array, integer
-    Scalar4 v, dv;  // value, d(value)
+    const Scalar *pair_table = m_pair_table.data();
 
     // there are enough other checks on the input data: but it doesn't hurt to be safe
     assert(h_force.data);
@@ -357,9 +420,7 @@ void EAMForceCompute::computeForces(unsigned int timestep)
     assert(h_F.data);
     assert(h_dF.data);
     assert(h_rho.data);
-    assert(h_drho.data);
-    assert(h_rphi.data);
-    assert(h_drphi.data);
+    assert(pair_table);
 
     // Zero data for force calculation.
     memset((void *) h_force.data, 0, sizeof(Scalar4) * m_force.getNumElements());
@@ -371,108 +432,109 @@ void EAMForceCompute::computeForces(unsigned int timestep)
     // create a temporary copy of r_cut squared
     Scalar r_cut_sq = m_r_cut * m_r_cut;
 
-    // sum up the number of forces calculated
-    int64_t n_calc = 0;
-
-    // parameters for each particle
-    vector<Scalar> atomElectronDensity;
-    atomElectronDensity.resize(m_pdata->getN());
-    vector<Scalar> atomDerivativeEmbeddingFunction;
-    atomDerivativeEmbeddingFunction.resize(m_pdata->getN());
-    vector<Scalar> atomEmbeddingFunction;
-    atomEmbeddingFunction.resize(m_pdata->getN());
     unsigned int ntypes = m_pdata->getNTypes();
 
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
         {
-        // access the particle's position and type
-        Scalar3 pi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
-        unsigned int typei = __scalar_as_int(h_pos.data[i].w);
-        const unsigned int head_i = h_head_list.data[i];
-
-        // sanity check
-        assert(typei < m_pdata->getNTypes());
+        ArrayHandle<Scalar> h_dFdP(m_dFdP, access_location::host, access_mode::overwrite);
 
-        // loop over all of the neighbors of this particle
-        const unsigned int size = (unsigned int) h_n_neigh.data[i];
-
-        for (unsigned int j = 0; j < size; j++)
+        // first sweep: electron density, embedding energy and dF / dP
+        #ifdef ENABLE_TBB
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, N),
+            [&](const tbb::blocked_range<unsigned int>& r)
             {
-            // increment our calculation counter
-            n_calc++;
+            for (unsigned int i = r.begin(); i != r.end(); ++i)
+        #else
+        for (unsigned int i = 0; i < N; i++)
+        #endif
+            {
+            // access the particle's position and type
+            Scalar3 pi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
+            unsigned int typei = __scalar_as_int(h_pos.data[i].w);
+            const unsigned int head_i = h_head_list.data[i];
 
-            // access the index of this neighbor
-            unsigned int k = h_nlist.data[head_i + j];
             // sanity check
-            assert(k < m_pdata->getN());
+            assert(typei < m_pdata->getNTypes());
 
-            // calculate dr
-            Scalar3 pk = make_scalar3(h_pos.data[k].x, h_pos.data[k].y, h_pos.data[k].z);
-            Scalar3 dx = pi - pk;
+            // loop over all of the neighbors of this particle
+            const unsigned int size = (unsigned int) h_n_neigh.data[i];
+            Scalar atomElectronDensity(0.0);
 
-            // access the type of the neighbor particle
-            unsigned int typej = __scalar_as_int(h_pos.data[k].w);
-            // sanity check
-            assert(typej < m_pdata->getNTypes());
+            for (unsigned int j = 0; j < size; j++)
+                {
+                // access the index of this neighbor
+                unsigned int k = h_nlist.data[head_i + j];
+                // sanity check
+                assert(k < nptl);
 
-            // apply periodic boundary conditions
-            dx = box.minImage(dx);
+                // calculate dr
+                Scalar4 postypek = h_pos.data[k];
+                Scalar3 dx = pi - make_scalar3(postypek.x, postypek.y, postypek.z);
 
-            // start computing the force
-            // calculate r squared
-            Scalar rsq = dot(dx, dx);
-            ;
-            // only compute the force if the particles are closer than the cut-off
-            if (rsq < r_cut_sq)
-                {
-                // calculate position r for rho(r)
-                position = sqrt(rsq) * rdr;
-                int_position = (unsigned int) position;
-                int_position = min(int_position, nr - 1);
-                remainder = position - int_position;
-                // calculate P = sum{rho}
-                idxs = int_position + nr * (typej * ntypes + typei);
-                v = h_rho.data[idxs];
-                atomElectronDensity[i] += v.w + v.z * remainder + v.y * remainder * remainder
-                        + v.x * remainder * remainder * remainder;
-                // if third_law, pair it
-                if (third_law)
+                // access the type of the neighbor particle
+                unsigned int typej = __scalar_as_int(postypek.w);
+                // sanity check
+                assert(typej < m_pdata->getNTypes());
+
+                // apply periodic boundary conditions
+                dx = box.minImage(dx);
+
+                // calculate r squared
+                Scalar rsq = dot(dx, dx);
+
+                // only compute the density if the particles are closer than the cut-off
+                if (rsq < r_cut_sq)
                     {
-                    idxs = int_position + nr * (typei * ntypes + typej);
-                    v = h_rho.data[idxs];
-                    atomElectronDensity[k] += v.w + v.z * remainder + v.y * remainder * remainder
-                            + v.x * remainder * remainder * remainder;
+                    // calculate position r for rho(r)
+                    Scalar position = sqrt(rsq) * rdr;
+                    unsigned int int_position = min((unsigned int) position, nr - 1);
+                    Scalar remainder = position - int_position;
+                    // calculate P = sum{rho}
+                    Scalar4 v = h_rho.data[int_position + nr * (typej * ntypes + typei)];
+                    atomElectronDensity += v.w + remainder * (v.z + remainder * (v.y + remainder * v.x));
                     }
                 }
+
+            // calculate position rho for F(rho)
+            Scalar position = atomElectronDensity * rdrho;
+            unsigned int int_position = min((unsigned int) position, nrho - 1);
+            Scalar remainder = position - int_position;
+
+            unsigned int idxs = int_position + typei * nrho;
+            Scalar4 v = h_F.data[idxs];
+            Scalar4 dv = h_dF.data[idxs];
+            // compute dF / dP
+            h_dFdP.data[i] = dv.z + remainder * (dv.y + remainder * dv.x);
+            // compute embedded energy F(P)
+            h_force.data[i].w = v.w + remainder * (v.z + remainder * (v.y + remainder * v.x));
             }
+        #ifdef ENABLE_TBB
+            });
+        #endif
         }
 
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        {
-        unsigned int typei = __scalar_as_int(h_pos.data[i].w);
-        // calculate position rho for F(rho)
-        position = atomElectronDensity[i] * rdrho;
-        int_position = (unsigned int) position;
-        int_position = min(int_position, nrho - 1);
-        remainder = position - int_position;
-
-        idxs = int_position + typei * nrho;
-        v = h_F.data[idxs];
-        dv = h_dF.data[idxs];
-        // compute dF / dP
-        atomDerivativeEmbeddingFunction[i] = dv.z + dv.y * remainder + dv.x * remainder * remainder;
-        // compute embedded energy F(P), sum up each particle
-        h_force.data[i].w += v.w + v.z * remainder + v.y * remainder * remainder
-                + v.x * remainder * remainder * remainder;
+    #ifdef ENABLE_MPI
+    // the force sweep needs dF / dP of the ghost neighbors
+    if (m_comm)
+        m_comm->updateGhostScalars(m_dFdP);
+    #endif
 
-        }
+    ArrayHandle<Scalar> h_dFdP(m_dFdP, access_location::host, access_mode::read);
 
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
+    // second sweep: forces, pair energy and virial
+    #ifdef ENABLE_TBB
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, N),
+        [&](const tbb::blocked_range<unsigned int>& r)
+        {
+        for (unsigned int i = r.begin(); i != r.end(); ++i)
+    #else
+    for (unsigned int i = 0; i < N; i++)
+    #endif
         {
         // access the particle's position and type
         Scalar3 pi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
         unsigned int typei = __scalar_as_int(h_pos.data[i].w);
         const unsigned int head_i = h_head_list.data[i];
+        const Scalar dFdPi = h_dFdP.data[i];
         // sanity check
         assert(typei < m_pdata->getNTypes());
 
@@ -482,34 +544,30 @@ void EAMForceCompute::computeForces(unsigned int timestep)
         Scalar fzi = 0.0;
         Scalar pei = 0.0;
         Scalar viriali[6];
-        for (int k = 0; k < 6; k++)
-            viriali[k] = 0.0;
+        for (int l = 0; l < 6; l++)
+            viriali[l] = 0.0;
 
         // loop over all of the neighbors of this particle
         const unsigned int size = (unsigned int) h_n_neigh.data[i];
         for (unsigned int j = 0; j < size; j++)
             {
-            // increment our calculation counter
-            n_calc++;
-
             // access the index of this neighbor
             unsigned int k = h_nlist.data[head_i + j];
             // sanity check
-            assert(k < m_pdata->getN());
+            assert(k < nptl);
 
             // calculate \Delta r
-            Scalar3 pk = make_scalar3(h_pos.data[k].x, h_pos.data[k].y, h_pos.data[k].z);
-            Scalar3 dx = pi - pk;
+            Scalar4 postypek = h_pos.data[k];
+            Scalar3 dx = pi - make_scalar3(postypek.x, postypek.y, postypek.z);
 
             // access the type of the neighbor particle
-            unsigned int typej = __scalar_as_int(h_pos.data[k].w);
+            unsigned int typej = __scalar_as_int(postypek.w);
             // sanity check
             assert(typej < m_pdata->getNTypes());
 
             // apply periodic boundary conditions
             dx = box.minImage(dx);
 
-            // start computing the force
             // calculate r squared
             Scalar rsq = dot(dx, dx);
 
@@ -518,78 +576,70 @@ void EAMForceCompute::computeForces(unsigned int timestep)
                 continue;
             Scalar r = sqrt(rsq);
             Scalar inverseR = 1.0 / r;
-            position = r * rdr;
-            int_position = (unsigned int) position;
-            int_position = min(int_position, nr - 1);
-            remainder = position - int_position;
-            // calculate the shift position for type ij
-            int shift =
-                    (typei >= typej) ?
-                            (int) (0.5 * (2 * ntypes - typej - 1) * typej + typei) * nr :
-                            (int) (0.5 * (2 * ntypes - typei - 1) * typei + typej) * nr;
+            Scalar position = r * rdr;
+            unsigned int int_position = min((unsigned int) position, nr - 1);
+            Scalar remainder = position - int_position;
+
+            // one record holds all coefficients for this type pair and table point
+            const Scalar *rec = pair_table + ((typei * ntypes + typej) * nr + int_position) * pair_table_width;
 
-            idxs = int_position + shift;
-            v = h_rphi.data[idxs];
-            dv = h_drphi.data[idxs];
             // pair_eng = phi
-            Scalar pair_eng = (v.w + v.z * remainder + v.y * remainder * remainder
-                    + v.x * remainder * remainder * remainder) * inverseR;
+            Scalar pair_eng = (rec[0] + remainder * (rec[1] + remainder * (rec[2] + remainder * rec[3]))) * inverseR;
             // derivativePhi = (phi + r * dphi/dr - phi) * 1/r = dphi / dr
-            Scalar derivativePhi = (dv.z + dv.y * remainder + dv.x * remainder * remainder - pair_eng) * inverseR;
+            Scalar derivativePhi = (rec[4] + remainder * (rec[5] + remainder * rec[6]) - pair_eng) * inverseR;
             // derivativeRhoI = drho / dr of i
-            idxs = int_position + typei * ntypes * nr + typej * nr;
-            dv = h_drho.data[idxs];
-            Scalar derivativeRhoI = dv.z + dv.y * remainder + dv.x * remainder * remainder;
+            Scalar derivativeRhoI = rec[7] + remainder * (rec[8] + remainder * rec[9]);
             // derivativeRhoJ = drho / dr of j
-            idxs = int_position + typej * ntypes * nr + typei * nr;
-            dv = h_drho.data[idxs];
-            Scalar derivativeRhoJ = dv.z + dv.y * remainder + dv.x * remainder * remainder;
+            Scalar derivativeRhoJ = rec[10] + remainder * (rec[11] + remainder * rec[12]);
             // fullDerivativePhi = dF/dP * drho / dr for j + dF/dP * drho / dr for j + phi
-            Scalar fullDerivativePhi = atomDerivativeEmbeddingFunction[i] * derivativeRhoJ
-                    + atomDerivativeEmbeddingFunction[k] * derivativeRhoI + derivativePhi;
+            Scalar fullDerivativePhi = dFdPi * derivativeRhoJ + h_dFdP.data[k] * derivativeRhoI + derivativePhi;
             // compute forces
             Scalar pairForce = -fullDerivativePhi * inverseR;
-            viriali[0] += dx.x * dx.x * pairForce;
-            viriali[1] += dx.x * dx.y * pairForce;
-            viriali[2] += dx.x * dx.z * pairForce;
-            viriali[3] += dx.y * dx.y * pairForce;
-            viriali[4] += dx.y * dx.z * pairForce;
-            viriali[5] += dx.z * dx.z * pairForce;
+            // avoid double counting
+            Scalar pairForceover2 = Scalar(0.5) * pairForce;
+            viriali[0] += dx.x * dx.x * pairForceover2;
+            viriali[1] += dx.x * dx.y * pairForceover2;
+            viriali[2] += dx.x * dx.z * pairForceover2;
+            viriali[3] += dx.y * dx.y * pairForceover2;
+            viriali[4] += dx.y * dx.z * pairForceover2;
+            viriali[5] += dx.z * dx.z * pairForceover2;
             fxi += dx.x * pairForce;
             fyi += dx.y * pairForce;
             fzi += dx.z * pairForce;
             pei += pair_eng * 0.5;
-
-            if (third_law)
-                {
-                h_force.data[k].x -= dx.x * pairForce;
-                h_force.data[k].y -= dx.y * pairForce;
-                h_force.data[k].z -= dx.z * pairForce;
-                h_force.data[k].w += pair_eng * 0.5;
-                }
             }
-        h_force.data[i].x += fxi;
-        h_force.data[i].y += fyi;
-        h_force.data[i].z += fzi;
+        h_force.data[i].x = fxi;
+        h_force.data[i].y = fyi;
+        h_force.data[i].z = fzi;
         h_force.data[i].w += pei;
-        for (int k = 0; k < 6; k++)
-            h_virial.data[k * virial_pitch + i] += viriali[k];
+        for (int l = 0; l < 6; l++)
+            h_virial.data[l * virial_pitch + i] = viriali[l];
         }
+    #ifdef ENABLE_TBB
+        });
+    #endif
 
-    int64_t flops = m_pdata->getN() * 5 + n_calc * (3 + 5 + 9 + 1 + 9 + 6 + 8);
-    if (third_law)
-        flops += n_calc * 8;
-    int64_t mem_transfer = m_pdata->getN() * (5 + 4 + 10) * sizeof(Scalar) + n_calc * (1 + 3 + 1) * sizeof(Scalar);
-    if (third_law)
-        mem_transfer += n_calc * 10 * sizeof(Scalar);
     if (m_prof)
+        {
+        // sum up the number of pair interactions evaluated in both sweeps
+        int64_t n_calc = 0;
+        for (unsigned int i = 0; i < N; i++)
+            n_calc += h_n_neigh.data[i];
+        n_calc *= 2;
+
+        int64_t flops = N * 5 + n_calc * (3 + 5 + 9 + 1 + 9 + 6 + 8);
+        int64_t mem_transfer = N * (5 + 4 + 10) * sizeof(Scalar) + n_calc * (1 + 3 + 1) * sizeof(Scalar);
         m_prof->pop(flops, mem_transfer);
+        }
     }
 
 void EAMForceCompute::set_neighbor_list(std::shared_ptr<NeighborList> nlist)
     {
     m_nlist = nlist;
     assert(m_nlist);
+
+    // both sweeps gather from the neighbors of each particle
+    m_nlist->setStorageMode(NeighborList::full);
     }
 
 Scalar EAMForceCompute::get_r_cut()
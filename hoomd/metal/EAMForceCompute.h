@@ -8,6 +8,7 @@
 #include "hoomd/md/NeighborList.h"
 
 #include <memory>
+#include <vector>
 
 /*! \file EAMForceCompute.h
  \brief Declares the EAMForceCompute class
@@ -42,6 +43,10 @@
  h_dF.data[100].z, h_dF.data[100].y, h_dF.data[100].x, are for interpolating derivative embedded
  function.
 
+ For the CPU force sweep, the coefficients of r*phi(r), its derivative and drho/dr for both orderings of a type
+ pair are additionally packed into m_pair_table, one record of pair_table_width Scalars per ordered type pair
+ and table point, so that each neighbor needs a single contiguous load.
+
  \ingroup computes
  */
 class EAMForceCompute: public ForceCompute
@@ -92,6 +97,10 @@ protected:
     GPUArray<Scalar4> m_drho;              //!< derivative electron density and its coefficients
     GPUArray<Scalar4> m_drphi;             //!< derivative pair wise function and its coefficients
     GPUArray<Scalar> m_dFdP;               //!< derivative F / derivative P
+    std::vector<Scalar> m_pair_table;      //!< packed coefficients for the CPU force sweep (padded, not aligned)
+
+    //! Number of Scalars per record in m_pair_table
+    static const unsigned int pair_table_width = 16;
 
     //! Actually compute the forces
     virtual void computeForces(unsigned int timestep);
@@ -106,6 +115,9 @@ protected:
     //! cubic interpolation
     virtual void interpolation(int num_all, int num_per, Scalar delta, ArrayHandle<Scalar4> *f,
             ArrayHandle<Scalar4> *df);
+
+    //! Pack the force sweep coefficients into m_pair_table
+    void buildPairTable(ArrayHandle<Scalar4> *drho, ArrayHandle<Scalar4> *rphi, ArrayHandle<Scalar4> *drphi);
     };
 
 //! Exports the EAMForceCompute class to python
@@ -38,7 +38,7 @@ class eam(force._force):
     and are also described here: http://enpub.fulton.asu.edu/cms/potentials/submain/format.htm
 
     .. attention::
-        EAM is **NOT** supported in MPI parallel simulations.
+        EAM is **NOT** supported in MPI parallel simulations on the GPU.
 
     Example::
 
@@ -62,10 +62,10 @@ class eam(force._force):
 
         hoomd.util.print_status_line();
 
-        # Error out in MPI simulations
-        if (_hoomd.is_MPI_available()):
+        # Error out in MPI simulations on the GPU
+        if (_hoomd.is_MPI_available() and hoomd.context.exec_conf.isCUDAEnabled()):
             if hoomd.context.current.system_definition.getParticleData().getDomainDecomposition():
-                hoomd.context.msg.error("pair.eam is not supported in multi-processor simulations.\n\n")
+                hoomd.context.msg.error("pair.eam is not supported in multi-processor simulations on the GPU.\n\n")
                 raise RuntimeError("Error setting up pair potential.")
 
         # initialize the base class
@@ -89,8 +89,6 @@ class eam(force._force):
 
         #Load neighbor list to compute.
         self.cpp_force.set_neighbor_list(self.nlist.cpp_nlist);
-        if hoomd.context.exec_conf.isCUDAEnabled():
-            self.nlist.cpp_nlist.setStorageMode(_md.NeighborList.storageMode.full);
 
         hoomd.context.msg.notice(2, "Set r_cut = " + str(self.r_cut_new) + " from potential`s file '" +  str(file) + "'.\n");
 
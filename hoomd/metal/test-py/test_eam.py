@@ -24,6 +24,9 @@ class eam_tests(unittest.TestCase):
         # - generate system -
         snapshot = data.make_snapshot(N=4, box=data.boxdim(L=ltconst), particle_types=[type1, type2])
         system = init.read_snapshot(snapshot)
+        self.system = system
+        self.poslst = poslst
+        self.ltconst = ltconst
         for p in system.particles:
             p.position = poslst[p.tag]
             p.type = typelst[p.tag]
@@ -31,11 +34,13 @@ class eam_tests(unittest.TestCase):
         cwd = os.getcwd()
         # the unit test uses a potential, which is sparsed from G.Purja Pun & Y. Mishin, 2009
         tmpd = cwd + '/eamtemp/'
-        os.system('rm -rf ' + tmpd)
-        os.system('mkdir -p ' + tmpd)
         potf = tmpd + 'testpot'
-        with open(potf, 'w') as outf:
-            outf.write('test potential sparse from:\n Mishin-Ni-Al-2009.eam.alloy\n Alloy\n 2 Ni Al\n 20 0.250661 20 0.31436 6.28721\n 28 58.71 3.52 fcc\n -0.0225464 -1.76636 -2.37638 -2.58753 -2.56335 \n -2.44363 -2.1936 -1.69669 -0.881535 0.259267 \n 1.71214 3.47279 5.52768 7.84679 10.3946 \n 13.1387 16.0533 19.12 22.3271 25.6681 \n 0.166428 0.170459 0.167088 0.158941 0.148264 \n 0.134559 0.116655 0.0950843 0.0717676 0.0494264 \n 0.0305923 0.0166948 0.00778478 0.00291687 0.00076581 \n 9.6658e-05 8.84137e-07 0 0 0 \n 13 26.982 4.05 fcc\n -4.3767e-11 -1.6886 -2.24356 -2.61981 -2.8881 \n -3.03673 -3.07531 -3.14579 -3.15517 -3.04228 \n -2.80696 -2.44921 -1.96903 -1.36641 -0.641356 \n 0.206131 1.17605 2.2684 3.48319 4.82042 \n 0.396504 0.268377 0.182302 0.130397 0.104787 \n 0.09764 0.10114 0.10747 0.108814 0.097359 \n 0.0701286 0.0394937 0.0192524 0.00952344 0.00538008 \n 0.00357488 0.0027837 0.00202854 0.0010566 9.93586e-05 \n 0 1.45214 3.46822 4.73416 4.63266 \n 3.27018 1.42217 0.00246105 -0.578463 -0.528943 \n -0.314831 -0.217411 -0.216257 -0.18649 -0.098564 \n -0.021759 -0.000310685 0 0 0 \n 0 2016.46 1530.29 608.866 120.656 \n 8.56573 1.68568 0.0591469 -0.564815 -0.587964 \n -0.416922 -0.286477 -0.251829 -0.249993 -0.216214 \n -0.137026 -0.0706754 -0.0262716 -1.62953e-08 0 \n 0 10.7294 10.5529 7.42998 5.15814 \n 4.13394 3.26306 1.83395 0.548762 0.044061 \n -0.0987007 -0.134826 -0.151869 -0.205764 -0.215437 \n -0.169569 -0.0703696 0.0113375 0.0283944 0.00186361 \n')
+        if comm.get_rank() == 0:
+            os.system('rm -rf ' + tmpd)
+            os.system('mkdir -p ' + tmpd)
+            with open(potf, 'w') as outf:
+                outf.write('test potential sparse from:\n Mishin-Ni-Al-2009.eam.alloy\n Alloy\n 2 Ni Al\n 20 0.250661 20 0.31436 6.28721\n 28 58.71 3.52 fcc\n -0.0225464 -1.76636 -2.37638 -2.58753 -2.56335 \n -2.44363 -2.1936 -1.69669 -0.881535 0.259267 \n 1.71214 3.47279 5.52768 7.84679 10.3946 \n 13.1387 16.0533 19.12 22.3271 25.6681 \n 0.166428 0.170459 0.167088 0.158941 0.148264 \n 0.134559 0.116655 0.0950843 0.0717676 0.0494264 \n 0.0305923 0.0166948 0.00778478 0.00291687 0.00076581 \n 9.6658e-05 8.84137e-07 0 0 0 \n 13 26.982 4.05 fcc\n -4.3767e-11 -1.6886 -2.24356 -2.61981 -2.8881 \n -3.03673 -3.07531 -3.14579 -3.15517 -3.04228 \n -2.80696 -2.44921 -1.96903 -1.36641 -0.641356 \n 0.206131 1.17605 2.2684 3.48319 4.82042 \n 0.396504 0.268377 0.182302 0.130397 0.104787 \n 0.09764 0.10114 0.10747 0.108814 0.097359 \n 0.0701286 0.0394937 0.0192524 0.00952344 0.00538008 \n 0.00357488 0.0027837 0.00202854 0.0010566 9.93586e-05 \n 0 1.45214 3.46822 4.73416 4.63266 \n 3.27018 1.42217 0.00246105 -0.578463 -0.528943 \n -0.314831 -0.217411 -0.216257 -0.18649 -0.098564 \n -0.021759 -0.000310685 0 0 0 \n 0 2016.46 1530.29 608.866 120.656 \n 8.56573 1.68568 0.0591469 -0.564815 -0.587964 \n -0.416922 -0.286477 -0.251829 -0.249993 -0.216214 \n -0.137026 -0.0706754 -0.0262716 -1.62953e-08 0 \n 0 10.7294 10.5529 7.42998 5.15814 \n 4.13394 3.26306 1.83395 0.548762 0.044061 \n -0.0987007 -0.134826 -0.151869 -0.205764 -0.215437 \n -0.169569 -0.0703696 0.0113375 0.0283944 0.00186361 \n')
+        comm.barrier_all()
 
     # API test: class initialization
     def test_API(self):
@@ -45,8 +50,8 @@ class eam_tests(unittest.TestCase):
         nl = md.nlist.cell()
         metal.pair.eam(file=potf, type="Alloy", nlist=nl)
 
-    # Unit test: ensure that forces and energies compute correctly
-    def test_force(self):
+    # helper: compute the forces with one step and compare them to the reference values
+    def check_force(self):
         cwd = os.getcwd()
         tmpd = cwd + '/eamtemp/'
         potf = tmpd + 'testpot'
@@ -69,7 +74,27 @@ class eam_tests(unittest.TestCase):
         numpy.testing.assert_allclose(F, F_ref, rtol=1e-5)
         numpy.testing.assert_allclose(U, U_ref, rtol=1e-6)
 
-        os.system('rm -rf ' + tmpd)
+        comm.barrier_all()
+        if comm.get_rank() == 0:
+            os.system('rm -rf ' + tmpd)
+
+    # Unit test: ensure that forces and energies compute correctly
+    def test_force(self):
+        self.check_force()
+
+    # Unit test: the threaded force sweeps give the same forces
+    def test_force_threads(self):
+        option.set_num_threads(4)
+        self.check_force()
+
+    # Unit test: the forces do not change when the particles are spread over the domains of several ranks,
+    # the densities of the neighbors are then communicated to the ghost particles
+    def test_force_domains(self):
+        shift = 0.45 * self.ltconst
+        for p in self.system.particles:
+            pos = self.poslst[p.tag]
+            p.position = (pos[0] + shift, pos[1] + shift, pos[2] + shift)
+        self.check_force()
 
     # tearDown is called at the end of every test method
     def tearDown(self):
@@ -14,6 +14,7 @@
 #include "Initializers.h"
 #include "GetarInitializer.h"
 #include "GSDReader.h"
+#include "CheckpointReader.h"
 #include "Compute.h"
 #include "ComputeThermo.h"
 #include "CellList.h"
@@ -26,10 +27,12 @@
 #include "DCDDumpWriter.h"
 #include "GetarDumpWriter.h"
 #include "GSDDumpWriter.h"
+#include "CheckpointWriter.h"
 #include "Logger.h"
 #include "LogPlainTXT.h"
 #include "LogMatrix.h"
 #include "LogHDF5.h"
+#include "LogBinary.h"
 #include "CallbackAnalyzer.h"
 #include "Updater.h"
 #include "Integrator.h"
@@ -341,6 +344,7 @@ PYBIND11_MODULE(_hoomd, m)
 
     // initializers
     export_GSDReader(m);
+    export_CheckpointReader(m);
     getardump::export_GetarInitializer(m);
 
     // computes
@@ -363,10 +367,12 @@ PYBIND11_MODULE(_hoomd, m)
     export_DCDDumpWriter(m);
     getardump::export_GetarDumpWriter(m);
     export_GSDDumpWriter(m);
+    export_CheckpointWriter(m);
     export_Logger(m);
     export_LogPlainTXT(m);
     export_LogMatrix(m);
     export_LogHDF5(m);
+    export_LogBinary(m);
     export_CallbackAnalyzer(m);
     export_ParticleGroup(m);
 
@@ -48,6 +48,13 @@ mpcd::Communicator::Communicator(std::shared_ptr<mpcd::SystemData> system_data)
 
     m_exec_conf->msg->notice(5) << "Constructing MPCD Communicator" << endl;
 
+    // the cells are exchanged between grid neighbors, which requires aligned cut planes
+    if (m_decomposition->isStaggered())
+        {
+        m_exec_conf->msg->error() << "Staggered domain decompositions are not supported by the MPCD communicator" << std::endl;
+        throw std::runtime_error("Staggered domain decomposition");
+        }
+
     // allocate memory
     GPUArray<unsigned int> neighbors(neigh_max,m_exec_conf);
     m_neighbors.swap(neighbors);
@@ -0,0 +1,92 @@
+# -*- coding: iso-8859-1 -*-
+
+from hoomd import *
+import hoomd;
+import unittest
+import os
+import numpy
+import shutil
+import tempfile
+
+# unit tests for dump.checkpoint and init.read_checkpoint
+class dmp_checkpoint_tests (unittest.TestCase):
+    def setUp(self):
+        context.initialize()
+        if comm.get_rank() == 0:
+            self.tmp_dir = tempfile.mkdtemp();
+        else:
+            self.tmp_dir = "invalid";
+        self.prefix = os.path.join(self.tmp_dir, 'restart');
+
+        snapshot = data.make_snapshot(N=4, box=data.boxdim(Lx=10, Ly=20, Lz=30, xy=0.5), particle_types=['A', 'B'], bond_types=['polymer']);
+        if comm.get_rank() == 0:
+            snapshot.particles.position[:] = [[0,1,2], [1,2,3], [-3,-4,-5], [-1,-2,-3]];
+            snapshot.particles.velocity[:] = [[10,11,12], [11,12,13], [12,13,14], [13,14,15]];
+            snapshot.particles.typeid[:] = [0, 1, 1, 0];
+            snapshot.particles.image[:] = [[1,2,3], [0,0,0], [-1,0,4], [0,-5,0]];
+            snapshot.particles.charge[:] = [0.5, -0.5, 1.5, -1.5];
+            snapshot.bonds.resize(2);
+            snapshot.bonds.group[:] = [[0,1], [2,3]];
+        self.s = init.read_snapshot(snapshot);
+
+    # tests basic creation of the dump
+    def test(self):
+        dump.checkpoint(prefix=self.prefix, period=10);
+        run(10);
+
+    # tests that a restored system has exactly the state that was written
+    def test_read_checkpoint(self):
+        ckpt = dump.checkpoint(prefix=self.prefix, period=None);
+        run(3);
+        ckpt.write_restart();
+        snap = self.s.take_snapshot(all=True, dtype='double');
+
+        context.initialize();
+        s = init.read_checkpoint(self.prefix);
+        snap_read = s.take_snapshot(all=True, dtype='double');
+
+        self.assertEqual(get_step(), 3);
+        if comm.get_rank() == 0:
+            self.assertEqual(snap_read.particles.N, snap.particles.N);
+            self.assertEqual(snap_read.particles.types, snap.particles.types);
+            numpy.testing.assert_array_equal(snap_read.particles.typeid, snap.particles.typeid);
+            numpy.testing.assert_array_equal(snap_read.particles.position, snap.particles.position);
+            numpy.testing.assert_array_equal(snap_read.particles.velocity, snap.particles.velocity);
+            numpy.testing.assert_array_equal(snap_read.particles.image, snap.particles.image);
+            numpy.testing.assert_array_equal(snap_read.particles.charge, snap.particles.charge);
+            self.assertEqual(snap_read.box.xy, snap.box.xy);
+            self.assertEqual(snap_read.box.Lz, snap.box.Lz);
+            self.assertEqual(snap_read.bonds.N, snap.bonds.N);
+            self.assertEqual(snap_read.bonds.types, snap.bonds.types);
+            numpy.testing.assert_array_equal(snap_read.bonds.group, snap.bonds.group);
+
+    # tests that a new checkpoint removes the files of the previous one only after its manifest is written
+    def test_replace_checkpoint(self):
+        ckpt = dump.checkpoint(prefix=self.prefix, period=None);
+        run(3);
+        ckpt.write_restart();
+        run(2);
+        ckpt.write_restart();
+
+        if comm.get_rank() == 0:
+            files = sorted(os.listdir(self.tmp_dir));
+            expected = ['restart.5.%d.bin' % r for r in range(comm.get_num_ranks())] + ['restart.manifest'];
+            self.assertEqual(files, sorted(expected));
+
+        context.initialize();
+        init.read_checkpoint(self.prefix);
+        self.assertEqual(get_step(), 5);
+
+    # tests that a missing checkpoint is an error
+    def test_read_checkpoint_missing(self):
+        context.initialize();
+        self.assertRaises(RuntimeError, init.read_checkpoint, self.prefix);
+
+    def tearDown(self):
+        comm.barrier_all();
+        if comm.get_rank() == 0:
+            shutil.rmtree(self.tmp_dir);
+        comm.barrier_all();
+
+if __name__ == '__main__':
+    unittest.main(argv = ['test.py', '-v'])
@@ -12,7 +12,7 @@ import tempfile
 class dmp_dcd_tests (unittest.TestCase):
     def setUp(self):
         print
-        init.create_lattice(lattice.sc(a=2.1878096788957757),n=[5,5,4]); #target a packing fraction of 0.05
+        self.s = init.create_lattice(lattice.sc(a=2.1878096788957757),n=[5,5,4]); #target a packing fraction of 0.05
 
         context.current.sorter.set_params(grid=8)
 
@@ -65,6 +65,71 @@ class dmp_dcd_tests (unittest.TestCase):
         if (comm.get_rank() == 0):
             os.remove(self.tmp_file)
 
+    # tests that parallel output writes the same frames as serial output
+    def test_parallel(self):
+        if comm.get_rank() == 0:
+            tmp = tempfile.mkstemp(suffix='.test.dcd');
+            serial_file = tmp[1]+'.tmp';
+        else:
+            serial_file = "invalid";
+
+        typeA = group.type('A');
+        dump.dcd(filename=self.tmp_file, group=typeA, period=100, unwrap_full=True, parallel=True);
+        dump.dcd(filename=serial_file, group=typeA, period=100, unwrap_full=True);
+        run(201)
+
+        if (comm.get_rank() == 0):
+            with open(self.tmp_file, 'rb') as f:
+                parallel_data = f.read()
+            with open(serial_file, 'rb') as f:
+                serial_data = f.read()
+
+            # the header contains the creation time in bytes 180 to 260
+            self.assertEqual(len(parallel_data), len(serial_data));
+            self.assertEqual(parallel_data[:180], serial_data[:180]);
+            self.assertEqual(parallel_data[260:], serial_data[260:]);
+            os.remove(self.tmp_file)
+            os.remove(serial_file)
+
+    # tests that parallel output follows changes of the group members
+    def test_parallel_group_update(self):
+        if comm.get_rank() == 0:
+            tmp = tempfile.mkstemp(suffix='.test.dcd');
+            serial_file = tmp[1]+'.tmp';
+        else:
+            serial_file = "invalid";
+
+        self.s.particles.types.add('B');
+        self.s.particles[0].type = 'B';
+        typeA = group.type('A', update=True);
+        dump.dcd(filename=self.tmp_file, group=typeA, period=100, unwrap_full=True, parallel=True);
+        dump.dcd(filename=serial_file, group=typeA, period=100, unwrap_full=True);
+        run(101)
+
+        # exchange a member, the number of members stays the same
+        self.s.particles[0].type = 'A';
+        self.s.particles[99].type = 'B';
+        typeA.force_update();
+        run(100)
+
+        if (comm.get_rank() == 0):
+            with open(self.tmp_file, 'rb') as f:
+                parallel_data = f.read()
+            with open(serial_file, 'rb') as f:
+                serial_data = f.read()
+
+            self.assertEqual(len(parallel_data), len(serial_data));
+            self.assertEqual(parallel_data[260:], serial_data[260:]);
+            os.remove(serial_file)
+
+        # the DCD file format requires a constant number of members
+        self.s.particles[99].type = 'A';
+        typeA.force_update();
+        self.assertRaises(RuntimeError, run, 100);
+
+        if (comm.get_rank() == 0):
+            os.remove(self.tmp_file)
+
     # test disable/enable
     def test_enable_disable(self):
         dcd = dump.dcd(filename=self.tmp_file, period=100);
@@ -95,6 +95,51 @@ class gsd_write_tests (unittest.TestCase):
         if comm.get_rank() == 0:
             self.assertRaises(RuntimeError, data.gsd_snapshot, self.tmp_file, frame=5);
 
+    # tests frames written in the background
+    def test_buffer_frames(self):
+        dump.gsd(filename=self.tmp_file, group=group.all(), period=1, overwrite=True, buffer_frames=2);
+        run(5);
+        # all frames are written at the end of the run
+        data.gsd_snapshot(self.tmp_file, frame=4);
+        if comm.get_rank() == 0:
+            self.assertRaises(RuntimeError, data.gsd_snapshot, self.tmp_file, frame=5);
+
+        run(3);
+        data.gsd_snapshot(self.tmp_file, frame=7);
+
+    # tests truncate with frames written in the background
+    def test_buffer_frames_truncate(self):
+        dump.gsd(filename=self.tmp_file, group=group.all(), period=1, truncate=True, overwrite=True, buffer_frames=2);
+        run(5);
+        snap = data.gsd_snapshot(self.tmp_file, frame=0);
+        if comm.get_rank() == 0:
+            self.assertRaises(RuntimeError, data.gsd_snapshot, self.tmp_file, frame=1);
+
+    # tests quantized positions
+    def test_position_bits(self):
+        dump.gsd(filename=self.tmp_file, group=group.all(), period=1, overwrite=True, position_bits=16, keyframe_period=2);
+        run(3);
+
+        # frames 0 and 2 are keyframes, frame 1 and 3 are deltas
+        for frame in range(4):
+            snap = data.gsd_snapshot(self.tmp_file, frame=frame);
+            if comm.get_rank() == 0:
+                numpy.testing.assert_allclose(snap.particles.position, self.snapshot.particles.position, atol=30/2**16);
+
+        self.assertRaises(ValueError, dump.gsd, filename=self.tmp_file, group=group.all(), period=1, position_bits=32);
+
+    # tests that the quantized positions of a frame take precedence over the full positions of frame 0
+    def test_position_bits_append(self):
+        dump.gsd(filename=self.tmp_file, group=group.all(), period=None, overwrite=True, time_step=0);
+
+        self.s.particles[0].position = (2, 3, 4);
+        dump.gsd(filename=self.tmp_file, group=group.all(), period=None, position_bits=16, time_step=1);
+
+        snap = data.gsd_snapshot(self.tmp_file, frame=1);
+        if comm.get_rank() == 0:
+            numpy.testing.assert_allclose(snap.particles.position[0], [2, 3, 4], atol=30/2**16);
+            numpy.testing.assert_allclose(snap.particles.position[1:], self.snapshot.particles.position[1:], atol=30/2**16);
+
     # tests with phase
     def test_phase(self):
         dump.gsd(filename=self.tmp_file, group=group.all(), period=1, phase=0, overwrite=True);
@@ -147,6 +192,27 @@ class gsd_write_tests (unittest.TestCase):
         if comm.get_rank() == 0:
             self.assertRaises(RuntimeError, data.gsd_snapshot, self.tmp_file, frame=1);
 
+    # test that topology written only when it changes reads back in every frame
+    def test_dynamic_topology(self):
+        dump.gsd(filename=self.tmp_file, group=group.all(), period=1, dynamic=['topology'], overwrite=True);
+        run(2);
+        self.s.bonds.remove(1);
+        run(2);
+        self.s.pairs.remove(0);
+        self.s.pairs.remove(1);
+        run(1);
+
+        for frame, bonds_N, pairs_N in [(0, 2, 2), (1, 2, 2), (2, 1, 2), (3, 1, 2), (4, 1, 0)]:
+            snap = data.gsd_snapshot(self.tmp_file, frame=frame);
+            if comm.get_rank() == 0:
+                self.assertEqual(snap.bonds.N, bonds_N);
+                self.assertEqual(snap.pairs.N, pairs_N);
+                self.assertEqual(snap.dihedrals.N, self.snapshot.dihedrals.N);
+                numpy.testing.assert_array_equal(snap.dihedrals.group, self.snapshot.dihedrals.group);
+
+        if comm.get_rank() == 0:
+            numpy.testing.assert_array_equal(snap.bonds.group, [self.snapshot.bonds.group[0]]);
+
     # test write file
     def test_write_immediate(self):
         dump.gsd(filename=self.tmp_file, group=group.all(), period=None, time_step=1000, overwrite=True);
@@ -165,6 +231,23 @@ class gsd_write_tests (unittest.TestCase):
         if comm.get_rank() == 0:
             self.assertRaises(RuntimeError, init.read_gsd, self.tmp_file, frame=5);
 
+    # tests init.read_gsd with the particles read by all ranks
+    def test_read_gsd_distributed(self):
+        dump.gsd(filename=self.tmp_file, group=group.all(), period=None, overwrite=True, dynamic=['momentum']);
+        snap = self.s.take_snapshot(all=True);
+
+        context.initialize();
+        s = init.read_gsd(filename=self.tmp_file, distributed=True);
+        snap_read = s.take_snapshot(all=True);
+        if comm.get_rank() == 0:
+            self.assertEqual(snap_read.particles.N, snap.particles.N);
+            numpy.testing.assert_array_equal(snap_read.particles.typeid, snap.particles.typeid);
+            numpy.testing.assert_allclose(snap_read.particles.position, snap.particles.position, rtol=1e-6);
+            numpy.testing.assert_allclose(snap_read.particles.velocity, snap.particles.velocity, rtol=1e-6);
+            numpy.testing.assert_array_equal(snap_read.particles.image, snap.particles.image);
+            self.assertEqual(snap_read.bonds.N, snap.bonds.N);
+            numpy.testing.assert_array_equal(snap_read.bonds.group, snap.bonds.group);
+
     # tests init.read_gsd time_step
     def test_read_gsd_time_step(self):
         dump.gsd(filename=self.tmp_file, group=group.all(), period=1, overwrite=True);
@@ -280,6 +363,69 @@ class gsd_read_tests (unittest.TestCase):
         self.s = init.read_snapshot(self.snapshot);
         context.current.sorter.set_params(grid=8)
 
+    # tests particle data written by all ranks
+    def test_parallel(self):
+        dump.gsd(filename=self.tmp_file, group=group.all(), period=None, overwrite=True, parallel=True);
+
+        snap = data.gsd_snapshot(self.tmp_file, frame=0);
+        if comm.get_rank() == 0:
+            self.assertEqual(snap.particles.N, self.snapshot.particles.N);
+            self.assertEqual(snap.particles.types, self.snapshot.particles.types);
+
+            numpy.testing.assert_array_equal(snap.particles.typeid, self.snapshot.particles.typeid);
+            numpy.testing.assert_array_equal(snap.particles.mass, self.snapshot.particles.mass);
+            numpy.testing.assert_array_equal(snap.particles.charge, self.snapshot.particles.charge);
+            numpy.testing.assert_array_equal(snap.particles.diameter, self.snapshot.particles.diameter);
+            numpy.testing.assert_array_equal(snap.particles.body, self.snapshot.particles.body);
+            numpy.testing.assert_array_equal(snap.particles.moment_inertia, self.snapshot.particles.moment_inertia);
+            numpy.testing.assert_array_equal(snap.particles.position, self.snapshot.particles.position);
+            numpy.testing.assert_array_equal(snap.particles.orientation, self.snapshot.particles.orientation);
+            numpy.testing.assert_array_equal(snap.particles.velocity, self.snapshot.particles.velocity);
+            numpy.testing.assert_array_equal(snap.particles.angmom, self.snapshot.particles.angmom);
+            numpy.testing.assert_array_equal(snap.particles.image, self.snapshot.particles.image);
+
+            self.assertEqual(snap.bonds.N, self.snapshot.bonds.N);
+            numpy.testing.assert_array_equal(snap.bonds.group, self.snapshot.bonds.group);
+
+    # tests every chunk of several frames written by all ranks
+    def test_parallel_frames(self):
+        dump.gsd(filename=self.tmp_file, group=group.all(), period=1, overwrite=True, parallel=True,
+                 dynamic=['attribute', 'property', 'momentum']);
+
+        expected = [];
+        for f in range(3):
+            snap = self.s.take_snapshot(all=True);
+            if comm.get_rank() == 0:
+                snap.particles.position[:] = self.snapshot.particles.position + 0.1*f;
+                snap.particles.typeid[:] = (self.snapshot.particles.typeid + f) % 2;
+                snap.particles.mass[:] = self.snapshot.particles.mass + f;
+                snap.particles.charge[:] = self.snapshot.particles.charge - f;
+                snap.particles.diameter[:] = self.snapshot.particles.diameter + 2*f;
+                snap.particles.moment_inertia[:] = self.snapshot.particles.moment_inertia + f;
+                snap.particles.orientation[:] = self.snapshot.particles.orientation + f;
+                snap.particles.velocity[:] = self.snapshot.particles.velocity - f;
+                snap.particles.angmom[:] = self.snapshot.particles.angmom + 3*f;
+                snap.particles.image[:] = self.snapshot.particles.image + f;
+            self.s.restore_snapshot(snap);
+            expected.append(snap);
+            run(1);
+
+        for f in range(3):
+            snap = data.gsd_snapshot(self.tmp_file, frame=f);
+            if comm.get_rank() == 0:
+                self.assertEqual(snap.particles.N, self.snapshot.particles.N);
+                numpy.testing.assert_array_equal(snap.particles.typeid, expected[f].particles.typeid);
+                numpy.testing.assert_array_equal(snap.particles.mass, expected[f].particles.mass);
+                numpy.testing.assert_array_equal(snap.particles.charge, expected[f].particles.charge);
+                numpy.testing.assert_array_equal(snap.particles.diameter, expected[f].particles.diameter);
+                numpy.testing.assert_array_equal(snap.particles.body, expected[f].particles.body);
+                numpy.testing.assert_array_equal(snap.particles.moment_inertia, expected[f].particles.moment_inertia);
+                numpy.testing.assert_allclose(snap.particles.position, expected[f].particles.position, rtol=1e-6);
+                numpy.testing.assert_array_equal(snap.particles.orientation, expected[f].particles.orientation);
+                numpy.testing.assert_array_equal(snap.particles.velocity, expected[f].particles.velocity);
+                numpy.testing.assert_array_equal(snap.particles.angmom, expected[f].particles.angmom);
+                numpy.testing.assert_array_equal(snap.particles.image, expected[f].particles.image);
+
     # tests data.gsd_snapshot
     def test_gsd_snapshot(self):
         dump.gsd(filename=self.tmp_file, group=group.all(), period=None, overwrite=True);
@@ -0,0 +1,81 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+// this include is necessary to get MPI included before anything else to support intel MPI
+#include "hoomd/ExecutionConfiguration.h"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+#include "hoomd/BackgroundWriter.h"
+
+using namespace std;
+
+/*! \file test_background_writer.cc
+    \brief Unit tests for BackgroundWriter
+    \ingroup unit_tests
+*/
+
+#include "upp11_config.h"
+HOOMD_UP_MAIN();
+
+//! Check that the tasks run in order and flush() waits for them
+UP_TEST( BackgroundWriter_order )
+    {
+    std::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    BackgroundWriter writer(exec_conf, 2);
+
+    std::vector<unsigned int> written;
+    for (unsigned int i = 0; i < 10; i++)
+        writer.queue([&written, i]{ written.push_back(i); });
+    writer.flush();
+
+    UP_ASSERT_EQUAL(written.size(), (size_t)10);
+    for (unsigned int i = 0; i < 10; i++)
+        UP_ASSERT_EQUAL(written[i], i);
+
+    // the thread can be restarted after it was stopped
+    writer.stop();
+    writer.queue([&written]{ written.push_back(10); });
+    writer.flush();
+    UP_ASSERT_EQUAL(written.size(), (size_t)11);
+    }
+
+//! Check that errors are printed and raised on the caller's thread
+UP_TEST( BackgroundWriter_error )
+    {
+    std::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    ostringstream error_stream;
+    exec_conf->msg->setErrorStream(error_stream);
+    BackgroundWriter writer(exec_conf, 3);
+
+    // hold the writer until all tasks are queued, so that queue() does not raise the error
+    std::atomic<bool> go(false);
+    bool in_writer_thread = false;
+    bool notice_is_null = false;
+    unsigned int n_written = 0;
+    writer.queue([&go]{ while (! go) std::this_thread::yield(); });
+    writer.queue([&]
+        {
+        in_writer_thread = BackgroundWriter::isWriterThread();
+        notice_is_null = &writer.notice(0) != &exec_conf->msg->notice(0);
+        throw runtime_error("test: write failed");
+        });
+    writer.queue([&n_written]{ n_written++; });
+    go = true;
+
+    UP_ASSERT_EXCEPTION(runtime_error, [&]{ writer.flush(); });
+    UP_ASSERT(in_writer_thread);
+    UP_ASSERT(notice_is_null);
+    UP_ASSERT(! BackgroundWriter::isWriterThread());
+    UP_ASSERT(error_stream.str().find("test: write failed") != string::npos);
+
+    // the tasks after the error are discarded and the error is raised once
+    UP_ASSERT_EQUAL(n_written, (unsigned int)0);
+    writer.flush();
+    }
@@ -0,0 +1,114 @@
+// Copyright (c) 2009-2019 The Regents of the University of Michigan
+// This file is part of the HOOMD-blue project, released under the BSD 3-Clause License.
+
+
+#ifdef ENABLE_MPI
+
+// this has to be included after naming the test module
+#include "upp11_config.h"
+HOOMD_UP_MAIN();
+
+#include "hoomd/ExecutionConfiguration.h"
+#include "hoomd/DomainDecomposition.h"
+
+#include <memory>
+#include <vector>
+
+/*! \file test_domain_decomposition.cc
+    \brief Unit tests for the mapping of the DomainDecomposition grid onto the ranks
+    \ingroup unit_tests
+*/
+
+using namespace std;
+
+//! Get the cartesian ranks lookup table of a decomposition
+std::vector<unsigned int> get_cart_ranks(std::shared_ptr<DomainDecomposition> dd, unsigned int nranks)
+    {
+    ArrayHandle<unsigned int> h_cart_ranks(dd->getCartRanks(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_cart_ranks_inv(dd->getInverseCartRanks(), access_location::host, access_mode::read);
+
+    std::vector<unsigned int> cart_ranks(h_cart_ranks.data, h_cart_ranks.data + nranks);
+
+    // the lookup tables are inverse permutations of each other
+    for (unsigned int i = 0; i < nranks; i++)
+        {
+        UP_ASSERT(cart_ranks[i] < nranks);
+        UP_ASSERT_EQUAL(h_cart_ranks_inv.data[cart_ranks[i]], i);
+        }
+    return cart_ranks;
+    }
+
+//! Test that only automatic grids map the ranks of a node onto a block, unless requested for a given grid
+/*! The decompositions are constructed on halves of the world communicator with interleaved ranks, so that the ranks
+    of a node in the split communicator differ from the ones in the world communicator.
+*/
+UP_TEST( DomainDecomposition_twolevel_split )
+    {
+    // this test needs to be run on eight processors
+    int size, world_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    UP_ASSERT_EQUAL(size,8);
+
+    MPI_Comm split_comm;
+    MPI_Comm_split(MPI_COMM_WORLD, world_rank % 2, world_rank, &split_comm);
+
+        {
+        std::shared_ptr<MPIConfiguration> mpi_conf(new MPIConfiguration(split_comm));
+        std::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU,
+            std::vector<int>(), false, false, mpi_conf));
+        UP_ASSERT_EQUAL(exec_conf->getNRanks(), (unsigned int)4);
+        unsigned int nranks = exec_conf->getNRanks();
+
+        Scalar3 L = make_scalar3(10.0, 20.0, 40.0);
+
+        // automatic grid with the two-level mapping
+        std::shared_ptr<DomainDecomposition> dd_auto(new DomainDecomposition(exec_conf, L, 0, 0, 0, true));
+        uint3 grid = dd_auto->getGridSize();
+        UP_ASSERT_EQUAL(grid.x*grid.y*grid.z, nranks);
+        std::vector<unsigned int> auto_ranks = get_cart_ranks(dd_auto, nranks);
+
+        // the one-level mapping is sequential
+        std::shared_ptr<DomainDecomposition> dd_one(new DomainDecomposition(exec_conf, L, 0, 0, 0, false));
+        UP_ASSERT(!dd_one->isTwoLevel());
+        std::vector<unsigned int> one_ranks = get_cart_ranks(dd_one, nranks);
+        for (unsigned int i = 0; i < nranks; i++)
+            UP_ASSERT_EQUAL(one_ranks[i], i);
+
+        // the same grid given by the user keeps the sequential order
+        std::shared_ptr<DomainDecomposition> dd_user(new DomainDecomposition(exec_conf, L, grid.x, grid.y, grid.z, true));
+        UP_ASSERT(!dd_user->isTwoLevel());
+        uint3 user_grid = dd_user->getGridSize();
+        UP_ASSERT_EQUAL(user_grid.x, grid.x);
+        UP_ASSERT_EQUAL(user_grid.y, grid.y);
+        UP_ASSERT_EQUAL(user_grid.z, grid.z);
+        std::vector<unsigned int> user_ranks = get_cart_ranks(dd_user, nranks);
+        for (unsigned int i = 0; i < nranks; i++)
+            UP_ASSERT_EQUAL(user_ranks[i], i);
+
+        // and so do the fractions
+        std::vector<Scalar> fxs(grid.x-1, Scalar(1.0)/Scalar(grid.x));
+        std::vector<Scalar> fys(grid.y-1, Scalar(1.0)/Scalar(grid.y));
+        std::vector<Scalar> fzs(grid.z-1, Scalar(1.0)/Scalar(grid.z));
+        std::shared_ptr<DomainDecomposition> dd_frac(new DomainDecomposition(exec_conf, L, fxs, fys, fzs, true));
+        UP_ASSERT(!dd_frac->isTwoLevel());
+        std::vector<unsigned int> frac_ranks = get_cart_ranks(dd_frac, nranks);
+        for (unsigned int i = 0; i < nranks; i++)
+            UP_ASSERT_EQUAL(frac_ranks[i], i);
+
+        // unless the two-level mapping is requested for the given grid
+        std::shared_ptr<DomainDecomposition> dd_fixed(new DomainDecomposition(exec_conf, L, grid.x, grid.y, grid.z, true, true));
+        UP_ASSERT_EQUAL(dd_fixed->isTwoLevel(), dd_auto->isTwoLevel());
+        std::vector<unsigned int> fixed_ranks = get_cart_ranks(dd_fixed, nranks);
+        for (unsigned int i = 0; i < nranks; i++)
+            UP_ASSERT_EQUAL(fixed_ranks[i], auto_ranks[i]);
+
+        // the request has no effect without the two-level decomposition
+        std::shared_ptr<DomainDecomposition> dd_fixed_one(new DomainDecomposition(exec_conf, L, grid.x, grid.y, grid.z, false, true));
+        UP_ASSERT(!dd_fixed_one->isTwoLevel());
+        }
+
+    MPI_Comm_free(&split_comm);
+    }
+
+#endif // ENABLE_MPI
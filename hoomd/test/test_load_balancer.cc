@@ -359,6 +359,137 @@ void test_load_balancer_ghost(std::shared_ptr<ExecutionConfiguration> exec_conf,
     UP_ASSERT_EQUAL(pdata->getOwnerRank(7), di(1,0,1));
     }
 
+template<class LB>
+void test_load_balancer_time_weights(std::shared_ptr<ExecutionConfiguration> exec_conf)
+{
+    // this test needs to be run on eight processors
+    int size;
+    MPI_Comm_size(exec_conf->getHOOMDWorldMPICommunicator(), &size);
+    UP_ASSERT_EQUAL(size,8);
+
+    // one particle in the middle of every domain
+    std::shared_ptr<SystemDefinition> sysdef(new SystemDefinition(8,           // number of particles
+                                                             BoxDim(2.0), // box dimensions
+                                                             1,           // number of particle types
+                                                             0,           // number of bond types
+                                                             0,           // number of angle types
+                                                             0,           // number of dihedral types
+                                                             0,           // number of dihedral types
+                                                             exec_conf));
+
+    std::shared_ptr<ParticleData> pdata(sysdef->getParticleData());
+
+    pdata->setPosition(0, make_scalar3(-0.5,-0.5,-0.5),false);
+    pdata->setPosition(1, make_scalar3( 0.5,-0.5,-0.5),false);
+    pdata->setPosition(2, make_scalar3(-0.5, 0.5,-0.5),false);
+    pdata->setPosition(3, make_scalar3( 0.5, 0.5,-0.5),false);
+    pdata->setPosition(4, make_scalar3(-0.5,-0.5, 0.5),false);
+    pdata->setPosition(5, make_scalar3( 0.5,-0.5, 0.5),false);
+    pdata->setPosition(6, make_scalar3(-0.5, 0.5, 0.5),false);
+    pdata->setPosition(7, make_scalar3( 0.5, 0.5, 0.5),false);
+
+    SnapshotParticleData<Scalar> snap(8);
+    pdata->takeSnapshot(snap);
+
+    // initialize a 2x2x2 domain decomposition on processor with rank 0
+    std::vector<Scalar> fxs(1), fys(1), fzs(1);
+    fxs[0] = Scalar(0.5);
+    fys[0] = Scalar(0.5);
+    fzs[0] = Scalar(0.5);
+    std::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, pdata->getBox().getL(), fxs, fys, fzs));
+    std::shared_ptr<Communicator> comm(new Communicator(sysdef, decomposition));
+    pdata->setDomainDecomposition(decomposition);
+
+    pdata->initializeFromSnapshot(snap);
+    UP_ASSERT_EQUAL(pdata->getN(), 1);
+
+    std::shared_ptr<LoadBalancer> lb(new LB(sysdef,decomposition));
+    lb->setCommunicator(comm);
+
+    // the particle counts are balanced
+    lb->update(0);
+    MY_CHECK_CLOSE(decomposition->getCumulativeFractions(0)[1], 0.5, tol_small);
+
+    // the particles in the lower half in x are three times as expensive
+    lb->setTimeWeights(true);
+    lb->update(1);
+    comm->addComputeTime(decomposition->getGridPos().x == 0 ? 3000 : 1000);
+    lb->update(2);
+
+    // the lower domains shrink by the maximum rescaling, the other dimensions remain balanced
+    MY_CHECK_CLOSE(decomposition->getCumulativeFractions(0)[1], 0.475, tol_small);
+    MY_CHECK_CLOSE(decomposition->getCumulativeFractions(1)[1], 0.5, tol_small);
+    MY_CHECK_CLOSE(decomposition->getCumulativeFractions(2)[1], 0.5, tol_small);
+    UP_ASSERT_EQUAL(pdata->getN(), 1);
+}
+
+template<class LB>
+void test_load_balancer_staggered(std::shared_ptr<ExecutionConfiguration> exec_conf)
+{
+    // this test needs to be run on eight processors
+    int size;
+    MPI_Comm_size(exec_conf->getHOOMDWorldMPICommunicator(), &size);
+    UP_ASSERT_EQUAL(size,8);
+
+    std::shared_ptr<SystemDefinition> sysdef(new SystemDefinition(16,          // number of particles
+                                                             BoxDim(2.0), // box dimensions
+                                                             1,           // number of particle types
+                                                             0,           // number of bond types
+                                                             0,           // number of angle types
+                                                             0,           // number of dihedral types
+                                                             0,           // number of dihedral types
+                                                             exec_conf));
+
+    std::shared_ptr<ParticleData> pdata(sysdef->getParticleData());
+
+    // the particles gather at low y in the lower x slab and at high y in the upper x slab
+    const Scalar z[2] = {-0.5, 0.5};
+    for (unsigned int k=0; k < 2; ++k)
+        {
+        pdata->setPosition(8*k+0, make_scalar3(-0.5,-0.5,z[k]),false);
+        pdata->setPosition(8*k+1, make_scalar3(-0.5,-0.6,z[k]),false);
+        pdata->setPosition(8*k+2, make_scalar3(-0.5,-0.7,z[k]),false);
+        pdata->setPosition(8*k+3, make_scalar3(-0.5, 0.5,z[k]),false);
+        pdata->setPosition(8*k+4, make_scalar3( 0.5,-0.5,z[k]),false);
+        pdata->setPosition(8*k+5, make_scalar3( 0.5, 0.5,z[k]),false);
+        pdata->setPosition(8*k+6, make_scalar3( 0.5, 0.6,z[k]),false);
+        pdata->setPosition(8*k+7, make_scalar3( 0.5, 0.7,z[k]),false);
+        }
+
+    SnapshotParticleData<Scalar> snap(16);
+    pdata->takeSnapshot(snap);
+
+    // initialize a 2x2x2 domain decomposition on processor with rank 0
+    std::vector<Scalar> fxs(1), fys(1), fzs(1);
+    fxs[0] = Scalar(0.5);
+    fys[0] = Scalar(0.5);
+    fzs[0] = Scalar(0.5);
+    std::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, pdata->getBox().getL(), fxs, fys, fzs));
+    decomposition->setStaggered(true);
+    std::shared_ptr<Communicator> comm(new Communicator(sysdef, decomposition));
+    pdata->setDomainDecomposition(decomposition);
+
+    pdata->initializeFromSnapshot(snap);
+
+    std::shared_ptr<LoadBalancer> lb(new LB(sysdef,decomposition));
+    lb->setCommunicator(comm);
+    lb->update(0);
+
+    // both slabs hold the same load, but the y cuts move in opposite directions by the maximum rescaling
+    const uint3 my_pos = decomposition->getGridPos();
+    MY_CHECK_CLOSE(decomposition->getCumulativeFractions(0)[1], 0.5, tol_small);
+    MY_CHECK_CLOSE(decomposition->getCumulativeFractions(1)[1], my_pos.x == 0 ? 0.475 : 0.525, tol_small);
+    MY_CHECK_CLOSE(decomposition->getCumulativeFractions(2)[1], 0.5, tol_small);
+
+    // the local box follows the cut of its slab
+    const Scalar3 L = pdata->getBox().getL();
+    if (my_pos.x == 0)
+        MY_CHECK_CLOSE(L.y, my_pos.y == 0 ? 0.95 : 1.05, tol_small);
+    else
+        MY_CHECK_CLOSE(L.y, my_pos.y == 0 ? 1.05 : 0.95, tol_small);
+    UP_ASSERT_EQUAL(pdata->getN(), (my_pos.x == my_pos.y) ? 3 : 1);
+}
+
 //! Tests basic particle redistribution
 UP_TEST( LoadBalancer_test_basic)
     {
@@ -395,6 +526,20 @@ UP_TEST( LoadBalancer_test_ghost)
     test_load_balancer_ghost<LoadBalancer>(exec_conf, BoxDim(1.0,-.6,.7,.5));
     }
 
+//! Tests balancing of the measured compute time
+UP_TEST( LoadBalancer_test_time_weights)
+    {
+    std::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    test_load_balancer_time_weights<LoadBalancer>(exec_conf);
+    }
+
+//! Tests balancing of a staggered decomposition
+UP_TEST( LoadBalancer_test_staggered)
+    {
+    std::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    test_load_balancer_staggered<LoadBalancer>(exec_conf);
+    }
+
 #ifdef ENABLE_CUDA
 //! Tests basic particle redistribution on the GPU
 UP_TEST( LoadBalancerGPU_test_basic)
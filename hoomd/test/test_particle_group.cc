@@ -223,6 +223,53 @@ UP_TEST( ParticleGroup_sort_test )
     }
     }
 
+//! Checks that ParticleGroup is updated in place when the particles are permuted
+UP_TEST( ParticleGroup_permutation_test )
+    {
+    std::shared_ptr<SystemDefinition> sysdef = create_sysdef();
+    std::shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+
+    std::shared_ptr<ParticleSelector> selector04(new ParticleSelectorTag(sysdef, 0, 4));
+    ParticleGroup tags04(sysdef, selector04);
+    CHECK_EQUAL_UINT(tags04.getNumMembers(), 5);
+
+    // reverse the particle order
+    std::vector<unsigned int> order(pdata->getN());
+    for (unsigned int i = 0; i < pdata->getN(); i++)
+        order[i] = pdata->getN() - 1 - i;
+
+    Scalar3 pos_tag1 = pdata->getPosition(1);
+    pdata->applyPermutation(order.data());
+
+    // the particle data has been reordered consistently
+        {
+        ArrayHandle<unsigned int> h_tag(pdata->getTags(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_rtag(pdata->getRTags(), access_location::host, access_mode::read);
+        for (unsigned int i = 0; i < pdata->getN(); i++)
+            {
+            CHECK_EQUAL_UINT(h_tag.data[i], pdata->getN() - 1 - i);
+            CHECK_EQUAL_UINT(h_rtag.data[h_tag.data[i]], i);
+            }
+        }
+    MY_CHECK_CLOSE(pdata->getPosition(1).y, pos_tag1.y, tol);
+
+    // verify that the group has updated
+    CHECK_EQUAL_UINT(tags04.getNumMembers(), 5);
+    for (unsigned int i = 0; i < 5; i++)
+        {
+        CHECK_EQUAL_UINT(tags04.getMemberTag(i), i);
+        // indices are in sorted order (tags 0-4 are particles 9-5)
+        CHECK_EQUAL_UINT(tags04.getMemberIndex(i), i + 5);
+        }
+    for (unsigned int i = 0; i < pdata->getN(); i++)
+        {
+        if (i >= 5)
+            UP_ASSERT(tags04.isMember(i));
+        else
+            UP_ASSERT(!tags04.isMember(i));
+        }
+    }
+
 //! Checks that ParticleGroup can initialize by particle type
 UP_TEST( ParticleGroup_type_test )
     {
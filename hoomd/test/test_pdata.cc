@@ -617,6 +617,75 @@ UP_TEST( ParticleData_test )
     UP_ASSERT(pdata_type_test.getTypeByName("test") == 1);
     }
 
+//! Test the structure-of-arrays position mirror
+UP_TEST( ParticleData_soa_test )
+    {
+    BoxDim box(10.0);
+    std::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    const unsigned int N = 100;
+    ParticleData pdata(N, box, 3, exec_conf);
+
+    Scalar tol = Scalar(1e-6);
+
+    // the mirror is off by default
+    UP_ASSERT(!pdata.hasPositionsSoA());
+    UP_ASSERT(pdata.getPositionsX().isNull());
+
+    pdata.setPositionsSoA(true);
+    UP_ASSERT(pdata.hasPositionsSoA());
+    UP_ASSERT_EQUAL(pdata.getPositionsX().getNumElements(), pdata.getMaxN());
+    UP_ASSERT_EQUAL(pdata.getTypesSoA().getNumElements(), pdata.getMaxN());
+
+        {
+        ArrayHandle<Scalar4> h_pos(pdata.getPositions(), access_location::host, access_mode::overwrite);
+        for (unsigned int i = 0; i < N; ++i)
+            h_pos.data[i] = make_scalar4(Scalar(0.01)*i, Scalar(-0.02)*i, Scalar(0.03)*i, __int_as_scalar(i % 3));
+        }
+
+    pdata.updatePositionsSoA();
+
+        {
+        ArrayHandle<Scalar> h_x(pdata.getPositionsX(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_y(pdata.getPositionsY(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_z(pdata.getPositionsZ(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_type(pdata.getTypesSoA(), access_location::host, access_mode::read);
+        for (unsigned int i = 0; i < N; ++i)
+            {
+            MY_CHECK_CLOSE(h_x.data[i], Scalar(0.01)*i, tol);
+            MY_CHECK_CLOSE(h_y.data[i], Scalar(-0.02)*i, tol);
+            MY_CHECK_CLOSE(h_z.data[i], Scalar(0.03)*i, tol);
+            UP_ASSERT_EQUAL(h_type.data[i], i % 3);
+            }
+        }
+
+    // the mirror is only copied again after it has been invalidated
+        {
+        ArrayHandle<Scalar4> h_pos(pdata.getPositions(), access_location::host, access_mode::readwrite);
+        h_pos.data[1].x = Scalar(1.5);
+        }
+    pdata.updatePositionsSoA();
+        {
+        ArrayHandle<Scalar> h_x(pdata.getPositionsX(), access_location::host, access_mode::read);
+        MY_CHECK_CLOSE(h_x.data[1], Scalar(0.01), tol);
+        }
+    pdata.invalidatePositionsSoA();
+    pdata.updatePositionsSoA();
+        {
+        ArrayHandle<Scalar> h_x(pdata.getPositionsX(), access_location::host, access_mode::read);
+        MY_CHECK_CLOSE(h_x.data[1], Scalar(1.5), tol);
+        }
+
+    // the mirror grows with the particle data
+    pdata.addGhostParticles(2*N);
+    UP_ASSERT(pdata.getPositionsX().getNumElements() >= 3*N);
+    UP_ASSERT_EQUAL(pdata.getPositionsX().getNumElements(), pdata.getMaxN());
+
+    // disabling releases the memory
+    pdata.setPositionsSoA(false);
+    UP_ASSERT(!pdata.hasPositionsSoA());
+    UP_ASSERT(pdata.getPositionsX().isNull());
+    }
+
 //! Tests the RandomParticleInitializer class
 UP_TEST( Random_test )
     {
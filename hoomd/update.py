@@ -400,6 +400,7 @@ class balance(_updater):
         maxiter (int): Maximum number of iterations to attempt in a single step.
         period (int): Balancing will be attempted every \a period time steps
         phase (int): When -1, start on the current time step. When >= 0, execute on steps where *(step + phase) % period == 0*.
+        weight (str): Particle weight used to measure the load, ``'particles'`` or ``'time'``.
 
     Every *period* steps, the boundaries of the processor domains are adjusted to distribute the particle load close
     to evenly between them. The load imbalance is defined as the number of particles owned by a rank divided by the
@@ -424,6 +425,13 @@ class balance(_updater):
     have significantly more pair force neighbors than others, this estimate of the load imbalance may not produce the
     optimal results.
 
+    With *weight* = ``'time'``, each particle instead carries the wall-clock time that its rank spent in the force and
+    neighbor list computations since the last balancing step, divided by the number of particles on that rank and
+    normalized so that the weights sum to :math:`N`. :math:`N(i)` then becomes the total weight of the particles owned
+    by rank :math:`i`, so that ranks with expensive particles (dense regions, long-range cutoffs, many bonded
+    interactions) shrink even when their particle count is average. The weights travel with the particles when the
+    domain boundaries move, and are remeasured at the next balancing step. Time weights are only available on the CPU.
+
     A load balancing adjustment is only performed when the maximum load imbalance exceeds a *tolerance*. The ideal load
     balance is 1.0, so setting *tolerance* less than 1.0 will force an adjustment every *period*. The load balancer
     can attempt multiple iterations of balancing every *period*, and up to *maxiter* attempts can be made. The optimal
@@ -440,9 +448,13 @@ class balance(_updater):
     either balance infrequently or to balance once in a short test run and then set the decomposition statically in a
     separate initialization.
 
+    With a staggered decomposition (see comm.decomposition()), the *y* cuts of every slab and the *z* cuts of every
+    column are balanced independently. A cut stays at least one ghost layer width inside the neighboring domains of
+    the adjacent slabs and columns, so that particles still only move between neighboring domains in the grid.
+
     Balancing is ignored if there is no domain decomposition available (MPI is not built or is running on a single rank).
     """
-    def __init__(self, x=True, y=True, z=True, tolerance=1.02, maxiter=1, period=1000, phase=0):
+    def __init__(self, x=True, y=True, z=True, tolerance=1.02, maxiter=1, period=1000, phase=0, weight='particles'):
         hoomd.util.print_status_line();
 
         # initialize base class
@@ -462,16 +474,16 @@ class balance(_updater):
         self.setupUpdater(period,phase)
 
         # stash arguments to metadata
-        self.metadata_fields = ['tolerance','maxiter','period','phase']
+        self.metadata_fields = ['tolerance','maxiter','period','phase','weight']
         self.period = period
         self.phase = phase
 
         # configure the parameters
         hoomd.util.quiet_status()
-        self.set_params(x,y,z,tolerance, maxiter)
+        self.set_params(x,y,z,tolerance, maxiter, weight)
         hoomd.util.unquiet_status()
 
-    def set_params(self, x=None, y=None, z=None, tolerance=None, maxiter=None):
+    def set_params(self, x=None, y=None, z=None, tolerance=None, maxiter=None, weight=None):
         R""" Change load balancing parameters.
 
         Args:
@@ -480,12 +492,14 @@ class balance(_updater):
             z (bool): If True, balance in z dimension.
             tolerance (float): Load imbalance tolerance (if <= 1.0, balance every step).
             maxiter (int): Maximum number of iterations to attempt in a single step.
+            weight (str): Particle weight used to measure the load, ``'particles'`` or ``'time'``.
 
 
         Examples::
 
             balance.set_params(x=True, y=False)
             balance.set_params(tolerance=0.02, maxiter=5)
+            balance.set_params(weight='time')
         """
         hoomd.util.print_status_line()
         self.check_initialization()
@@ -502,6 +516,15 @@ class balance(_updater):
         if maxiter is not None:
             self.maxiter = maxiter
             self.cpp_updater.setMaxIterations(self.maxiter)
+        if weight is not None:
+            if weight not in ('particles', 'time'):
+                hoomd.context.msg.error("update.balance: weight must be 'particles' or 'time'\n")
+                raise ValueError("Invalid load balancing weight")
+            if weight == 'time' and hoomd.context.exec_conf.isCUDAEnabled():
+                hoomd.context.msg.error("update.balance: time weights are not supported on the GPU\n")
+                raise RuntimeError("Error setting load balancing weight")
+            self.weight = weight
+            self.cpp_updater.setTimeWeights(self.weight == 'time')
 
 # Global current id counter to assign updaters unique names
 _updater.cur_id = 0;